@@ -7,6 +7,9 @@
 #ifndef _UN_GLM_DATA_H
 #define _UN_GLM_DATA_H
 
+#include <stddef.h>
+#include <stdint.h>
+
 /* The three dimensions number_of_time_bounds,
  * number_of_field_of_view_bounds, number_of_wavelength_bounds have
  * a length of 2. */
@@ -74,6 +77,13 @@
 #define SCALE_FACTOR "scale_factor"
 #define ADD_OFFSET "add_offset"
 
+/* Seconds from 1970-01-01 00:00:00 UTC, the Unix epoch, to
+ * 2000-01-01 12:00:00 UTC, the epoch of product_time. */
+#define GLM_J2000_UNIX 946728000
+
+/* The time fields of the structs are nanoseconds since the Unix
+ * epoch: product_time plus the time offset, decoded in double
+ * precision, so they may be used as exact keys across files. */
 typedef struct GLM_EVENT
 {
     int id;
@@ -82,6 +92,7 @@ typedef struct GLM_EVENT
     float lon;
     float energy;
     unsigned int parent_group_id;
+    int64_t time;
 } GLM_EVENT_T;
 
 typedef struct GLM_GROUP
@@ -94,22 +105,62 @@ typedef struct GLM_GROUP
     float area;
     unsigned int parent_flash_id;
     short quality_flag;
+    int64_t time;
 } GLM_GROUP_T;
 
 typedef struct GLM_FLASH
 {
     int id;
-    unsigned int time_offset_of_first_event;
-    unsigned int time_offset_of_last_event;
-    unsigned int frame_time_offset_of_first_event;
-    unsigned int frame_time_offset_of_last_event;
+    float time_offset_of_first_event;
+    float time_offset_of_last_event;
+    float frame_time_offset_of_first_event;
+    float frame_time_offset_of_last_event;
     float lat;
     float lon;
     float area;
     float energy;
     short quality_flag;
+    int64_t time_of_first_event;
+    int64_t time_of_last_event;
 } GLM_FLASH_T;
 
+/* How a variable is packed: its value is (float)packed *
+ * scale_factor + add_offset, in single precision, where packed is
+ * the value in the file as an unsigned short. */
+typedef struct GLM_PACKING
+{
+    float scale_factor;
+    float add_offset;
+} GLM_PACKING_T;
+
+/* The packing of each packed event variable. */
+typedef struct GLM_EVENT_PACKING
+{
+    GLM_PACKING_T time_offset;
+    GLM_PACKING_T lat;
+    GLM_PACKING_T lon;
+    GLM_PACKING_T energy;
+} GLM_EVENT_PACKING_T;
+
+/* The packing of each packed group variable. */
+typedef struct GLM_GROUP_PACKING
+{
+    GLM_PACKING_T time_offset;
+    GLM_PACKING_T area;
+    GLM_PACKING_T energy;
+} GLM_GROUP_PACKING_T;
+
+/* The packing of each packed flash variable. */
+typedef struct GLM_FLASH_PACKING
+{
+    GLM_PACKING_T time_offset_of_first_event;
+    GLM_PACKING_T time_offset_of_last_event;
+    GLM_PACKING_T frame_time_offset_of_first_event;
+    GLM_PACKING_T frame_time_offset_of_last_event;
+    GLM_PACKING_T area;
+    GLM_PACKING_T energy;
+} GLM_FLASH_PACKING_T;
+
 typedef struct GLM_SCALAR
 {
     double product_time;
@@ -137,4 +188,190 @@ typedef struct GLM_SCALAR
     int algorithm_product_version_container;
 } GLM_SCALAR_T;
 
+/* What a catalog needs to know about a GLM file, from glm_peek(). */
+typedef struct GLM_FILE_INFO
+{
+    size_t nevent;
+    size_t ngroup;
+    size_t nflash;
+    double product_time;
+    double product_time_bounds[EXTRA_DIM_LEN];
+    int event_count;
+    int group_count;
+    int flash_count;
+    float lat_field_of_view_bounds[EXTRA_DIM_LEN];
+    float lon_field_of_view_bounds[EXTRA_DIM_LEN];
+} GLM_FILE_INFO_T;
+
+/* The data of one or more GLM files, as columns. Each *_file column
+ * holds the index of the file each event, group, or flash came
+ * from. When several files are read, the IDs and the parent IDs are
+ * remapped so that they are unique across all the files. */
+typedef struct GLM_BATCH
+{
+    size_t nfile;
+    size_t nevent;
+    size_t ngroup;
+    size_t nflash;
+
+    /* Events. */
+    unsigned int *event_id;
+    float *event_time_offset;
+    float *event_lat;
+    float *event_lon;
+    float *event_energy;
+    unsigned int *event_parent_group_id;
+    int *event_file;
+
+    /* Groups. */
+    unsigned int *group_id;
+    float *group_time_offset;
+    float *group_lat;
+    float *group_lon;
+    float *group_area;
+    float *group_energy;
+    unsigned int *group_parent_flash_id;
+    short *group_quality_flag;
+    int *group_file;
+
+    /* Flashes. */
+    unsigned int *flash_id;
+    float *flash_time_offset_of_first_event;
+    float *flash_time_offset_of_last_event;
+    float *flash_frame_time_offset_of_first_event;
+    float *flash_frame_time_offset_of_last_event;
+    float *flash_lat;
+    float *flash_lon;
+    float *flash_area;
+    float *flash_energy;
+    short *flash_quality_flag;
+    int *flash_file;
+
+    /* Scalars, one per file. */
+    GLM_SCALAR_T *scalar;
+
+    /* The block the columns are carved from, or NULL if the batch
+     * does not own them. */
+    void *block;
+} GLM_BATCH_T;
+
+/* Index of a record which is not there: the parent of an event or
+ * group whose parent ID is not in the batch, or an ID which is not
+ * used. */
+#define GLM_NO_INDEX ((size_t)-1)
+
+/* How the events, groups, and flashes of a batch are related, from
+ * glm_build_hierarchy(). All values are indexes into the columns of
+ * the batch. The groups of flash f are flash_group[flash_group_start[f]]
+ * up to flash_group[flash_group_start[f + 1]], in file order, and the
+ * same for the events of a group and the events of a flash. The
+ * events of a flash are those of its groups, group after group. The
+ * records whose parent is not in the batch come last, from
+ * flash_group_start[nflash], group_event_start[ngroup], and
+ * flash_event_start[nflash]. The maps take an ID, less the first ID
+ * of the map and then masked, to the index of the record with that
+ * ID. The mask is 0xffff when the IDs of a kind are 16-bit counters
+ * which wrap in the batch, as flash IDs may, and all ones
+ * otherwise. */
+typedef struct GLM_HIERARCHY
+{
+    size_t nevent;
+    size_t ngroup;
+    size_t nflash;
+
+    /* Flash to groups. */
+    size_t *flash_group_start;
+    size_t *flash_group;
+
+    /* Group to events. */
+    size_t *group_event_start;
+    size_t *group_event;
+
+    /* Flash to events. */
+    size_t *flash_event_start;
+    size_t *flash_event;
+
+    /* Parent of each event and group, or GLM_NO_INDEX. */
+    size_t *event_group;
+    size_t *group_flash;
+
+    /* ID to index maps. */
+    unsigned int group_id_min;
+    size_t group_id_span;
+    unsigned int group_id_mask;
+    size_t *group_index;
+    unsigned int flash_id_min;
+    size_t flash_id_span;
+    unsigned int flash_id_mask;
+    size_t *flash_index;
+
+    /* The block the arrays are carved from. */
+    void *block;
+} GLM_HIERARCHY_T;
+
+/* Parts of a GLM_FILTER_T which are used. */
+#define GLM_FILTER_BOX 1     /* lat_min <= lat <= lat_max, and the same for lon. */
+#define GLM_FILTER_TIME 2    /* time_min <= time offset <= time_max. */
+#define GLM_FILTER_ENERGY 4  /* energy >= energy_min. */
+#define GLM_FILTER_QUALITY 8 /* quality flag == quality_flag. */
+
+/* A filter on events, groups, or flashes. Only those which pass every
+ * part of the filter named in flags are returned. The time of a flash
+ * is the time offset of its first event. Events have no quality
+ * flag, so GLM_FILTER_QUALITY is ignored for them. */
+typedef struct GLM_FILTER
+{
+    int flags;
+    float lat_min;
+    float lat_max;
+    float lon_min;
+    float lon_max;
+    float time_min;
+    float time_max;
+    float energy_min;
+    short quality_flag;
+} GLM_FILTER_T;
+
+/* Size of the name field of a GLM_CATALOG_ENTRY_T. */
+#define GLM_CATALOG_NAME_LEN 128
+
+/* One granule in a catalog, from glm_catalog_entry(). Times are
+ * seconds since 2000-01-01 12:00:00 UTC, like product_time. The time
+ * span of the granule is the union of product_time_bounds and the
+ * start and end times in its name. The extent is that of its events;
+ * if it has none, lat_min > lat_max. */
+typedef struct GLM_CATALOG_ENTRY
+{
+    char name[GLM_CATALOG_NAME_LEN];
+    double time_start;
+    double time_end;
+    double name_start;
+    double name_end;
+    double name_created;
+    int64_t mtime;
+    int64_t size;
+    int64_t nevent;
+    int64_t ngroup;
+    int64_t nflash;
+    float lat_min;
+    float lat_max;
+    float lon_min;
+    float lon_max;
+} GLM_CATALOG_ENTRY_T;
+
+/* A query of a catalog. Only granules which pass every part named in
+ * flags are returned: GLM_FILTER_TIME for those whose time span
+ * overlaps time_min to time_max, GLM_FILTER_BOX for those whose
+ * extent overlaps the box. */
+typedef struct GLM_CATALOG_QUERY
+{
+    int flags;
+    double time_min;
+    double time_max;
+    float lat_min;
+    float lat_max;
+    float lon_min;
+    float lon_max;
+} GLM_CATALOG_QUERY_T;
+
 #endif /* _UN_GLM_DATA_H */
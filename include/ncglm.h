@@ -7,12 +7,113 @@
 #ifndef _GOES_GLM_H
 #define _GOES_GLM_H
 
+#include <stdint.h>
 #include <netcdf.h>
 #include "glm_data.h"
 
 #define GLM_ERR_TIMER 99
 #define GLM_ERR_MEMORY 100
 #define GLM_ERR_UNEXPECTED 101
+#define GLM_ERR_RANGE 102
+#define GLM_ERR_IO 103
+#define GLM_ERR_CACHE 104
+#define GLM_ERR_NAME 105
+#define GLM_ERR_CATALOG 106
+
+/* Event fields, for glm_set_fields(). */
+#define GLM_EV_ID 0x1
+#define GLM_EV_TIME 0x2
+#define GLM_EV_LAT 0x4
+#define GLM_EV_LON 0x8
+#define GLM_EV_ENERGY 0x10
+#define GLM_EV_PARENT 0x20
+#define GLM_EV_ALL 0x3f
+
+/* Group fields, for glm_set_fields(). */
+#define GLM_GR_ID 0x1
+#define GLM_GR_TIME 0x2
+#define GLM_GR_LAT 0x8
+#define GLM_GR_LON 0x10
+#define GLM_GR_AREA 0x20
+#define GLM_GR_ENERGY 0x40
+#define GLM_GR_PARENT 0x80
+#define GLM_GR_QUALITY 0x100
+#define GLM_GR_ALL 0x1ff
+
+/* Flash fields, for glm_set_fields(). */
+#define GLM_FL_ID 0x1
+#define GLM_FL_TIME_FIRST 0x2
+#define GLM_FL_TIME_LAST 0x4
+#define GLM_FL_FRAME_TIME_FIRST 0x8
+#define GLM_FL_FRAME_TIME_LAST 0x10
+#define GLM_FL_LAT 0x20
+#define GLM_FL_LON 0x40
+#define GLM_FL_AREA 0x80
+#define GLM_FL_ENERGY 0x100
+#define GLM_FL_QUALITY 0x200
+#define GLM_FL_ALL 0x3ff
+
+/* Opaque handle to an open GLM file, from glm_open(). */
+typedef struct GLM_FILE GLM_FILE_T;
+
+/* Opaque iterator over the events, groups, or flashes of a file. */
+typedef struct GLM_ITER GLM_ITER_T;
+
+/* Opaque handle to an open cache file, from glm_open_cache(). */
+typedef struct GLM_CACHE GLM_CACHE_T;
+
+/* Opaque handle to an open catalog, from glm_catalog_open(). */
+typedef struct GLM_CATALOG GLM_CATALOG_T;
+
+/* Opaque reader context, from glm_reader_create(). */
+typedef struct GLM_READER GLM_READER_T;
+
+/* The structs of the Apache Arrow C Data Interface, as given in its
+ * specification, for glm_export_*_arrow(). */
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+struct ArrowSchema
+{
+    const char *format;
+    const char *name;
+    const char *metadata;
+    int64_t flags;
+    int64_t n_children;
+    struct ArrowSchema **children;
+    struct ArrowSchema *dictionary;
+    void (*release)(struct ArrowSchema *);
+    void *private_data;
+};
+
+struct ArrowArray
+{
+    int64_t length;
+    int64_t null_count;
+    int64_t offset;
+    int64_t n_buffers;
+    int64_t n_children;
+    const void **buffers;
+    struct ArrowArray **children;
+    struct ArrowArray *dictionary;
+    void (*release)(struct ArrowArray *);
+    void *private_data;
+};
+
+#endif /* ARROW_C_DATA_INTERFACE */
+
+/* Allocator hooks, for glm_set_allocator(). GLM_ALLOC_FN returns
+ * size bytes aligned to align bytes, or NULL. */
+typedef void *(*GLM_ALLOC_FN)(size_t size, size_t align, void *ctx);
+typedef void (*GLM_FREE_FN)(void *ptr, void *ctx);
+
+/* Function called by glm_pipeline() with the data of each file. A
+ * non-zero return stops the pipeline. */
+typedef int (*GLM_BATCH_FN)(const GLM_BATCH_T *batch, int file, void *arg);
 
 /* This macro prints an error message with line number and name of
  * test program, and the netCDF error string. */
@@ -28,6 +129,13 @@
 extern "C" {
 #endif
 
+    /* Set the functions which allocate and free all library memory. */
+    int glm_set_allocator(GLM_ALLOC_FN alloc_fn, GLM_FREE_FN free_fn,
+                          void *ctx);
+
+    /* Choose whether large blocks are backed by huge pages. */
+    int glm_set_hugepages(int hugepages);
+
     /* Learn the lengths of each dimension. */
     int glm_read_dims(int ncid, size_t *nevent, size_t *ngroup, size_t *nflash);
 
@@ -62,6 +170,380 @@ extern "C" {
     /* Read scalars and small arrays into GLM_SCALAR_T struct. */
     int read_scalars(int ncid, GLM_SCALAR_T *glm_scalar);
 
+    /* Open a GLM file, caching all of its metadata. */
+    int glm_open(const char *file_name, GLM_FILE_T **glm);
+
+    /* Open a GLM file which is already in memory. */
+    int glm_open_mem(const void *buf, size_t len, GLM_FILE_T **glm);
+
+    /* Close a GLM file opened with glm_open() or glm_open_mem(). */
+    int glm_close(GLM_FILE_T *glm);
+
+    /* Choose which fields the readers of an open GLM file read. */
+    int glm_set_fields(GLM_FILE_T *glm, int event_fields, int group_fields,
+                       int flash_fields);
+
+    /* Choose the number of threads which read the variables of an open GLM file. */
+    int glm_set_nthreads(GLM_FILE_T *glm, int nthreads);
+
+    /* Turn direct, parallel chunk reads on or off for an open GLM file. */
+    int glm_set_direct(GLM_FILE_T *glm, int nthreads);
+
+    /* Learn whether direct chunk reads are on for an open GLM file. */
+    int glm_inq_direct(GLM_FILE_T *glm, int *direct);
+
+    /* Find the ncid of an open GLM file. */
+    int glm_inq_ncid(GLM_FILE_T *glm, int *ncid);
+
+    /* Learn the lengths of each dimension of an open GLM file. */
+    int glm_inq_dims(GLM_FILE_T *glm, size_t *nevent, size_t *ngroup,
+                     size_t *nflash);
+
+    /* Read event data from an open GLM file into array of GLM_EVENT_T. */
+    int glm_get_event_structs(GLM_FILE_T *glm, size_t *nevent,
+                              GLM_EVENT_T *event);
+
+    /* Read group data from an open GLM file into array of GLM_GROUP_T. */
+    int glm_get_group_structs(GLM_FILE_T *glm, size_t *ngroup,
+                              GLM_GROUP_T *group);
+
+    /* Read flash data from an open GLM file into array of GLM_FLASH_T. */
+    int glm_get_flash_structs(GLM_FILE_T *glm, size_t *nflash,
+                              GLM_FLASH_T *flash);
+
+    /* Read event data from an open GLM file into arrays. */
+    int glm_get_event_arrays(GLM_FILE_T *glm, size_t *nevent, int *event_id,
+                             float *time_offset, float *lat, float *lon,
+                             float *energy, int *parent_group_id);
+
+    /* Read group data from an open GLM file into arrays. */
+    int glm_get_group_arrays(GLM_FILE_T *glm, size_t *ngroup,
+                             float *time_offset, float *lat, float *lon,
+                             float *energy, float *area,
+                             unsigned int *parent_flash_id,
+                             short *quality_flag);
+
+    /* Read flash data from an open GLM file into arrays. */
+    int glm_get_flash_arrays(GLM_FILE_T *glm, size_t *nflash,
+                             float *time_offset_of_first_event,
+                             float *time_offset_of_last_event,
+                             float *frame_time_offset_of_first_event,
+                             float *frame_time_offset_of_last_event,
+                             float *lat, float *lon, float *area,
+                             float *energy, short *quality_flag);
+
+    /* Read a range of events from an open GLM file into array of
+     * GLM_EVENT_T. */
+    int glm_read_event_range(GLM_FILE_T *glm, size_t start, size_t count,
+                             GLM_EVENT_T *event);
+
+    /* Read a range of groups from an open GLM file into array of
+     * GLM_GROUP_T. */
+    int glm_read_group_range(GLM_FILE_T *glm, size_t start, size_t count,
+                             GLM_GROUP_T *group);
+
+    /* Read a range of flashes from an open GLM file into array of
+     * GLM_FLASH_T. */
+    int glm_read_flash_range(GLM_FILE_T *glm, size_t start, size_t count,
+                             GLM_FLASH_T *flash);
+
+    /* Read the times of a range of events, in ns since the Unix
+     * epoch. */
+    int glm_read_event_times(GLM_FILE_T *glm, size_t start, size_t count,
+                             int64_t *time);
+
+    /* Read the times of a range of groups, in ns since the Unix
+     * epoch. */
+    int glm_read_group_times(GLM_FILE_T *glm, size_t start, size_t count,
+                             int64_t *time);
+
+    /* Read the times of the first and last events of a range of
+     * flashes, in ns since the Unix epoch. */
+    int glm_read_flash_times(GLM_FILE_T *glm, size_t start, size_t count,
+                             int64_t *time_of_first_event,
+                             int64_t *time_of_last_event);
+
+    /* Read a range of events from an open GLM file into arrays. */
+    int glm_read_event_range_arrays(GLM_FILE_T *glm, size_t start,
+                                    size_t count, int *event_id,
+                                    float *time_offset, float *lat,
+                                    float *lon, float *energy,
+                                    int *parent_group_id);
+
+    /* Read a range of groups from an open GLM file into arrays. */
+    int glm_read_group_range_arrays(GLM_FILE_T *glm, size_t start,
+                                    size_t count, float *time_offset,
+                                    float *lat, float *lon, float *energy,
+                                    float *area, unsigned int *parent_flash_id,
+                                    short *quality_flag);
+
+    /* Read a range of flashes from an open GLM file into arrays. */
+    int glm_read_flash_range_arrays(GLM_FILE_T *glm, size_t start,
+                                    size_t count,
+                                    float *time_offset_of_first_event,
+                                    float *time_offset_of_last_event,
+                                    float *frame_time_offset_of_first_event,
+                                    float *frame_time_offset_of_last_event,
+                                    float *lat, float *lon, float *area,
+                                    float *energy, short *quality_flag);
+
+    /* Read a range of events into arrays, leaving the packed
+     * variables packed. */
+    int glm_read_event_packed(GLM_FILE_T *glm, size_t start, size_t count,
+                              int *event_id, unsigned short *time_offset,
+                              unsigned short *lat, unsigned short *lon,
+                              unsigned short *energy, int *parent_group_id,
+                              GLM_EVENT_PACKING_T *packing);
+
+    /* Read a range of groups into arrays, leaving the packed
+     * variables packed. */
+    int glm_read_group_packed(GLM_FILE_T *glm, size_t start, size_t count,
+                              unsigned short *time_offset, float *lat,
+                              float *lon, unsigned short *energy,
+                              unsigned short *area,
+                              unsigned int *parent_flash_id,
+                              short *quality_flag,
+                              GLM_GROUP_PACKING_T *packing);
+
+    /* Read a range of flashes into arrays, leaving the packed
+     * variables packed. */
+    int glm_read_flash_packed(GLM_FILE_T *glm, size_t start, size_t count,
+                              unsigned short *time_offset_of_first_event,
+                              unsigned short *time_offset_of_last_event,
+                              unsigned short *frame_time_offset_of_first_event,
+                              unsigned short *frame_time_offset_of_last_event,
+                              float *lat, float *lon, unsigned short *area,
+                              unsigned short *energy, short *quality_flag,
+                              GLM_FLASH_PACKING_T *packing);
+
+    /* Unpack values read by the packed readers, as the library
+     * does. */
+    int glm_unpack(const GLM_PACKING_T *packing, const unsigned short *packed,
+                   size_t n, float *value);
+
+    /* Read the events of a range which pass a filter into array of
+     * GLM_EVENT_T. */
+    int glm_read_event_filter(GLM_FILE_T *glm, size_t start, size_t count,
+                              const GLM_FILTER_T *filter, size_t *nmatch,
+                              GLM_EVENT_T *event);
+
+    /* Read the events of a range which pass a filter into arrays. */
+    int glm_read_event_filter_arrays(GLM_FILE_T *glm, size_t start,
+                                     size_t count, const GLM_FILTER_T *filter,
+                                     size_t *nmatch, int *event_id,
+                                     float *time_offset, float *lat,
+                                     float *lon, float *energy,
+                                     int *parent_group_id);
+
+    /* Read the groups of a range which pass a filter into array of
+     * GLM_GROUP_T. */
+    int glm_read_group_filter(GLM_FILE_T *glm, size_t start, size_t count,
+                              const GLM_FILTER_T *filter, size_t *nmatch,
+                              GLM_GROUP_T *group);
+
+    /* Read the groups of a range which pass a filter into arrays. */
+    int glm_read_group_filter_arrays(GLM_FILE_T *glm, size_t start,
+                                     size_t count, const GLM_FILTER_T *filter,
+                                     size_t *nmatch, float *time_offset,
+                                     float *lat, float *lon, float *energy,
+                                     float *area, unsigned int *parent_flash_id,
+                                     short *quality_flag);
+
+    /* Read the flashes of a range which pass a filter into array of
+     * GLM_FLASH_T. */
+    int glm_read_flash_filter(GLM_FILE_T *glm, size_t start, size_t count,
+                              const GLM_FILTER_T *filter, size_t *nmatch,
+                              GLM_FLASH_T *flash);
+
+    /* Read the flashes of a range which pass a filter into arrays. */
+    int glm_read_flash_filter_arrays(GLM_FILE_T *glm, size_t start,
+                                     size_t count, const GLM_FILTER_T *filter,
+                                     size_t *nmatch,
+                                     float *time_offset_of_first_event,
+                                     float *time_offset_of_last_event,
+                                     float *frame_time_offset_of_first_event,
+                                     float *frame_time_offset_of_last_event,
+                                     float *lat, float *lon, float *area,
+                                     float *energy, short *quality_flag);
+
+    /* Iterate over the events of an open GLM file in batches. */
+    int glm_event_iter_open(GLM_FILE_T *glm, size_t batch_len,
+                            GLM_ITER_T **iter);
+    int glm_event_iter_next(GLM_ITER_T *iter, GLM_EVENT_T *event,
+                            size_t *count);
+
+    /* Iterate over the groups of an open GLM file in batches. */
+    int glm_group_iter_open(GLM_FILE_T *glm, size_t batch_len,
+                            GLM_ITER_T **iter);
+    int glm_group_iter_next(GLM_ITER_T *iter, GLM_GROUP_T *group,
+                            size_t *count);
+
+    /* Iterate over the flashes of an open GLM file in batches. */
+    int glm_flash_iter_open(GLM_FILE_T *glm, size_t batch_len,
+                            GLM_ITER_T **iter);
+    int glm_flash_iter_next(GLM_ITER_T *iter, GLM_FLASH_T *flash,
+                            size_t *count);
+
+    /* Close an iterator. */
+    int glm_iter_close(GLM_ITER_T *iter);
+
+    /* Read many GLM files, on several threads, into one batch. */
+    int glm_read_files(const char **paths, int nfile, int nthreads,
+                       GLM_BATCH_T *batch);
+
+    /* Free the data of a batch. */
+    int glm_free_batch(GLM_BATCH_T *batch);
+
+    /* Read GLM files in order, reading ahead on a background thread,
+     * and pass each to a callback. */
+    int glm_pipeline(const char **paths, int nfile, int depth,
+                     GLM_BATCH_FN callback, void *arg);
+
+    /* Write the data of a batch to a cache file. */
+    int glm_write_cache(const GLM_BATCH_T *batch, const char *path);
+
+    /* Read a GLM file, and write its data to a cache file. */
+    int glm_convert_to_cache(const char *file_name, const char *path);
+
+    /* Open a cache file by mapping it into memory. */
+    int glm_open_cache(const char *path, GLM_CACHE_T **cache);
+
+    /* Get the columns of an open cache file, with no copy. */
+    int glm_cache_batch(GLM_CACHE_T *cache, const GLM_BATCH_T **batch);
+
+    /* Close a cache file opened with glm_open_cache(). */
+    int glm_close_cache(GLM_CACHE_T *cache);
+
+    /* Export the events of a batch as an Arrow array, with no copy. */
+    int glm_export_events_arrow(const GLM_BATCH_T *batch,
+                                struct ArrowSchema *schema,
+                                struct ArrowArray *array);
+
+    /* Export the groups of a batch as an Arrow array, with no copy. */
+    int glm_export_groups_arrow(const GLM_BATCH_T *batch,
+                                struct ArrowSchema *schema,
+                                struct ArrowArray *array);
+
+    /* Export the flashes of a batch as an Arrow array, with no copy. */
+    int glm_export_flashes_arrow(const GLM_BATCH_T *batch,
+                                 struct ArrowSchema *schema,
+                                 struct ArrowArray *array);
+
+    /* Learn the dimensions, times, counts, and field of view of a GLM
+     * file, reading nothing else. */
+    int glm_peek(const char *path, GLM_FILE_INFO_T *info);
+
+    /* Peek at many GLM files, on several threads. */
+    int glm_peek_files(const char **paths, int nfile, int nthreads,
+                       GLM_FILE_INFO_T *info, int *status);
+
+    /* Find the start, end, and creation times in the name of a GLM
+     * file. */
+    int glm_name_times(const char *name, double *start, double *end,
+                       double *created);
+
+    /* Catalog all the GLM files of a directory. */
+    int glm_catalog_build(const char *dir, const char *path, int nthreads,
+                          size_t *nentry);
+
+    /* Bring a catalog up to date with its directory. */
+    int glm_catalog_update(const char *dir, const char *path, int nthreads,
+                           size_t *nentry);
+
+    /* Open a catalog by mapping it into memory. */
+    int glm_catalog_open(const char *path, GLM_CATALOG_T **catalog);
+
+    /* Learn the number of granules in an open catalog. */
+    int glm_catalog_len(GLM_CATALOG_T *catalog, size_t *nentry);
+
+    /* Get one granule of an open catalog. */
+    int glm_catalog_entry(GLM_CATALOG_T *catalog, size_t i,
+                          const GLM_CATALOG_ENTRY_T **entry);
+
+    /* Find the granules of an open catalog which pass a query. */
+    int glm_catalog_query(GLM_CATALOG_T *catalog,
+                          const GLM_CATALOG_QUERY_T *query, size_t *nmatch,
+                          size_t *match);
+
+    /* Close a catalog opened with glm_catalog_open(). */
+    int glm_catalog_close(GLM_CATALOG_T *catalog);
+
+    /* Read the events, groups, and flashes of a time window from a
+     * directory of GLM files, in time order. */
+    int glm_query_time(const char *dir, double t0, double t1, int nthreads,
+                       GLM_BATCH_T *batch);
+
+    /* Index how the events, groups, and flashes of a batch are
+     * related. */
+    int glm_build_hierarchy(const GLM_BATCH_T *batch, int nthreads,
+                            GLM_HIERARCHY_T *hier);
+
+    /* Free the arrays of a hierarchy. */
+    int glm_free_hierarchy(GLM_HIERARCHY_T *hier);
+
+    /* Get the groups of a flash. */
+    int glm_flash_groups(const GLM_HIERARCHY_T *hier, size_t flash,
+                         const size_t **group, size_t *ngroup);
+
+    /* Get the events of a flash. */
+    int glm_flash_events(const GLM_HIERARCHY_T *hier, size_t flash,
+                         const size_t **event, size_t *nevent);
+
+    /* Get the events of a group. */
+    int glm_group_events(const GLM_HIERARCHY_T *hier, size_t group,
+                         const size_t **event, size_t *nevent);
+
+    /* Find the index of a group from its ID. */
+    int glm_group_index(const GLM_HIERARCHY_T *hier, unsigned int id,
+                        size_t *group);
+
+    /* Find the index of a flash from its ID. */
+    int glm_flash_index(const GLM_HIERARCHY_T *hier, unsigned int id,
+                        size_t *flash);
+
+    /* Reorder the events and groups of a batch so that the records of
+     * each flash are next to each other. */
+    int glm_cluster_batch(const GLM_BATCH_T *batch, int nthreads,
+                          GLM_BATCH_T *out, size_t *event_perm,
+                          size_t *group_perm);
+
+    /* Create a reader context, which reuses its buffers from file to
+     * file. */
+    int glm_reader_create(GLM_READER_T **reader);
+
+    /* Open a GLM file with a reader, closing the one it had open. */
+    int glm_reader_open(GLM_READER_T *reader, const char *file_name);
+
+    /* Get the handle of the file open in a reader. */
+    int glm_reader_file(GLM_READER_T *reader, GLM_FILE_T **glm);
+
+    /* Read the events of the file open in a reader. */
+    int glm_reader_events(GLM_READER_T *reader, size_t *nevent,
+                          const GLM_EVENT_T **event);
+
+    /* Read the groups of the file open in a reader. */
+    int glm_reader_groups(GLM_READER_T *reader, size_t *ngroup,
+                          const GLM_GROUP_T **group);
+
+    /* Read the flashes of the file open in a reader. */
+    int glm_reader_flashes(GLM_READER_T *reader, size_t *nflash,
+                           const GLM_FLASH_T **flash);
+
+    /* Read the scalars of the file open in a reader. */
+    int glm_reader_scalars(GLM_READER_T *reader, const GLM_SCALAR_T **scalar);
+
+    /* Read all the data of the file open in a reader into a batch. */
+    int glm_reader_batch(GLM_READER_T *reader, const GLM_BATCH_T **batch);
+
+    /* Close the file open in a reader, keeping its buffers. */
+    int glm_reader_close(GLM_READER_T *reader);
+
+    /* Free a reader and its buffers. */
+    int glm_reader_free(GLM_READER_T *reader);
+
+    /* Read scalars from an open GLM file into GLM_SCALAR_T struct. */
+    int glm_get_scalars(GLM_FILE_T *glm, GLM_SCALAR_T *glm_scalar);
+
     /* Read the whole file. */
     int glm_read_file(char *file_name, int verbose);
 
@@ -1,47 +1,397 @@
 # This is the Python wrapper for the ncglm library.
+#
+# NumPy is required at run time. Data comes back as NumPy arrays. Structured arrays (EVENT_DTYPE,
+# GROUP_DTYPE, FLASH_DTYPE) have the layout of the C structs, and the
+# library reads straight into them. The columns of a Batch or a Cache
+# wrap the buffers of the library with no copy, and keep them alive
+# for as long as any array uses them.
+#
+# Calls through ctypes.CDLL release the GIL, so other Python threads
+# run while read_files() reads.
 
 # Maximilian McClelland 1/29/21
 
 import ctypes
+import ctypes.util
 import os
 
-# Full path is necessiary for cytpes function.
-temp = os.path.abspath(__file__)
-temp = os.path.realpath(temp)
-temp = os.path.dirname(temp)
-end = len(temp) - 4
-path = temp[:end] + "src"
-lib = os.path.join(path, "libncglm.so")
-
-# Checks that path is correct. Will also be removed later.
-path = "\nPath: \n" + lib + "\n"
-
-# Creating Libraries
-try:
-    lib_ncglm = ctypes.CDLL(lib)
-except Exception as err:
-    err = "Could not load NCGLM Library:\n" + str(err)
-    print(err)
-    exit()
-
-# Specifying Functions
-read_group_vars = lib_ncglm.read_group_vars
-glm_read_group_structs = lib_ncglm.glm_read_group_structs
-glm_read_group_arrays = lib_ncglm.glm_read_group_arrays
-
-read_event_vars = lib_ncglm.read_event_vars
-glm_read_event_structs = lib_ncglm.glm_read_event_structs
-glm_read_event_arrays = lib_ncglm.glm_read_event_arrays
-
-read_flash_vars = lib_ncglm.read_flash_vars
-glm_read_flash_structs = lib_ncglm.glm_read_flash_structs
-glm_read_flash_arrays = lib_ncglm.glm_read_flash_arrays
-
-glm_read_dims = lib_ncglm.glm_read_dims
-read_scalars = lib_ncglm.read_scalars
-glm_read_file = lib_ncglm.glm_read_file
-glm_read_file_arrays = lib_ncglm.glm_read_file_arrays
-
-# Specify inputs
-# read_group_vars.argtypes = [ctypes.c_int, ctypes.]
+import numpy as np
 
+__all__ = ["GLMError", "File", "Batch", "Cache", "read_files",
+           "open_cache", "convert_to_cache", "EVENT_DTYPE", "GROUP_DTYPE",
+           "FLASH_DTYPE"]
+
+
+def _load():
+    """Find and load libncglm. NCGLM_LIBRARY names it, otherwise the
+    build tree is searched, then the system."""
+    here = os.path.dirname(os.path.realpath(__file__))
+    names = [os.environ.get("NCGLM_LIBRARY"),
+             os.path.join(here, "..", "src", ".libs", "libncglm.so"),
+             os.path.join(here, "..", "src", "libncglm.so"),
+             ctypes.util.find_library("ncglm")]
+    for name in names:
+        if name and (os.path.exists(name) or name == names[-1]):
+            return ctypes.CDLL(name)
+    raise ImportError("Could not find the ncglm library; set NCGLM_LIBRARY")
+
+
+_lib = _load()
+
+# Error codes, from ncglm.h.
+GLM_ERR_TIMER = 99
+GLM_ERR_MEMORY = 100
+GLM_ERR_UNEXPECTED = 101
+GLM_ERR_RANGE = 102
+GLM_ERR_IO = 103
+GLM_ERR_CACHE = 104
+GLM_ERR_NAME = 105
+GLM_ERR_CATALOG = 106
+
+_messages = {GLM_ERR_TIMER: "timer error",
+             GLM_ERR_MEMORY: "out of memory",
+             GLM_ERR_UNEXPECTED: "unexpected result",
+             GLM_ERR_RANGE: "value out of range",
+             GLM_ERR_IO: "I/O error",
+             GLM_ERR_CACHE: "not a valid cache file",
+             GLM_ERR_NAME: "not a GLM file name",
+             GLM_ERR_CATALOG: "not a valid catalog file"}
+
+# Structured array types with the layout of GLM_EVENT_T, GLM_GROUP_T
+# and GLM_FLASH_T.
+EVENT_DTYPE = np.dtype([("id", np.int32), ("time_offset", np.float32),
+                        ("lat", np.float32), ("lon", np.float32),
+                        ("energy", np.float32),
+                        ("parent_group_id", np.uint32),
+                        ("time", np.int64)], align=True)
+GROUP_DTYPE = np.dtype([("id", np.int32), ("time_offset", np.float32),
+                        ("lat", np.float32), ("lon", np.float32),
+                        ("energy", np.float32), ("area", np.float32),
+                        ("parent_flash_id", np.uint32),
+                        ("quality_flag", np.int16),
+                        ("time", np.int64)], align=True)
+FLASH_DTYPE = np.dtype([("id", np.int32),
+                        ("time_offset_of_first_event", np.float32),
+                        ("time_offset_of_last_event", np.float32),
+                        ("frame_time_offset_of_first_event", np.float32),
+                        ("frame_time_offset_of_last_event", np.float32),
+                        ("lat", np.float32), ("lon", np.float32),
+                        ("area", np.float32), ("energy", np.float32),
+                        ("quality_flag", np.int16),
+                        ("time_of_first_event", np.int64),
+                        ("time_of_last_event", np.int64)], align=True)
+
+# Fields, for File.set_fields(), from ncglm.h.
+GLM_EV_ID, GLM_EV_TIME, GLM_EV_LAT, GLM_EV_LON = 0x1, 0x2, 0x4, 0x8
+GLM_EV_ENERGY, GLM_EV_PARENT, GLM_EV_ALL = 0x10, 0x20, 0x3f
+GLM_GR_ID, GLM_GR_TIME, GLM_GR_LAT, GLM_GR_LON = 0x1, 0x2, 0x8, 0x10
+GLM_GR_AREA, GLM_GR_ENERGY, GLM_GR_PARENT = 0x20, 0x40, 0x80
+GLM_GR_QUALITY, GLM_GR_ALL = 0x100, 0x1ff
+GLM_FL_ID, GLM_FL_TIME_FIRST, GLM_FL_TIME_LAST = 0x1, 0x2, 0x4
+GLM_FL_FRAME_TIME_FIRST, GLM_FL_FRAME_TIME_LAST = 0x8, 0x10
+GLM_FL_LAT, GLM_FL_LON, GLM_FL_AREA, GLM_FL_ENERGY = 0x20, 0x40, 0x80, 0x100
+GLM_FL_QUALITY, GLM_FL_ALL = 0x200, 0x3ff
+
+_EXTRA_DIM_LEN = 2
+
+
+class GLMError(Exception):
+    """An error code from the ncglm library, or from netCDF."""
+
+    def __init__(self, code):
+        self.code = code
+        if code in _messages:
+            msg = _messages[code]
+        else:
+            msg = _lib.nc_strerror(code).decode()
+        Exception.__init__(self, "%s (%d)" % (msg, code))
+
+
+def _check(ret):
+    if ret:
+        raise GLMError(ret)
+
+
+class _Scalar(ctypes.Structure):
+    _fields_ = [("product_time", ctypes.c_double),
+                ("product_time_bounds", ctypes.c_double * _EXTRA_DIM_LEN),
+                ("lightning_wavelength", ctypes.c_float),
+                ("lightning_wavelength_bounds", ctypes.c_float * _EXTRA_DIM_LEN),
+                ("group_time_threshold", ctypes.c_float),
+                ("flash_time_threshold", ctypes.c_float),
+                ("lat_field_of_view", ctypes.c_float),
+                ("lat_field_of_view_bounds", ctypes.c_float * _EXTRA_DIM_LEN),
+                ("goes_lat_lon_projection", ctypes.c_int),
+                ("event_count", ctypes.c_int),
+                ("group_count", ctypes.c_int),
+                ("flash_count", ctypes.c_int),
+                ("percent_navigated_L1b_events", ctypes.c_float),
+                ("yaw_flip_flag", ctypes.c_byte),
+                ("nominal_satellite_subpoint_lat", ctypes.c_float),
+                ("nominal_satellite_height", ctypes.c_float),
+                ("nominal_satellite_subpoint_lon", ctypes.c_float),
+                ("lon_field_of_view", ctypes.c_float),
+                ("lon_field_of_view_bounds", ctypes.c_float * _EXTRA_DIM_LEN),
+                ("percent_uncorrectable_L0_errors", ctypes.c_float),
+                ("algorithm_dynamic_input_data_container", ctypes.c_int),
+                ("processing_parm_version_container", ctypes.c_int),
+                ("algorithm_product_version_container", ctypes.c_int)]
+
+    def to_dict(self):
+        d = {}
+        for name, ctype in self._fields_:
+            value = getattr(self, name)
+            d[name] = list(value) if issubclass(ctype, ctypes.Array) else value
+        return d
+
+
+# The columns of GLM_BATCH_T, in order, with their types and the
+# count which gives their length.
+_columns = [("event_id", ctypes.c_uint, "nevent"),
+            ("event_time_offset", ctypes.c_float, "nevent"),
+            ("event_lat", ctypes.c_float, "nevent"),
+            ("event_lon", ctypes.c_float, "nevent"),
+            ("event_energy", ctypes.c_float, "nevent"),
+            ("event_parent_group_id", ctypes.c_uint, "nevent"),
+            ("event_file", ctypes.c_int, "nevent"),
+            ("group_id", ctypes.c_uint, "ngroup"),
+            ("group_time_offset", ctypes.c_float, "ngroup"),
+            ("group_lat", ctypes.c_float, "ngroup"),
+            ("group_lon", ctypes.c_float, "ngroup"),
+            ("group_area", ctypes.c_float, "ngroup"),
+            ("group_energy", ctypes.c_float, "ngroup"),
+            ("group_parent_flash_id", ctypes.c_uint, "ngroup"),
+            ("group_quality_flag", ctypes.c_short, "ngroup"),
+            ("group_file", ctypes.c_int, "ngroup"),
+            ("flash_id", ctypes.c_uint, "nflash"),
+            ("flash_time_offset_of_first_event", ctypes.c_float, "nflash"),
+            ("flash_time_offset_of_last_event", ctypes.c_float, "nflash"),
+            ("flash_frame_time_offset_of_first_event", ctypes.c_float, "nflash"),
+            ("flash_frame_time_offset_of_last_event", ctypes.c_float, "nflash"),
+            ("flash_lat", ctypes.c_float, "nflash"),
+            ("flash_lon", ctypes.c_float, "nflash"),
+            ("flash_area", ctypes.c_float, "nflash"),
+            ("flash_energy", ctypes.c_float, "nflash"),
+            ("flash_quality_flag", ctypes.c_short, "nflash"),
+            ("flash_file", ctypes.c_int, "nflash")]
+
+
+class _Batch(ctypes.Structure):
+    _fields_ = ([("nfile", ctypes.c_size_t), ("nevent", ctypes.c_size_t),
+                 ("ngroup", ctypes.c_size_t), ("nflash", ctypes.c_size_t)] +
+                [(name, ctypes.POINTER(ctype)) for name, ctype, n in _columns] +
+                [("scalar", ctypes.POINTER(_Scalar)),
+                 ("block", ctypes.c_void_p)])
+
+
+# Argument and return types of the functions used.
+_size_p = ctypes.POINTER(ctypes.c_size_t)
+_lib.nc_strerror.restype = ctypes.c_char_p
+_lib.nc_strerror.argtypes = [ctypes.c_int]
+_lib.glm_open.argtypes = [ctypes.c_char_p, ctypes.POINTER(ctypes.c_void_p)]
+_lib.glm_close.argtypes = [ctypes.c_void_p]
+_lib.glm_set_fields.argtypes = [ctypes.c_void_p, ctypes.c_int, ctypes.c_int,
+                                ctypes.c_int]
+_lib.glm_set_nthreads.argtypes = [ctypes.c_void_p, ctypes.c_int]
+_lib.glm_set_direct.argtypes = [ctypes.c_void_p, ctypes.c_int]
+_lib.glm_inq_dims.argtypes = [ctypes.c_void_p, _size_p, _size_p, _size_p]
+for _f in (_lib.glm_read_event_range, _lib.glm_read_group_range,
+           _lib.glm_read_flash_range, _lib.glm_read_event_times,
+           _lib.glm_read_group_times):
+    _f.argtypes = [ctypes.c_void_p, ctypes.c_size_t, ctypes.c_size_t,
+                   ctypes.c_void_p]
+_lib.glm_read_flash_times.argtypes = [ctypes.c_void_p, ctypes.c_size_t,
+                                      ctypes.c_size_t, ctypes.c_void_p,
+                                      ctypes.c_void_p]
+_lib.glm_get_scalars.argtypes = [ctypes.c_void_p, ctypes.POINTER(_Scalar)]
+_lib.glm_read_files.argtypes = [ctypes.POINTER(ctypes.c_char_p), ctypes.c_int,
+                                ctypes.c_int, ctypes.POINTER(_Batch)]
+_lib.glm_free_batch.argtypes = [ctypes.POINTER(_Batch)]
+_lib.glm_write_cache.argtypes = [ctypes.POINTER(_Batch), ctypes.c_char_p]
+_lib.glm_convert_to_cache.argtypes = [ctypes.c_char_p, ctypes.c_char_p]
+_lib.glm_open_cache.argtypes = [ctypes.c_char_p, ctypes.POINTER(ctypes.c_void_p)]
+_lib.glm_cache_batch.argtypes = [ctypes.c_void_p,
+                                 ctypes.POINTER(ctypes.POINTER(_Batch))]
+_lib.glm_close_cache.argtypes = [ctypes.c_void_p]
+
+
+class File:
+    """A GLM file, opened with glm_open()."""
+
+    def __init__(self, path):
+        self._glm = ctypes.c_void_p()
+        _check(_lib.glm_open(os.fsencode(path), ctypes.byref(self._glm)))
+
+    def close(self):
+        if self._glm:
+            glm, self._glm = self._glm, ctypes.c_void_p()
+            _check(_lib.glm_close(glm))
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+    def __del__(self):
+        if getattr(self, "_glm", None):
+            _lib.glm_close(self._glm)
+
+    def dims(self):
+        """Return the numbers of events, groups and flashes."""
+        n = [ctypes.c_size_t() for i in range(3)]
+        _check(_lib.glm_inq_dims(self._glm, *[ctypes.byref(x) for x in n]))
+        return tuple(x.value for x in n)
+
+    def set_fields(self, event_fields, group_fields, flash_fields):
+        """Choose the fields read, with the GLM_EV_*, GLM_GR_* and
+        GLM_FL_* masks. Others are left 0."""
+        _check(_lib.glm_set_fields(self._glm, event_fields, group_fields,
+                                   flash_fields))
+
+    def set_nthreads(self, nthreads):
+        """Choose the number of threads which read the variables."""
+        _check(_lib.glm_set_nthreads(self._glm, nthreads))
+
+    def set_direct(self, nthreads):
+        """Turn direct chunk reads on, or off with a negative nthreads."""
+        _check(_lib.glm_set_direct(self._glm, nthreads))
+
+    def _read(self, func, which, dtype, start, count):
+        if count is None:
+            count = max(self.dims()[which] - start, 0)
+        data = np.zeros(count, dtype)
+        if count:
+            _check(func(self._glm, start, count, data.ctypes.data))
+        return data
+
+    def events(self, start=0, count=None):
+        """Read events into a structured array of EVENT_DTYPE."""
+        return self._read(_lib.glm_read_event_range, 0, EVENT_DTYPE, start,
+                          count)
+
+    def groups(self, start=0, count=None):
+        """Read groups into a structured array of GROUP_DTYPE."""
+        return self._read(_lib.glm_read_group_range, 1, GROUP_DTYPE, start,
+                          count)
+
+    def flashes(self, start=0, count=None):
+        """Read flashes into a structured array of FLASH_DTYPE."""
+        return self._read(_lib.glm_read_flash_range, 2, FLASH_DTYPE, start,
+                          count)
+
+    def event_times(self, start=0, count=None):
+        """Read event times, in ns since the Unix epoch, into an int64
+        array. View it as datetime64[ns] for dates."""
+        return self._read(_lib.glm_read_event_times, 0, np.int64, start,
+                          count)
+
+    def group_times(self, start=0, count=None):
+        """Read group times, in ns since the Unix epoch, into an int64
+        array."""
+        return self._read(_lib.glm_read_group_times, 1, np.int64, start,
+                          count)
+
+    def flash_times(self, start=0, count=None):
+        """Read the times of the first and last events of flashes, in
+        ns since the Unix epoch, into two int64 arrays."""
+        if count is None:
+            count = max(self.dims()[2] - start, 0)
+        first, last = np.zeros(count, np.int64), np.zeros(count, np.int64)
+        if count:
+            _check(_lib.glm_read_flash_times(self._glm, start, count,
+                                             first.ctypes.data,
+                                             last.ctypes.data))
+        return first, last
+
+    def scalars(self):
+        """Read the scalars into a dict."""
+        scalar = _Scalar()
+        _check(_lib.glm_get_scalars(self._glm, ctypes.byref(scalar)))
+        return scalar.to_dict()
+
+
+def _wrap(owner, ptr, ctype, n):
+    """Make a NumPy array of n values at ptr, with no copy, which keeps
+    owner alive."""
+    if not n:
+        return np.zeros(0, ctype)
+    buf = (ctype * n).from_address(ctypes.addressof(ptr.contents))
+    buf._owner = owner
+    return np.frombuffer(buf, ctype)
+
+
+class _Columns:
+    """The columns of a GLM_BATCH_T, as NumPy arrays with no copy."""
+
+    def _setup(self, batch):
+        self.nfile = batch.nfile
+        self.nevent = batch.nevent
+        self.ngroup = batch.ngroup
+        self.nflash = batch.nflash
+        for name, ctype, n in _columns:
+            setattr(self, name,
+                    _wrap(self, getattr(batch, name), ctype, getattr(batch, n)))
+        self._scalar = batch.scalar
+
+    def scalars(self, f):
+        """Return the scalars of file f as a dict."""
+        if not 0 <= f < self.nfile:
+            raise IndexError(f)
+        return self._scalar[f].to_dict()
+
+
+class Batch(_Columns):
+    """The columns of several GLM files, from read_files(). The data
+    are freed when the Batch, and every array of it, are gone."""
+
+    def __init__(self):
+        self._batch = _Batch()
+
+    def write_cache(self, path):
+        """Write the batch to a cache file."""
+        _check(_lib.glm_write_cache(ctypes.byref(self._batch),
+                                    os.fsencode(path)))
+
+    def __del__(self):
+        if getattr(self, "_batch", None) is not None:
+            _lib.glm_free_batch(ctypes.byref(self._batch))
+
+
+def read_files(paths, nthreads=0):
+    """Read GLM files on nthreads threads (0 for one per processor) into
+    a Batch. The GIL is released while they are read."""
+    paths = [os.fsencode(p) for p in paths]
+    cpaths = (ctypes.c_char_p * len(paths))(*paths)
+    batch = Batch()
+    _check(_lib.glm_read_files(cpaths, len(paths), nthreads,
+                               ctypes.byref(batch._batch)))
+    batch._setup(batch._batch)
+    return batch
+
+
+class Cache(_Columns):
+    """A cache file, mapped into memory by open_cache(). The file is
+    unmapped when the Cache, and every array of it, are gone."""
+
+    def __init__(self, path):
+        self._cache = ctypes.c_void_p()
+        _check(_lib.glm_open_cache(os.fsencode(path), ctypes.byref(self._cache)))
+        batch = ctypes.POINTER(_Batch)()
+        _check(_lib.glm_cache_batch(self._cache, ctypes.byref(batch)))
+        self._setup(batch.contents)
+
+    def __del__(self):
+        if getattr(self, "_cache", None):
+            _lib.glm_close_cache(self._cache)
+
+
+def convert_to_cache(file_name, path):
+    """Read a GLM file, and write it to a cache file."""
+    _check(_lib.glm_convert_to_cache(os.fsencode(file_name),
+                                     os.fsencode(path)))
+
+
+def open_cache(path):
+    """Open a cache file written by glm_write_cache()."""
+    return Cache(path)
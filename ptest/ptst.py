@@ -2,45 +2,151 @@
 
 # Maximilian McClelland 1/29/21
 
-import psrc.ncglm
-import time
+import os
+import sys
+import threading
+
+import numpy as np
+
+import ncglm
 
 EPSILON = 0.0001
 NUM_VAL = 5
+GLM_DATA_FILE = os.environ.get(
+    "GLM_DATA_FILE",
+    "OR_GLM-L2-LCFA_G17_s20192692359400_e20192700000000_c20192700000028.nc")
+CACHE_FILE = "ptst.glmc"
 
 
 def main():
-    print("TestingPythonWrapper\n")
-    print("Testing GLM event reads.")
+    print("Testing Python wrapper.")
     glm_event()
+    glm_file()
+    glm_batch()
+    glm_cache()
+    print("*** Tests successful!")
+
+
+def check(ok):
+    if not ok:
+        raise AssertionError("Sorry! Unexpected result, line: %d" %
+                             sys._getframe(1).f_lineno)
 
 
 def glm_event():
-    global EPSILON
-    global NUM_VAL
-    total_err = 0
-    err = 0
-    print("testing GLM event reads...")
+    print("testing GLM event reads...", end="")
     x_time = [-0.475699, -0.475699, -0.444037, -0.332646, -0.330739]
     x_lat = [23.9904, 23.9945, 23.9904, 23.9904, 23.9904]
     x_lon = [-105.711212, -105.619804, -105.711212, -105.711212, -105.711212]
     x_energy = [1.37337e-14, 7.62985e-15, 3.05194e-15, 4.57791e-15, 4.57791e-15]
     x_parent_group_id = [467109464, 467109464, 467109465, 467109472, 467109473]
+    with ncglm.File(GLM_DATA_FILE) as glm:
+        event = glm.events(0, NUM_VAL)
+    check(event.dtype.itemsize == 32 and len(event) == NUM_VAL)
+    for i in range(NUM_VAL):
+        check(are_same(event["time_offset"][i], x_time[i]))
+        check(are_same(event["lat"][i], x_lat[i]))
+        check(are_same(event["lon"][i], x_lon[i]))
+        check(are_same(event["energy"][i] * 1e14, x_energy[i] * 1e14))
+        check(event["parent_group_id"][i] == x_parent_group_id[i])
+    print("ok.")
 
 
-def are_same(a, b):
-    if fabs(a - b) < EPSILON:
-        return 1
-    else:
-        return 0
+def glm_file():
+    print("testing GLM file reads...", end="")
+    glm = ncglm.File(GLM_DATA_FILE)
+    check(glm.dims() == (4578, 1609, 123))
+    event = glm.events()
+    group = glm.groups()
+    flash = glm.flashes()
+    check(len(event) == 4578 and len(group) == 1609 and len(flash) == 123)
+    check(group.dtype.itemsize == 40 and flash.dtype.itemsize == 56)
+    check(np.array_equal(glm.events(4000, 578), event[4000:]))
+
+    # Times in ns since the Unix epoch, on 2019-09-26 or 27.
+    check(np.array_equal(glm.event_times(), event["time"]))
+    check(np.array_equal(glm.group_times(), group["time"]))
+    first, last = glm.flash_times()
+    check(np.array_equal(first, flash["time_of_first_event"]) and
+          np.array_equal(last, flash["time_of_last_event"]))
+    day = event["time"].view("datetime64[ns]").astype("datetime64[D]")
+    check(((day >= np.datetime64("2019-09-26")) &
+           (day <= np.datetime64("2019-09-27"))).all())
+    check(glm.scalars()["event_count"] == 4578)
+
+    # Only some fields.
+    glm.set_fields(ncglm.GLM_EV_LAT, ncglm.GLM_GR_ALL, ncglm.GLM_FL_ALL)
+    lat = glm.events()
+    check(np.array_equal(lat["lat"], event["lat"]) and not lat["id"].any())
+    glm.close()
+
+    try:
+        ncglm.File("no_such_file.nc")
+        check(False)
+    except ncglm.GLMError as e:
+        check(e.code)
+    print("ok.")
 
 
-def fabs(equation):
-    return equation
+def glm_batch():
+    print("testing GLM batch reads...", end="")
+    with ncglm.File(GLM_DATA_FILE) as glm:
+        event = glm.events()
+    batch = ncglm.read_files([GLM_DATA_FILE] * 3, 2)
+    check(batch.nfile == 3 and batch.nevent == 3 * 4578)
+    check(np.array_equal(batch.event_lat[:4578], event["lat"]))
+    check(batch.event_file[-1] == 2)
+    check(batch.scalars(2)["flash_count"] == 123)
 
+    # The columns wrap the batch, and keep it alive.
+    lat = batch.event_lat
+    check(not lat.flags.owndata)
+    del batch
+    check(np.array_equal(lat[:4578], event["lat"]))
 
-def print_time(offset):
-    print(time.asctime(time.localtime(time.time() + offset)))
+    # Other threads run while files are read.
+    ticks = []
+    stop = threading.Event()
+
+    def tick():
+        while not stop.is_set():
+            ticks.append(1)
+            stop.wait(0.001)
+    t = threading.Thread(target=tick)
+    t.start()
+    ncglm.read_files([GLM_DATA_FILE] * 8, 1)
+    stop.set()
+    t.join()
+    check(ticks)
+    print("ok.")
+
+
+def glm_cache():
+    print("testing GLM cache reads...", end="")
+    batch = ncglm.read_files([GLM_DATA_FILE])
+    ncglm.convert_to_cache(GLM_DATA_FILE, CACHE_FILE)
+    cache = ncglm.open_cache(CACHE_FILE)
+    check(cache.nflash == 123)
+    check(np.array_equal(cache.flash_energy, batch.flash_energy))
+    check(np.array_equal(cache.group_quality_flag, batch.group_quality_flag))
+    energy = cache.flash_energy
+    del cache
+    check(np.array_equal(energy, batch.flash_energy))
+
+    # A batch written to a cache.
+    batch.write_cache(CACHE_FILE)
+    cache = ncglm.open_cache(CACHE_FILE)
+    check(np.array_equal(cache.event_id, batch.event_id))
+    try:
+        ncglm.open_cache(GLM_DATA_FILE)
+        check(False)
+    except ncglm.GLMError as e:
+        check(e.code == ncglm.GLM_ERR_CACHE)
+    print("ok.")
+
+
+def are_same(a, b):
+    return abs(a - b) < EPSILON
 
 
 main()
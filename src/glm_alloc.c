@@ -0,0 +1,366 @@
+/**
+ * @file
+ * Memory allocation for the ncglm library.
+ *
+ * Every allocation the library makes goes through the hooks set with
+ * glm_set_allocator(), so that a program can give the library its own
+ * allocator, such as an arena per ingest thread. By default, malloc()
+ * and posix_memalign() are used, and free().
+ *
+ * Sets of arrays which live and die together, such as the columns of
+ * a batch, are carved out of one block, with each array starting on a
+ * GLM_ALIGN byte boundary. This is one call to the allocator per
+ * granule, however many columns it has, and keeps the columns in one
+ * run of memory. Large blocks may be backed by huge pages, see
+ * glm_set_hugepages().
+ *
+ * Cache and catalog files are mapped read-only into memory with
+ * glm_map_file().
+ *
+ * @author Ed Hartnett
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <assert.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "glm_internal.h"
+
+/** Alignment of every allocation which does not ask for more. */
+#define GLM_MIN_ALIGN 16
+
+/** Size of a huge page, and the alignment of blocks which use them. */
+#define GLM_HUGEPAGE_SIZE (2 * 1024 * 1024)
+
+/** Allocator hooks, set with glm_set_allocator(). */
+static GLM_ALLOC_FN glm_alloc_fn;
+static GLM_FREE_FN glm_free_fn;
+static void *glm_alloc_ctx;
+
+/** Non-zero if large blocks are backed by huge pages. */
+static int glm_hugepages;
+
+/**
+ * The default allocator.
+ *
+ * @param size Size in bytes.
+ * @param align Alignment in bytes, a power of 2.
+ * @param ctx Ignored.
+ *
+ * @return Pointer to the memory, or NULL if there is none.
+ * @author Ed Hartnett
+ */
+static void *
+default_alloc(size_t size, size_t align, void *ctx)
+{
+    void *ptr;
+
+    (void)ctx;
+    if (align <= GLM_MIN_ALIGN)
+        return malloc(size);
+    if (posix_memalign(&ptr, align, size))
+        return NULL;
+
+    return ptr;
+}
+
+/**
+ * The default free.
+ *
+ * @param ptr Pointer to the memory.
+ * @param ctx Ignored.
+ *
+ * @author Ed Hartnett
+ */
+static void
+default_free(void *ptr, void *ctx)
+{
+    (void)ctx;
+    free(ptr);
+}
+
+/**
+ * Set the functions which the library uses to allocate and free all
+ * of its memory. alloc_fn is called with a size (never 0), an
+ * alignment (a power of 2, at least 16), and ctx, and returns memory
+ * with at least that alignment, or NULL. free_fn is called with
+ * memory from alloc_fn, and ctx.
+ *
+ * Set the allocator before any other library call, and do not change
+ * it while anything the library has allocated is still alive:
+ * handles, iterators, batches, caches, and Arrow exports are all
+ * freed with the free_fn in use when they are freed.
+ *
+ * @param alloc_fn Function which allocates memory. If NULL, and
+ * free_fn is NULL, the default allocator is used again.
+ * @param free_fn Function which frees memory. Must be NULL if
+ * alloc_fn is NULL.
+ * @param ctx Passed to every call of alloc_fn and free_fn.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+int
+glm_set_allocator(GLM_ALLOC_FN alloc_fn, GLM_FREE_FN free_fn, void *ctx)
+{
+    /* Check inputs. */
+    assert(!alloc_fn == !free_fn);
+
+    glm_alloc_fn = alloc_fn;
+    glm_free_fn = free_fn;
+    glm_alloc_ctx = ctx;
+
+    return 0;
+}
+
+/**
+ * Choose whether blocks of GLM_HUGEPAGE_SIZE bytes or more are
+ * aligned to huge pages, and advised to use them with
+ * madvise(MADV_HUGEPAGE). Where madvise() does not support this,
+ * blocks are only aligned. Off by default.
+ *
+ * @param hugepages Non-zero to use huge pages.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+int
+glm_set_hugepages(int hugepages)
+{
+    glm_hugepages = hugepages;
+
+    return 0;
+}
+
+/**
+ * Allocate memory with an alignment, through the allocator hooks.
+ *
+ * @param size Size in bytes. If 0, one byte is allocated.
+ * @param align Alignment in bytes, a power of 2.
+ *
+ * @return Pointer to the memory, or NULL if there is none.
+ * @author Ed Hartnett
+ */
+void *
+glm_aligned_alloc(size_t size, size_t align)
+{
+    if (align < GLM_MIN_ALIGN)
+        align = GLM_MIN_ALIGN;
+    if (!size)
+        size = 1;
+    if (glm_alloc_fn)
+        return glm_alloc_fn(size, align, glm_alloc_ctx);
+
+    return default_alloc(size, align, NULL);
+}
+
+/**
+ * Allocate memory through the allocator hooks.
+ *
+ * @param size Size in bytes. If 0, one byte is allocated.
+ *
+ * @return Pointer to the memory, or NULL if there is none.
+ * @author Ed Hartnett
+ */
+void *
+glm_malloc(size_t size)
+{
+    return glm_aligned_alloc(size, GLM_MIN_ALIGN);
+}
+
+/**
+ * Allocate zeroed memory for an array through the allocator hooks.
+ *
+ * @param n Number of elements.
+ * @param size Size of each element in bytes.
+ *
+ * @return Pointer to the memory, or NULL if there is none.
+ * @author Ed Hartnett
+ */
+void *
+glm_calloc(size_t n, size_t size)
+{
+    void *ptr;
+
+    if (size && n > SIZE_MAX / size)
+        return NULL;
+    if ((ptr = glm_malloc(n * size)))
+        memset(ptr, 0, n * size);
+
+    return ptr;
+}
+
+/**
+ * Free memory allocated through the allocator hooks.
+ *
+ * @param ptr Pointer to the memory. Ignored if NULL.
+ *
+ * @author Ed Hartnett
+ */
+void
+glm_free(void *ptr)
+{
+    if (!ptr)
+        return;
+    if (glm_free_fn)
+        glm_free_fn(ptr, glm_alloc_ctx);
+    else
+        default_free(ptr, NULL);
+}
+
+/**
+ * Copy a string into memory from the allocator hooks.
+ *
+ * @param s The string.
+ *
+ * @return Pointer to the copy, or NULL if there is no memory.
+ * @author Ed Hartnett
+ */
+char *
+glm_strdup(const char *s)
+{
+    size_t len = strlen(s) + 1;
+    char *copy;
+
+    if ((copy = glm_malloc(len)))
+        memcpy(copy, s, len);
+
+    return copy;
+}
+
+/**
+ * Lay out several arrays in one block, each starting on a GLM_ALIGN
+ * byte boundary.
+ *
+ * @param n Number of arrays.
+ * @param len Array of n sizes in bytes.
+ * @param offset Array of n that gets the offset of each array from
+ * the start of the block.
+ * @param size Pointer that gets the size of the block.
+ *
+ * @return 0 for success, GLM_ERR_RANGE if the block would be too
+ * large.
+ * @author Ed Hartnett
+ */
+int
+glm_block_layout(int n, const size_t *len, size_t *offset, size_t *size)
+{
+    size_t pos = 0;
+    int i;
+
+    /* Check inputs. */
+    assert(n >= 0 && (len || !n) && (offset || !n) && size);
+
+    for (i = 0; i < n; i++)
+    {
+        if (len[i] > SIZE_MAX - pos - GLM_ALIGN)
+            return GLM_ERR_RANGE;
+        offset[i] = pos;
+        pos = (pos + len[i] + GLM_ALIGN - 1) / GLM_ALIGN * GLM_ALIGN;
+    }
+    *size = pos;
+
+    return 0;
+}
+
+/**
+ * Allocate a block for arrays laid out by glm_block_layout(). It is
+ * aligned to GLM_ALIGN bytes, or to a huge page if
+ * glm_set_hugepages() is on and the block is large enough. Free it
+ * with glm_free().
+ *
+ * @param size Size of the block in bytes.
+ * @param block Pointer that gets the block.
+ *
+ * @return 0 for success, GLM_ERR_MEMORY otherwise.
+ * @author Ed Hartnett
+ */
+int
+glm_alloc_block(size_t size, void **block)
+{
+    int huge = glm_hugepages && size >= GLM_HUGEPAGE_SIZE;
+
+    /* Check inputs. */
+    assert(block);
+
+    if (!(*block = glm_aligned_alloc(size, huge ? GLM_HUGEPAGE_SIZE : GLM_ALIGN)))
+        return GLM_ERR_MEMORY;
+
+#ifdef MADV_HUGEPAGE
+    /* This is only advice, so it does not matter if it fails. Only
+     * whole huge pages of the block are advised. */
+    if (huge)
+        madvise(*block, size / GLM_HUGEPAGE_SIZE * GLM_HUGEPAGE_SIZE,
+                MADV_HUGEPAGE);
+#endif
+
+    return 0;
+}
+
+/**
+ * Is this machine little-endian? Cache and catalog files are written
+ * in the byte order of a little-endian machine, and mapped as they
+ * are.
+ *
+ * @return Non-zero if it is.
+ * @author Ed Hartnett
+ */
+int
+glm_little_endian(void)
+{
+    uint32_t bom = 0x01020304;
+
+    return *(unsigned char *)&bom == 0x04;
+}
+
+/**
+ * Map a whole file read-only into memory. The mapping stays valid
+ * after the file is closed; free it with munmap().
+ *
+ * @param path Path of the file.
+ * @param min_size Smallest size the file may have.
+ * @param size_err Error code returned if the file is smaller than
+ * min_size.
+ * @param map Pointer that gets the start of the mapping.
+ * @param length Pointer that gets the length of the mapping.
+ *
+ * @return 0 for success, error code otherwise: GLM_ERR_IO if the file
+ * can't be opened or mapped, size_err if it is too small.
+ * @author Ed Hartnett
+ */
+int
+glm_map_file(const char *path, size_t min_size, int size_err, void **map,
+             size_t *length)
+{
+    struct stat st;
+    int fd;
+
+    /* Check inputs. */
+    assert(path && map && length);
+
+    if ((fd = open(path, O_RDONLY)) < 0)
+        return GLM_ERR_IO;
+    if (fstat(fd, &st))
+    {
+        close(fd);
+        return GLM_ERR_IO;
+    }
+    if ((size_t)st.st_size < min_size)
+    {
+        close(fd);
+        return size_err;
+    }
+
+    *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (*map == MAP_FAILED)
+        return GLM_ERR_IO;
+    *length = st.st_size;
+
+    return 0;
+}
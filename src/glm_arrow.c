@@ -0,0 +1,389 @@
+/**
+ * @file
+ * Code to export the columns of a batch through the Apache Arrow C
+ * Data Interface.
+ *
+ * The events, groups, or flashes of a batch are exported as an Arrow
+ * struct array, with one child array for each column. The child
+ * arrays point at the columns of the batch, so nothing is copied; the
+ * batch must not be freed, or its cache closed, until every exported
+ * array has been released. Only the small structs which describe the
+ * arrays are allocated, and the release callbacks free them, as the
+ * interface requires. No Arrow library is needed.
+ *
+ * @author Ed Hartnett
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <assert.h>
+#include "glm_internal.h"
+
+/* Arrow format strings of the column types. */
+#define ARROW_FMT_STRUCT "+s"
+#define ARROW_FMT_INT "i"
+#define ARROW_FMT_UINT "I"
+#define ARROW_FMT_SHORT "s"
+#define ARROW_FMT_FLOAT "f"
+
+/** One column of an export. */
+typedef struct GLM_ARROW_COL
+{
+    const char *name;   /**< Name of the field. */
+    const char *format; /**< Arrow format string. */
+    size_t field;       /**< Offset of the column pointer in GLM_BATCH_T. */
+} GLM_ARROW_COL_T;
+
+/** The event columns. */
+static const GLM_ARROW_COL_T event_col[] = {
+    {"id", ARROW_FMT_UINT, offsetof(GLM_BATCH_T, event_id)},
+    {"time_offset", ARROW_FMT_FLOAT, offsetof(GLM_BATCH_T, event_time_offset)},
+    {"lat", ARROW_FMT_FLOAT, offsetof(GLM_BATCH_T, event_lat)},
+    {"lon", ARROW_FMT_FLOAT, offsetof(GLM_BATCH_T, event_lon)},
+    {"energy", ARROW_FMT_FLOAT, offsetof(GLM_BATCH_T, event_energy)},
+    {"parent_group_id", ARROW_FMT_UINT, offsetof(GLM_BATCH_T, event_parent_group_id)},
+    {"file", ARROW_FMT_INT, offsetof(GLM_BATCH_T, event_file)},
+};
+
+/** The group columns. */
+static const GLM_ARROW_COL_T group_col[] = {
+    {"id", ARROW_FMT_UINT, offsetof(GLM_BATCH_T, group_id)},
+    {"time_offset", ARROW_FMT_FLOAT, offsetof(GLM_BATCH_T, group_time_offset)},
+    {"lat", ARROW_FMT_FLOAT, offsetof(GLM_BATCH_T, group_lat)},
+    {"lon", ARROW_FMT_FLOAT, offsetof(GLM_BATCH_T, group_lon)},
+    {"area", ARROW_FMT_FLOAT, offsetof(GLM_BATCH_T, group_area)},
+    {"energy", ARROW_FMT_FLOAT, offsetof(GLM_BATCH_T, group_energy)},
+    {"parent_flash_id", ARROW_FMT_UINT, offsetof(GLM_BATCH_T, group_parent_flash_id)},
+    {"quality_flag", ARROW_FMT_SHORT, offsetof(GLM_BATCH_T, group_quality_flag)},
+    {"file", ARROW_FMT_INT, offsetof(GLM_BATCH_T, group_file)},
+};
+
+/** The flash columns. */
+static const GLM_ARROW_COL_T flash_col[] = {
+    {"id", ARROW_FMT_UINT, offsetof(GLM_BATCH_T, flash_id)},
+    {"time_offset_of_first_event", ARROW_FMT_FLOAT,
+     offsetof(GLM_BATCH_T, flash_time_offset_of_first_event)},
+    {"time_offset_of_last_event", ARROW_FMT_FLOAT,
+     offsetof(GLM_BATCH_T, flash_time_offset_of_last_event)},
+    {"frame_time_offset_of_first_event", ARROW_FMT_FLOAT,
+     offsetof(GLM_BATCH_T, flash_frame_time_offset_of_first_event)},
+    {"frame_time_offset_of_last_event", ARROW_FMT_FLOAT,
+     offsetof(GLM_BATCH_T, flash_frame_time_offset_of_last_event)},
+    {"lat", ARROW_FMT_FLOAT, offsetof(GLM_BATCH_T, flash_lat)},
+    {"lon", ARROW_FMT_FLOAT, offsetof(GLM_BATCH_T, flash_lon)},
+    {"area", ARROW_FMT_FLOAT, offsetof(GLM_BATCH_T, flash_area)},
+    {"energy", ARROW_FMT_FLOAT, offsetof(GLM_BATCH_T, flash_energy)},
+    {"quality_flag", ARROW_FMT_SHORT, offsetof(GLM_BATCH_T, flash_quality_flag)},
+    {"file", ARROW_FMT_INT, offsetof(GLM_BATCH_T, flash_file)},
+};
+
+/** Number of columns in a table. */
+#define NUM_COLS(t) ((int)(sizeof(t) / sizeof(t[0])))
+
+/**
+ * Release a child schema. Its strings are static, so there is nothing
+ * to free.
+ *
+ * @param schema Pointer to the schema.
+ *
+ * @author Ed Hartnett
+ */
+static void
+release_child_schema(struct ArrowSchema *schema)
+{
+    schema->release = NULL;
+}
+
+/**
+ * Release the schema of an export, and any child which has not been
+ * moved out of it and released.
+ *
+ * @param schema Pointer to the schema.
+ *
+ * @author Ed Hartnett
+ */
+static void
+release_schema(struct ArrowSchema *schema)
+{
+    int64_t c;
+
+    for (c = 0; c < schema->n_children; c++)
+        if (schema->children[c]->release)
+            schema->children[c]->release(schema->children[c]);
+    glm_free(schema->private_data);
+    schema->release = NULL;
+}
+
+/**
+ * Release a child array, freeing its list of buffers.
+ *
+ * @param array Pointer to the array.
+ *
+ * @author Ed Hartnett
+ */
+static void
+release_child_array(struct ArrowArray *array)
+{
+    glm_free(array->private_data);
+    array->release = NULL;
+}
+
+/**
+ * Release the array of an export, and any child which has not been
+ * moved out of it and released. The columns are not freed: they
+ * belong to the batch.
+ *
+ * @param array Pointer to the array.
+ *
+ * @author Ed Hartnett
+ */
+static void
+release_array(struct ArrowArray *array)
+{
+    int64_t c;
+
+    for (c = 0; c < array->n_children; c++)
+        if (array->children[c]->release)
+            array->children[c]->release(array->children[c]);
+    glm_free(array->private_data);
+    array->release = NULL;
+}
+
+/**
+ * Fill in the schema of an export: a struct with one field for each
+ * column.
+ *
+ * @param col Table of columns.
+ * @param ncol Number of columns.
+ * @param schema Pointer to the schema to fill in.
+ *
+ * @return 0 for success, GLM_ERR_MEMORY otherwise.
+ * @author Ed Hartnett
+ */
+static int
+export_schema(const GLM_ARROW_COL_T *col, int ncol, struct ArrowSchema *schema)
+{
+    struct ArrowSchema **children;
+    struct ArrowSchema *child;
+    int c;
+
+    /* The list of children, and the children, in one block. */
+    if (!(children = glm_malloc(ncol * (sizeof(struct ArrowSchema *) +
+                                    sizeof(struct ArrowSchema)))))
+        return GLM_ERR_MEMORY;
+    child = (struct ArrowSchema *)(children + ncol);
+
+    for (c = 0; c < ncol; c++)
+    {
+        memset(&child[c], 0, sizeof(struct ArrowSchema));
+        child[c].format = col[c].format;
+        child[c].name = col[c].name;
+        child[c].release = release_child_schema;
+        children[c] = &child[c];
+    }
+
+    memset(schema, 0, sizeof(struct ArrowSchema));
+    schema->format = ARROW_FMT_STRUCT;
+    schema->name = "";
+    schema->n_children = ncol;
+    schema->children = children;
+    schema->release = release_schema;
+    schema->private_data = children;
+
+    return 0;
+}
+
+/**
+ * Fill in the array of an export: a struct array with no nulls, whose
+ * children point at the columns of the batch.
+ *
+ * @param batch Pointer to the batch.
+ * @param length Number of rows.
+ * @param col Table of columns.
+ * @param ncol Number of columns.
+ * @param array Pointer to the array to fill in.
+ *
+ * @return 0 for success, GLM_ERR_MEMORY otherwise.
+ * @author Ed Hartnett
+ */
+static int
+export_array(const GLM_BATCH_T *batch, size_t length,
+             const GLM_ARROW_COL_T *col, int ncol, struct ArrowArray *array)
+{
+    struct ArrowArray **children;
+    struct ArrowArray *child;
+    const void **buffers;
+    int c;
+
+    /* The list of children, the children, and the one (validity)
+     * buffer of the struct array, in one block. Each child has its
+     * own list of buffers, so it can be moved out and released on its
+     * own. */
+    if (!(children = glm_malloc(ncol * (sizeof(struct ArrowArray *) +
+                                    sizeof(struct ArrowArray)) +
+                            sizeof(void *))))
+        return GLM_ERR_MEMORY;
+    child = (struct ArrowArray *)(children + ncol);
+    buffers = (const void **)(child + ncol);
+    buffers[0] = NULL;
+
+    for (c = 0; c < ncol; c++)
+    {
+        const void **child_buffers;
+
+        if (!(child_buffers = glm_malloc(2 * sizeof(void *))))
+        {
+            while (c--)
+                glm_free(child[c].private_data);
+            glm_free(children);
+            return GLM_ERR_MEMORY;
+        }
+
+        /* No validity buffer, since there are no nulls, and the
+         * column itself. */
+        child_buffers[0] = NULL;
+        child_buffers[1] = *(void * const *)((const char *)batch + col[c].field);
+        memset(&child[c], 0, sizeof(struct ArrowArray));
+        child[c].length = length;
+        child[c].n_buffers = 2;
+        child[c].buffers = child_buffers;
+        child[c].release = release_child_array;
+        child[c].private_data = child_buffers;
+        children[c] = &child[c];
+    }
+
+    memset(array, 0, sizeof(struct ArrowArray));
+    array->length = length;
+    array->n_buffers = 1;
+    array->buffers = buffers;
+    array->n_children = ncol;
+    array->children = children;
+    array->release = release_array;
+    array->private_data = children;
+
+    return 0;
+}
+
+/**
+ * Export some of the columns of a batch.
+ *
+ * @param batch Pointer to the batch.
+ * @param length Number of rows.
+ * @param col Table of columns.
+ * @param ncol Number of columns.
+ * @param schema Pointer that gets the schema. Ignored if NULL.
+ * @param array Pointer that gets the array. Ignored if NULL.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+static int
+export_cols(const GLM_BATCH_T *batch, size_t length,
+            const GLM_ARROW_COL_T *col, int ncol, struct ArrowSchema *schema,
+            struct ArrowArray *array)
+{
+    int ret;
+
+    if (schema && (ret = export_schema(col, ncol, schema)))
+        return ret;
+    if (array && (ret = export_array(batch, length, col, ncol, array)))
+    {
+        if (schema)
+            schema->release(schema);
+        return ret;
+    }
+
+    return 0;
+}
+
+/**
+ * Export the events of a batch as an Arrow struct array, through the
+ * Arrow C Data Interface. The fields are id, time_offset, lat, lon,
+ * energy, parent_group_id, and file.
+ *
+ * The arrays point at the columns of the batch, with no copy. The
+ * batch must not be freed until the consumer has called the release
+ * callbacks of the schema and the array.
+ *
+ * @param batch Pointer to the batch, from glm_read_files(),
+ * glm_pipeline(), or glm_cache_batch().
+ * @param schema Pointer to a struct ArrowSchema that gets the
+ * schema. Ignored if NULL.
+ * @param array Pointer to a struct ArrowArray that gets the
+ * array. Ignored if NULL.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+int
+glm_export_events_arrow(const GLM_BATCH_T *batch, struct ArrowSchema *schema,
+                        struct ArrowArray *array)
+{
+    /* Check inputs. */
+    assert(batch);
+
+    return export_cols(batch, batch->nevent, event_col, NUM_COLS(event_col),
+                       schema, array);
+}
+
+/**
+ * Export the groups of a batch as an Arrow struct array, through the
+ * Arrow C Data Interface. The fields are id, time_offset, lat, lon,
+ * area, energy, parent_flash_id, quality_flag, and file.
+ *
+ * The arrays point at the columns of the batch, with no copy. The
+ * batch must not be freed until the consumer has called the release
+ * callbacks of the schema and the array.
+ *
+ * @param batch Pointer to the batch.
+ * @param schema Pointer to a struct ArrowSchema that gets the
+ * schema. Ignored if NULL.
+ * @param array Pointer to a struct ArrowArray that gets the
+ * array. Ignored if NULL.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+int
+glm_export_groups_arrow(const GLM_BATCH_T *batch, struct ArrowSchema *schema,
+                        struct ArrowArray *array)
+{
+    /* Check inputs. */
+    assert(batch);
+
+    return export_cols(batch, batch->ngroup, group_col, NUM_COLS(group_col),
+                       schema, array);
+}
+
+/**
+ * Export the flashes of a batch as an Arrow struct array, through the
+ * Arrow C Data Interface. The fields are id,
+ * time_offset_of_first_event, time_offset_of_last_event,
+ * frame_time_offset_of_first_event, frame_time_offset_of_last_event,
+ * lat, lon, area, energy, quality_flag, and file.
+ *
+ * The arrays point at the columns of the batch, with no copy. The
+ * batch must not be freed until the consumer has called the release
+ * callbacks of the schema and the array.
+ *
+ * @param batch Pointer to the batch.
+ * @param schema Pointer to a struct ArrowSchema that gets the
+ * schema. Ignored if NULL.
+ * @param array Pointer to a struct ArrowArray that gets the
+ * array. Ignored if NULL.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+int
+glm_export_flashes_arrow(const GLM_BATCH_T *batch, struct ArrowSchema *schema,
+                         struct ArrowArray *array)
+{
+    /* Check inputs. */
+    assert(batch);
+
+    return export_cols(batch, batch->nflash, flash_col, NUM_COLS(flash_col),
+                       schema, array);
+}
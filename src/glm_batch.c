@@ -0,0 +1,766 @@
+/**
+ * @file
+ * Code to read many GLM files at once, on several threads, into one
+ * set of columns.
+ *
+ * Each file is first read into its own GLM_BATCH_T, on whichever
+ * thread of the pool picks it up. The per-file batches are then
+ * copied into the combined batch, also in parallel, remapping the
+ * IDs as they are copied.
+ *
+ * IDs are remapped so that they are unique across the batch: for each
+ * kind of ID (event, group, flash), the range of IDs used in each file
+ * is found, including the parent IDs which refer to it, and the
+ * ranges are laid end to end, in file order. The first file keeps its
+ * IDs, so reading a single file does not change them. Flash IDs are
+ * 16-bit counters, which may wrap within a file; the range of a file
+ * whose flash IDs wrap starts after the wrap, and its IDs are
+ * unwrapped, so that they follow on past 65535.
+ *
+ * @author Ed Hartnett
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <limits.h>
+#include <assert.h>
+#include "glm_internal.h"
+
+/* The kinds of ID. */
+#define ID_EVENT 0 /* event_id. */
+#define ID_GROUP 1 /* group_id and event_parent_group_id. */
+#define ID_FLASH 2 /* flash_id and group_parent_flash_id. */
+#define NUM_ID 3
+
+/** Number of event columns. */
+#define NUM_EVENT_COLS 6
+
+/** Number of group columns. */
+#define NUM_GROUP_COLS 8
+
+/** Number of flash columns. */
+#define NUM_FLASH_COLS 10
+
+/** One file of a multi-file read. */
+typedef struct GLM_PART
+{
+    GLM_BATCH_T batch;        /**< The data of this file. */
+    int has_id[NUM_ID];       /**< Non-zero if the file uses this kind of ID. */
+    unsigned int min[NUM_ID]; /**< Smallest ID of each kind. */
+    unsigned int max[NUM_ID]; /**< Largest ID of each kind. */
+    unsigned int base[NUM_ID]; /**< What min is remapped to. */
+    unsigned int mask[NUM_ID]; /**< Mask of IDs, less min. */
+    size_t event_start;       /**< Index of first event in the batch. */
+    size_t group_start;       /**< Index of first group in the batch. */
+    size_t flash_start;       /**< Index of first flash in the batch. */
+} GLM_PART_T;
+
+/** Shared state of a multi-file read. */
+typedef struct GLM_READ_FILES
+{
+    const char **paths; /**< Names of the files. */
+    GLM_PART_T *part;   /**< One part per file. */
+    GLM_BATCH_T *batch; /**< The combined batch. */
+} GLM_READ_FILES_T;
+
+/** Shared state of glm_batch_gather(). */
+typedef struct GLM_GATHER
+{
+    const GLM_BATCH_T *src;    /**< Batch copied from. */
+    GLM_BATCH_T *dst;          /**< Batch copied to. */
+    const size_t *const *idx;  /**< Records copied, by GLM_COUNT_*. */
+} GLM_GATHER_T;
+
+/** The columns of a batch, in the order they are laid out. */
+const GLM_BATCH_COL_T glm_batch_col[GLM_NUM_BATCH_COLS] = {
+    {offsetof(GLM_BATCH_T, event_id), GLM_COUNT_EVENT, sizeof(unsigned int)},
+    {offsetof(GLM_BATCH_T, event_time_offset), GLM_COUNT_EVENT, sizeof(float)},
+    {offsetof(GLM_BATCH_T, event_lat), GLM_COUNT_EVENT, sizeof(float)},
+    {offsetof(GLM_BATCH_T, event_lon), GLM_COUNT_EVENT, sizeof(float)},
+    {offsetof(GLM_BATCH_T, event_energy), GLM_COUNT_EVENT, sizeof(float)},
+    {offsetof(GLM_BATCH_T, event_parent_group_id), GLM_COUNT_EVENT, sizeof(unsigned int)},
+    {offsetof(GLM_BATCH_T, event_file), GLM_COUNT_EVENT, sizeof(int)},
+    {offsetof(GLM_BATCH_T, group_id), GLM_COUNT_GROUP, sizeof(unsigned int)},
+    {offsetof(GLM_BATCH_T, group_time_offset), GLM_COUNT_GROUP, sizeof(float)},
+    {offsetof(GLM_BATCH_T, group_lat), GLM_COUNT_GROUP, sizeof(float)},
+    {offsetof(GLM_BATCH_T, group_lon), GLM_COUNT_GROUP, sizeof(float)},
+    {offsetof(GLM_BATCH_T, group_area), GLM_COUNT_GROUP, sizeof(float)},
+    {offsetof(GLM_BATCH_T, group_energy), GLM_COUNT_GROUP, sizeof(float)},
+    {offsetof(GLM_BATCH_T, group_parent_flash_id), GLM_COUNT_GROUP, sizeof(unsigned int)},
+    {offsetof(GLM_BATCH_T, group_quality_flag), GLM_COUNT_GROUP, sizeof(short)},
+    {offsetof(GLM_BATCH_T, group_file), GLM_COUNT_GROUP, sizeof(int)},
+    {offsetof(GLM_BATCH_T, flash_id), GLM_COUNT_FLASH, sizeof(unsigned int)},
+    {offsetof(GLM_BATCH_T, flash_time_offset_of_first_event), GLM_COUNT_FLASH, sizeof(float)},
+    {offsetof(GLM_BATCH_T, flash_time_offset_of_last_event), GLM_COUNT_FLASH, sizeof(float)},
+    {offsetof(GLM_BATCH_T, flash_frame_time_offset_of_first_event), GLM_COUNT_FLASH, sizeof(float)},
+    {offsetof(GLM_BATCH_T, flash_frame_time_offset_of_last_event), GLM_COUNT_FLASH, sizeof(float)},
+    {offsetof(GLM_BATCH_T, flash_lat), GLM_COUNT_FLASH, sizeof(float)},
+    {offsetof(GLM_BATCH_T, flash_lon), GLM_COUNT_FLASH, sizeof(float)},
+    {offsetof(GLM_BATCH_T, flash_area), GLM_COUNT_FLASH, sizeof(float)},
+    {offsetof(GLM_BATCH_T, flash_energy), GLM_COUNT_FLASH, sizeof(float)},
+    {offsetof(GLM_BATCH_T, flash_quality_flag), GLM_COUNT_FLASH, sizeof(short)},
+    {offsetof(GLM_BATCH_T, flash_file), GLM_COUNT_FLASH, sizeof(int)},
+    {offsetof(GLM_BATCH_T, scalar), GLM_COUNT_FILE, sizeof(GLM_SCALAR_T)},
+};
+
+/**
+ * Find the number of values in a column of a batch.
+ *
+ * @param col Pointer to the column.
+ * @param nfile Number of files.
+ * @param nevent Number of events.
+ * @param ngroup Number of groups.
+ * @param nflash Number of flashes.
+ *
+ * @return Number of values.
+ * @author Ed Hartnett
+ */
+size_t
+glm_batch_col_len(const GLM_BATCH_COL_T *col, size_t nfile, size_t nevent,
+                  size_t ngroup, size_t nflash)
+{
+    switch (col->count)
+    {
+    case GLM_COUNT_EVENT:
+        return nevent;
+    case GLM_COUNT_GROUP:
+        return ngroup;
+    case GLM_COUNT_FLASH:
+        return nflash;
+    default:
+        return nfile;
+    }
+}
+
+/**
+ * Allocate the columns of a batch. All the columns are carved from one
+ * block, each starting on a GLM_ALIGN byte boundary. Each column has
+ * room for at least one value, so that empty columns are not NULL.
+ *
+ * @param batch Pointer to the batch.
+ * @param block_size If not NULL, the size of the block the batch
+ * already has, which is kept if it is big enough, and which gets the
+ * size of the block. If NULL, the batch has no block.
+ * @param nfile Number of files.
+ * @param nevent Number of events.
+ * @param ngroup Number of groups.
+ * @param nflash Number of flashes.
+ *
+ * @return 0 for success, error code otherwise. On error the batch is
+ * not changed.
+ * @author Ed Hartnett
+ */
+int
+glm_batch_alloc(GLM_BATCH_T *batch, size_t *block_size, size_t nfile,
+                size_t nevent, size_t ngroup, size_t nflash)
+{
+    size_t len[GLM_NUM_BATCH_COLS], offset[GLM_NUM_BATCH_COLS];
+    void *block = block_size ? batch->block : NULL;
+    size_t size;
+    int c;
+    int ret;
+
+    /* Lay out the block. */
+    for (c = 0; c < GLM_NUM_BATCH_COLS; c++)
+    {
+        size_t n = glm_batch_col_len(&glm_batch_col[c], nfile, nevent, ngroup,
+                                     nflash);
+
+        if (n > SIZE_MAX / glm_batch_col[c].size)
+            return GLM_ERR_RANGE;
+        len[c] = (n ? n : 1) * glm_batch_col[c].size;
+    }
+    if ((ret = glm_block_layout(GLM_NUM_BATCH_COLS, len, offset, &size)))
+        return ret;
+
+    /* Only get a new block if the old one is too small. */
+    if (!block || size > *block_size)
+    {
+        void *new_block;
+
+        if ((ret = glm_alloc_block(size, &new_block)))
+            return ret;
+        glm_free(block);
+        block = new_block;
+        if (block_size)
+            *block_size = size;
+    }
+
+    /* Point each column into it. */
+    memset(batch, 0, sizeof(GLM_BATCH_T));
+    batch->block = block;
+    for (c = 0; c < GLM_NUM_BATCH_COLS; c++)
+        *(void **)((char *)batch + glm_batch_col[c].field) =
+            (char *)block + offset[c];
+    batch->nfile = nfile;
+    batch->nevent = nevent;
+    batch->ngroup = ngroup;
+    batch->nflash = nflash;
+
+    return 0;
+}
+
+/**
+ * Free the columns of a batch. The batch struct itself is not freed,
+ * and is left empty, so it is safe to free a batch twice. Batches
+ * which do not own their columns, such as those of a cache, must not
+ * be freed.
+ *
+ * @param batch Pointer to the batch.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+int
+glm_free_batch(GLM_BATCH_T *batch)
+{
+    /* Check inputs. */
+    assert(batch);
+
+    glm_free(batch->block);
+    memset(batch, 0, sizeof(GLM_BATCH_T));
+
+    return 0;
+}
+
+/**
+ * Copy the records of one column, task c of glm_batch_gather().
+ *
+ * @param arg Pointer to the GLM_GATHER_T.
+ * @param c Index of the column in glm_batch_col.
+ *
+ * @return 0.
+ * @author Ed Hartnett
+ */
+static int
+gather_task(void *arg, int c)
+{
+    GLM_GATHER_T *g = arg;
+    const GLM_BATCH_COL_T *col = &glm_batch_col[c];
+    const char *src = *(char * const *)((const char *)g->src + col->field);
+    char *dst = *(char **)((char *)g->dst + col->field);
+    const size_t *idx;
+    size_t n, i;
+
+    n = glm_batch_col_len(col, g->dst->nfile, g->dst->nevent, g->dst->ngroup,
+                          g->dst->nflash);
+
+    /* The scalars of every file are kept, and a kind with no index
+     * is copied as it is. */
+    if (col->count == GLM_COUNT_FILE || !(idx = g->idx[col->count]))
+    {
+        memcpy(dst, src, n * col->size);
+        return 0;
+    }
+
+    /* Copies of a constant size compile to single moves. */
+    switch (col->size)
+    {
+    case 4:
+        for (i = 0; i < n; i++)
+            memcpy(dst + i * 4, src + idx[i] * 4, 4);
+        break;
+    case 2:
+        for (i = 0; i < n; i++)
+            memcpy(dst + i * 2, src + idx[i] * 2, 2);
+        break;
+    default:
+        for (i = 0; i < n; i++)
+            memcpy(dst + i * col->size, src + idx[i] * col->size, col->size);
+    }
+
+    return 0;
+}
+
+/**
+ * Copy chosen records of a batch into another, one column per task
+ * on the thread pool. Record i of each kind in dst is record idx[k][i]
+ * of src, where k is GLM_COUNT_EVENT, GLM_COUNT_GROUP, or
+ * GLM_COUNT_FLASH. The scalars of every file are copied.
+ *
+ * @param src Pointer to the batch copied from.
+ * @param dst Pointer to the batch copied to, allocated with the
+ * number of files of src and the number of records of each kind
+ * wanted.
+ * @param idx Index in src of each record of each kind. If idx[k] is
+ * NULL, the first records of that kind are copied as they are.
+ * @param nthreads Number of threads. If less than 1, the number of
+ * online processors is used.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+int
+glm_batch_gather(const GLM_BATCH_T *src, GLM_BATCH_T *dst,
+                 const size_t *const *idx, int nthreads)
+{
+    GLM_GATHER_T g;
+
+    /* Check inputs. */
+    assert(src && dst && idx && dst->nfile == src->nfile);
+
+    g.src = src;
+    g.dst = dst;
+    g.idx = idx;
+
+    return glm_pool_run(nthreads, GLM_NUM_BATCH_COLS, gather_task, &g);
+}
+
+/**
+ * Read all the data of an open file into a batch with room for it.
+ *
+ * @param glm Pointer to the GLM file handle.
+ * @param batch Pointer to the batch.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+static int
+read_file_batch(GLM_FILE_T *glm, GLM_BATCH_T *batch)
+{
+    GLM_COLUMN_T ecol[NUM_EVENT_COLS];
+    GLM_COLUMN_T gcol[NUM_GROUP_COLS];
+    GLM_COLUMN_T fcol[NUM_FLASH_COLS];
+    size_t i;
+    int ret;
+
+    /* Check inputs. */
+    assert(glm && batch && batch->nevent == glm->nevent &&
+           batch->ngroup == glm->ngroup && batch->nflash == glm->nflash);
+
+    /* Describe the columns. */
+    glm_set_column(&ecol[0], GLM_VAR_EVENT_ID, GLM_COL_INT, batch->event_id,
+                   sizeof(unsigned int));
+    glm_set_column(&ecol[1], GLM_VAR_EVENT_TIME_OFFSET, GLM_COL_FLOAT,
+                   batch->event_time_offset, sizeof(float));
+    glm_set_column(&ecol[2], GLM_VAR_EVENT_LAT, GLM_COL_FLOAT,
+                   batch->event_lat, sizeof(float));
+    glm_set_column(&ecol[3], GLM_VAR_EVENT_LON, GLM_COL_FLOAT,
+                   batch->event_lon, sizeof(float));
+    glm_set_column(&ecol[4], GLM_VAR_EVENT_ENERGY, GLM_COL_FLOAT,
+                   batch->event_energy, sizeof(float));
+    glm_set_column(&ecol[5], GLM_VAR_EVENT_PARENT_GROUP_ID, GLM_COL_INT,
+                   batch->event_parent_group_id, sizeof(unsigned int));
+    glm_set_column(&gcol[0], GLM_VAR_GROUP_ID, GLM_COL_INT, batch->group_id,
+                   sizeof(unsigned int));
+    glm_set_column(&gcol[1], GLM_VAR_GROUP_TIME_OFFSET, GLM_COL_FLOAT,
+                   batch->group_time_offset, sizeof(float));
+    glm_set_column(&gcol[2], GLM_VAR_GROUP_LAT, GLM_COL_FLOAT,
+                   batch->group_lat, sizeof(float));
+    glm_set_column(&gcol[3], GLM_VAR_GROUP_LON, GLM_COL_FLOAT,
+                   batch->group_lon, sizeof(float));
+    glm_set_column(&gcol[4], GLM_VAR_GROUP_AREA, GLM_COL_FLOAT,
+                   batch->group_area, sizeof(float));
+    glm_set_column(&gcol[5], GLM_VAR_GROUP_ENERGY, GLM_COL_FLOAT,
+                   batch->group_energy, sizeof(float));
+    glm_set_column(&gcol[6], GLM_VAR_GROUP_PARENT_FLASH_ID, GLM_COL_INT,
+                   batch->group_parent_flash_id, sizeof(unsigned int));
+    glm_set_column(&gcol[7], GLM_VAR_GROUP_QUALITY_FLAG, GLM_COL_SHORT,
+                   batch->group_quality_flag, sizeof(short));
+    glm_set_column(&fcol[0], GLM_VAR_FLASH_ID, GLM_COL_INT, batch->flash_id,
+                   sizeof(unsigned int));
+    glm_set_column(&fcol[1], GLM_VAR_FLASH_TIME_OFFSET_OF_FIRST_EVENT,
+                   GLM_COL_FLOAT, batch->flash_time_offset_of_first_event,
+                   sizeof(float));
+    glm_set_column(&fcol[2], GLM_VAR_FLASH_TIME_OFFSET_OF_LAST_EVENT,
+                   GLM_COL_FLOAT, batch->flash_time_offset_of_last_event,
+                   sizeof(float));
+    glm_set_column(&fcol[3], GLM_VAR_FLASH_FRAME_TIME_OFFSET_OF_FIRST_EVENT,
+                   GLM_COL_FLOAT, batch->flash_frame_time_offset_of_first_event,
+                   sizeof(float));
+    glm_set_column(&fcol[4], GLM_VAR_FLASH_FRAME_TIME_OFFSET_OF_LAST_EVENT,
+                   GLM_COL_FLOAT, batch->flash_frame_time_offset_of_last_event,
+                   sizeof(float));
+    glm_set_column(&fcol[5], GLM_VAR_FLASH_LAT, GLM_COL_FLOAT,
+                   batch->flash_lat, sizeof(float));
+    glm_set_column(&fcol[6], GLM_VAR_FLASH_LON, GLM_COL_FLOAT,
+                   batch->flash_lon, sizeof(float));
+    glm_set_column(&fcol[7], GLM_VAR_FLASH_AREA, GLM_COL_FLOAT,
+                   batch->flash_area, sizeof(float));
+    glm_set_column(&fcol[8], GLM_VAR_FLASH_ENERGY, GLM_COL_FLOAT,
+                   batch->flash_energy, sizeof(float));
+    glm_set_column(&fcol[9], GLM_VAR_FLASH_QUALITY_FLAG, GLM_COL_SHORT,
+                   batch->flash_quality_flag, sizeof(short));
+
+    /* Read the data. */
+    if ((ret = glm_read_columns(glm, 0, glm->nevent, NUM_EVENT_COLS, ecol)))
+        return ret;
+    if ((ret = glm_read_columns(glm, 0, glm->ngroup, NUM_GROUP_COLS, gcol)))
+        return ret;
+    if ((ret = glm_read_columns(glm, 0, glm->nflash, NUM_FLASH_COLS, fcol)))
+        return ret;
+    if ((ret = glm_get_scalars(glm, batch->scalar)))
+        return ret;
+
+    /* Everything came from file 0. */
+    for (i = 0; i < batch->nevent; i++)
+        batch->event_file[i] = 0;
+    for (i = 0; i < batch->ngroup; i++)
+        batch->group_file[i] = 0;
+    for (i = 0; i < batch->nflash; i++)
+        batch->flash_file[i] = 0;
+
+    return 0;
+}
+
+/**
+ * Open a GLM file, read all its data into a batch, and close it.
+ *
+ * @param path Name of the file.
+ * @param batch Pointer to a GLM_BATCH_T which gets the data. Free
+ * the data with glm_free_batch(). It is left empty on error.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+int
+glm_read_file_batch(const char *path, GLM_BATCH_T *batch)
+{
+    GLM_FILE_T *glm;
+    int ret;
+
+    /* Check inputs. */
+    assert(path && batch);
+    memset(batch, 0, sizeof(GLM_BATCH_T));
+
+    if ((ret = glm_open(path, &glm)))
+        return ret;
+    if (!(ret = glm_batch_alloc(batch, NULL, 1, glm->nevent, glm->ngroup,
+                                glm->nflash)))
+        ret = read_file_batch(glm, batch);
+    glm_close(glm);
+    if (ret)
+        glm_free_batch(batch);
+
+    return ret;
+}
+
+/**
+ * Read all the data of an open file into a batch, keeping the block
+ * of the batch if it is big enough. This is how a reader context
+ * reads file after file with no allocation once its block has grown
+ * to fit the largest.
+ *
+ * @param glm Pointer to the GLM file handle.
+ * @param batch Pointer to the batch. It may already have a block,
+ * which is freed if a bigger one is needed, or it may be empty.
+ * @param block_size Pointer to the size of the block of the batch,
+ * 0 if it has none. It gets the size of the new block, if there is
+ * one.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+int
+glm_batch_read(GLM_FILE_T *glm, GLM_BATCH_T *batch, size_t *block_size)
+{
+    int ret;
+
+    /* Check inputs. */
+    assert(glm && batch && block_size && (batch->block || !*block_size));
+
+    if ((ret = glm_batch_alloc(batch, block_size, 1, glm->nevent,
+                               glm->ngroup, glm->nflash)))
+        return ret;
+
+    return read_file_batch(glm, batch);
+}
+
+/**
+ * Widen the range of IDs of one kind with some more IDs.
+ *
+ * @param part Pointer to the part.
+ * @param kind Kind of ID, ID_EVENT, ID_GROUP, or ID_FLASH.
+ * @param id The IDs.
+ * @param n Number of IDs.
+ *
+ * @author Ed Hartnett
+ */
+static void
+id_range(GLM_PART_T *part, int kind, const unsigned int *id, size_t n)
+{
+    size_t i;
+
+    if (!n)
+        return;
+    if (!part->has_id[kind])
+    {
+        part->min[kind] = part->max[kind] = id[0];
+        part->has_id[kind] = 1;
+    }
+    for (i = 0; i < n; i++)
+    {
+        if (id[i] < part->min[kind])
+            part->min[kind] = id[i];
+        if (id[i] > part->max[kind])
+            part->max[kind] = id[i];
+    }
+}
+
+/**
+ * Pool task which reads one file into its part.
+ *
+ * @param arg Pointer to the GLM_READ_FILES_T.
+ * @param f Index of the file.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+static int
+read_part(void *arg, int f)
+{
+    GLM_READ_FILES_T *rf = arg;
+    GLM_PART_T *part = &rf->part[f];
+    GLM_BATCH_T *b = &part->batch;
+    const unsigned int *flash_id[2];
+    size_t nflash_id[2], span;
+    unsigned int min;
+    int k;
+    int ret;
+
+    if ((ret = glm_read_file_batch(rf->paths[f], b)))
+        return ret;
+
+    /* Find the range of each kind of ID. */
+    for (k = 0; k < NUM_ID; k++)
+        part->mask[k] = UINT_MAX;
+    id_range(part, ID_EVENT, b->event_id, b->nevent);
+    id_range(part, ID_GROUP, b->group_id, b->ngroup);
+    id_range(part, ID_GROUP, b->event_parent_group_id, b->nevent);
+    id_range(part, ID_FLASH, b->flash_id, b->nflash);
+    id_range(part, ID_FLASH, b->group_parent_flash_id, b->ngroup);
+
+    /* Flash IDs may wrap, so their range is found around the wrap. */
+    flash_id[0] = b->flash_id;
+    nflash_id[0] = b->nflash;
+    flash_id[1] = b->group_parent_flash_id;
+    nflash_id[1] = b->ngroup;
+    if (!glm_wrapped_range(flash_id, nflash_id, 2, &min, &span))
+    {
+        part->min[ID_FLASH] = min;
+        part->max[ID_FLASH] = min + (unsigned int)(span - 1);
+        part->mask[ID_FLASH] = GLM_ID_MASK_16;
+    }
+
+    return 0;
+}
+
+/**
+ * Copy IDs, remapping them.
+ *
+ * @param dst Output IDs.
+ * @param src Input IDs.
+ * @param n Number of IDs.
+ * @param min First ID of the range of this kind in the file.
+ * @param mask Mask of the IDs, less min.
+ * @param base What min is remapped to.
+ *
+ * @author Ed Hartnett
+ */
+static void
+copy_ids(unsigned int *dst, const unsigned int *src, size_t n,
+         unsigned int min, unsigned int mask, unsigned int base)
+{
+    size_t i;
+
+    for (i = 0; i < n; i++)
+        dst[i] = ((src[i] - min) & mask) + base;
+}
+
+/**
+ * Fill a file index column.
+ *
+ * @param dst Output column.
+ * @param n Number of values.
+ * @param f Index of the file.
+ *
+ * @author Ed Hartnett
+ */
+static void
+fill_file(int *dst, size_t n, int f)
+{
+    size_t i;
+
+    for (i = 0; i < n; i++)
+        dst[i] = f;
+}
+
+/**
+ * Pool task which copies one part into the combined batch, and then
+ * frees the part.
+ *
+ * @param arg Pointer to the GLM_READ_FILES_T.
+ * @param f Index of the file.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+static int
+copy_part(void *arg, int f)
+{
+    GLM_READ_FILES_T *rf = arg;
+    GLM_PART_T *part = &rf->part[f];
+    GLM_BATCH_T *src = &part->batch;
+    GLM_BATCH_T *dst = rf->batch;
+    size_t e = part->event_start, g = part->group_start;
+    size_t l = part->flash_start;
+    size_t ne = src->nevent, ng = src->ngroup, nf = src->nflash;
+
+    /* Events. */
+    copy_ids(dst->event_id + e, src->event_id, ne, part->min[ID_EVENT],
+             part->mask[ID_EVENT], part->base[ID_EVENT]);
+    memcpy(dst->event_time_offset + e, src->event_time_offset, ne * sizeof(float));
+    memcpy(dst->event_lat + e, src->event_lat, ne * sizeof(float));
+    memcpy(dst->event_lon + e, src->event_lon, ne * sizeof(float));
+    memcpy(dst->event_energy + e, src->event_energy, ne * sizeof(float));
+    copy_ids(dst->event_parent_group_id + e, src->event_parent_group_id, ne,
+             part->min[ID_GROUP], part->mask[ID_GROUP], part->base[ID_GROUP]);
+    fill_file(dst->event_file + e, ne, f);
+
+    /* Groups. */
+    copy_ids(dst->group_id + g, src->group_id, ng, part->min[ID_GROUP],
+             part->mask[ID_GROUP], part->base[ID_GROUP]);
+    memcpy(dst->group_time_offset + g, src->group_time_offset, ng * sizeof(float));
+    memcpy(dst->group_lat + g, src->group_lat, ng * sizeof(float));
+    memcpy(dst->group_lon + g, src->group_lon, ng * sizeof(float));
+    memcpy(dst->group_area + g, src->group_area, ng * sizeof(float));
+    memcpy(dst->group_energy + g, src->group_energy, ng * sizeof(float));
+    copy_ids(dst->group_parent_flash_id + g, src->group_parent_flash_id, ng,
+             part->min[ID_FLASH], part->mask[ID_FLASH], part->base[ID_FLASH]);
+    memcpy(dst->group_quality_flag + g, src->group_quality_flag, ng * sizeof(short));
+    fill_file(dst->group_file + g, ng, f);
+
+    /* Flashes. */
+    copy_ids(dst->flash_id + l, src->flash_id, nf, part->min[ID_FLASH],
+             part->mask[ID_FLASH], part->base[ID_FLASH]);
+    memcpy(dst->flash_time_offset_of_first_event + l,
+           src->flash_time_offset_of_first_event, nf * sizeof(float));
+    memcpy(dst->flash_time_offset_of_last_event + l,
+           src->flash_time_offset_of_last_event, nf * sizeof(float));
+    memcpy(dst->flash_frame_time_offset_of_first_event + l,
+           src->flash_frame_time_offset_of_first_event, nf * sizeof(float));
+    memcpy(dst->flash_frame_time_offset_of_last_event + l,
+           src->flash_frame_time_offset_of_last_event, nf * sizeof(float));
+    memcpy(dst->flash_lat + l, src->flash_lat, nf * sizeof(float));
+    memcpy(dst->flash_lon + l, src->flash_lon, nf * sizeof(float));
+    memcpy(dst->flash_area + l, src->flash_area, nf * sizeof(float));
+    memcpy(dst->flash_energy + l, src->flash_energy, nf * sizeof(float));
+    memcpy(dst->flash_quality_flag + l, src->flash_quality_flag, nf * sizeof(short));
+    fill_file(dst->flash_file + l, nf, f);
+
+    dst->scalar[f] = src->scalar[0];
+    glm_free_batch(src);
+
+    return 0;
+}
+
+/**
+ * Find where each part goes in the combined batch, and what its IDs
+ * are remapped to.
+ *
+ * @param part Array of parts.
+ * @param nfile Number of parts.
+ * @param nevent Pointer that gets the total number of events.
+ * @param ngroup Pointer that gets the total number of groups.
+ * @param nflash Pointer that gets the total number of flashes.
+ *
+ * @return 0 for success, GLM_ERR_RANGE if the remapped IDs do not
+ * fit in an unsigned int.
+ * @author Ed Hartnett
+ */
+static int
+layout_parts(GLM_PART_T *part, int nfile, size_t *nevent, size_t *ngroup,
+             size_t *nflash)
+{
+    unsigned long long next[NUM_ID];
+    int started[NUM_ID] = {0, 0, 0};
+    int f, k;
+
+    *nevent = *ngroup = *nflash = 0;
+    for (f = 0; f < nfile; f++)
+    {
+        part[f].event_start = *nevent;
+        part[f].group_start = *ngroup;
+        part[f].flash_start = *nflash;
+        *nevent += part[f].batch.nevent;
+        *ngroup += part[f].batch.ngroup;
+        *nflash += part[f].batch.nflash;
+
+        for (k = 0; k < NUM_ID; k++)
+        {
+            if (!part[f].has_id[k])
+                continue;
+
+            /* The first file with IDs of this kind keeps them. */
+            if (!started[k])
+            {
+                next[k] = part[f].min[k];
+                started[k] = 1;
+            }
+            part[f].base[k] = next[k];
+            next[k] += (unsigned long long)(part[f].max[k] - part[f].min[k]) + 1;
+            if (next[k] - 1 > UINT_MAX)
+                return GLM_ERR_RANGE;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Read many GLM files, on several threads, into one batch of
+ * columns. The files are concatenated in the order given. The IDs of
+ * each kind (event, group, flash), and the parent IDs which refer to
+ * them, are remapped so that they are unique across the batch: the
+ * IDs of each file are shifted so that its range of IDs follows that
+ * of the file before. The first file keeps its IDs, except that flash
+ * IDs which wrap past 65535 within a file are unwrapped.
+ *
+ * @param paths Array of nfile file names.
+ * @param nfile Number of files.
+ * @param nthreads Number of threads. If less than 1, one thread per
+ * processor is used.
+ * @param batch Pointer to a GLM_BATCH_T which gets the data. Free
+ * the data with glm_free_batch(). It is left empty on error.
+ *
+ * @return 0 for success, GLM_ERR_RANGE if the remapped IDs do not fit
+ * in an unsigned int, other error code otherwise.
+ * @author Ed Hartnett
+ */
+int
+glm_read_files(const char **paths, int nfile, int nthreads,
+               GLM_BATCH_T *batch)
+{
+    GLM_READ_FILES_T rf;
+    GLM_PART_T *part;
+    size_t nevent, ngroup, nflash;
+    int f;
+    int ret;
+
+    /* Check inputs. */
+    assert((paths || !nfile) && nfile >= 0 && batch);
+    memset(batch, 0, sizeof(GLM_BATCH_T));
+
+    if (!(part = glm_calloc(nfile ? nfile : 1, sizeof(GLM_PART_T))))
+        return GLM_ERR_MEMORY;
+    rf.paths = paths;
+    rf.part = part;
+    rf.batch = batch;
+
+    /* Read each file into its part, then copy the parts into the
+     * batch. */
+    if (!(ret = glm_pool_run(nthreads, nfile, read_part, &rf)) &&
+        !(ret = layout_parts(part, nfile, &nevent, &ngroup, &nflash)) &&
+        !(ret = glm_batch_alloc(batch, NULL, nfile, nevent, ngroup, nflash)))
+        ret = glm_pool_run(nthreads, nfile, copy_part, &rf);
+
+    /* Free any parts which are left. */
+    for (f = 0; f < nfile; f++)
+        glm_free_batch(&part[f].batch);
+    glm_free(part);
+
+    return ret;
+}
@@ -0,0 +1,376 @@
+/**
+ * @file
+ * Code to write the decoded data of GLM files to a cache file, and to
+ * open cache files with mmap().
+ *
+ * A cache file (.glmc) holds the columns of a GLM_BATCH_T, already
+ * unpacked, so it can be used again without decompressing or
+ * unpacking anything. The file is:
+ *
+ * - A header of GLM_CACHE_HEADER_SIZE bytes: the magic number
+ *   "GLMC", the format version, a byte order mark, the size of
+ *   GLM_SCALAR_T, the number of columns, the total length of the
+ *   file, and the number of files, events, groups, and flashes.
+ * - A directory, with the offset of each column, and of the array of
+ *   GLM_SCALAR_T, from the start of the file.
+ * - The columns, in the order of glm_batch_col, each
+ *   starting on a GLM_CACHE_ALIGN byte boundary.
+ *
+ * All numbers are little-endian, as are the values of the
+ * columns. Opening a cache maps the file read-only, checks the header
+ * and directory, and points the columns of a GLM_BATCH_T at the
+ * mapped data, so nothing is read or copied until it is used.
+ *
+ * @author Ed Hartnett
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <assert.h>
+#include <sys/mman.h>
+#include "glm_internal.h"
+
+/** Magic number at the start of a cache file. */
+#define GLM_CACHE_MAGIC "GLMC"
+
+/** Version of the cache format. */
+#define GLM_CACHE_VERSION 1
+
+/** Byte order mark, as written by a little-endian machine. */
+#define GLM_CACHE_BOM 0x01020304
+
+/** Size of the header in bytes. */
+#define GLM_CACHE_HEADER_SIZE 64
+
+/** Alignment of each column in bytes. */
+#define GLM_CACHE_ALIGN 64
+
+/** Number of columns in the cache. */
+#define NUM_CACHE_COLS GLM_NUM_BATCH_COLS
+
+/** The header of a cache file, as laid out in the first
+ * GLM_CACHE_HEADER_SIZE bytes. */
+typedef struct GLM_CACHE_HEADER
+{
+    char magic[4];        /**< GLM_CACHE_MAGIC. */
+    uint32_t version;     /**< GLM_CACHE_VERSION. */
+    uint32_t bom;         /**< GLM_CACHE_BOM. */
+    uint32_t scalar_size; /**< sizeof(GLM_SCALAR_T). */
+    uint32_t ncol;        /**< Number of columns. */
+    uint32_t pad;         /**< Zero. */
+    uint64_t length;      /**< Length of the file in bytes. */
+    uint64_t nfile;       /**< Number of files. */
+    uint64_t nevent;      /**< Number of events. */
+    uint64_t ngroup;      /**< Number of groups. */
+    uint64_t nflash;      /**< Number of flashes. */
+} GLM_CACHE_HEADER_T;
+
+/** An open cache file. */
+struct GLM_CACHE
+{
+    void *map;         /**< The mapped file. */
+    size_t length;     /**< Length of the mapping in bytes. */
+    GLM_BATCH_T batch; /**< Columns, pointing into the mapping. */
+};
+
+/**
+ * Find the number of values in a column.
+ *
+ * @param c Index of the column in glm_batch_col.
+ * @param hdr Pointer to the header, with the counts filled in.
+ *
+ * @return Number of values.
+ * @author Ed Hartnett
+ */
+static uint64_t
+col_len(int c, const GLM_CACHE_HEADER_T *hdr)
+{
+    return glm_batch_col_len(&glm_batch_col[c], hdr->nfile, hdr->nevent,
+                             hdr->ngroup, hdr->nflash);
+}
+
+/**
+ * Round a file offset up to the column alignment.
+ *
+ * @param offset The offset.
+ *
+ * @return The next multiple of GLM_CACHE_ALIGN.
+ * @author Ed Hartnett
+ */
+static uint64_t
+align_up(uint64_t offset)
+{
+    return (offset + GLM_CACHE_ALIGN - 1) / GLM_CACHE_ALIGN * GLM_CACHE_ALIGN;
+}
+
+/**
+ * Lay out a cache file: find the offset of each column, and the length
+ * of the file.
+ *
+ * @param hdr Pointer to the header, with the counts filled in. The
+ * length is filled in.
+ * @param offset Array of NUM_CACHE_COLS that gets the offsets.
+ *
+ * @return 0 for success, GLM_ERR_RANGE if the file would be too large.
+ * @author Ed Hartnett
+ */
+static int
+layout(GLM_CACHE_HEADER_T *hdr, uint64_t *offset)
+{
+    uint64_t pos;
+    int c;
+
+    pos = align_up(GLM_CACHE_HEADER_SIZE + NUM_CACHE_COLS * sizeof(uint64_t));
+    for (c = 0; c < NUM_CACHE_COLS; c++)
+    {
+        uint64_t n = col_len(c, hdr);
+
+        if (n > (UINT64_MAX / 2 - pos) / glm_batch_col[c].size)
+            return GLM_ERR_RANGE;
+        offset[c] = pos;
+        pos = align_up(pos + n * glm_batch_col[c].size);
+    }
+    hdr->length = pos;
+
+    return 0;
+}
+
+/**
+ * Write the data of a batch to a cache file, which can be opened with
+ * glm_open_cache(). An existing file is overwritten.
+ *
+ * @param batch Pointer to the batch, from glm_read_files(),
+ * glm_pipeline(), or glm_open_cache().
+ * @param path Name of the cache file, usually ending in .glmc.
+ *
+ * @return 0 for success, GLM_ERR_IO if the file can't be written, or
+ * GLM_ERR_CACHE if this machine is not little-endian.
+ * @author Ed Hartnett
+ */
+int
+glm_write_cache(const GLM_BATCH_T *batch, const char *path)
+{
+    GLM_CACHE_HEADER_T hdr;
+    uint64_t offset[NUM_CACHE_COLS];
+    unsigned char pad[GLM_CACHE_ALIGN];
+    uint64_t pos;
+    FILE *f;
+    int c;
+    int ret;
+
+    /* Check inputs. */
+    assert(batch && path && sizeof(hdr) == GLM_CACHE_HEADER_SIZE);
+
+    /* The values are written as they are in memory. */
+    if (!glm_little_endian())
+        return GLM_ERR_CACHE;
+
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, GLM_CACHE_MAGIC, sizeof(hdr.magic));
+    hdr.version = GLM_CACHE_VERSION;
+    hdr.bom = GLM_CACHE_BOM;
+    hdr.scalar_size = sizeof(GLM_SCALAR_T);
+    hdr.ncol = NUM_CACHE_COLS;
+    hdr.nfile = batch->nfile;
+    hdr.nevent = batch->nevent;
+    hdr.ngroup = batch->ngroup;
+    hdr.nflash = batch->nflash;
+    if ((ret = layout(&hdr, offset)))
+        return ret;
+    memset(pad, 0, sizeof(pad));
+
+    if (!(f = fopen(path, "wb")))
+        return GLM_ERR_IO;
+
+    /* The header and the directory. */
+    ret = fwrite(&hdr, sizeof(hdr), 1, f) != 1 ||
+        fwrite(offset, sizeof(uint64_t), NUM_CACHE_COLS, f) != NUM_CACHE_COLS;
+    pos = GLM_CACHE_HEADER_SIZE + NUM_CACHE_COLS * sizeof(uint64_t);
+
+    /* Each column, padded to the next one. */
+    for (c = 0; c < NUM_CACHE_COLS && !ret; c++)
+    {
+        const void *data = *(void * const *)((const char *)batch + glm_batch_col[c].field);
+        uint64_t len = col_len(c, &hdr) * glm_batch_col[c].size;
+
+        if (offset[c] > pos)
+            ret = fwrite(pad, offset[c] - pos, 1, f) != 1;
+        if (len && !ret)
+            ret = fwrite(data, len, 1, f) != 1;
+        pos = offset[c] + len;
+    }
+    if (pos < hdr.length && !ret)
+        ret = fwrite(pad, hdr.length - pos, 1, f) != 1;
+
+    if (fclose(f) || ret)
+    {
+        remove(path);
+        return GLM_ERR_IO;
+    }
+
+    return 0;
+}
+
+/**
+ * Read a GLM file, and write its decoded data to a cache file.
+ *
+ * @param file_name Name of the GLM file.
+ * @param path Name of the cache file, usually ending in .glmc.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+int
+glm_convert_to_cache(const char *file_name, const char *path)
+{
+    GLM_BATCH_T batch;
+    int ret;
+
+    /* Check inputs. */
+    assert(file_name && path);
+
+    if ((ret = glm_read_file_batch(file_name, &batch)))
+        return ret;
+    ret = glm_write_cache(&batch, path);
+    glm_free_batch(&batch);
+
+    return ret;
+}
+
+/**
+ * Check the header and directory of a mapped cache file, and point
+ * the columns of the batch at the mapped data.
+ *
+ * @param cache Pointer to the cache, with the file mapped.
+ *
+ * @return 0 for success, GLM_ERR_CACHE if it is not a valid cache
+ * file.
+ * @author Ed Hartnett
+ */
+static int
+check_cache(GLM_CACHE_T *cache)
+{
+    GLM_CACHE_HEADER_T hdr;
+    uint64_t expected[NUM_CACHE_COLS];
+    const uint64_t *offset;
+    const char *base = cache->map;
+    int c;
+
+    if (cache->length < GLM_CACHE_HEADER_SIZE)
+        return GLM_ERR_CACHE;
+    memcpy(&hdr, base, sizeof(hdr));
+    if (memcmp(hdr.magic, GLM_CACHE_MAGIC, sizeof(hdr.magic)) ||
+        hdr.version != GLM_CACHE_VERSION || hdr.bom != GLM_CACHE_BOM ||
+        hdr.scalar_size != sizeof(GLM_SCALAR_T) ||
+        hdr.ncol != NUM_CACHE_COLS || hdr.length != cache->length)
+        return GLM_ERR_CACHE;
+
+    /* The columns must be where they were laid out, which also checks
+     * that they are aligned and inside the file. */
+    if (layout(&hdr, expected) || hdr.length != cache->length)
+        return GLM_ERR_CACHE;
+    offset = (const uint64_t *)(base + GLM_CACHE_HEADER_SIZE);
+    for (c = 0; c < NUM_CACHE_COLS; c++)
+        if (offset[c] != expected[c])
+            return GLM_ERR_CACHE;
+
+    cache->batch.nfile = hdr.nfile;
+    cache->batch.nevent = hdr.nevent;
+    cache->batch.ngroup = hdr.ngroup;
+    cache->batch.nflash = hdr.nflash;
+    for (c = 0; c < NUM_CACHE_COLS; c++)
+        *(const void **)((char *)&cache->batch + glm_batch_col[c].field) =
+            base + offset[c];
+
+    return 0;
+}
+
+/**
+ * Open a cache file written by glm_write_cache() or
+ * glm_convert_to_cache(). The file is mapped read-only, and its
+ * columns are used where they are, with no copy. Get them with
+ * glm_cache_batch().
+ *
+ * @param path Name of the cache file.
+ * @param cachep Pointer that gets the cache. Free it with
+ * glm_close_cache().
+ *
+ * @return 0 for success, GLM_ERR_IO if the file can't be opened or
+ * mapped, GLM_ERR_CACHE if it is not a valid cache file, or
+ * GLM_ERR_MEMORY.
+ * @author Ed Hartnett
+ */
+int
+glm_open_cache(const char *path, GLM_CACHE_T **cachep)
+{
+    GLM_CACHE_T *cache;
+    int ret;
+
+    /* Check inputs. */
+    assert(path && cachep);
+
+    if (!glm_little_endian())
+        return GLM_ERR_CACHE;
+    if (!(cache = glm_calloc(1, sizeof(GLM_CACHE_T))))
+        return GLM_ERR_MEMORY;
+    if ((ret = glm_map_file(path, GLM_CACHE_HEADER_SIZE, GLM_ERR_CACHE, &cache->map,
+                            &cache->length)))
+    {
+        glm_free(cache);
+        return ret;
+    }
+
+    if ((ret = check_cache(cache)))
+    {
+        glm_close_cache(cache);
+        return ret;
+    }
+    *cachep = cache;
+
+    return 0;
+}
+
+/**
+ * Get the columns of an open cache. They point into the mapped file,
+ * and are valid until glm_close_cache() is called. They must not be
+ * changed, or freed with glm_free_batch().
+ *
+ * @param cache Pointer to the cache.
+ * @param batch Pointer that gets a pointer to the batch.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+int
+glm_cache_batch(GLM_CACHE_T *cache, const GLM_BATCH_T **batch)
+{
+    /* Check inputs. */
+    assert(cache && batch);
+
+    *batch = &cache->batch;
+
+    return 0;
+}
+
+/**
+ * Close a cache opened with glm_open_cache(), and free it.
+ *
+ * @param cache Pointer to the cache.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+int
+glm_close_cache(GLM_CACHE_T *cache)
+{
+    /* Check inputs. */
+    assert(cache);
+
+    munmap(cache->map, cache->length);
+    glm_free(cache);
+
+    return 0;
+}
@@ -0,0 +1,847 @@
+/**
+ * @file
+ * Code to keep a catalog of the GLM files of a directory, so that
+ * the files which cover a time window and region can be found without
+ * opening any of them.
+ *
+ * A catalog file (.glmx) holds one GLM_CATALOG_ENTRY_T per granule:
+ * its name, its time span, from product_time_bounds and from the
+ * times in its name, its counts, and the extent of its events. The
+ * file is:
+ *
+ * - A header of GLM_CATALOG_HEADER_SIZE bytes: the magic number
+ *   "GLMX", the format version, a byte order mark, the size of
+ *   GLM_CATALOG_ENTRY_T, the number of entries, and the longest time
+ *   span of any entry.
+ * - The entries, sorted by time_start, then by name.
+ *
+ * All numbers are little-endian. Opening a catalog maps it read-only,
+ * as glm_open_cache() does. A query finds the entries which may
+ * overlap a time window with two binary searches: entries which start
+ * after the window are past the end, and entries which start more
+ * than the longest span before the window are past the start. Only
+ * the entries between are checked.
+ *
+ * Updating a catalog only reads the files which are new, or which
+ * have changed size or modification time since it was written.
+ * Entries of files which are gone are dropped. Files which can't be
+ * read are left out, and tried again by the next update.
+ *
+ * @author Ed Hartnett
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <assert.h>
+#include <dirent.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "glm_internal.h"
+
+/** Magic number at the start of a catalog file. */
+#define GLM_CATALOG_MAGIC "GLMX"
+
+/** Version of the catalog format. */
+#define GLM_CATALOG_VERSION 1
+
+/** Byte order mark, as written by a little-endian machine. */
+#define GLM_CATALOG_BOM 0x01020304
+
+/** Size of the header in bytes. */
+#define GLM_CATALOG_HEADER_SIZE 64
+
+/** Suffix of GLM file names. */
+#define GLM_SUFFIX ".nc"
+
+/** Suffix added to the name of a catalog while it is written. */
+#define GLM_CATALOG_TMP ".tmp"
+
+/** Days from 1970-01-01 to 2000-01-01. */
+#define J2000_DAYS 10957
+
+/** Seconds from 2000-01-01 00:00:00 to the epoch of product_time. */
+#define J2000_NOON 43200
+
+/** Seconds in a day. */
+#define DAY_SECONDS 86400
+
+/** Number of digits of a time in a GLM file name. */
+#define NAME_TIME_DIGITS 14
+
+/** Entries a directory listing starts with room for. */
+#define SCAN_START 64
+
+/** The header of a catalog file, as laid out in the first
+ * GLM_CATALOG_HEADER_SIZE bytes. */
+typedef struct GLM_CATALOG_HEADER
+{
+    char magic[4];        /**< GLM_CATALOG_MAGIC. */
+    uint32_t version;     /**< GLM_CATALOG_VERSION. */
+    uint32_t bom;         /**< GLM_CATALOG_BOM. */
+    uint32_t entry_size;  /**< sizeof(GLM_CATALOG_ENTRY_T). */
+    uint64_t nentry;      /**< Number of entries. */
+    double max_span;      /**< Longest time_end - time_start. */
+    char pad[32];         /**< Zero. */
+} GLM_CATALOG_HEADER_T;
+
+/** An open catalog file. */
+struct GLM_CATALOG
+{
+    void *map;                        /**< The mapped file. */
+    size_t length;                    /**< Length of the mapping. */
+    size_t nentry;                    /**< Number of entries. */
+    double max_span;                  /**< Longest time span. */
+    const GLM_CATALOG_ENTRY_T *entry; /**< The entries, in the map. */
+};
+
+/** What catalog_write() shares with its tasks. */
+typedef struct GLM_CATALOG_TASK
+{
+    const char *dir;                 /**< The directory. */
+    GLM_CATALOG_ENTRY_T *entry;      /**< Entries of the directory. */
+    const GLM_CATALOG_ENTRY_T **old; /**< Old entry of each, or NULL. */
+    int *status;                     /**< Status of each. */
+} GLM_CATALOG_TASK_T;
+
+/**
+ * Find the number of days from 1970-01-01 to the first day of a
+ * year.
+ *
+ * @param year The year.
+ *
+ * @return Number of days.
+ * @author Ed Hartnett
+ */
+static long
+days_to_year(long year)
+{
+    long y = year - 1;
+
+    return 365 * (year - 1970) + (y / 4 - y / 100 + y / 400) -
+        (1969 / 4 - 1969 / 100 + 1969 / 400);
+}
+
+/**
+ * Parse one time of a GLM file name, YYYYJJJHHMMSSt: the year, day of
+ * the year, hour, minute, second, and tenth of a second.
+ *
+ * @param s Pointer to the first digit.
+ * @param t Pointer that gets the time in seconds since 2000-01-01
+ * 12:00:00 UTC.
+ *
+ * @return 0 for success, GLM_ERR_NAME if it is not a time.
+ * @author Ed Hartnett
+ */
+static int
+parse_name_time(const char *s, double *t)
+{
+    long year, doy, hour, min, sec, tenth;
+    int i;
+
+    for (i = 0; i < NAME_TIME_DIGITS; i++)
+        if (s[i] < '0' || s[i] > '9')
+            return GLM_ERR_NAME;
+    year = (s[0] - '0') * 1000 + (s[1] - '0') * 100 + (s[2] - '0') * 10 +
+        (s[3] - '0');
+    doy = (s[4] - '0') * 100 + (s[5] - '0') * 10 + (s[6] - '0');
+    hour = (s[7] - '0') * 10 + (s[8] - '0');
+    min = (s[9] - '0') * 10 + (s[10] - '0');
+    sec = (s[11] - '0') * 10 + (s[12] - '0');
+    tenth = s[13] - '0';
+    if (doy < 1 || doy > 366 || hour > 23 || min > 59 || sec > 60)
+        return GLM_ERR_NAME;
+
+    *t = (double)(days_to_year(year) + doy - 1 - J2000_DAYS) * DAY_SECONDS +
+        hour * 3600 + min * 60 + sec - J2000_NOON + tenth / 10.0;
+
+    return 0;
+}
+
+/**
+ * Find the start, end, and creation times in the name of a GLM file,
+ * such as
+ * OR_GLM-L2-LCFA_G17_s20192692359400_e20192700000000_c20192700000028.nc,
+ * in which they follow _s, _e, and _c.
+ *
+ * @param name Name of the file. Any directory is ignored.
+ * @param start Pointer that gets the start time, in seconds since
+ * 2000-01-01 12:00:00 UTC, like product_time. Ignored if NULL.
+ * @param end Pointer that gets the end time. Ignored if NULL.
+ * @param created Pointer that gets the creation time. Ignored if
+ * NULL.
+ *
+ * @return 0 for success, GLM_ERR_NAME if it is not the name of a GLM
+ * file.
+ * @author Ed Hartnett
+ */
+int
+glm_name_times(const char *name, double *start, double *end,
+               double *created)
+{
+    static const char tag[3][4] = {"_s", "_e", "_c"};
+    double t[3];
+    const char *base, *s;
+    int i;
+    int ret;
+
+    /* Check inputs. */
+    assert(name);
+
+    base = (s = strrchr(name, '/')) ? s + 1 : name;
+    for (i = 0, s = base; i < 3; i++)
+    {
+        if (!(s = strstr(s, tag[i])))
+            return GLM_ERR_NAME;
+        if ((ret = parse_name_time(s + 2, &t[i])))
+            return ret;
+        s += 2 + NAME_TIME_DIGITS;
+    }
+    if (start)
+        *start = t[0];
+    if (end)
+        *end = t[1];
+    if (created)
+        *created = t[2];
+
+    return 0;
+}
+
+/**
+ * Make sure an array of entries has room for n.
+ *
+ * @param entry Pointer to the array, which is moved if it grows.
+ * @param cap Pointer to the number of entries there is room for.
+ * @param n Number of entries used.
+ * @param need Number of entries needed.
+ *
+ * @return 0 for success, GLM_ERR_MEMORY otherwise.
+ * @author Ed Hartnett
+ */
+static int
+grow_entries(GLM_CATALOG_ENTRY_T **entry, size_t *cap, size_t n, size_t need)
+{
+    GLM_CATALOG_ENTRY_T *new_entry;
+    size_t new_cap;
+
+    if (need <= *cap)
+        return 0;
+    new_cap = *cap ? *cap * 2 : SCAN_START;
+    if (new_cap < need)
+        new_cap = need;
+    if (!(new_entry = glm_calloc(new_cap, sizeof(GLM_CATALOG_ENTRY_T))))
+        return GLM_ERR_MEMORY;
+    if (n)
+        memcpy(new_entry, *entry, n * sizeof(GLM_CATALOG_ENTRY_T));
+    glm_free(*entry);
+    *entry = new_entry;
+    *cap = new_cap;
+
+    return 0;
+}
+
+/**
+ * List the GLM files of a directory. Each gets an entry with its
+ * name, the times in its name, its size, and its modification time
+ * filled in. Files whose names are not GLM names, or are too long,
+ * and anything which is not a regular file, are left out.
+ *
+ * @param dir Name of the directory.
+ * @param entryp Pointer that gets the entries. Free them with
+ * glm_free().
+ * @param nentry Pointer that gets the number of entries.
+ *
+ * @return 0 for success, GLM_ERR_IO if the directory can't be read,
+ * or GLM_ERR_MEMORY.
+ * @author Ed Hartnett
+ */
+int
+glm_catalog_scan(const char *dir, GLM_CATALOG_ENTRY_T **entryp,
+                 size_t *nentry)
+{
+    GLM_CATALOG_ENTRY_T *entry = NULL;
+    size_t n = 0, cap = 0;
+    struct dirent *de;
+    DIR *d;
+    int ret = 0;
+
+    /* Check inputs. */
+    assert(dir && entryp && nentry);
+
+    if (!(d = opendir(dir)))
+        return GLM_ERR_IO;
+    while (!ret && (de = readdir(d)))
+    {
+        GLM_CATALOG_ENTRY_T *e;
+        char path[PATH_MAX];
+        size_t len = strlen(de->d_name);
+        struct stat st;
+
+        if (len >= GLM_CATALOG_NAME_LEN || len < strlen(GLM_SUFFIX) ||
+            strcmp(de->d_name + len - strlen(GLM_SUFFIX), GLM_SUFFIX) ||
+            glm_name_times(de->d_name, NULL, NULL, NULL))
+            continue;
+        if (snprintf(path, sizeof(path), "%s/%s", dir, de->d_name) >=
+            (int)sizeof(path) || stat(path, &st) || !S_ISREG(st.st_mode))
+            continue;
+        if ((ret = grow_entries(&entry, &cap, n, n + 1)))
+            break;
+
+        e = &entry[n++];
+        memcpy(e->name, de->d_name, len + 1);
+        glm_name_times(e->name, &e->name_start, &e->name_end,
+                       &e->name_created);
+        e->mtime = st.st_mtime;
+        e->size = st.st_size;
+    }
+    closedir(d);
+    if (ret)
+    {
+        glm_free(entry);
+        return ret;
+    }
+    *entryp = entry;
+    *nentry = n;
+
+    return 0;
+}
+
+/**
+ * Read what an entry needs from its file: product_time_bounds, the
+ * counts, and the extent of the events.
+ *
+ * @param path Name of the file.
+ * @param entry Pointer to the entry, with the name times filled in.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+static int
+read_entry(const char *path, GLM_CATALOG_ENTRY_T *entry)
+{
+    GLM_FILE_T *glm;
+    GLM_SCALAR_T scalar;
+    size_t nevent, ngroup, nflash;
+    float *lat = NULL, *lon = NULL;
+    size_t i;
+    int ret;
+
+    if ((ret = glm_open(path, &glm)))
+        return ret;
+    if (!(ret = glm_inq_dims(glm, &nevent, &ngroup, &nflash)) &&
+        !(ret = glm_get_scalars(glm, &scalar)))
+    {
+        if (!(lat = glm_malloc(nevent * sizeof(float))) ||
+            !(lon = glm_malloc(nevent * sizeof(float))))
+            ret = GLM_ERR_MEMORY;
+        else
+            ret = glm_get_event_arrays(glm, NULL, NULL, NULL, lat, lon, NULL,
+                                       NULL);
+    }
+    glm_close(glm);
+
+    if (!ret)
+    {
+        entry->time_start = scalar.product_time_bounds[0];
+        entry->time_end = scalar.product_time_bounds[1];
+        if (entry->name_start < entry->time_start)
+            entry->time_start = entry->name_start;
+        if (entry->name_end > entry->time_end)
+            entry->time_end = entry->name_end;
+        entry->nevent = nevent;
+        entry->ngroup = ngroup;
+        entry->nflash = nflash;
+
+        /* An empty extent has min > max. */
+        entry->lat_min = entry->lon_min = 1.0;
+        entry->lat_max = entry->lon_max = -1.0;
+        for (i = 0; i < nevent; i++)
+        {
+            if (!i || lat[i] < entry->lat_min)
+                entry->lat_min = lat[i];
+            if (!i || lat[i] > entry->lat_max)
+                entry->lat_max = lat[i];
+            if (!i || lon[i] < entry->lon_min)
+                entry->lon_min = lon[i];
+            if (!i || lon[i] > entry->lon_max)
+                entry->lon_max = lon[i];
+        }
+    }
+    glm_free(lat);
+    glm_free(lon);
+
+    return ret;
+}
+
+/**
+ * Fill in the entry of one file, task i of catalog_write(). If the
+ * old catalog has an entry for the file, and the file has not
+ * changed, the old entry is used.
+ *
+ * @param arg Pointer to the GLM_CATALOG_TASK_T.
+ * @param i Index of the entry.
+ *
+ * @return 0.
+ * @author Ed Hartnett
+ */
+static int
+entry_task(void *arg, int i)
+{
+    GLM_CATALOG_TASK_T *ct = arg;
+    GLM_CATALOG_ENTRY_T *entry = &ct->entry[i];
+    const GLM_CATALOG_ENTRY_T *old = ct->old[i];
+    char path[PATH_MAX];
+
+    if (old && old->mtime == entry->mtime && old->size == entry->size)
+    {
+        *entry = *old;
+        ct->status[i] = 0;
+        return 0;
+    }
+    snprintf(path, sizeof(path), "%s/%s", ct->dir, entry->name);
+    ct->status[i] = read_entry(path, entry);
+
+    return 0;
+}
+
+/**
+ * Order entries by name, for qsort() and bsearch().
+ *
+ * @param a Pointer to a pointer to an entry.
+ * @param b Pointer to a pointer to an entry.
+ *
+ * @return <0, 0, or >0.
+ * @author Ed Hartnett
+ */
+static int
+cmp_name(const void *a, const void *b)
+{
+    return strcmp((*(const GLM_CATALOG_ENTRY_T * const *)a)->name,
+                  (*(const GLM_CATALOG_ENTRY_T * const *)b)->name);
+}
+
+/**
+ * Order entries by time_start, then by name, for qsort().
+ *
+ * @param a Pointer to an entry.
+ * @param b Pointer to an entry.
+ *
+ * @return <0, 0, or >0.
+ * @author Ed Hartnett
+ */
+static int
+cmp_time(const void *a, const void *b)
+{
+    const GLM_CATALOG_ENTRY_T *ea = a, *eb = b;
+
+    if (ea->time_start != eb->time_start)
+        return ea->time_start < eb->time_start ? -1 : 1;
+
+    return strcmp(ea->name, eb->name);
+}
+
+/**
+ * Write a catalog file. It is written under a temporary name, then
+ * renamed, so that a catalog which is open, or is being queried, is
+ * never seen half written.
+ *
+ * @param path Name of the catalog file.
+ * @param entry Array of entries, sorted.
+ * @param nentry Number of entries.
+ *
+ * @return 0 for success, GLM_ERR_IO otherwise.
+ * @author Ed Hartnett
+ */
+static int
+write_catalog(const char *path, const GLM_CATALOG_ENTRY_T *entry,
+              size_t nentry)
+{
+    GLM_CATALOG_HEADER_T hdr;
+    char tmp[PATH_MAX];
+    FILE *f;
+    size_t i;
+    int ret;
+
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, GLM_CATALOG_MAGIC, sizeof(hdr.magic));
+    hdr.version = GLM_CATALOG_VERSION;
+    hdr.bom = GLM_CATALOG_BOM;
+    hdr.entry_size = sizeof(GLM_CATALOG_ENTRY_T);
+    hdr.nentry = nentry;
+    for (i = 0; i < nentry; i++)
+        if (entry[i].time_end - entry[i].time_start > hdr.max_span)
+            hdr.max_span = entry[i].time_end - entry[i].time_start;
+
+    if (snprintf(tmp, sizeof(tmp), "%s%s", path, GLM_CATALOG_TMP) >=
+        (int)sizeof(tmp))
+        return GLM_ERR_IO;
+    if (!(f = fopen(tmp, "wb")))
+        return GLM_ERR_IO;
+    ret = fwrite(&hdr, sizeof(hdr), 1, f) != 1 ||
+        (nentry && fwrite(entry, sizeof(GLM_CATALOG_ENTRY_T), nentry, f) != nentry);
+    if (fclose(f) || ret || rename(tmp, path))
+    {
+        remove(tmp);
+        return GLM_ERR_IO;
+    }
+
+    return 0;
+}
+
+/**
+ * Catalog the GLM files of a directory, using the entries of an old
+ * catalog for files which have not changed.
+ *
+ * @param dir Name of the directory.
+ * @param path Name of the catalog file.
+ * @param nthreads Number of threads which read files.
+ * @param old Pointer to the old catalog, or NULL.
+ * @param nentry Pointer that gets the number of entries. Ignored if
+ * NULL.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+static int
+catalog_write(const char *dir, const char *path, int nthreads,
+              GLM_CATALOG_T *old, size_t *nentry)
+{
+    GLM_CATALOG_TASK_T ct;
+    const GLM_CATALOG_ENTRY_T **by_name = NULL;
+    GLM_CATALOG_ENTRY_T *entry;
+    size_t n, nold = old ? old->nentry : 0;
+    size_t i, j;
+    int ret;
+
+    if ((ret = glm_catalog_scan(dir, &entry, &n)))
+        return ret;
+    if ((size_t)(int)n != n)
+    {
+        glm_free(entry);
+        return GLM_ERR_RANGE;
+    }
+
+    ct.dir = dir;
+    ct.entry = entry;
+    ct.old = glm_calloc(n ? n : 1, sizeof(GLM_CATALOG_ENTRY_T *));
+    ct.status = glm_calloc(n ? n : 1, sizeof(int));
+    if (nold)
+        by_name = glm_malloc(nold * sizeof(GLM_CATALOG_ENTRY_T *));
+    if (!ct.old || !ct.status || (nold && !by_name))
+        ret = GLM_ERR_MEMORY;
+
+    /* Find the old entry of each file. */
+    if (!ret && nold)
+    {
+        for (i = 0; i < nold; i++)
+            by_name[i] = &old->entry[i];
+        qsort(by_name, nold, sizeof(GLM_CATALOG_ENTRY_T *), cmp_name);
+        for (i = 0; i < n; i++)
+        {
+            const GLM_CATALOG_ENTRY_T *key = &entry[i];
+            const GLM_CATALOG_ENTRY_T **found;
+
+            found = bsearch(&key, by_name, nold, sizeof(GLM_CATALOG_ENTRY_T *),
+                            cmp_name);
+            ct.old[i] = found ? *found : NULL;
+        }
+    }
+
+    /* Fill in the entries, leave out those which can't be read, sort
+     * them, and write them. */
+    if (!ret)
+        ret = glm_pool_run(nthreads, (int)n, entry_task, &ct);
+    if (!ret)
+    {
+        for (i = 0, j = 0; i < n; i++)
+            if (!ct.status[i])
+                entry[j++] = entry[i];
+        qsort(entry, j, sizeof(GLM_CATALOG_ENTRY_T), cmp_time);
+        if (!(ret = write_catalog(path, entry, j)) && nentry)
+            *nentry = j;
+    }
+
+    glm_free(by_name);
+    glm_free(ct.status);
+    glm_free(ct.old);
+    glm_free(entry);
+
+    return ret;
+}
+
+/**
+ * Catalog all the GLM files of a directory, reading every one, and
+ * write the catalog to a file. An existing catalog file is
+ * overwritten. Files which can't be read are left out.
+ *
+ * @param dir Name of the directory.
+ * @param path Name of the catalog file, usually ending in .glmx. It
+ * may be in the directory.
+ * @param nthreads Number of threads which read files. If less than
+ * 1, the number of online processors is used.
+ * @param nentry Pointer that gets the number of granules in the
+ * catalog. Ignored if NULL.
+ *
+ * @return 0 for success, GLM_ERR_IO if the directory can't be read or
+ * the catalog can't be written, GLM_ERR_CATALOG if this machine is
+ * not little-endian, other error code otherwise.
+ * @author Ed Hartnett
+ */
+int
+glm_catalog_build(const char *dir, const char *path, int nthreads,
+                  size_t *nentry)
+{
+    /* Check inputs. */
+    assert(dir && path);
+
+    if (!glm_little_endian())
+        return GLM_ERR_CATALOG;
+
+    return catalog_write(dir, path, nthreads, NULL, nentry);
+}
+
+/**
+ * Bring a catalog up to date with its directory. Only files which are
+ * new, or whose size or modification time has changed, are read.
+ * Granules whose files are gone are dropped. If there is no catalog
+ * file, or it is not a valid catalog, this is glm_catalog_build().
+ *
+ * @param dir Name of the directory.
+ * @param path Name of the catalog file.
+ * @param nthreads Number of threads which read files. If less than
+ * 1, the number of online processors is used.
+ * @param nentry Pointer that gets the number of granules in the
+ * catalog. Ignored if NULL.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+int
+glm_catalog_update(const char *dir, const char *path, int nthreads,
+                   size_t *nentry)
+{
+    GLM_CATALOG_T *old;
+    int ret;
+
+    /* Check inputs. */
+    assert(dir && path);
+
+    if (!glm_little_endian())
+        return GLM_ERR_CATALOG;
+    if (glm_catalog_open(path, &old))
+        return catalog_write(dir, path, nthreads, NULL, nentry);
+    ret = catalog_write(dir, path, nthreads, old, nentry);
+    glm_catalog_close(old);
+
+    return ret;
+}
+
+/**
+ * Open a catalog file written by glm_catalog_build() or
+ * glm_catalog_update(). The file is mapped read-only.
+ *
+ * @param path Name of the catalog file.
+ * @param catalogp Pointer that gets the catalog. Free it with
+ * glm_catalog_close().
+ *
+ * @return 0 for success, GLM_ERR_IO if the file can't be opened or
+ * mapped, GLM_ERR_CATALOG if it is not a valid catalog file, or
+ * GLM_ERR_MEMORY.
+ * @author Ed Hartnett
+ */
+int
+glm_catalog_open(const char *path, GLM_CATALOG_T **catalogp)
+{
+    GLM_CATALOG_T *catalog;
+    GLM_CATALOG_HEADER_T hdr;
+    int ret;
+
+    /* Check inputs. */
+    assert(path && catalogp && sizeof(hdr) == GLM_CATALOG_HEADER_SIZE);
+
+    if (!glm_little_endian())
+        return GLM_ERR_CATALOG;
+    if (!(catalog = glm_calloc(1, sizeof(GLM_CATALOG_T))))
+        return GLM_ERR_MEMORY;
+    if ((ret = glm_map_file(path, GLM_CATALOG_HEADER_SIZE, GLM_ERR_CATALOG,
+                            &catalog->map, &catalog->length)))
+    {
+        glm_free(catalog);
+        return ret;
+    }
+
+    /* Check the header, and that the entries fill the rest. */
+    memcpy(&hdr, catalog->map, sizeof(hdr));
+    if (memcmp(hdr.magic, GLM_CATALOG_MAGIC, sizeof(hdr.magic)) ||
+        hdr.version != GLM_CATALOG_VERSION || hdr.bom != GLM_CATALOG_BOM ||
+        hdr.entry_size != sizeof(GLM_CATALOG_ENTRY_T) ||
+        hdr.nentry != (catalog->length - GLM_CATALOG_HEADER_SIZE) /
+        sizeof(GLM_CATALOG_ENTRY_T) ||
+        (catalog->length - GLM_CATALOG_HEADER_SIZE) %
+        sizeof(GLM_CATALOG_ENTRY_T))
+    {
+        glm_catalog_close(catalog);
+        return GLM_ERR_CATALOG;
+    }
+    catalog->nentry = hdr.nentry;
+    catalog->max_span = hdr.max_span;
+    catalog->entry = (const GLM_CATALOG_ENTRY_T *)
+        ((const char *)catalog->map + GLM_CATALOG_HEADER_SIZE);
+    *catalogp = catalog;
+
+    return 0;
+}
+
+/**
+ * Learn the number of granules in an open catalog.
+ *
+ * @param catalog Pointer to the catalog.
+ * @param nentry Pointer that gets the number of granules.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+int
+glm_catalog_len(GLM_CATALOG_T *catalog, size_t *nentry)
+{
+    /* Check inputs. */
+    assert(catalog && nentry);
+
+    *nentry = catalog->nentry;
+
+    return 0;
+}
+
+/**
+ * Get one granule of an open catalog. Granules are in order of
+ * time_start. The entry points into the mapped file, and is valid
+ * until glm_catalog_close() is called.
+ *
+ * @param catalog Pointer to the catalog.
+ * @param i Index of the granule.
+ * @param entry Pointer that gets a pointer to the entry.
+ *
+ * @return 0 for success, GLM_ERR_RANGE if there is no granule i.
+ * @author Ed Hartnett
+ */
+int
+glm_catalog_entry(GLM_CATALOG_T *catalog, size_t i,
+                  const GLM_CATALOG_ENTRY_T **entry)
+{
+    /* Check inputs. */
+    assert(catalog && entry);
+    if (i >= catalog->nentry)
+        return GLM_ERR_RANGE;
+
+    *entry = &catalog->entry[i];
+
+    return 0;
+}
+
+/**
+ * Find the first entry of a catalog which starts at or after a time.
+ *
+ * @param catalog Pointer to the catalog.
+ * @param t The time.
+ * @param after If non-zero, find the first entry which starts after
+ * the time instead.
+ *
+ * @return Index of the entry, or the number of entries if there is
+ * none.
+ * @author Ed Hartnett
+ */
+static size_t
+lower_bound(const GLM_CATALOG_T *catalog, double t, int after)
+{
+    size_t lo = 0, hi = catalog->nentry;
+
+    while (lo < hi)
+    {
+        size_t mid = lo + (hi - lo) / 2;
+        double start = catalog->entry[mid].time_start;
+
+        if (start < t || (after && start == t))
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    return lo;
+}
+
+/**
+ * Find the granules of an open catalog which pass a query. Only the
+ * entries which may overlap the time window of the query are checked,
+ * so a query of a small window is quick whatever the size of the
+ * catalog. The extent of a granule which crosses the antimeridian
+ * spans all longitudes between, so it may match boxes which it does
+ * not overlap, but a granule is never missed.
+ *
+ * @param catalog Pointer to the catalog.
+ * @param query Pointer to the query.
+ * @param nmatch Pointer that gets the number of granules which pass.
+ * @param match Array which gets the index of each granule which
+ * passes, in order. It must have room for every granule in the
+ * catalog. Ignored if NULL.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+int
+glm_catalog_query(GLM_CATALOG_T *catalog, const GLM_CATALOG_QUERY_T *query,
+                  size_t *nmatch, size_t *match)
+{
+    size_t lo = 0, hi;
+    size_t i, n = 0;
+
+    /* Check inputs. */
+    assert(catalog && query && nmatch);
+
+    hi = catalog->nentry;
+    if (query->flags & GLM_FILTER_TIME)
+    {
+        lo = lower_bound(catalog, query->time_min - catalog->max_span, 0);
+        hi = lower_bound(catalog, query->time_max, 1);
+    }
+
+    for (i = lo; i < hi; i++)
+    {
+        const GLM_CATALOG_ENTRY_T *e = &catalog->entry[i];
+
+        if ((query->flags & GLM_FILTER_TIME) && e->time_end < query->time_min)
+            continue;
+        if ((query->flags & GLM_FILTER_BOX) &&
+            (e->lat_min > e->lat_max || e->lat_max < query->lat_min ||
+             e->lat_min > query->lat_max || e->lon_max < query->lon_min ||
+             e->lon_min > query->lon_max))
+            continue;
+        if (match)
+            match[n] = i;
+        n++;
+    }
+    *nmatch = n;
+
+    return 0;
+}
+
+/**
+ * Close a catalog opened with glm_catalog_open(), and free it.
+ *
+ * @param catalog Pointer to the catalog.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+int
+glm_catalog_close(GLM_CATALOG_T *catalog)
+{
+    /* Check inputs. */
+    assert(catalog);
+
+    munmap(catalog->map, catalog->length);
+    glm_free(catalog);
+
+    return 0;
+}
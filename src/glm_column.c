@@ -0,0 +1,364 @@
+/**
+ * @file
+ * Code to read a range of values of GLM variables directly into the
+ * caller's arrays, or arrays of struct.
+ *
+ * For array output, the values are read from the file into the end
+ * of the output array itself, and then unpacked in place, so no
+ * temporary storage is needed. For array of struct output, the values
+ * are read into the scratch buffer of the file handle, which is
+ * reused from read to read, and then unpacked into the struct fields.
+ *
+ * If the handle has more than one thread (see glm_set_nthreads()),
+ * the columns of a read are read and unpacked at the same time, each
+ * with its own part of the scratch buffer. The netCDF reads are still
+ * made one at a time, under the netCDF lock, but each column is
+ * unpacked while the next is read.
+ *
+ * @author Ed Hartnett
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "glm_internal.h"
+
+/**
+ * Fill in a column description.
+ *
+ * @param col Pointer to the GLM_COLUMN_T to fill in.
+ * @param var Index of the variable in the var table (GLM_VAR_*).
+ * @param type Output type, one of GLM_COL_*.
+ * @param data Address of the first output value, or NULL to skip the
+ * variable.
+ * @param stride Bytes between output values.
+ *
+ * @author Ed Hartnett
+ */
+void
+glm_set_column(GLM_COLUMN_T *col, int var, int type, void *data,
+               size_t stride)
+{
+    assert(col);
+
+    col->var = var;
+    col->type = type;
+    col->data = data;
+    col->stride = stride;
+    col->time = NULL;
+    col->time_stride = 0;
+}
+
+/**
+ * Get the scale factor and offset of a variable, cached when the
+ * handle was initialized.
+ *
+ * @param glm Pointer to the GLM file handle.
+ * @param var Index of the variable in the var table (GLM_VAR_*).
+ * @param packing Pointer to the GLM_PACKING_T which gets them.
+ *
+ * @author Ed Hartnett
+ */
+void
+glm_get_packing(GLM_FILE_T *glm, int var, GLM_PACKING_T *packing)
+{
+    assert(glm && var >= 0 && var < GLM_NUM_VARS && packing);
+
+    packing->scale_factor = glm->var[var].scale;
+    packing->add_offset = glm->var[var].offset;
+}
+
+/**
+ * Also decode the values of a time offset column to nanoseconds
+ * since the Unix epoch. The column may have no other output.
+ *
+ * @param col Pointer to the GLM_COLUMN_T, filled in by
+ * glm_set_column().
+ * @param time Address of the first time, or NULL for none.
+ * @param stride Bytes between times.
+ *
+ * @author Ed Hartnett
+ */
+void
+glm_set_column_time(GLM_COLUMN_T *col, int64_t *time, size_t stride)
+{
+    assert(col);
+
+    col->time = time;
+    col->time_stride = stride;
+}
+
+/**
+ * Find the size of the values of a variable in the file.
+ *
+ * @param var Pointer to the variable.
+ * @param size Pointer that gets the size in bytes.
+ *
+ * @return 0 for success, GLM_ERR_UNEXPECTED for a type which is not
+ * read by columns.
+ * @author Ed Hartnett
+ */
+int
+glm_column_src_size(GLM_VAR_T *var, size_t *size)
+{
+    switch (var->xtype)
+    {
+    case NC_SHORT:
+        *size = sizeof(short);
+        break;
+    case NC_INT:
+    case NC_FLOAT:
+        *size = sizeof(int);
+        break;
+    default:
+        return GLM_ERR_UNEXPECTED;
+    }
+
+    return 0;
+}
+
+/**
+ * Read a range of values of one variable, as they are in the
+ * file. Only the read is done under the netCDF lock, so other threads
+ * may read while this one unpacks. If direct reads are on, the chunks
+ * are read with glm_direct_read() instead.
+ *
+ * @param glm Pointer to the GLM file handle.
+ * @param v Index of the variable in the var table.
+ * @param start Index of the first value to read.
+ * @param count Number of values to read.
+ * @param buf Buffer with room for count values.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+int
+glm_column_read_raw(GLM_FILE_T *glm, int v, size_t start, size_t count,
+                    void *buf)
+{
+    GLM_VAR_T *var;
+    int done;
+    int ret;
+
+    /* Check inputs. */
+    assert(glm && v >= 0 && v < GLM_NUM_VARS && buf);
+    var = &glm->var[v];
+    assert(var->varid >= 0);
+
+    /* Read the chunks directly, if direct reads are on. */
+    if ((ret = glm_direct_read(glm, v, start, count, buf, &done)))
+        return ret;
+    if (done)
+        return 0;
+
+    glm_nc_lock();
+    switch (var->xtype)
+    {
+    case NC_SHORT:
+        ret = nc_get_vara_short(glm->ncid, var->varid, &start, &count, buf);
+        break;
+    case NC_INT:
+        ret = nc_get_vara_int(glm->ncid, var->varid, &start, &count, buf);
+        break;
+    default:
+        ret = nc_get_vara_float(glm->ncid, var->varid, &start, &count, buf);
+    }
+    glm_nc_unlock();
+    if (ret)
+        NC_ERR(ret);
+
+    return 0;
+}
+
+/**
+ * Unpack values, as they are in the file, into a column.
+ *
+ * @param glm Pointer to the GLM file handle.
+ * @param col Pointer to the column description.
+ * @param buf The values, as read by glm_column_read_raw(). It may be
+ * at the end of the column's output array.
+ * @param count Number of values.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+int
+glm_column_unpack(GLM_FILE_T *glm, GLM_COLUMN_T *col, void *buf,
+                  size_t count)
+{
+    GLM_VAR_T *var;
+
+    /* Check inputs. */
+    assert(glm && col && col->var >= 0 && col->var < GLM_NUM_VARS);
+    var = &glm->var[col->var];
+
+    /* Times are decoded first, since the other output may be unpacked
+     * over buf. */
+    if (col->time)
+    {
+        if (var->xtype != NC_SHORT)
+            return GLM_ERR_UNEXPECTED;
+        glm_unpack_ushort_ns(buf, count, var->scale, var->offset,
+                             glm->time_base, col->time, col->time_stride);
+    }
+    if (!col->data)
+        return 0;
+
+    switch (col->type)
+    {
+    case GLM_COL_FLOAT:
+        if (var->xtype == NC_SHORT)
+            glm_unpack_ushort(buf, count, var->scale, var->offset, col->data,
+                              col->stride);
+        else if (buf != col->data)
+            glm_copy_4(buf, count, col->data, col->stride);
+        break;
+    case GLM_COL_INT:
+        if (var->xtype == NC_SHORT)
+            glm_widen_ushort(buf, count, col->data, col->stride);
+        else if (buf != col->data)
+            glm_copy_4(buf, count, col->data, col->stride);
+        break;
+    case GLM_COL_SHORT:
+        if (buf != col->data)
+            glm_copy_2(buf, count, col->data, col->stride);
+        break;
+    default:
+        return GLM_ERR_UNEXPECTED;
+    }
+
+    return 0;
+}
+
+/** Shared state of the tasks which read the columns of one read. */
+typedef struct GLM_COLUMNS
+{
+    GLM_FILE_T *glm;   /**< The GLM file handle. */
+    size_t start;      /**< Index of the first value to read. */
+    size_t count;      /**< Number of values to read. */
+    GLM_COLUMN_T *col; /**< The columns. */
+    char *scratch;     /**< Room for count ints for each column. */
+} GLM_COLUMNS_T;
+
+/**
+ * Read a range of values of one variable, and unpack them into a
+ * column.
+ *
+ * @param glm Pointer to the GLM file handle.
+ * @param start Index of the first value to read.
+ * @param count Number of values to read.
+ * @param col Pointer to the column description.
+ * @param scratch Buffer with room for count ints, used for array of
+ * struct output. If NULL, the scratch buffer of the handle is used.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+static int
+read_column(GLM_FILE_T *glm, size_t start, size_t count, GLM_COLUMN_T *col,
+            void *scratch)
+{
+    GLM_VAR_T *var;
+    size_t src_size, dst_size;
+    void *buf;
+    int ret;
+
+    /* Check inputs. */
+    assert(glm && col && col->var >= 0 && col->var < GLM_NUM_VARS);
+    var = &glm->var[col->var];
+    assert(var->varid >= 0);
+
+    /* Nothing to do. Skipped variables are not read or unpacked. */
+    if (!count || (!col->data && !col->time) || var->skip)
+        return 0;
+
+    /* Size of values in the file and in the output. */
+    if ((ret = glm_column_src_size(var, &src_size)))
+        return ret;
+    dst_size = col->type == GLM_COL_SHORT ? sizeof(short) : sizeof(int);
+    if (src_size > dst_size)
+        return GLM_ERR_UNEXPECTED;
+
+    /* Arrays are read into the end of the output array, and unpacked
+     * in place. A column with only times is read into the end of the
+     * times. Arrays of struct are read into the scratch buffer. */
+    if (col->data && col->stride == dst_size)
+        buf = (char *)col->data + count * (dst_size - src_size);
+    else if (!col->data && col->time_stride == sizeof(int64_t))
+        buf = (char *)col->time + count * (sizeof(int64_t) - src_size);
+    else if (scratch)
+        buf = scratch;
+    else if ((ret = glm_file_scratch(glm, count * src_size, &buf)))
+        return ret;
+
+    /* Read the data, and unpack it into the output. */
+    if ((ret = glm_column_read_raw(glm, col->var, start, count, buf)))
+        return ret;
+
+    return glm_column_unpack(glm, col, buf, count);
+}
+
+/**
+ * Read one column of a read. This is a task for glm_pool_run().
+ *
+ * @param arg Pointer to the GLM_COLUMNS_T.
+ * @param c Index of the column.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+static int
+read_column_task(void *arg, int c)
+{
+    GLM_COLUMNS_T *r = arg;
+
+    return read_column(r->glm, r->start, r->count, &r->col[c],
+                       r->scratch + c * r->count * sizeof(int));
+}
+
+/**
+ * Read a range of values of several variables, and unpack them into
+ * their columns. If the handle has more than one thread, the columns
+ * are read at the same time.
+ *
+ * @param glm Pointer to the GLM file handle.
+ * @param start Index of the first value to read.
+ * @param count Number of values to read.
+ * @param ncol Number of columns.
+ * @param col Array of ncol column descriptions.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+int
+glm_read_columns(GLM_FILE_T *glm, size_t start, size_t count, int ncol,
+                 GLM_COLUMN_T *col)
+{
+    GLM_COLUMNS_T r;
+    void *scratch;
+    int c;
+    int ret;
+
+    /* Check inputs. */
+    assert(glm && (col || !ncol));
+
+    /* One thread reads the columns one after the other. */
+    if (glm->nthreads <= 1 || ncol <= 1 || !count)
+    {
+        for (c = 0; c < ncol; c++)
+            if ((ret = read_column(glm, start, count, &col[c], NULL)))
+                return ret;
+        return 0;
+    }
+
+    /* Each column gets its own part of the scratch buffer. */
+    if ((ret = glm_file_scratch(glm, ncol * count * sizeof(int), &scratch)))
+        return ret;
+    r.glm = glm;
+    r.start = start;
+    r.count = count;
+    r.col = col;
+    r.scratch = scratch;
+
+    return glm_pool_run(glm->nthreads, ncol, read_column_task, &r);
+}
@@ -0,0 +1,645 @@
+/**
+ * @file
+ * Code to read the chunks of GLM variables directly with HDF5, and
+ * decompress them in parallel.
+ *
+ * GLM files are netCDF-4 files, which are HDF5 files. Each event,
+ * group, and flash variable is a 1-D chunked dataset, usually
+ * compressed. netCDF decompresses the chunks of a read one after the
+ * other, on one thread. With direct reads turned on, the compressed
+ * chunks which hold the values wanted are fetched with
+ * H5Dread_chunk(), under the netCDF lock, and are then decompressed
+ * on a pool of threads, outside the lock, straight into the buffer
+ * which is then unpacked as usual.
+ *
+ * Only the deflate and shuffle filters are handled. Variables with
+ * any other layout, filter, or type, and chunks which were never
+ * written, are read through netCDF as usual.
+ *
+ * Direct reads are only available if the library was configured with
+ * --enable-hdf5-direct. Otherwise glm_set_direct() has no effect.
+ *
+ * @author Ed Hartnett
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "glm_internal.h"
+#ifdef HAVE_HDF5_DIRECT
+#include <hdf5.h>
+#include <zlib.h>
+#endif
+
+/**
+ * Undo the shuffle filter: gather the bytes of each value, which the
+ * filter stores as size planes of n bytes.
+ *
+ * @param src The shuffled bytes.
+ * @param n Number of values.
+ * @param size Size of each value in bytes.
+ * @param dst Buffer that gets n values.
+ *
+ * @author Ed Hartnett
+ */
+static void
+unshuffle(const unsigned char *src, size_t n, size_t size, unsigned char *dst)
+{
+    size_t i, b;
+
+    for (b = 0; b < size; b++)
+        for (i = 0; i < n; i++)
+            dst[i * size + b] = src[b * n + i];
+}
+
+/**
+ * Decode one chunk, as it is stored in the file, into its values. The
+ * filters are undone in the reverse of the order they were applied
+ * when the chunk was written. A filter whose bit is set in mask was
+ * not applied to this chunk.
+ *
+ * @param src The chunk as stored in the file.
+ * @param src_len Length of the chunk in bytes.
+ * @param nfilter Number of filters in the pipeline.
+ * @param filter Array of nfilter filter IDs, GLM_H5_DEFLATE or
+ * GLM_H5_SHUFFLE, in the order they were applied.
+ * @param mask Filter mask of the chunk.
+ * @param size Size of each value in bytes.
+ * @param dst Buffer that gets the values.
+ * @param dst_len Length of the decoded chunk in bytes.
+ *
+ * @return 0 for success, GLM_ERR_UNEXPECTED if the chunk can't be
+ * decoded, or GLM_ERR_MEMORY.
+ * @author Ed Hartnett
+ */
+int
+glm_direct_decode(const void *src, size_t src_len, int nfilter,
+                  const int *filter, unsigned int mask, size_t size,
+                  void *dst, size_t dst_len)
+{
+    unsigned char *tmp;
+    const void *in = src;
+    size_t in_len = src_len;
+    int f;
+    int ret = 0;
+
+    /* Check inputs. */
+    assert(src && (filter || !nfilter) && size && dst);
+
+    if (!(tmp = glm_malloc(dst_len ? dst_len : 1)))
+        return GLM_ERR_MEMORY;
+
+    /* Undo each filter, from the last applied to the first. Each step
+     * decodes into whichever of dst and tmp does not hold its
+     * input. */
+    for (f = nfilter - 1; f >= 0 && !ret; f--)
+    {
+        unsigned char *out = in == dst ? tmp : dst;
+
+        if (mask & (1u << f))
+            continue;
+        switch (filter[f])
+        {
+        case GLM_H5_SHUFFLE:
+            if (in_len != dst_len || dst_len % size)
+                ret = GLM_ERR_UNEXPECTED;
+            else
+                unshuffle(in, dst_len / size, size, out);
+            break;
+        case GLM_H5_DEFLATE:
+#ifdef HAVE_HDF5_DIRECT
+        {
+            uLongf out_len = dst_len;
+
+            if (uncompress(out, &out_len, in, in_len) != Z_OK ||
+                out_len != dst_len)
+                ret = GLM_ERR_UNEXPECTED;
+            break;
+        }
+#endif
+        default:
+            ret = GLM_ERR_UNEXPECTED;
+        }
+        in = out;
+        in_len = dst_len;
+    }
+
+    /* The values must end up in dst, and be the right length. */
+    if (!ret && in_len != dst_len)
+        ret = GLM_ERR_UNEXPECTED;
+    if (!ret && in != dst)
+        memcpy(dst, in, dst_len);
+    glm_free(tmp);
+
+    return ret;
+}
+
+#ifdef HAVE_HDF5_DIRECT
+
+/* State of a variable in the direct read table. */
+#define DIRECT_UNKNOWN 0 /* Not looked at yet. */
+#define DIRECT_OK 1      /* Chunks can be read directly. */
+#define DIRECT_NO 2      /* Read through netCDF. */
+
+/* Most filters in a pipeline that direct reads handle. */
+#define MAX_FILTERS 2
+
+/** What direct reads know about one variable. */
+typedef struct GLM_DIRECT_VAR
+{
+    int state;              /**< One of the DIRECT_* states. */
+    hid_t dsid;             /**< HDF5 dataset ID, if DIRECT_OK. */
+    hsize_t chunk_len;      /**< Number of values in each chunk. */
+    int nfilter;            /**< Number of filters in the pipeline. */
+    int filter[MAX_FILTERS]; /**< The filters, in the order applied. */
+} GLM_DIRECT_VAR_T;
+
+/** Direct read state of a GLM file handle. */
+struct GLM_DIRECT
+{
+    hid_t fid;        /**< HDF5 file ID. */
+    int nthreads;     /**< Threads which decode chunks. */
+    GLM_DIRECT_VAR_T var[GLM_NUM_VARS]; /**< One entry for each var. */
+};
+
+/** One chunk of a direct read. */
+typedef struct GLM_CHUNK
+{
+    void *data;        /**< The chunk as stored in the file. */
+    size_t len;        /**< Length of the stored chunk in bytes. */
+    unsigned int mask; /**< Filter mask of the chunk. */
+    size_t first;      /**< Index of the first value of the chunk. */
+} GLM_CHUNK_T;
+
+/** Shared state of the tasks which decode the chunks of one read. */
+typedef struct GLM_DECODE
+{
+    GLM_DIRECT_VAR_T *dvar; /**< The variable being read. */
+    GLM_CHUNK_T *chunk;     /**< The chunks. */
+    size_t size;            /**< Size of each value in bytes. */
+    size_t start;           /**< Index of the first value wanted. */
+    size_t count;           /**< Number of values wanted. */
+    unsigned char *buf;     /**< Buffer that gets count values. */
+} GLM_DECODE_T;
+
+/**
+ * Find the HDF5 type of the values of a netCDF type.
+ *
+ * @param xtype The netCDF type.
+ *
+ * @return The native HDF5 type, or -1 for a type that is not read by
+ * columns.
+ * @author Ed Hartnett
+ */
+static hid_t
+native_type(nc_type xtype)
+{
+    switch (xtype)
+    {
+    case NC_SHORT:
+        return H5T_NATIVE_SHORT;
+    case NC_INT:
+        return H5T_NATIVE_INT;
+    case NC_FLOAT:
+        return H5T_NATIVE_FLOAT;
+    default:
+        return -1;
+    }
+}
+
+/**
+ * Look at the dataset of a variable, and decide whether its chunks
+ * can be read directly. It must be a 1-D chunked dataset, of the
+ * native type, with no filters other than deflate and shuffle. The
+ * netCDF lock must be held.
+ *
+ * @param glm Pointer to the GLM file handle.
+ * @param v Index of the variable in the var table.
+ *
+ * @author Ed Hartnett
+ */
+static void
+probe_var(GLM_FILE_T *glm, int v)
+{
+    GLM_DIRECT_VAR_T *dvar = &glm->direct->var[v];
+    char name[NC_MAX_NAME + 1];
+    hid_t dsid, plist = -1, type = -1, space = -1;
+    hid_t native = native_type(glm->var[v].xtype);
+    int ok = 0;
+
+    dvar->state = DIRECT_NO;
+    if (native < 0 || nc_inq_varname(glm->ncid, glm->var[v].varid, name))
+        return;
+
+    H5E_BEGIN_TRY {
+        if ((dsid = H5Dopen2(glm->direct->fid, name, H5P_DEFAULT)) >= 0)
+        {
+            plist = H5Dget_create_plist(dsid);
+            type = H5Dget_type(dsid);
+            space = H5Dget_space(dsid);
+        }
+    } H5E_END_TRY;
+    if (dsid < 0)
+        return;
+
+    if (plist >= 0 && type >= 0 && space >= 0 &&
+        H5Tequal(type, native) > 0 &&
+        H5Sget_simple_extent_ndims(space) == 1 &&
+        H5Pget_layout(plist) == H5D_CHUNKED &&
+        H5Pget_chunk(plist, 1, &dvar->chunk_len) == 1 && dvar->chunk_len)
+    {
+        int nfilter = H5Pget_nfilters(plist);
+        int f;
+
+        ok = nfilter >= 0 && nfilter <= MAX_FILTERS;
+        for (f = 0; f < nfilter && ok; f++)
+        {
+            unsigned int flags, cd_values[8];
+            size_t ncd = 8;
+
+            switch (H5Pget_filter2(plist, f, &flags, &ncd, cd_values, 0,
+                                   NULL, NULL))
+            {
+            case H5Z_FILTER_DEFLATE:
+                dvar->filter[f] = GLM_H5_DEFLATE;
+                break;
+            case H5Z_FILTER_SHUFFLE:
+                dvar->filter[f] = GLM_H5_SHUFFLE;
+                break;
+            default:
+                ok = 0;
+            }
+        }
+        dvar->nfilter = nfilter;
+    }
+
+    if (plist >= 0)
+        H5Pclose(plist);
+    if (type >= 0)
+        H5Tclose(type);
+    if (space >= 0)
+        H5Sclose(space);
+    if (ok)
+    {
+        dvar->dsid = dsid;
+        dvar->state = DIRECT_OK;
+    }
+    else
+        H5Dclose(dsid);
+}
+
+/**
+ * Free the chunks of a direct read.
+ *
+ * @param chunk Array of chunks.
+ * @param nchunk Number of chunks.
+ *
+ * @author Ed Hartnett
+ */
+static void
+free_chunks(GLM_CHUNK_T *chunk, size_t nchunk)
+{
+    size_t c;
+
+    for (c = 0; c < nchunk; c++)
+        if (chunk[c].data)
+            glm_free(chunk[c].data);
+    glm_free(chunk);
+}
+
+/**
+ * Fetch the stored chunks which hold a range of values. The netCDF
+ * lock must be held.
+ *
+ * @param dvar Pointer to the variable.
+ * @param first Index of the first chunk.
+ * @param nchunk Number of chunks.
+ * @param chunk Array of nchunk chunks, zeroed, that get the chunks.
+ *
+ * @return 0 for success, -1 if a chunk could not be read directly,
+ * or GLM_ERR_MEMORY.
+ * @author Ed Hartnett
+ */
+static int
+fetch_chunks(GLM_DIRECT_VAR_T *dvar, size_t first, size_t nchunk,
+             GLM_CHUNK_T *chunk)
+{
+    size_t c;
+    int ret = 0;
+
+    H5E_BEGIN_TRY {
+        for (c = 0; c < nchunk && !ret; c++)
+        {
+            hsize_t offset = (first + c) * dvar->chunk_len;
+            hsize_t nbytes;
+            uint32_t mask;
+
+            /* A chunk which was never written has no storage. */
+            chunk[c].first = offset;
+            if (H5Dget_chunk_storage_size(dvar->dsid, &offset, &nbytes) < 0 ||
+                !nbytes)
+                ret = -1;
+            else if (!(chunk[c].data = glm_malloc(nbytes)))
+                ret = GLM_ERR_MEMORY;
+            else if (H5Dread_chunk(dvar->dsid, H5P_DEFAULT, &offset, &mask,
+                                   chunk[c].data) < 0)
+                ret = -1;
+            else
+            {
+                chunk[c].len = nbytes;
+                chunk[c].mask = mask;
+            }
+        }
+    } H5E_END_TRY;
+
+    return ret;
+}
+
+/**
+ * Decode one chunk of a direct read, and copy the values wanted into
+ * the buffer. This is a task for glm_pool_run().
+ *
+ * @param arg Pointer to the GLM_DECODE_T.
+ * @param i Index of the chunk.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+static int
+decode_chunk(void *arg, int i)
+{
+    GLM_DECODE_T *d = arg;
+    GLM_CHUNK_T *chunk = &d->chunk[i];
+    size_t chunk_bytes = d->dvar->chunk_len * d->size;
+    size_t lo, hi;
+    void *values;
+    int ret;
+
+    /* The values of this chunk which were asked for. */
+    lo = chunk->first > d->start ? chunk->first : d->start;
+    hi = chunk->first + d->dvar->chunk_len;
+    if (hi > d->start + d->count)
+        hi = d->start + d->count;
+
+    /* An unfiltered chunk holds the values as they are. */
+    if (!d->dvar->nfilter)
+    {
+        if (chunk->len != chunk_bytes)
+            return GLM_ERR_UNEXPECTED;
+        memcpy(d->buf + (lo - d->start) * d->size,
+               (unsigned char *)chunk->data + (lo - chunk->first) * d->size,
+               (hi - lo) * d->size);
+        return 0;
+    }
+
+    if (!(values = glm_malloc(chunk_bytes)))
+        return GLM_ERR_MEMORY;
+    if (!(ret = glm_direct_decode(chunk->data, chunk->len, d->dvar->nfilter,
+                                  d->dvar->filter, chunk->mask, d->size,
+                                  values, chunk_bytes)))
+        memcpy(d->buf + (lo - d->start) * d->size,
+               (unsigned char *)values + (lo - chunk->first) * d->size,
+               (hi - lo) * d->size);
+    glm_free(values);
+
+    return ret;
+}
+
+/**
+ * Read a range of values of one variable, as they are in the file,
+ * by reading its chunks directly, if it can be done.
+ *
+ * @param glm Pointer to the GLM file handle.
+ * @param v Index of the variable in the var table.
+ * @param start Index of the first value to read.
+ * @param count Number of values to read.
+ * @param buf Buffer with room for count values.
+ * @param done Pointer that gets 1 if the values were read, or 0 if
+ * they must be read through netCDF.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+int
+glm_direct_read(GLM_FILE_T *glm, int v, size_t start, size_t count,
+                void *buf, int *done)
+{
+    GLM_DIRECT_VAR_T *dvar;
+    GLM_DECODE_T decode;
+    GLM_CHUNK_T *chunk;
+    size_t first, nchunk;
+    int ret;
+
+    /* Check inputs. */
+    assert(glm && v >= 0 && v < GLM_NUM_VARS && buf && done);
+
+    *done = 0;
+    if (!glm->direct || !count)
+        return 0;
+    dvar = &glm->direct->var[v];
+
+    /* Fetch the stored chunks, under the lock. */
+    glm_nc_lock();
+    if (dvar->state == DIRECT_UNKNOWN)
+        probe_var(glm, v);
+    if (dvar->state != DIRECT_OK)
+    {
+        glm_nc_unlock();
+        return 0;
+    }
+    first = start / dvar->chunk_len;
+    nchunk = (start + count - 1) / dvar->chunk_len - first + 1;
+    if (!(chunk = glm_calloc(nchunk, sizeof(GLM_CHUNK_T))))
+    {
+        glm_nc_unlock();
+        return GLM_ERR_MEMORY;
+    }
+    ret = fetch_chunks(dvar, first, nchunk, chunk);
+    glm_nc_unlock();
+
+    /* Chunks which can't be read directly are read through netCDF. */
+    if (ret < 0)
+    {
+        free_chunks(chunk, nchunk);
+        return 0;
+    }
+
+    /* Decode the chunks in parallel, outside the lock. */
+    if (!ret)
+    {
+        decode.dvar = dvar;
+        decode.chunk = chunk;
+        decode.start = start;
+        decode.count = count;
+        decode.buf = buf;
+        if (!(ret = glm_column_src_size(&glm->var[v], &decode.size)))
+            ret = glm_pool_run(glm->direct->nthreads, nchunk, decode_chunk,
+                               &decode);
+    }
+    free_chunks(chunk, nchunk);
+    if (!ret)
+        *done = 1;
+
+    return ret;
+}
+
+/**
+ * Turn off direct reads of a GLM file handle, and free their
+ * resources.
+ *
+ * @param glm Pointer to the GLM file handle.
+ *
+ * @author Ed Hartnett
+ */
+void
+glm_direct_free(GLM_FILE_T *glm)
+{
+    int v;
+
+    /* Check inputs. */
+    assert(glm);
+
+    if (!glm->direct)
+        return;
+    glm_nc_lock();
+    for (v = 0; v < GLM_NUM_VARS; v++)
+        if (glm->direct->var[v].state == DIRECT_OK)
+            H5Dclose(glm->direct->var[v].dsid);
+    H5Fclose(glm->direct->fid);
+    glm_nc_unlock();
+    glm_free(glm->direct);
+    glm->direct = NULL;
+}
+
+/**
+ * Open the file of a handle with HDF5, for direct reads. netCDF
+ * already has the file open, and HDF5 only lets a file be opened
+ * again with the same file close degree, so each degree netCDF may
+ * have used is tried. The netCDF lock must be held.
+ *
+ * @param path Name of the file.
+ *
+ * @return The HDF5 file ID, or a negative number if the file can't
+ * be opened.
+ * @author Ed Hartnett
+ */
+static hid_t
+open_h5(const char *path)
+{
+    H5F_close_degree_t degree[2] = {H5F_CLOSE_DEFAULT, H5F_CLOSE_SEMI};
+    hid_t fid = -1;
+    int d;
+
+    H5E_BEGIN_TRY {
+        for (d = 0; d < 2 && fid < 0; d++)
+        {
+            hid_t fapl;
+
+            if ((fapl = H5Pcreate(H5P_FILE_ACCESS)) < 0)
+                break;
+            if (H5Pset_fclose_degree(fapl, degree[d]) >= 0)
+                fid = H5Fopen(path, H5F_ACC_RDONLY, fapl);
+            H5Pclose(fapl);
+        }
+    } H5E_END_TRY;
+
+    return fid;
+}
+
+#else /* HAVE_HDF5_DIRECT */
+
+/* Without HDF5, values are always read through netCDF. */
+int
+glm_direct_read(GLM_FILE_T *glm, int v, size_t start, size_t count,
+                void *buf, int *done)
+{
+    (void)glm;
+    (void)v;
+    (void)start;
+    (void)count;
+    (void)buf;
+    *done = 0;
+    return 0;
+}
+
+void
+glm_direct_free(GLM_FILE_T *glm)
+{
+    (void)glm;
+}
+
+#endif /* HAVE_HDF5_DIRECT */
+
+/**
+ * Turn direct chunk reads on or off for a GLM file handle. When they
+ * are on, the readers fetch the compressed chunks of each variable
+ * with HDF5, and decompress them on nthreads threads, instead of
+ * having netCDF decompress them one at a time. The values read are
+ * the same either way. Direct reads are off until this is called.
+ *
+ * Direct reads need the library to be configured with
+ * --enable-hdf5-direct, and a file opened with glm_open(). Otherwise,
+ * and for any variable whose layout they don't handle, the values are
+ * read through netCDF; glm_inq_direct() tells whether they are on.
+ *
+ * @param glm Pointer to the GLM file handle.
+ * @param nthreads Number of threads which decompress chunks. If 0,
+ * the number of online processors is used. If less than 0, direct
+ * reads are turned off.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+int
+glm_set_direct(GLM_FILE_T *glm, int nthreads)
+{
+    /* Check inputs. */
+    assert(glm);
+
+    glm_direct_free(glm);
+#ifdef HAVE_HDF5_DIRECT
+    if (nthreads >= 0 && glm->path)
+    {
+        GLM_DIRECT_T *direct;
+
+        if (!(direct = glm_calloc(1, sizeof(GLM_DIRECT_T))))
+            return GLM_ERR_MEMORY;
+        glm_nc_lock();
+        direct->fid = open_h5(glm->path);
+        glm_nc_unlock();
+        if (direct->fid < 0)
+            glm_free(direct);
+        else
+        {
+            direct->nthreads = glm_pool_nthreads(nthreads);
+            glm->direct = direct;
+        }
+    }
+#else
+    (void)nthreads;
+#endif
+
+    return 0;
+}
+
+/**
+ * Learn whether direct chunk reads are on for a GLM file handle.
+ *
+ * @param glm Pointer to the GLM file handle.
+ * @param direct Pointer that gets 1 if direct reads are on, 0
+ * otherwise.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+int
+glm_inq_direct(GLM_FILE_T *glm, int *direct)
+{
+    /* Check inputs. */
+    assert(glm && direct);
+
+    *direct = glm->direct ? 1 : 0;
+
+    return 0;
+}
@@ -8,7 +8,10 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <assert.h>
-#include "ncglm.h"
+#include "glm_internal.h"
+
+/** Number of event variables read. */
+#define NUM_EVENT_COLS 6
 
 /**
  * @mainpage The Geostationary Lightning Mapper C Library
@@ -77,9 +80,13 @@
  *   valid_range and _FillValue attribute values are to be governed by
  *   the “_Unsigned” attribute.
  *
- * @param ncid ID of already opened GLM file.
- * @param nevent A pointer that gets the number of events
- * read. Ignored if NULL.
+ * @param glm Pointer to the GLM file handle.
+ * @param start Index of the first event to read.
+ * @param count Number of events to read.
+ * @param filter Pointer to the filter, or NULL to read all the
+ * events.
+ * @param nmatch Pointer that gets the number of events which pass the
+ * filter. Ignored if filter is NULL.
  * @param event Pointer to already-allocated arrat of GLM_EVENT_T, or
  * NULL if array reads are being done.
  * @param event_id Pointer to already-allocated array of int for
@@ -99,167 +106,65 @@
  * @author Ed Hartnett
 */
 static int
-read_event_vars(int ncid, size_t *nevent, GLM_EVENT_T *event, int *event_id,
-                float *time_offset, float *lat, float *lon, float *energy,
-                int *parent_group_id)
+read_event_vars(GLM_FILE_T *glm, size_t start, size_t count,
+                const GLM_FILTER_T *filter, size_t *nmatch,
+                GLM_EVENT_T *event, int *event_id, float *time_offset,
+                float *lat, float *lon, float *energy, int *parent_group_id)
 {
-    size_t my_nevent;
-
-    /* Event varids. */
-    int event_id_varid;
-    int event_time_offset_varid, event_lat_varid, event_lon_varid;
-    int event_energy_varid, event_parent_group_id_varid;
-
-    /* Storage for packed data. */
-    int *my_event_id = NULL;
-    short *event_lat = NULL;
-    unsigned short *event_lat2 = NULL;
-    short *event_time_offset = NULL, *event_lon = NULL;
-    short *event_energy = NULL;
-    int *event_parent_group_id = NULL;
-
-    /* Scale factors and offsets. */
-    float event_time_offset_scale, event_time_offset_offset;
-    float event_lat_scale, event_lat_offset;
-    float event_lon_scale, event_lon_offset;
-    float event_energy_scale, event_energy_offset;
-
-    int i;
+    GLM_COLUMN_T col[NUM_EVENT_COLS];
     int ret;
 
     /* Check inputs. */
-    assert(ncid && (event || event_id));
+    assert(glm && (glm->sections & GLM_SECTION_EVENT));
+    if (start > glm->nevent || count > glm->nevent - start)
+        return GLM_ERR_RANGE;
 
-    /* How many events to read? */
-    if ((ret = glm_read_dims(ncid, &my_nevent, NULL, NULL)))
-        return ret;
-
-    /* Return the number of events to user if desired. */
-    if (nevent)
-        *nevent = my_nevent;
-
-    /* Allocate storeage for event variables. */
-    if (!(my_event_id = malloc(my_nevent * sizeof(int))))
-	return GLM_ERR_MEMORY;
-    if (!(event_time_offset = malloc(my_nevent * sizeof(short))))
-	return GLM_ERR_TIMER;
-    if (!(event_lat = malloc(my_nevent * sizeof(short))))
-	return GLM_ERR_MEMORY;
-    if (!(event_lat2 = malloc(my_nevent * sizeof(unsigned short))))
-	return GLM_ERR_MEMORY;
-    if (!(event_lon = malloc(my_nevent * sizeof(short))))
-	return GLM_ERR_MEMORY;
-    if (!(event_energy = malloc(my_nevent * sizeof(short))))
-	return GLM_ERR_MEMORY;
-    if (!(event_parent_group_id = malloc(my_nevent * sizeof(int))))
-	return GLM_ERR_MEMORY;
-
-    /* Find the varids for the event variables. Also get the scale
-     * factors and offsets. */
-    if ((ret = nc_inq_varid(ncid, EVENT_ID, &event_id_varid)))
-	NC_ERR(ret);
-
-    if ((ret = nc_inq_varid(ncid, EVENT_TIME_OFFSET, &event_time_offset_varid)))
-	NC_ERR(ret);
-    if ((ret = nc_get_att_float(ncid, event_time_offset_varid, SCALE_FACTOR, &event_time_offset_scale)))
-	NC_ERR(ret);
-    if ((ret = nc_get_att_float(ncid, event_time_offset_varid, ADD_OFFSET, &event_time_offset_offset)))
-	NC_ERR(ret);
-
-    if ((ret = nc_inq_varid(ncid, EVENT_LAT, &event_lat_varid)))
-	NC_ERR(ret);
-    if ((ret = nc_get_att_float(ncid, event_lat_varid, SCALE_FACTOR, &event_lat_scale)))
-	NC_ERR(ret);
-    if ((ret = nc_get_att_float(ncid, event_lat_varid, ADD_OFFSET, &event_lat_offset)))
-	NC_ERR(ret);
-
-    if ((ret = nc_inq_varid(ncid, EVENT_LON, &event_lon_varid)))
-	NC_ERR(ret);
-    if ((ret = nc_get_att_float(ncid, event_lon_varid, SCALE_FACTOR, &event_lon_scale)))
-	NC_ERR(ret);
-    if ((ret = nc_get_att_float(ncid, event_lon_varid, ADD_OFFSET, &event_lon_offset)))
-	NC_ERR(ret);
-
-    if ((ret = nc_inq_varid(ncid, EVENT_ENERGY, &event_energy_varid)))
-	NC_ERR(ret);
-    if ((ret = nc_get_att_float(ncid, event_energy_varid, SCALE_FACTOR, &event_energy_scale)))
-	NC_ERR(ret);
-    if ((ret = nc_get_att_float(ncid, event_energy_varid, ADD_OFFSET, &event_energy_offset)))
-	NC_ERR(ret);
-
-    /* event_parent_group_id is not packed. */
-    if ((ret = nc_inq_varid(ncid, EVENT_PARENT_GROUP_ID, &event_parent_group_id_varid)))
-	NC_ERR(ret);
-
-    /* Read the event variables. */
-    if ((ret = nc_get_var_int(ncid, event_id_varid, my_event_id)))
-	NC_ERR(ret);
-    if ((ret = nc_get_var_short(ncid, event_time_offset_varid, event_time_offset)))
-	NC_ERR(ret);
-    if ((ret = nc_get_var_short(ncid, event_lat_varid, event_lat)))
-	NC_ERR(ret);
-    ret = nc_get_var_ushort(ncid, event_lat_varid, event_lat2);
-    if (ret && ret != NC_ERANGE)
-	NC_ERR(ret);
-    if ((ret = nc_get_var_short(ncid, event_lon_varid, event_lon)))
-	NC_ERR(ret);
-    if ((ret = nc_get_var_short(ncid, event_energy_varid, event_energy)))
-	NC_ERR(ret);
-    if ((ret = nc_get_var_int(ncid, event_parent_group_id_varid, event_parent_group_id)))
-	NC_ERR(ret);
-
-    /* Unpack the data into our already-allocated array of struct
-     * GLM_EVENT. */
-    for (i = 0; i < my_nevent; i++)
+    /* Describe where each variable goes. The varids, scale factors
+     * and offsets were cached when the file handle was initialized. */
+    if (event) /* fill structs */
     {
-        float my_time_offset;
-        float my_lat;
-        float my_lon;
-        float my_energy;
-
-        /* Unpack some values. */
-        my_time_offset = (float)((unsigned short)event_time_offset[i]) *
-            event_time_offset_scale + event_time_offset_offset;
-        my_lat = (float)((unsigned short)event_lat[i]) * event_lat_scale +
-            event_lat_offset;
-        my_lon = (float)((unsigned short)event_lon[i]) * event_lon_scale +
-            event_lon_offset;
-        my_energy = (float)((unsigned short)event_energy[i]) *
-            event_energy_scale + event_energy_offset;
-
-        if (event) /* fill structs */
-        {
-            event[i].id = my_event_id[i];
-            event[i].time_offset = my_time_offset;
-            event[i].lat = my_lat;
-            event[i].lon = my_lon;
-            event[i].energy = my_energy;
-            event[i].parent_group_id = event_parent_group_id[i];
-        }
-        else /* fill arrays */
-        {
-            event_id[i] = my_event_id[i];
-            time_offset[i] = my_time_offset;
-            lat[i] = my_lat;
-            lon[i] = my_lon;
-            energy[i] = my_energy;
-            parent_group_id[i] = event_parent_group_id[i];
-        }
+        glm_set_column(&col[0], GLM_VAR_EVENT_ID, GLM_COL_INT, &event->id,
+                       sizeof(GLM_EVENT_T));
+        glm_set_column(&col[1], GLM_VAR_EVENT_TIME_OFFSET, GLM_COL_FLOAT,
+                       &event->time_offset, sizeof(GLM_EVENT_T));
+        glm_set_column_time(&col[1], &event->time, sizeof(GLM_EVENT_T));
+        glm_set_column(&col[2], GLM_VAR_EVENT_LAT, GLM_COL_FLOAT, &event->lat,
+                       sizeof(GLM_EVENT_T));
+        glm_set_column(&col[3], GLM_VAR_EVENT_LON, GLM_COL_FLOAT, &event->lon,
+                       sizeof(GLM_EVENT_T));
+        glm_set_column(&col[4], GLM_VAR_EVENT_ENERGY, GLM_COL_FLOAT,
+                       &event->energy, sizeof(GLM_EVENT_T));
+        glm_set_column(&col[5], GLM_VAR_EVENT_PARENT_GROUP_ID, GLM_COL_INT,
+                       &event->parent_group_id, sizeof(GLM_EVENT_T));
     }
+    else /* fill arrays */
+    {
+        glm_set_column(&col[0], GLM_VAR_EVENT_ID, GLM_COL_INT, event_id,
+                       sizeof(int));
+        glm_set_column(&col[1], GLM_VAR_EVENT_TIME_OFFSET, GLM_COL_FLOAT,
+                       time_offset, sizeof(float));
+        glm_set_column(&col[2], GLM_VAR_EVENT_LAT, GLM_COL_FLOAT, lat,
+                       sizeof(float));
+        glm_set_column(&col[3], GLM_VAR_EVENT_LON, GLM_COL_FLOAT, lon,
+                       sizeof(float));
+        glm_set_column(&col[4], GLM_VAR_EVENT_ENERGY, GLM_COL_FLOAT, energy,
+                       sizeof(float));
+        glm_set_column(&col[5], GLM_VAR_EVENT_PARENT_GROUP_ID, GLM_COL_INT,
+                       parent_group_id, sizeof(int));
+    }
+
+    /* Read and unpack the event variables. */
+    if (filter)
+    {
+        GLM_PRED_T pred[GLM_MAX_PREDS];
+        int npred;
 
-    /* Free event storage. */
-    if (my_event_id)
-	free(my_event_id);
-    if (event_time_offset)
-	free(event_time_offset);
-    if (event_lat)
-	free(event_lat);
-    if (event_lon)
-	free(event_lon);
-    if (event_energy)
-	free(event_energy);
-    if (event_parent_group_id)
-	free(event_parent_group_id);
+        glm_filter_preds(filter, GLM_SECTION_EVENT, pred, &npred);
+        return glm_read_columns_filter(glm, start, count, npred, pred, NUM_EVENT_COLS,
+                                       col, nmatch);
+    }
+    if ((ret = glm_read_columns(glm, start, count, NUM_EVENT_COLS, col)))
+	return ret;
 
     return 0;
 }
@@ -279,19 +184,25 @@ read_event_vars(int ncid, size_t *nevent, GLM_EVENT_T *event, int *event_id,
 int
 glm_read_event_structs(int ncid, size_t *nevent, GLM_EVENT_T *event)
 {
+    GLM_FILE_T glm;
     int ret;
 
-    if ((ret = read_event_vars(ncid, nevent, event, NULL, NULL,
-                               NULL, NULL, NULL, NULL)))
-	return ret;
+    if ((ret = glm_file_init(ncid, GLM_SECTION_EVENT, &glm)))
+        return ret;
 
-    return 0;
+    ret = glm_get_event_structs(&glm, nevent, event);
+    glm_file_free(&glm);
+
+    return ret;
 }
 
 /**
  * Read and unpack all the event data in the file. It will be loaded
  * into the pre-allocated array of struct event.
  *
+ * Any of the arrays may be NULL, in which case that variable is not
+ * read.
+ *
  * @param ncid ID of already opened GLM file.
  * @param nevent Pointer that gets the number of events. Ignored if
  * NULL.
@@ -315,12 +226,326 @@ int
 glm_read_event_arrays(int ncid, size_t *nevent, int *event_id,
                       float *time_offset, float *lat, float *lon,
                       float *energy, int *parent_group_id)
+{
+    GLM_FILE_T glm;
+    int ret;
+
+    if ((ret = glm_file_init(ncid, GLM_SECTION_EVENT, &glm)))
+        return ret;
+
+    ret = glm_get_event_arrays(&glm, nevent, event_id, time_offset, lat,
+                               lon, energy, parent_group_id);
+    glm_file_free(&glm);
+
+    return ret;
+}
+
+/**
+ * Read and unpack all the event data in the file, using the metadata
+ * cached in the GLM file handle. It will be loaded into the
+ * pre-allocated array of struct event.
+ *
+ * @param glm Pointer to the GLM file handle, from glm_open().
+ * @param nevent Pointer that gets the number of events. Ignored if
+ * NULL.
+ * @param event Pointer to already-allocated array of GLM_EVENT_T.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+*/
+int
+glm_get_event_structs(GLM_FILE_T *glm, size_t *nevent, GLM_EVENT_T *event)
+{
+    int ret;
+
+    if ((ret = read_event_vars(glm, 0, glm->nevent, NULL, NULL, event, NULL,
+                               NULL, NULL, NULL, NULL, NULL)))
+	return ret;
+    if (nevent)
+        *nevent = glm->nevent;
+
+    return 0;
+}
+
+/**
+ * Read and unpack all the event data in the file into arrays, using
+ * the metadata cached in the GLM file handle.
+ *
+ * Any of the arrays may be NULL, in which case that variable is not
+ * read.
+ *
+ * @param glm Pointer to the GLM file handle, from glm_open().
+ * @param nevent Pointer that gets the number of events. Ignored if
+ * NULL.
+ * @param event_id Pointer to already-allocated array of int for
+ * event_id values.
+ * @param time_offset Pointer to already-allocated array of float for
+ * time_offset data.
+ * @param lat Pointer to already-allocated array of float for lat
+ * data.
+ * @param lon Pointer to already-allocated array of float for lon
+ * data.
+ * @param energy Pointer to already-allocated array of float for
+ * energy data.
+ * @param parent_group_id Pointer to already-allocated array of int
+ * for parent_group_id data.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+*/
+int
+glm_get_event_arrays(GLM_FILE_T *glm, size_t *nevent, int *event_id,
+                     float *time_offset, float *lat, float *lon,
+                     float *energy, int *parent_group_id)
 {
     int ret;
 
-    if ((ret = read_event_vars(ncid, nevent, NULL, event_id, time_offset,
-                               lat, lon, energy, parent_group_id)))
+    if ((ret = read_event_vars(glm, 0, glm->nevent, NULL, NULL, NULL,
+                               event_id, time_offset, lat, lon, energy,
+                               parent_group_id)))
 	return ret;
+    if (nevent)
+        *nevent = glm->nevent;
 
     return 0;
 }
+
+/**
+ * Read and unpack a range of the events in the file, using the
+ * metadata cached in the GLM file handle. It will be loaded into the
+ * pre-allocated array of struct event, which must have room for count
+ * events.
+ *
+ * @param glm Pointer to the GLM file handle, from glm_open().
+ * @param start Index of the first event to read.
+ * @param count Number of events to read.
+ * @param event Pointer to already-allocated array of GLM_EVENT_T.
+ *
+ * @return 0 for success, GLM_ERR_RANGE if the range is not inside the
+ * file, other error code otherwise.
+ * @author Ed Hartnett
+*/
+int
+glm_read_event_range(GLM_FILE_T *glm, size_t start, size_t count,
+                     GLM_EVENT_T *event)
+{
+    return read_event_vars(glm, start, count, NULL, NULL, event, NULL, NULL,
+                           NULL, NULL, NULL, NULL);
+}
+
+/**
+ * Read and unpack a range of the events in the file into arrays,
+ * using the metadata cached in the GLM file handle. Each array must
+ * have room for count values.
+ *
+ * Any of the arrays may be NULL, in which case that variable is not
+ * read.
+ *
+ * @param glm Pointer to the GLM file handle, from glm_open().
+ * @param start Index of the first event to read.
+ * @param count Number of events to read.
+ * @param event_id Pointer to already-allocated array of int for
+ * event_id values.
+ * @param time_offset Pointer to already-allocated array of float for
+ * time_offset data.
+ * @param lat Pointer to already-allocated array of float for lat
+ * data.
+ * @param lon Pointer to already-allocated array of float for lon
+ * data.
+ * @param energy Pointer to already-allocated array of float for
+ * energy data.
+ * @param parent_group_id Pointer to already-allocated array of int
+ * for parent_group_id data.
+ *
+ * @return 0 for success, GLM_ERR_RANGE if the range is not inside the
+ * file, other error code otherwise.
+ * @author Ed Hartnett
+*/
+int
+glm_read_event_range_arrays(GLM_FILE_T *glm, size_t start, size_t count,
+                            int *event_id, float *time_offset, float *lat,
+                            float *lon, float *energy, int *parent_group_id)
+{
+    return read_event_vars(glm, start, count, NULL, NULL, NULL, event_id,
+                           time_offset, lat, lon, energy, parent_group_id);
+}
+
+/**
+ * Read and unpack the events of a range which pass a filter into an
+ * array of struct, using the metadata cached in the GLM file
+ * handle. The filter is evaluated on the packed values, and only the
+ * events which pass it are unpacked. They are stored one after the
+ * other at the start of the array, in file order.
+ *
+ * @param glm Pointer to the GLM file handle, from glm_open().
+ * @param start Index of the first event to read.
+ * @param count Number of events to read.
+ * @param filter Pointer to the filter.
+ * @param nmatch Pointer that gets the number of events which pass
+ * the filter.
+ * @param event Pointer to already-allocated array of GLM_EVENT_T,
+ * with room for count events.
+ *
+ * @return 0 for success, GLM_ERR_RANGE if the range is not inside the
+ * file, other error code otherwise.
+ * @author Ed Hartnett
+*/
+int
+glm_read_event_filter(GLM_FILE_T *glm, size_t start, size_t count,
+                      const GLM_FILTER_T *filter, size_t *nmatch,
+                      GLM_EVENT_T *event)
+{
+    assert(filter && nmatch && event);
+    return read_event_vars(glm, start, count, filter, nmatch, event, NULL,
+                           NULL, NULL, NULL, NULL, NULL);
+}
+
+/**
+ * Read and unpack the events of a range which pass a filter into
+ * arrays. Each array must have room for count values. See
+ * glm_read_event_filter().
+ *
+ * Any of the arrays may be NULL, in which case that variable is not
+ * read.
+ *
+ * @param glm Pointer to the GLM file handle, from glm_open().
+ * @param start Index of the first event to read.
+ * @param count Number of events to read.
+ * @param filter Pointer to the filter.
+ * @param nmatch Pointer that gets the number of events which pass
+ * the filter.
+ * @param event_id Pointer to already-allocated array of int for
+ * event_id values.
+ * @param time_offset Pointer to already-allocated array of float for
+ * time_offset data.
+ * @param lat Pointer to already-allocated array of float for lat
+ * data.
+ * @param lon Pointer to already-allocated array of float for lon
+ * data.
+ * @param energy Pointer to already-allocated array of float for
+ * energy data.
+ * @param parent_group_id Pointer to already-allocated array of int
+ * for parent_group_id data.
+ *
+ * @return 0 for success, GLM_ERR_RANGE if the range is not inside the
+ * file, other error code otherwise.
+ * @author Ed Hartnett
+*/
+int
+glm_read_event_filter_arrays(GLM_FILE_T *glm, size_t start, size_t count,
+                             const GLM_FILTER_T *filter, size_t *nmatch,
+                             int *event_id, float *time_offset, float *lat,
+                             float *lon, float *energy, int *parent_group_id)
+{
+    assert(filter && nmatch);
+    return read_event_vars(glm, start, count, filter, nmatch, NULL, event_id,
+                           time_offset, lat, lon, energy, parent_group_id);
+}
+
+/**
+ * Read the times of a range of the events in the file, as nanoseconds
+ * since the Unix epoch, using the metadata cached in the GLM file
+ * handle. Each time is product_time plus the event_time_offset,
+ * decoded in double precision and rounded to the nanosecond, so it
+ * is more exact than the float time offset, and may be compared
+ * across files. As with the other readers, nothing is read if
+ * GLM_EV_TIME was left out with glm_set_fields().
+ *
+ * @param glm Pointer to the GLM file handle, from glm_open().
+ * @param start Index of the first event to read.
+ * @param count Number of events to read.
+ * @param time Pointer to already-allocated array of count int64.
+ *
+ * @return 0 for success, GLM_ERR_RANGE if the range is not inside the
+ * file, other error code otherwise.
+ * @author Ed Hartnett
+*/
+int
+glm_read_event_times(GLM_FILE_T *glm, size_t start, size_t count,
+                     int64_t *time)
+{
+    GLM_COLUMN_T col;
+
+    /* Check inputs. */
+    assert(glm && (glm->sections & GLM_SECTION_EVENT) && time);
+    if (start > glm->nevent || count > glm->nevent - start)
+        return GLM_ERR_RANGE;
+
+    glm_set_column(&col, GLM_VAR_EVENT_TIME_OFFSET, GLM_COL_FLOAT, NULL,
+                   sizeof(float));
+    glm_set_column_time(&col, time, sizeof(int64_t));
+
+    return glm_read_columns(glm, start, count, 1, &col);
+}
+
+/**
+ * Read a range of the events in the file into arrays, leaving the
+ * packed variables as the unsigned shorts they are in the file, with
+ * the scale factor and offset of each. This takes half the memory of
+ * glm_read_event_range_arrays() for those variables, and skips the
+ * unpacking. Use glm_unpack() to get the values which the other
+ * readers would return.
+ *
+ * Any of the arrays may be NULL, in which case that variable is not
+ * read.
+ *
+ * @param glm Pointer to the GLM file handle, from glm_open().
+ * @param start Index of the first event to read.
+ * @param count Number of events to read.
+ * @param event_id Pointer to already-allocated array of int for
+ * event_id values.
+ * @param time_offset Pointer to already-allocated array of unsigned
+ * short for packed time_offset data.
+ * @param lat Pointer to already-allocated array of unsigned short for
+ * packed lat data.
+ * @param lon Pointer to already-allocated array of unsigned short for
+ * packed lon data.
+ * @param energy Pointer to already-allocated array of unsigned short
+ * for packed energy data.
+ * @param parent_group_id Pointer to already-allocated array of int
+ * for parent_group_id data.
+ * @param packing Pointer to a GLM_EVENT_PACKING_T which gets the
+ * packing of each packed variable. Ignored if NULL.
+ *
+ * @return 0 for success, GLM_ERR_RANGE if the range is not inside the
+ * file, other error code otherwise.
+ * @author Ed Hartnett
+*/
+int
+glm_read_event_packed(GLM_FILE_T *glm, size_t start, size_t count,
+                      int *event_id, unsigned short *time_offset,
+                      unsigned short *lat, unsigned short *lon,
+                      unsigned short *energy, int *parent_group_id,
+                      GLM_EVENT_PACKING_T *packing)
+{
+    GLM_COLUMN_T col[NUM_EVENT_COLS];
+
+    /* Check inputs. */
+    assert(glm && (glm->sections & GLM_SECTION_EVENT));
+    if (start > glm->nevent || count > glm->nevent - start)
+        return GLM_ERR_RANGE;
+
+    if (packing)
+    {
+        glm_get_packing(glm, GLM_VAR_EVENT_TIME_OFFSET, &packing->time_offset);
+        glm_get_packing(glm, GLM_VAR_EVENT_LAT, &packing->lat);
+        glm_get_packing(glm, GLM_VAR_EVENT_LON, &packing->lon);
+        glm_get_packing(glm, GLM_VAR_EVENT_ENERGY, &packing->energy);
+    }
+
+    /* Packed variables are copied as shorts. */
+    glm_set_column(&col[0], GLM_VAR_EVENT_ID, GLM_COL_INT, event_id,
+                   sizeof(int));
+    glm_set_column(&col[1], GLM_VAR_EVENT_TIME_OFFSET, GLM_COL_SHORT,
+                   time_offset, sizeof(short));
+    glm_set_column(&col[2], GLM_VAR_EVENT_LAT, GLM_COL_SHORT, lat,
+                   sizeof(short));
+    glm_set_column(&col[3], GLM_VAR_EVENT_LON, GLM_COL_SHORT, lon,
+                   sizeof(short));
+    glm_set_column(&col[4], GLM_VAR_EVENT_ENERGY, GLM_COL_SHORT, energy,
+                   sizeof(short));
+    glm_set_column(&col[5], GLM_VAR_EVENT_PARENT_GROUP_ID, GLM_COL_INT,
+                   parent_group_id, sizeof(int));
+
+    return glm_read_columns(glm, start, count, NUM_EVENT_COLS, col);
+}
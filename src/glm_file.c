@@ -0,0 +1,510 @@
+/**
+ * @file
+ * Code to open a GLM file and cache its metadata, so that the
+ * readers do not have to look up dimensions, varids, and scale
+ * factors and offsets on every call.
+ *
+ * @author Ed Hartnett
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <netcdf_mem.h>
+#include "glm_internal.h"
+
+/** Description of one variable in the GLM file. */
+typedef struct GLM_VAR_DEF
+{
+    const char *name; /**< Name of the variable. */
+    int section;      /**< Section of the var table it belongs to. */
+    nc_type xtype;    /**< Type of the variable in the file. */
+    int packed;       /**< Non-zero if it has scale_factor/add_offset. */
+} GLM_VAR_DEF_T;
+
+/** Table of variables, in the order of the GLM_VAR_* indices. */
+static const GLM_VAR_DEF_T glm_var_def[GLM_NUM_VARS] = {
+    {EVENT_ID, GLM_SECTION_EVENT, NC_INT, 0},
+    {EVENT_TIME_OFFSET, GLM_SECTION_EVENT, NC_SHORT, 1},
+    {EVENT_LAT, GLM_SECTION_EVENT, NC_SHORT, 1},
+    {EVENT_LON, GLM_SECTION_EVENT, NC_SHORT, 1},
+    {EVENT_ENERGY, GLM_SECTION_EVENT, NC_SHORT, 1},
+    {EVENT_PARENT_GROUP_ID, GLM_SECTION_EVENT, NC_INT, 0},
+    {GROUP_ID, GLM_SECTION_GROUP, NC_INT, 0},
+    {GROUP_TIME_OFFSET, GLM_SECTION_GROUP, NC_SHORT, 1},
+    {GROUP_FRAME_TIME_OFFSET, GLM_SECTION_GROUP, NC_SHORT, 1},
+    {GROUP_LAT, GLM_SECTION_GROUP, NC_FLOAT, 0},
+    {GROUP_LON, GLM_SECTION_GROUP, NC_FLOAT, 0},
+    {GROUP_AREA, GLM_SECTION_GROUP, NC_SHORT, 1},
+    {GROUP_ENERGY, GLM_SECTION_GROUP, NC_SHORT, 1},
+    {GROUP_PARENT_FLASH_ID, GLM_SECTION_GROUP, NC_SHORT, 0},
+    {GROUP_QUALITY_FLAG, GLM_SECTION_GROUP, NC_SHORT, 0},
+    {FLASH_ID, GLM_SECTION_FLASH, NC_SHORT, 0},
+    {FLASH_TIME_OFFSET_OF_FIRST_EVENT, GLM_SECTION_FLASH, NC_SHORT, 1},
+    {FLASH_TIME_OFFSET_OF_LAST_EVENT, GLM_SECTION_FLASH, NC_SHORT, 1},
+    {FLASH_FRAME_TIME_OFFSET_OF_FIRST_EVENT, GLM_SECTION_FLASH, NC_SHORT, 1},
+    {FLASH_FRAME_TIME_OFFSET_OF_LAST_EVENT, GLM_SECTION_FLASH, NC_SHORT, 1},
+    {FLASH_LAT, GLM_SECTION_FLASH, NC_FLOAT, 0},
+    {FLASH_LON, GLM_SECTION_FLASH, NC_FLOAT, 0},
+    {FLASH_AREA, GLM_SECTION_FLASH, NC_SHORT, 1},
+    {FLASH_ENERGY, GLM_SECTION_FLASH, NC_SHORT, 1},
+    {FLASH_QUALITY_FLAG, GLM_SECTION_FLASH, NC_SHORT, 0},
+    {PRODUCT_TIME, GLM_SECTION_SCALAR, NC_DOUBLE, 0},
+    {PRODUCT_TIME_BOUNDS, GLM_SECTION_SCALAR, NC_DOUBLE, 0},
+    {LIGHTNING_WAVELENGTH, GLM_SECTION_SCALAR, NC_FLOAT, 0},
+    {LIGHTNING_WAVELENGTH_BOUNDS, GLM_SECTION_SCALAR, NC_FLOAT, 0},
+    {GROUP_TIME_THRESHOLD, GLM_SECTION_SCALAR, NC_FLOAT, 0},
+    {FLASH_TIME_THRESHOLD, GLM_SECTION_SCALAR, NC_FLOAT, 0},
+    {LAT_FIELD_OF_VIEW, GLM_SECTION_SCALAR, NC_FLOAT, 0},
+    {LAT_FIELD_OF_VIEW_BOUNDS, GLM_SECTION_SCALAR, NC_FLOAT, 0},
+    {GOES_LAT_LON_PROJECTION, GLM_SECTION_SCALAR, NC_INT, 0},
+    {EVENT_COUNT, GLM_SECTION_SCALAR, NC_INT, 0},
+    {GROUP_COUNT, GLM_SECTION_SCALAR, NC_INT, 0},
+    {FLASH_COUNT, GLM_SECTION_SCALAR, NC_INT, 0},
+    {PERCENT_NAVIGATED_L1B_EVENTS, GLM_SECTION_SCALAR, NC_FLOAT, 0},
+    {YAW_FLIP_FLAG, GLM_SECTION_SCALAR, NC_BYTE, 0},
+    {NOMINAL_SATELLITE_SUBPOINT_LAT, GLM_SECTION_SCALAR, NC_FLOAT, 0},
+    {NOMINAL_SATELLITE_HEIGHT, GLM_SECTION_SCALAR, NC_FLOAT, 0},
+    {NOMINAL_SATELLITE_SUBPOINT_LON, GLM_SECTION_SCALAR, NC_FLOAT, 0},
+    {LON_FIELD_OF_VIEW, GLM_SECTION_SCALAR, NC_FLOAT, 0},
+    {LON_FIELD_OF_VIEW_BOUNDS, GLM_SECTION_SCALAR, NC_FLOAT, 0},
+    {PERCENT_UNCORRECTABLE_L0_ERRORS, GLM_SECTION_SCALAR, NC_FLOAT, 0},
+    {ALGORITHM_DYNAMIC_INPUT_DATA_CONTAINER, GLM_SECTION_SCALAR, NC_INT, 0},
+    {PROCESSING_PARM_VERSION_CONTAINER, GLM_SECTION_SCALAR, NC_INT, 0},
+    {ALGORITHM_PRODUCT_VERSION_CONTAINER, GLM_SECTION_SCALAR, NC_INT, 0}
+};
+
+/**
+ * Read product_time, and convert it to nanoseconds since the Unix
+ * epoch. The whole and fractional seconds are converted apart, since
+ * a double holds the whole time only to within a few hundred ns.
+ *
+ * @param ncid ID of already opened GLM file.
+ * @param base Pointer that gets the time.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+static int
+read_time_base(int ncid, int64_t *base)
+{
+    double product_time;
+    int64_t sec;
+    int varid;
+    int ret;
+
+    if ((ret = nc_inq_varid(ncid, PRODUCT_TIME, &varid)))
+        NC_ERR(ret);
+    if ((ret = nc_get_var_double(ncid, varid, &product_time)))
+        NC_ERR(ret);
+    sec = (int64_t)product_time;
+    if (sec > product_time)
+        sec--;
+    *base = (sec + GLM_J2000_UNIX) * 1000000000 +
+        (int64_t)((product_time - sec) * 1e9 + 0.5);
+
+    return 0;
+}
+
+/**
+ * Initialize a GLM file handle for an already-open file. The
+ * dimension lengths are always read. The varids, and for packed
+ * variables the scale factors and offsets, are looked up for the
+ * requested sections of the variable table.
+ *
+ * @param ncid ID of already opened GLM file.
+ * @param sections Bitwise OR of the GLM_SECTION_* flags to resolve.
+ * @param glm Pointer to the GLM_FILE_T to initialize.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+int
+glm_file_init(int ncid, int sections, GLM_FILE_T *glm)
+{
+    int v;
+    int ret;
+
+    /* Check inputs. */
+    assert(glm);
+
+    glm->ncid = ncid;
+    glm->own_ncid = 0;
+    glm->sections = sections;
+    glm->scratch = NULL;
+    glm->scratch_size = 0;
+    glm->nthreads = 1;
+    glm->path = NULL;
+    glm->direct = NULL;
+    glm->time_base = 0;
+
+    /* Read the size of the dimensions. */
+    if ((ret = glm_read_dims(ncid, &glm->nevent, &glm->ngroup, &glm->nflash)))
+        return ret;
+
+    /* The time offsets of events, groups, and flashes are relative
+     * to product_time. */
+    if ((sections & (GLM_SECTION_EVENT | GLM_SECTION_GROUP |
+                     GLM_SECTION_FLASH)) &&
+        (ret = read_time_base(ncid, &glm->time_base)))
+        return ret;
+
+    /* Find the varids, scale factors and offsets. */
+    for (v = 0; v < GLM_NUM_VARS; v++)
+    {
+        GLM_VAR_T *var = &glm->var[v];
+
+        var->varid = -1;
+        var->xtype = glm_var_def[v].xtype;
+        var->scale = 1.0;
+        var->offset = 0.0;
+        var->skip = 0;
+        if (!(glm_var_def[v].section & sections))
+            continue;
+
+        if ((ret = nc_inq_varid(ncid, glm_var_def[v].name, &var->varid)))
+            NC_ERR(ret);
+        if (glm_var_def[v].packed)
+        {
+            if ((ret = nc_get_att_float(ncid, var->varid, SCALE_FACTOR, &var->scale)))
+                NC_ERR(ret);
+            if ((ret = nc_get_att_float(ncid, var->varid, ADD_OFFSET, &var->offset)))
+                NC_ERR(ret);
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Free the resources held by a GLM file handle, without closing the
+ * file or freeing the handle itself.
+ *
+ * @param glm Pointer to the GLM_FILE_T.
+ *
+ * @author Ed Hartnett
+ */
+void
+glm_file_free(GLM_FILE_T *glm)
+{
+    /* Check inputs. */
+    assert(glm);
+
+    if (glm->scratch)
+        glm_free(glm->scratch);
+    glm->scratch = NULL;
+    glm->scratch_size = 0;
+    glm_direct_free(glm);
+    if (glm->path)
+        glm_free(glm->path);
+    glm->path = NULL;
+}
+
+/**
+ * Get a scratch buffer of at least size bytes. The buffer belongs to
+ * the handle, and is reused by every read which needs one. It only
+ * grows when a larger read is done.
+ *
+ * @param glm Pointer to the GLM_FILE_T.
+ * @param size Size needed, in bytes.
+ * @param scratch Pointer that gets a pointer to the buffer.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+int
+glm_file_scratch(GLM_FILE_T *glm, size_t size, void **scratch)
+{
+    /* Check inputs. */
+    assert(glm && scratch);
+
+    if (size > glm->scratch_size)
+    {
+        void *buf;
+
+        /* The old contents are not needed, so it is not copied. */
+        if (!(buf = glm_aligned_alloc(size, GLM_ALIGN)))
+            return GLM_ERR_MEMORY;
+        glm_free(glm->scratch);
+        glm->scratch = buf;
+        glm->scratch_size = size;
+    }
+    *scratch = glm->scratch;
+
+    return 0;
+}
+
+/**
+ * Create a handle for a file which has just been opened, and cache
+ * its metadata. If this fails, the file is closed. The netCDF lock
+ * must be held.
+ *
+ * @param ncid ID of the newly opened GLM file.
+ * @param glmp Pointer that gets the handle.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+static int
+open_handle(int ncid, GLM_FILE_T **glmp)
+{
+    GLM_FILE_T *glm;
+    int ret;
+
+    if (!(glm = glm_malloc(sizeof(GLM_FILE_T))))
+    {
+        nc_close(ncid);
+        return GLM_ERR_MEMORY;
+    }
+
+    /* Cache the metadata. */
+    if ((ret = glm_file_init(ncid, GLM_SECTION_ALL, glm)))
+    {
+        nc_close(ncid);
+        glm_free(glm);
+        return ret;
+    }
+    glm->own_ncid = 1;
+
+    *glmp = glm;
+
+    return 0;
+}
+
+/**
+ * Open a GLM file and return a handle to it. All dimension lengths,
+ * varids, and packing attributes are read once here, and are then
+ * used by every reader function that takes the handle.
+ *
+ * @param file_name Name of the GLM file.
+ * @param glmp Pointer that gets the handle. Free it with glm_close().
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+int
+glm_open(const char *file_name, GLM_FILE_T **glmp)
+{
+    int ncid;
+    int ret, ret2 = 0;
+
+    /* Check inputs. */
+    assert(file_name && glmp);
+
+    /* Open the data file as read-only. */
+    glm_nc_lock();
+    if (!(ret = nc_open(file_name, NC_NOWRITE, &ncid)))
+        ret2 = open_handle(ncid, glmp);
+    glm_nc_unlock();
+    if (ret)
+        NC_ERR(ret);
+    if (ret2)
+        return ret2;
+
+    /* Keep the name, for glm_set_direct(). */
+    if (!((*glmp)->path = glm_strdup(file_name)))
+    {
+        glm_close(*glmp);
+        return GLM_ERR_MEMORY;
+    }
+
+    return 0;
+}
+
+/**
+ * Open a GLM file which is already in memory, and return a handle to
+ * it. This works just like glm_open(), and every reader, including
+ * those which take the ncid from glm_inq_ncid(), may be used on the
+ * handle.
+ *
+ * The buffer is not copied. It must not be changed or freed until
+ * glm_close() is called.
+ *
+ * @param buf Pointer to the contents of the GLM file.
+ * @param len Length of the buffer in bytes.
+ * @param glmp Pointer that gets the handle. Free it with glm_close().
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+int
+glm_open_mem(const void *buf, size_t len, GLM_FILE_T **glmp)
+{
+    int ncid;
+    int ret, ret2 = 0;
+
+    /* Check inputs. */
+    assert(buf && glmp);
+
+    /* Open the memory as read-only. netCDF does not write to the
+     * buffer in NC_NOWRITE mode. */
+    glm_nc_lock();
+    if (!(ret = nc_open_mem(GLM_MEM_NAME, NC_NOWRITE, len, (void *)buf, &ncid)))
+        ret2 = open_handle(ncid, glmp);
+    glm_nc_unlock();
+    if (ret)
+        NC_ERR(ret);
+
+    return ret2;
+}
+
+/**
+ * Close a GLM file opened with glm_open(), and free the handle.
+ *
+ * @param glm Pointer to the GLM file handle.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+int
+glm_close(GLM_FILE_T *glm)
+{
+    int ret;
+
+    /* Check inputs. */
+    assert(glm);
+
+    glm_file_free(glm);
+    if (glm->own_ncid)
+    {
+        glm_nc_lock();
+        ret = nc_close(glm->ncid);
+        glm_nc_unlock();
+        if (ret)
+        {
+            glm_free(glm);
+            NC_ERR(ret);
+        }
+    }
+    glm_free(glm);
+
+    return 0;
+}
+
+/**
+ * Set the skip flags of one section of the var table from a field
+ * mask.
+ *
+ * @param glm Pointer to the GLM file handle.
+ * @param first Index of first variable of the section.
+ * @param last One past the index of the last variable.
+ * @param fields Bitmask of fields to read. Bit i is variable first + i.
+ *
+ * @author Ed Hartnett
+ */
+static void
+set_skip(GLM_FILE_T *glm, int first, int last, int fields)
+{
+    int v;
+
+    for (v = first; v < last; v++)
+        glm->var[v].skip = !(fields & (1 << (v - first)));
+}
+
+/**
+ * Choose which fields are read by the readers of an open file. Fields
+ * which are not chosen are neither read from the file nor unpacked:
+ * struct readers leave them as they were, and array readers do not
+ * touch the array, which may be NULL. Array readers also skip any
+ * field whose array is NULL, whatever the mask. All fields are read
+ * until this is called.
+ *
+ * @param glm Pointer to the GLM file handle.
+ * @param event_fields Bitwise OR of the GLM_EV_* flags, or
+ * GLM_EV_ALL.
+ * @param group_fields Bitwise OR of the GLM_GR_* flags, or
+ * GLM_GR_ALL.
+ * @param flash_fields Bitwise OR of the GLM_FL_* flags, or
+ * GLM_FL_ALL.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+int
+glm_set_fields(GLM_FILE_T *glm, int event_fields, int group_fields,
+               int flash_fields)
+{
+    /* Check inputs. */
+    assert(glm);
+
+    set_skip(glm, GLM_VAR_EVENT_ID, GLM_VAR_GROUP_ID, event_fields);
+    set_skip(glm, GLM_VAR_GROUP_ID, GLM_VAR_FLASH_ID, group_fields);
+    set_skip(glm, GLM_VAR_FLASH_ID, GLM_VAR_PRODUCT_TIME, flash_fields);
+
+    return 0;
+}
+
+/**
+ * Choose the number of threads which read the variables of each read
+ * of an open file. With more than one thread, the variables of a read
+ * are read and unpacked at the same time: reads through netCDF are
+ * still made one at a time, but each variable is unpacked while
+ * others are read. This cuts the time taken to read one large file.
+ * The values read are the same either way. Reads use one thread until
+ * this is called.
+ *
+ * @param glm Pointer to the GLM file handle.
+ * @param nthreads Number of threads. If less than 1, the number of
+ * online processors is used.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+int
+glm_set_nthreads(GLM_FILE_T *glm, int nthreads)
+{
+    /* Check inputs. */
+    assert(glm);
+
+    glm->nthreads = glm_pool_nthreads(nthreads);
+
+    return 0;
+}
+
+/**
+ * Find the netCDF ID of the file underlying a GLM file handle.
+ *
+ * @param glm Pointer to the GLM file handle.
+ * @param ncid Pointer that gets the ncid.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+int
+glm_inq_ncid(GLM_FILE_T *glm, int *ncid)
+{
+    /* Check inputs. */
+    assert(glm && ncid);
+
+    *ncid = glm->ncid;
+
+    return 0;
+}
+
+/**
+ * Learn the lengths of the dimensions, from the cached metadata.
+ *
+ * @param glm Pointer to the GLM file handle.
+ * @param nevent Pointer that gets the number of events. Ignored if NULL.
+ * @param ngroup Pointer that gets the number of groups. Ignored if NULL.
+ * @param nflash Pointer that gets the number of flashes. Ignored if NULL.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+int
+glm_inq_dims(GLM_FILE_T *glm, size_t *nevent, size_t *ngroup, size_t *nflash)
+{
+    /* Check inputs. */
+    assert(glm);
+
+    if (nevent)
+        *nevent = glm->nevent;
+    if (ngroup)
+        *ngroup = glm->ngroup;
+    if (nflash)
+        *nflash = glm->nflash;
+
+    return 0;
+}
@@ -0,0 +1,404 @@
+/**
+ * @file
+ * Code to read only the events, groups, or flashes which pass a
+ * filter.
+ *
+ * Each part of the filter becomes a predicate on one variable. The
+ * predicates are evaluated on the values as they are in the file:
+ * for packed variables, the range of unpacked values is turned into
+ * a range of packed values, which is matched with SIMD kernels. Only
+ * the rows which pass every predicate are then unpacked into the
+ * output, one after the other. A variable which has a predicate is
+ * read once: the values read to match it are kept, and its output
+ * column is unpacked from them.
+ *
+ * @author Ed Hartnett
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <math.h>
+#include <assert.h>
+#include "glm_internal.h"
+
+/**
+ * Fill in a predicate.
+ *
+ * @param pred Pointer to the predicate.
+ * @param var Index of the variable in the var table.
+ * @param type Type the value is compared as, GLM_COL_FLOAT or
+ * GLM_COL_SHORT.
+ * @param min Smallest value which passes.
+ * @param max Largest value which passes.
+ *
+ * @author Ed Hartnett
+ */
+static void
+set_pred(GLM_PRED_T *pred, int var, int type, float min, float max)
+{
+    pred->var = var;
+    pred->type = type;
+    pred->min = min;
+    pred->max = max;
+}
+
+/**
+ * Turn a filter into predicates on the variables of a section.
+ *
+ * @param filter Pointer to the filter.
+ * @param section GLM_SECTION_EVENT, GLM_SECTION_GROUP, or
+ * GLM_SECTION_FLASH.
+ * @param pred Array with room for GLM_MAX_PREDS predicates.
+ * @param npred Pointer that gets the number of predicates.
+ *
+ * @author Ed Hartnett
+ */
+void
+glm_filter_preds(const GLM_FILTER_T *filter, int section, GLM_PRED_T *pred,
+                 int *npred)
+{
+    int lat, lon, time, energy, quality;
+    int n = 0;
+
+    /* Check inputs. */
+    assert(filter && pred && npred);
+
+    switch (section)
+    {
+    case GLM_SECTION_EVENT:
+        lat = GLM_VAR_EVENT_LAT;
+        lon = GLM_VAR_EVENT_LON;
+        time = GLM_VAR_EVENT_TIME_OFFSET;
+        energy = GLM_VAR_EVENT_ENERGY;
+        quality = -1;
+        break;
+    case GLM_SECTION_GROUP:
+        lat = GLM_VAR_GROUP_LAT;
+        lon = GLM_VAR_GROUP_LON;
+        time = GLM_VAR_GROUP_TIME_OFFSET;
+        energy = GLM_VAR_GROUP_ENERGY;
+        quality = GLM_VAR_GROUP_QUALITY_FLAG;
+        break;
+    default:
+        lat = GLM_VAR_FLASH_LAT;
+        lon = GLM_VAR_FLASH_LON;
+        time = GLM_VAR_FLASH_TIME_OFFSET_OF_FIRST_EVENT;
+        energy = GLM_VAR_FLASH_ENERGY;
+        quality = GLM_VAR_FLASH_QUALITY_FLAG;
+    }
+
+    if (filter->flags & GLM_FILTER_BOX)
+    {
+        set_pred(&pred[n++], lat, GLM_COL_FLOAT, filter->lat_min,
+                 filter->lat_max);
+        set_pred(&pred[n++], lon, GLM_COL_FLOAT, filter->lon_min,
+                 filter->lon_max);
+    }
+    if (filter->flags & GLM_FILTER_TIME)
+        set_pred(&pred[n++], time, GLM_COL_FLOAT, filter->time_min,
+                 filter->time_max);
+    if (filter->flags & GLM_FILTER_ENERGY)
+        set_pred(&pred[n++], energy, GLM_COL_FLOAT, filter->energy_min,
+                 INFINITY);
+    if ((filter->flags & GLM_FILTER_QUALITY) && quality >= 0)
+        set_pred(&pred[n++], quality, GLM_COL_SHORT, filter->quality_flag,
+                 filter->quality_flag);
+    assert(n <= GLM_MAX_PREDS);
+
+    *npred = n;
+}
+
+/**
+ * Find the range of signed short values between min and max, as a
+ * range for glm_match_ushort().
+ *
+ * @param min Smallest value.
+ * @param max Largest value.
+ * @param lo Pointer that gets the smallest value in the range.
+ * @param span Pointer that gets the largest value minus lo.
+ *
+ * @return Non-zero if there are short values in the range, 0 if
+ * there are none.
+ * @author Ed Hartnett
+ */
+static int
+short_range(float min, float max, unsigned short *lo, unsigned short *span)
+{
+    float first = ceilf(min > SHRT_MIN ? min : SHRT_MIN);
+    float last = floorf(max < SHRT_MAX ? max : SHRT_MAX);
+
+    if (!(first <= last))
+        return 0;
+    *lo = (unsigned short)(short)first;
+    *span = (unsigned short)(last - first);
+
+    return 1;
+}
+
+/**
+ * Read one variable, and clear the match flag of each row which does
+ * not pass a predicate.
+ *
+ * @param glm Pointer to the GLM file handle.
+ * @param start Index of the first row.
+ * @param count Number of rows.
+ * @param pred Pointer to the predicate.
+ * @param match Array of count match flags.
+ * @param buf Buffer with room for count ints, which gets the values
+ * as they are in the file.
+ * @param read Pointer that gets 1 if the values were read into buf,
+ * or 0 if no value can pass, so nothing was read.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+static int
+match_pred(GLM_FILE_T *glm, size_t start, size_t count,
+           const GLM_PRED_T *pred, unsigned char *match, void *buf, int *read)
+{
+    GLM_VAR_T *var = &glm->var[pred->var];
+    unsigned short lo, span;
+    int nonempty;
+    int ret;
+
+    *read = 0;
+
+    /* Find the range of values in the file which pass. */
+    if (var->xtype == NC_SHORT && pred->type == GLM_COL_FLOAT)
+        nonempty = glm_ushort_range(var->scale, var->offset, pred->min,
+                                    pred->max, &lo, &span);
+    else if (var->xtype == NC_SHORT && pred->type == GLM_COL_SHORT)
+        nonempty = short_range(pred->min, pred->max, &lo, &span);
+    else if (var->xtype == NC_FLOAT && pred->type == GLM_COL_FLOAT)
+        nonempty = pred->min <= pred->max;
+    else
+        return GLM_ERR_UNEXPECTED;
+
+    /* If no value can pass, there is no need to read anything. */
+    if (!nonempty)
+    {
+        memset(match, 0, count);
+        return 0;
+    }
+
+    if ((ret = glm_column_read_raw(glm, pred->var, start, count, buf)))
+        return ret;
+    *read = 1;
+    if (var->xtype == NC_SHORT)
+        glm_match_ushort(buf, count, lo, span, match);
+    else
+        glm_match_float(buf, count, pred->min, pred->max, match);
+
+    return 0;
+}
+
+/**
+ * Move the values of the chosen rows to the start of a buffer, in
+ * order.
+ *
+ * @param buf The values.
+ * @param size Size of each value, 2 or 4 bytes.
+ * @param idx Increasing indices of the chosen rows.
+ * @param n Number of chosen rows.
+ *
+ * @author Ed Hartnett
+ */
+static void
+compact(void *buf, size_t size, const size_t *idx, size_t n)
+{
+    size_t k;
+
+    if (size == sizeof(short))
+    {
+        unsigned short *b = buf;
+
+        for (k = 0; k < n; k++)
+            b[k] = b[idx[k]];
+    }
+    else
+    {
+        unsigned int *b = buf;
+
+        for (k = 0; k < n; k++)
+            b[k] = b[idx[k]];
+    }
+}
+
+/** Shared state of the tasks which read the columns of a filtered
+ * read. */
+typedef struct GLM_FILTER_COLS
+{
+    GLM_FILE_T *glm;    /**< The GLM file handle. */
+    size_t start;       /**< Index of the first row. */
+    size_t count;       /**< Number of rows. */
+    GLM_COLUMN_T *col;  /**< The columns. */
+    const size_t *idx;  /**< Indices of the rows which pass. */
+    size_t n;           /**< Number of rows which pass. */
+    char *scratch;      /**< Room for count ints for each column. */
+    void **raw;         /**< Values read for each column, or NULL. */
+} GLM_FILTER_COLS_T;
+
+/**
+ * Read one variable, and unpack only the rows which pass into its
+ * column.
+ *
+ * @param glm Pointer to the GLM file handle.
+ * @param start Index of the first row.
+ * @param count Number of rows.
+ * @param col Pointer to the column description.
+ * @param idx Increasing indices of the rows which pass.
+ * @param n Number of rows which pass.
+ * @param buf Buffer with room for count values, or NULL to use the
+ * scratch buffer of the handle.
+ * @param raw The values of the variable, as read for a predicate, or
+ * NULL if they must be read. They are overwritten.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+static int
+filter_column(GLM_FILE_T *glm, size_t start, size_t count, GLM_COLUMN_T *col,
+              const size_t *idx, size_t n, void *buf, void *raw)
+{
+    GLM_VAR_T *var = &glm->var[col->var];
+    size_t src_size;
+    int ret;
+
+    if ((!col->data && !col->time) || var->skip)
+        return 0;
+    if ((ret = glm_column_src_size(var, &src_size)))
+        return ret;
+    if (raw)
+        buf = raw;
+    else if ((!buf && (ret = glm_file_scratch(glm, count * src_size, &buf))) ||
+             (ret = glm_column_read_raw(glm, col->var, start, count, buf)))
+        return ret;
+    compact(buf, src_size, idx, n);
+
+    return glm_column_unpack(glm, col, buf, n);
+}
+
+/**
+ * Read one column of a filtered read. This is a task for
+ * glm_pool_run().
+ *
+ * @param arg Pointer to the GLM_FILTER_COLS_T.
+ * @param c Index of the column.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+static int
+filter_column_task(void *arg, int c)
+{
+    GLM_FILTER_COLS_T *f = arg;
+
+    return filter_column(f->glm, f->start, f->count, &f->col[c], f->idx, f->n,
+                         f->scratch + c * f->count * sizeof(int), f->raw[c]);
+}
+
+/**
+ * Read a range of rows of several variables, and unpack only the rows
+ * which pass every predicate into their columns. The rows which pass
+ * are stored one after the other at the start of each column.
+ *
+ * @param glm Pointer to the GLM file handle.
+ * @param start Index of the first row.
+ * @param count Number of rows.
+ * @param npred Number of predicates.
+ * @param pred Array of npred predicates.
+ * @param ncol Number of columns.
+ * @param col Array of ncol column descriptions. Each must have room
+ * for count values.
+ * @param nmatch Pointer that gets the number of rows which pass.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+int
+glm_read_columns_filter(GLM_FILE_T *glm, size_t start, size_t count,
+                        int npred, const GLM_PRED_T *pred, int ncol,
+                        GLM_COLUMN_T *col, size_t *nmatch)
+{
+    unsigned char *match = NULL;
+    size_t *idx = NULL;
+    char *pred_buf = NULL;
+    void **raw = NULL;
+    size_t i, n = 0;
+    int p, c;
+    int ret = 0;
+
+    /* Check inputs. */
+    assert(glm && (pred || !npred) && (col || !ncol) && nmatch);
+
+    *nmatch = 0;
+    if (!count)
+        return 0;
+    if (!(match = glm_malloc(count)) ||
+        !(idx = glm_malloc(count * sizeof(size_t))) ||
+        !(raw = glm_calloc(ncol ? ncol : 1, sizeof(void *))) ||
+        (npred && !(pred_buf = glm_malloc(npred * count * sizeof(int)))))
+        ret = GLM_ERR_MEMORY;
+
+    /* Find the rows which pass. Each predicate reads its variable
+     * into its own part of pred_buf, which the column of that
+     * variable then uses. */
+    if (!ret)
+        memset(match, 1, count);
+    for (p = 0; p < npred && !ret; p++)
+    {
+        void *buf = pred_buf + p * count * sizeof(int);
+        int read;
+
+        if (!(ret = match_pred(glm, start, count, &pred[p], match, buf,
+                               &read)) && read)
+            for (c = 0; c < ncol; c++)
+                if (col[c].var == pred[p].var)
+                {
+                    raw[c] = buf;
+                    break;
+                }
+    }
+    for (i = 0; i < count && !ret; i++)
+        if (match[i])
+            idx[n++] = i;
+    glm_free(match);
+
+    /* Read each column, and unpack only the rows which pass. If the
+     * handle has more than one thread, the columns are read at the
+     * same time, each into its own part of the scratch buffer. */
+    if (glm->nthreads <= 1 || ncol <= 1)
+    {
+        for (c = 0; c < ncol && n && !ret; c++)
+            ret = filter_column(glm, start, count, &col[c], idx, n, NULL,
+                                raw[c]);
+    }
+    else if (n && !ret)
+    {
+        GLM_FILTER_COLS_T f;
+        void *scratch;
+
+        if (!(ret = glm_file_scratch(glm, ncol * count * sizeof(int), &scratch)))
+        {
+            f.glm = glm;
+            f.start = start;
+            f.count = count;
+            f.col = col;
+            f.idx = idx;
+            f.n = n;
+            f.scratch = scratch;
+            f.raw = raw;
+            ret = glm_pool_run(glm->nthreads, ncol, filter_column_task, &f);
+        }
+    }
+    glm_free(idx);
+    glm_free(raw);
+    glm_free(pred_buf);
+
+    if (!ret)
+        *nmatch = n;
+
+    return ret;
+}
@@ -8,15 +8,22 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <assert.h>
-#include "ncglm.h"
+#include "glm_internal.h"
+
+/** Most flash variables read at once. */
+#define MAX_FLASH_COLS 10
 
 /**
  * Read and unpack all the flash data in the file. It will be loaded
  * into the pre-allocated array of struct flash.
  *
- * @param ncid ID of already opened GLM file.
- * @param nflash A pointer that gets the number of flashes. Ignored if
- * NULL.
+ * @param glm Pointer to the GLM file handle.
+ * @param start Index of the first flash to read.
+ * @param count Number of flashes to read.
+ * @param filter Pointer to the filter, or NULL to read all the
+ * flashes.
+ * @param nmatch Pointer that gets the number of flashes which pass the
+ * filter. Ignored if filter is NULL.
  * @param flash Pointer to already-allocated array of GLM_FLASH_T, or
  * NULL if arrays are to be read.
  * @param time_offset_of_first_event Pointer to already-allocated
@@ -47,220 +54,95 @@
  * @author Ed Hartnett
  */
 static int
-read_flash_vars(int ncid, size_t *nflash, GLM_FLASH_T *flash,
-                float *time_offset_of_first_event,
+read_flash_vars(GLM_FILE_T *glm, size_t start, size_t count,
+                const GLM_FILTER_T *filter, size_t *nmatch,
+                GLM_FLASH_T *flash, float *time_offset_of_first_event,
                 float *time_offset_of_last_event,
                 float *frame_time_offset_of_first_event,
                 float *frame_time_offset_of_last_event,
                 float *lat, float *lon, float *area, float *energy,
                 short *quality_flag)
 {
-    /* Flashes. Note that event_id and group_id are int, but flash_id
-     * is short. */
-    int flash_id_varid;
-    int flash_time_offset_of_first_event_varid;
-    int flash_time_offset_of_last_event_varid;
-    int flash_frame_time_offset_of_first_event_varid;
-    int flash_frame_time_offset_of_last_event_varid;
-    int flash_lat_varid, flash_lon_varid;
-    int flash_area_varid, flash_energy_varid;
-    int flash_quality_flag_varid;
-    short *flash_id = NULL;
-    short *flash_time_offset_of_first_event = NULL;
-    short *flash_time_offset_of_last_event = NULL;
-    short *flash_frame_time_offset_of_first_event = NULL;
-    short *flash_frame_time_offset_of_last_event = NULL;
-    float *flash_lat = NULL, *flash_lon = NULL;
-    short *flash_area = NULL, *flash_energy = NULL;
-    short *flash_quality_flag = NULL;
-    size_t my_nflash;
-
-    /* Scale factors and offsets. */
-    float flash_time_offset_of_first_event_scale, flash_time_offset_of_first_event_offset;
-    float flash_time_offset_of_last_event_scale, flash_time_offset_of_last_event_offset;
-    float flash_frame_time_offset_of_first_event_scale, flash_frame_time_offset_of_first_event_offset;
-    float flash_frame_time_offset_of_last_event_scale, flash_frame_time_offset_of_last_event_offset;
-    float flash_area_scale, flash_area_offset;
-    float flash_energy_scale, flash_energy_offset;
-
-    int i;
+    GLM_COLUMN_T col[MAX_FLASH_COLS];
+    int ncol = 0;
     int ret;
 
-    /* How many flashes to read? */
-    if ((ret = glm_read_dims(ncid, NULL, NULL, &my_nflash)))
-        return ret;
+    /* Check inputs. */
+    assert(glm && (glm->sections & GLM_SECTION_FLASH));
+    if (start > glm->nflash || count > glm->nflash - start)
+        return GLM_ERR_RANGE;
 
-    /* Return the number of flashes to user if desired. */
-    if (nflash)
-        *nflash = my_nflash;
-
-    /* Allocate storeage for flash variables. */
-    if (!(flash_id = malloc(my_nflash * sizeof(short))))
-	return GLM_ERR_MEMORY;
-    if (!(flash_time_offset_of_first_event = malloc(my_nflash * sizeof(short))))
-	return GLM_ERR_MEMORY;
-    if (!(flash_time_offset_of_last_event = malloc(my_nflash * sizeof(short))))
-	return GLM_ERR_MEMORY;
-    if (!(flash_frame_time_offset_of_first_event = malloc(my_nflash * sizeof(short))))
-	return GLM_ERR_MEMORY;
-    if (!(flash_frame_time_offset_of_last_event = malloc(my_nflash * sizeof(short))))
-	return GLM_ERR_MEMORY;
-    if (!(flash_lat = malloc(my_nflash * sizeof(float))))
-	return GLM_ERR_MEMORY;
-    if (!(flash_lon = malloc(my_nflash * sizeof(float))))
-	return GLM_ERR_MEMORY;
-    if (!(flash_area = malloc(my_nflash * sizeof(short))))
-	return GLM_ERR_MEMORY;
-    if (!(flash_energy = malloc(my_nflash * sizeof(short))))
-	return GLM_ERR_MEMORY;
-    if (!(flash_quality_flag = malloc(my_nflash * sizeof(short))))
-	return GLM_ERR_MEMORY;
-
-    /* Find the varids for the flash variables. */
-    if ((ret = nc_inq_varid(ncid, FLASH_ID, &flash_id_varid)))
-	NC_ERR(ret);
-
-    if ((ret = nc_inq_varid(ncid, FLASH_TIME_OFFSET_OF_FIRST_EVENT,
-                            &flash_time_offset_of_first_event_varid)))
-	NC_ERR(ret);
-    if ((ret = nc_get_att_float(ncid, flash_time_offset_of_first_event_varid,
-                                SCALE_FACTOR, &flash_time_offset_of_first_event_scale)))
-	NC_ERR(ret);
-    if ((ret = nc_get_att_float(ncid, flash_time_offset_of_first_event_varid,
-                                ADD_OFFSET, &flash_time_offset_of_first_event_offset)))
-	NC_ERR(ret);
-
-    if ((ret = nc_inq_varid(ncid, FLASH_TIME_OFFSET_OF_LAST_EVENT,
-                            &flash_time_offset_of_last_event_varid)))
-	NC_ERR(ret);
-    if ((ret = nc_get_att_float(ncid, flash_time_offset_of_last_event_varid,
-                                SCALE_FACTOR, &flash_time_offset_of_last_event_scale)))
-	NC_ERR(ret);
-    if ((ret = nc_get_att_float(ncid, flash_time_offset_of_last_event_varid,
-                                ADD_OFFSET, &flash_time_offset_of_last_event_offset)))
-	NC_ERR(ret);
-
-    if ((ret = nc_inq_varid(ncid, FLASH_FRAME_TIME_OFFSET_OF_FIRST_EVENT,
-			    &flash_frame_time_offset_of_first_event_varid)))
-	NC_ERR(ret);
-    if ((ret = nc_get_att_float(ncid, flash_frame_time_offset_of_first_event_varid, SCALE_FACTOR,
-				&flash_frame_time_offset_of_first_event_scale)))
-	NC_ERR(ret);
-    if ((ret = nc_get_att_float(ncid, flash_frame_time_offset_of_first_event_varid, ADD_OFFSET,
-				&flash_frame_time_offset_of_first_event_offset)))
-	NC_ERR(ret);
-
-    if ((ret = nc_inq_varid(ncid, FLASH_FRAME_TIME_OFFSET_OF_LAST_EVENT,
-			    &flash_frame_time_offset_of_last_event_varid)))
-	NC_ERR(ret);
-    if ((ret = nc_get_att_float(ncid, flash_frame_time_offset_of_last_event_varid, SCALE_FACTOR,
-				&flash_frame_time_offset_of_last_event_scale)))
-	NC_ERR(ret);
-    if ((ret = nc_get_att_float(ncid, flash_frame_time_offset_of_last_event_varid, ADD_OFFSET,
-				&flash_frame_time_offset_of_last_event_offset)))
-	NC_ERR(ret);
-
-    /* flash_lat is not packed. */
-    if ((ret = nc_inq_varid(ncid, FLASH_LAT, &flash_lat_varid)))
-	NC_ERR(ret);
-
-    /* flash_lon is not packed. */
-    if ((ret = nc_inq_varid(ncid, FLASH_LON, &flash_lon_varid)))
-	NC_ERR(ret);
-
-    if ((ret = nc_inq_varid(ncid, FLASH_AREA, &flash_area_varid)))
-	NC_ERR(ret);
-    if ((ret = nc_get_att_float(ncid, flash_area_varid, SCALE_FACTOR,
-                                &flash_area_scale)))
-	NC_ERR(ret);
-    if ((ret = nc_get_att_float(ncid, flash_area_varid, ADD_OFFSET,
-                                &flash_area_offset)))
-	NC_ERR(ret);
-
-    if ((ret = nc_inq_varid(ncid, FLASH_ENERGY, &flash_energy_varid)))
-	NC_ERR(ret);
-    if ((ret = nc_get_att_float(ncid, flash_energy_varid, SCALE_FACTOR,
-                                &flash_energy_scale)))
-	NC_ERR(ret);
-    if ((ret = nc_get_att_float(ncid, flash_energy_varid, ADD_OFFSET,
-                                &flash_energy_offset)))
-	NC_ERR(ret);
-
-
-    /* flash_quality_flag is not packed. */
-    if ((ret = nc_inq_varid(ncid, FLASH_QUALITY_FLAG,
-                            &flash_quality_flag_varid)))
-	NC_ERR(ret);
-
-    /* Read the flash variables. */
-    if ((ret = nc_get_var_short(ncid, flash_id_varid, flash_id)))
-	NC_ERR(ret);
-    if ((ret = nc_get_var_short(ncid, flash_time_offset_of_first_event_varid,
-				flash_time_offset_of_first_event)))
-	NC_ERR(ret);
-    if ((ret = nc_get_var_short(ncid, flash_time_offset_of_last_event_varid,
-				flash_time_offset_of_last_event)))
-	NC_ERR(ret);
-    if ((ret = nc_get_var_short(ncid, flash_frame_time_offset_of_first_event_varid,
-				flash_frame_time_offset_of_first_event)))
-	NC_ERR(ret);
-    if ((ret = nc_get_var_short(ncid, flash_frame_time_offset_of_last_event_varid,
-				flash_frame_time_offset_of_last_event)))
-	NC_ERR(ret);
-    if ((ret = nc_get_var_float(ncid, flash_lat_varid, flash_lat)))
-	NC_ERR(ret);
-    if ((ret = nc_get_var_float(ncid, flash_lon_varid, flash_lon)))
-	NC_ERR(ret);
-    if ((ret = nc_get_var_short(ncid, flash_area_varid, flash_area)))
-    	NC_ERR(ret);
-    if ((ret = nc_get_var_short(ncid, flash_energy_varid, flash_energy)))
-    	NC_ERR(ret);
-    if ((ret = nc_get_var_short(ncid, flash_quality_flag_varid, flash_quality_flag)))
-    	NC_ERR(ret);
-
-    /* Unpack the data into our already-allocated array of struct
-     * GLM_FLASH. */
-    for (i = 0; i < my_nflash; i++)
+    /* Describe where each variable goes. The varids, scale factors
+     * and offsets were cached when the file handle was
+     * initialized. Note that flash_id is an unsigned short in the
+     * file. There is no flash_id array. */
+    if (flash) /* fill structs */
+    {
+        glm_set_column(&col[ncol++], GLM_VAR_FLASH_ID, GLM_COL_INT, &flash->id,
+                       sizeof(GLM_FLASH_T));
+        glm_set_column(&col[ncol++], GLM_VAR_FLASH_TIME_OFFSET_OF_FIRST_EVENT,
+                       GLM_COL_FLOAT, &flash->time_offset_of_first_event,
+                       sizeof(GLM_FLASH_T));
+        glm_set_column_time(&col[ncol - 1], &flash->time_of_first_event,
+                            sizeof(GLM_FLASH_T));
+        glm_set_column(&col[ncol++], GLM_VAR_FLASH_TIME_OFFSET_OF_LAST_EVENT,
+                       GLM_COL_FLOAT, &flash->time_offset_of_last_event,
+                       sizeof(GLM_FLASH_T));
+        glm_set_column_time(&col[ncol - 1], &flash->time_of_last_event,
+                            sizeof(GLM_FLASH_T));
+        glm_set_column(&col[ncol++], GLM_VAR_FLASH_FRAME_TIME_OFFSET_OF_FIRST_EVENT,
+                       GLM_COL_FLOAT, &flash->frame_time_offset_of_first_event,
+                       sizeof(GLM_FLASH_T));
+        glm_set_column(&col[ncol++], GLM_VAR_FLASH_FRAME_TIME_OFFSET_OF_LAST_EVENT,
+                       GLM_COL_FLOAT, &flash->frame_time_offset_of_last_event,
+                       sizeof(GLM_FLASH_T));
+        glm_set_column(&col[ncol++], GLM_VAR_FLASH_LAT, GLM_COL_FLOAT,
+                       &flash->lat, sizeof(GLM_FLASH_T));
+        glm_set_column(&col[ncol++], GLM_VAR_FLASH_LON, GLM_COL_FLOAT,
+                       &flash->lon, sizeof(GLM_FLASH_T));
+        glm_set_column(&col[ncol++], GLM_VAR_FLASH_AREA, GLM_COL_FLOAT,
+                       &flash->area, sizeof(GLM_FLASH_T));
+        glm_set_column(&col[ncol++], GLM_VAR_FLASH_ENERGY, GLM_COL_FLOAT,
+                       &flash->energy, sizeof(GLM_FLASH_T));
+        glm_set_column(&col[ncol++], GLM_VAR_FLASH_QUALITY_FLAG, GLM_COL_SHORT,
+                       &flash->quality_flag, sizeof(GLM_FLASH_T));
+    }
+    else /* fill arrays */
     {
-	flash[i].id = flash_id[i];
-	flash[i].time_offset_of_first_event = (float)((unsigned short)flash_time_offset_of_first_event[i]) *
-	    flash_time_offset_of_first_event_scale + flash_time_offset_of_first_event_offset;
-	flash[i].time_offset_of_last_event = (float)((unsigned short)flash_time_offset_of_last_event[i]) *
-	    flash_time_offset_of_last_event_scale + flash_time_offset_of_last_event_offset;
-	flash[i].frame_time_offset_of_first_event = (float)((unsigned short)flash_frame_time_offset_of_first_event[i]) *
-	    flash_frame_time_offset_of_first_event_scale + flash_frame_time_offset_of_first_event_offset;
-	flash[i].frame_time_offset_of_last_event = (float)((unsigned short)flash_frame_time_offset_of_last_event[i]) *
-	    flash_frame_time_offset_of_last_event_scale + flash_frame_time_offset_of_last_event_offset;
-	flash[i].lat = flash_lat[i];
-	flash[i].lon = flash_lon[i];
-	flash[i].area = (float)((unsigned short)flash_area[i]) * flash_area_scale +
-	    flash_area_offset;
-	flash[i].energy = (float)((unsigned short)flash_energy[i]) * flash_energy_scale +
-            flash_energy_offset;
-	flash[i].quality_flag = flash_quality_flag[i];
+        glm_set_column(&col[ncol++], GLM_VAR_FLASH_TIME_OFFSET_OF_FIRST_EVENT,
+                       GLM_COL_FLOAT, time_offset_of_first_event, sizeof(float));
+        glm_set_column(&col[ncol++], GLM_VAR_FLASH_TIME_OFFSET_OF_LAST_EVENT,
+                       GLM_COL_FLOAT, time_offset_of_last_event, sizeof(float));
+        glm_set_column(&col[ncol++], GLM_VAR_FLASH_FRAME_TIME_OFFSET_OF_FIRST_EVENT,
+                       GLM_COL_FLOAT, frame_time_offset_of_first_event,
+                       sizeof(float));
+        glm_set_column(&col[ncol++], GLM_VAR_FLASH_FRAME_TIME_OFFSET_OF_LAST_EVENT,
+                       GLM_COL_FLOAT, frame_time_offset_of_last_event,
+                       sizeof(float));
+        glm_set_column(&col[ncol++], GLM_VAR_FLASH_LAT, GLM_COL_FLOAT, lat,
+                       sizeof(float));
+        glm_set_column(&col[ncol++], GLM_VAR_FLASH_LON, GLM_COL_FLOAT, lon,
+                       sizeof(float));
+        glm_set_column(&col[ncol++], GLM_VAR_FLASH_AREA, GLM_COL_FLOAT, area,
+                       sizeof(float));
+        glm_set_column(&col[ncol++], GLM_VAR_FLASH_ENERGY, GLM_COL_FLOAT, energy,
+                       sizeof(float));
+        glm_set_column(&col[ncol++], GLM_VAR_FLASH_QUALITY_FLAG, GLM_COL_SHORT,
+                       quality_flag, sizeof(short));
     }
 
-    /* Free flash storage. */
-    if (flash_id)
-	free(flash_id);
-    if (flash_time_offset_of_first_event)
-	free(flash_time_offset_of_first_event);
-    if (flash_time_offset_of_last_event)
-	free(flash_time_offset_of_last_event);
-    if (flash_frame_time_offset_of_first_event)
-	free(flash_frame_time_offset_of_first_event);
-    if (flash_frame_time_offset_of_last_event)
-	free(flash_frame_time_offset_of_last_event);
-    if (flash_lat)
-	free(flash_lat);
-    if (flash_lon)
-	free(flash_lon);
-    if (flash_area)
-	free(flash_area);
-    if (flash_energy)
-	free(flash_energy);
-    if (flash_quality_flag)
-	free(flash_quality_flag);
+    /* Read and unpack the flash variables. */
+    if (filter)
+    {
+        GLM_PRED_T pred[GLM_MAX_PREDS];
+        int npred;
+
+        glm_filter_preds(filter, GLM_SECTION_FLASH, pred, &npred);
+        return glm_read_columns_filter(glm, start, count, npred, pred, ncol,
+                                       col, nmatch);
+    }
+    if ((ret = glm_read_columns(glm, start, count, ncol, col)))
+	return ret;
 
     return 0;
 }
@@ -280,19 +162,25 @@ read_flash_vars(int ncid, size_t *nflash, GLM_FLASH_T *flash,
 int
 glm_read_flash_structs(int ncid, size_t *nflash, GLM_FLASH_T *flash)
 {
+    GLM_FILE_T glm;
     int ret;
 
-    if ((ret = read_flash_vars(ncid, nflash, flash, NULL, NULL,
-                               NULL, NULL, NULL, NULL, NULL, NULL, NULL)))
-	return ret;
+    if ((ret = glm_file_init(ncid, GLM_SECTION_FLASH, &glm)))
+        return ret;
 
-    return 0;
+    ret = glm_get_flash_structs(&glm, nflash, flash);
+    glm_file_free(&glm);
+
+    return ret;
 }
 
 /**
  * Read and unpack all the flash data in the file. It will be loaded
  * into the pre-allocated array of struct GLM_FLASH_T.
  *
+ * Any of the arrays may be NULL, in which case that variable is not
+ * read.
+ *
  * @param ncid ID of already opened GLM file.
  * @param nflash A pointer that gets the number of flashes. Ignored if
  * NULL.
@@ -331,14 +219,401 @@ glm_read_flash_arrays(int ncid, size_t *nflash,
                       float *frame_time_offset_of_last_event,
                       float *lat, float *lon, float *area, float *energy,
                       short *quality_flag)
+{
+    GLM_FILE_T glm;
+    int ret;
+
+    if ((ret = glm_file_init(ncid, GLM_SECTION_FLASH, &glm)))
+        return ret;
+
+    ret = glm_get_flash_arrays(&glm, nflash, time_offset_of_first_event,
+                               time_offset_of_last_event,
+                               frame_time_offset_of_first_event,
+                               frame_time_offset_of_last_event, lat, lon,
+                               area, energy, quality_flag);
+    glm_file_free(&glm);
+
+    return ret;
+}
+
+/**
+ * Read and unpack all the flash data in the file, using the metadata
+ * cached in the GLM file handle. It will be loaded into the
+ * pre-allocated array of struct GLM_FLASH_T.
+ *
+ * @param glm Pointer to the GLM file handle, from glm_open().
+ * @param nflash A pointer that gets the number of flashes. Ignored if
+ * NULL.
+ * @param flash Pointer to already-allocated array of GLM_FLASH_T.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+*/
+int
+glm_get_flash_structs(GLM_FILE_T *glm, size_t *nflash, GLM_FLASH_T *flash)
 {
     int ret;
 
-    if ((ret = read_flash_vars(ncid, nflash, NULL, time_offset_of_first_event,
+    if ((ret = read_flash_vars(glm, 0, glm->nflash, NULL, NULL, flash, NULL,
+                               NULL, NULL, NULL, NULL, NULL, NULL, NULL,
+                               NULL)))
+	return ret;
+    if (nflash)
+        *nflash = glm->nflash;
+
+    return 0;
+}
+
+/**
+ * Read and unpack all the flash data in the file into arrays, using
+ * the metadata cached in the GLM file handle.
+ *
+ * Any of the arrays may be NULL, in which case that variable is not
+ * read.
+ *
+ * @param glm Pointer to the GLM file handle, from glm_open().
+ * @param nflash A pointer that gets the number of flashes. Ignored if
+ * NULL.
+ * @param time_offset_of_first_event Pointer to already-allocated
+ * array of float for time_offset_of_first_event data.
+ * @param time_offset_of_last_event Pointer to already-allocated
+ * array of float for time_offset_of_last_event data.
+ * @param frame_time_offset_of_first_event Pointer to
+ * already-allocated array of float for
+ * frame_time_offset_of_first_event data.
+ * @param frame_time_offset_of_last_event Pointer to already-allocated
+ * array of float for frame_time_offset_of_last_event data.
+ * @param lat Pointer to already-allocated array of float for lat
+ * data.
+ * @param lon Pointer to already-allocated array of float for lon
+ * data.
+ * @param area Pointer to already-allocated array of float for
+ * area data.
+ * @param energy Pointer to already-allocated array of float for
+ * energy data.
+ * @param quality_flag Pointer to already-allocated array of short
+ * for quality flag data.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+*/
+int
+glm_get_flash_arrays(GLM_FILE_T *glm, size_t *nflash,
+                     float *time_offset_of_first_event,
+                     float *time_offset_of_last_event,
+                     float *frame_time_offset_of_first_event,
+                     float *frame_time_offset_of_last_event,
+                     float *lat, float *lon, float *area, float *energy,
+                     short *quality_flag)
+{
+    int ret;
+
+    if ((ret = read_flash_vars(glm, 0, glm->nflash, NULL, NULL, NULL,
+                               time_offset_of_first_event,
                                time_offset_of_last_event, frame_time_offset_of_first_event,
                                frame_time_offset_of_last_event, lat, lon, area,
                                energy, quality_flag)))
 	return ret;
+    if (nflash)
+        *nflash = glm->nflash;
 
     return 0;
 }
+
+/**
+ * Read and unpack a range of the flashes in the file, using the
+ * metadata cached in the GLM file handle. It will be loaded into the
+ * pre-allocated array of struct GLM_FLASH_T, which must have room for
+ * count flashes.
+ *
+ * @param glm Pointer to the GLM file handle, from glm_open().
+ * @param start Index of the first flash to read.
+ * @param count Number of flashes to read.
+ * @param flash Pointer to already-allocated array of GLM_FLASH_T.
+ *
+ * @return 0 for success, GLM_ERR_RANGE if the range is not inside the
+ * file, other error code otherwise.
+ * @author Ed Hartnett
+*/
+int
+glm_read_flash_range(GLM_FILE_T *glm, size_t start, size_t count,
+                     GLM_FLASH_T *flash)
+{
+    return read_flash_vars(glm, start, count, NULL, NULL, flash, NULL, NULL,
+                           NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+}
+
+/**
+ * Read and unpack a range of the flashes in the file into arrays,
+ * using the metadata cached in the GLM file handle. Each array must
+ * have room for count values.
+ *
+ * Any of the arrays may be NULL, in which case that variable is not
+ * read.
+ *
+ * @param glm Pointer to the GLM file handle, from glm_open().
+ * @param start Index of the first flash to read.
+ * @param count Number of flashes to read.
+ * @param time_offset_of_first_event Pointer to already-allocated
+ * array of float for time_offset_of_first_event data.
+ * @param time_offset_of_last_event Pointer to already-allocated
+ * array of float for time_offset_of_last_event data.
+ * @param frame_time_offset_of_first_event Pointer to
+ * already-allocated array of float for
+ * frame_time_offset_of_first_event data.
+ * @param frame_time_offset_of_last_event Pointer to already-allocated
+ * array of float for frame_time_offset_of_last_event data.
+ * @param lat Pointer to already-allocated array of float for lat
+ * data.
+ * @param lon Pointer to already-allocated array of float for lon
+ * data.
+ * @param area Pointer to already-allocated array of float for
+ * area data.
+ * @param energy Pointer to already-allocated array of float for
+ * energy data.
+ * @param quality_flag Pointer to already-allocated array of short
+ * for quality flag data.
+ *
+ * @return 0 for success, GLM_ERR_RANGE if the range is not inside the
+ * file, other error code otherwise.
+ * @author Ed Hartnett
+*/
+int
+glm_read_flash_range_arrays(GLM_FILE_T *glm, size_t start, size_t count,
+                            float *time_offset_of_first_event,
+                            float *time_offset_of_last_event,
+                            float *frame_time_offset_of_first_event,
+                            float *frame_time_offset_of_last_event,
+                            float *lat, float *lon, float *area,
+                            float *energy, short *quality_flag)
+{
+    return read_flash_vars(glm, start, count, NULL, NULL, NULL,
+                           time_offset_of_first_event,
+                           time_offset_of_last_event,
+                           frame_time_offset_of_first_event,
+                           frame_time_offset_of_last_event, lat, lon, area,
+                           energy, quality_flag);
+}
+
+/**
+ * Read and unpack the flashes of a range which pass a filter into an
+ * array of struct, using the metadata cached in the GLM file
+ * handle. The filter is evaluated on the packed values, and only the
+ * flashes which pass it are unpacked. They are stored one after the
+ * other at the start of the array, in file order.
+ *
+ * @param glm Pointer to the GLM file handle, from glm_open().
+ * @param start Index of the first flash to read.
+ * @param count Number of flashes to read.
+ * @param filter Pointer to the filter.
+ * @param nmatch Pointer that gets the number of flashes which pass
+ * the filter.
+ * @param flash Pointer to already-allocated array of GLM_FLASH_T,
+ * with room for count flashes.
+ *
+ * @return 0 for success, GLM_ERR_RANGE if the range is not inside the
+ * file, other error code otherwise.
+ * @author Ed Hartnett
+*/
+int
+glm_read_flash_filter(GLM_FILE_T *glm, size_t start, size_t count,
+                      const GLM_FILTER_T *filter, size_t *nmatch,
+                      GLM_FLASH_T *flash)
+{
+    assert(filter && nmatch && flash);
+    return read_flash_vars(glm, start, count, filter, nmatch, flash, NULL,
+                           NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+}
+
+/**
+ * Read and unpack the flashes of a range which pass a filter into
+ * arrays. Each array must have room for count values. See
+ * glm_read_flash_filter().
+ *
+ * Any of the arrays may be NULL, in which case that variable is not
+ * read.
+ *
+ * @param glm Pointer to the GLM file handle, from glm_open().
+ * @param start Index of the first flash to read.
+ * @param count Number of flashes to read.
+ * @param filter Pointer to the filter.
+ * @param nmatch Pointer that gets the number of flashes which pass
+ * the filter.
+ * @param time_offset_of_first_event Pointer to already-allocated
+ * array of float for time_offset_of_first_event data.
+ * @param time_offset_of_last_event Pointer to already-allocated
+ * array of float for time_offset_of_last_event data.
+ * @param frame_time_offset_of_first_event Pointer to
+ * already-allocated array of float for
+ * frame_time_offset_of_first_event data.
+ * @param frame_time_offset_of_last_event Pointer to already-allocated
+ * array of float for frame_time_offset_of_last_event data.
+ * @param lat Pointer to already-allocated array of float for lat
+ * data.
+ * @param lon Pointer to already-allocated array of float for lon
+ * data.
+ * @param area Pointer to already-allocated array of float for area
+ * data.
+ * @param energy Pointer to already-allocated array of float for
+ * energy data.
+ * @param quality_flag Pointer to already-allocated array of short
+ * for quality_flag data.
+ *
+ * @return 0 for success, GLM_ERR_RANGE if the range is not inside the
+ * file, other error code otherwise.
+ * @author Ed Hartnett
+*/
+int
+glm_read_flash_filter_arrays(GLM_FILE_T *glm, size_t start, size_t count,
+                             const GLM_FILTER_T *filter, size_t *nmatch,
+                             float *time_offset_of_first_event,
+                             float *time_offset_of_last_event,
+                             float *frame_time_offset_of_first_event,
+                             float *frame_time_offset_of_last_event,
+                             float *lat, float *lon, float *area,
+                             float *energy, short *quality_flag)
+{
+    assert(filter && nmatch);
+    return read_flash_vars(glm, start, count, filter, nmatch, NULL,
+                           time_offset_of_first_event,
+                           time_offset_of_last_event,
+                           frame_time_offset_of_first_event,
+                           frame_time_offset_of_last_event, lat, lon, area,
+                           energy, quality_flag);
+}
+
+/**
+ * Read the times of the first and last events of a range of the
+ * flashes in the file, as nanoseconds since the Unix epoch, using the
+ * metadata cached in the GLM file handle. See glm_read_event_times().
+ *
+ * Either array may be NULL, in which case those times are not read.
+ *
+ * @param glm Pointer to the GLM file handle, from glm_open().
+ * @param start Index of the first flash to read.
+ * @param count Number of flashes to read.
+ * @param time_of_first_event Pointer to already-allocated array of
+ * count int64.
+ * @param time_of_last_event Pointer to already-allocated array of
+ * count int64.
+ *
+ * @return 0 for success, GLM_ERR_RANGE if the range is not inside the
+ * file, other error code otherwise.
+ * @author Ed Hartnett
+*/
+int
+glm_read_flash_times(GLM_FILE_T *glm, size_t start, size_t count,
+                     int64_t *time_of_first_event,
+                     int64_t *time_of_last_event)
+{
+    GLM_COLUMN_T col[2];
+
+    /* Check inputs. */
+    assert(glm && (glm->sections & GLM_SECTION_FLASH));
+    if (start > glm->nflash || count > glm->nflash - start)
+        return GLM_ERR_RANGE;
+
+    glm_set_column(&col[0], GLM_VAR_FLASH_TIME_OFFSET_OF_FIRST_EVENT,
+                   GLM_COL_FLOAT, NULL, sizeof(float));
+    glm_set_column_time(&col[0], time_of_first_event, sizeof(int64_t));
+    glm_set_column(&col[1], GLM_VAR_FLASH_TIME_OFFSET_OF_LAST_EVENT,
+                   GLM_COL_FLOAT, NULL, sizeof(float));
+    glm_set_column_time(&col[1], time_of_last_event, sizeof(int64_t));
+
+    return glm_read_columns(glm, start, count, 2, col);
+}
+
+/**
+ * Read a range of the flashes in the file into arrays, leaving the
+ * packed variables as the unsigned shorts they are in the file, with
+ * the scale factor and offset of each. See glm_read_event_packed().
+ *
+ * Any of the arrays may be NULL, in which case that variable is not
+ * read.
+ *
+ * @param glm Pointer to the GLM file handle, from glm_open().
+ * @param start Index of the first flash to read.
+ * @param count Number of flashes to read.
+ * @param time_offset_of_first_event Pointer to already-allocated
+ * array of unsigned short for packed time_offset_of_first_event data.
+ * @param time_offset_of_last_event Pointer to already-allocated
+ * array of unsigned short for packed time_offset_of_last_event data.
+ * @param frame_time_offset_of_first_event Pointer to
+ * already-allocated array of unsigned short for packed
+ * frame_time_offset_of_first_event data.
+ * @param frame_time_offset_of_last_event Pointer to already-allocated
+ * array of unsigned short for packed frame_time_offset_of_last_event
+ * data.
+ * @param lat Pointer to already-allocated array of float for lat
+ * data.
+ * @param lon Pointer to already-allocated array of float for lon
+ * data.
+ * @param area Pointer to already-allocated array of unsigned short
+ * for packed area data.
+ * @param energy Pointer to already-allocated array of unsigned short
+ * for packed energy data.
+ * @param quality_flag Pointer to already-allocated array of short
+ * for quality_flag data.
+ * @param packing Pointer to a GLM_FLASH_PACKING_T which gets the
+ * packing of each packed variable. Ignored if NULL.
+ *
+ * @return 0 for success, GLM_ERR_RANGE if the range is not inside the
+ * file, other error code otherwise.
+ * @author Ed Hartnett
+*/
+int
+glm_read_flash_packed(GLM_FILE_T *glm, size_t start, size_t count,
+                      unsigned short *time_offset_of_first_event,
+                      unsigned short *time_offset_of_last_event,
+                      unsigned short *frame_time_offset_of_first_event,
+                      unsigned short *frame_time_offset_of_last_event,
+                      float *lat, float *lon, unsigned short *area,
+                      unsigned short *energy, short *quality_flag,
+                      GLM_FLASH_PACKING_T *packing)
+{
+    GLM_COLUMN_T col[MAX_FLASH_COLS];
+    int ncol = 0;
+
+    /* Check inputs. */
+    assert(glm && (glm->sections & GLM_SECTION_FLASH));
+    if (start > glm->nflash || count > glm->nflash - start)
+        return GLM_ERR_RANGE;
+
+    if (packing)
+    {
+        glm_get_packing(glm, GLM_VAR_FLASH_TIME_OFFSET_OF_FIRST_EVENT,
+                        &packing->time_offset_of_first_event);
+        glm_get_packing(glm, GLM_VAR_FLASH_TIME_OFFSET_OF_LAST_EVENT,
+                        &packing->time_offset_of_last_event);
+        glm_get_packing(glm, GLM_VAR_FLASH_FRAME_TIME_OFFSET_OF_FIRST_EVENT,
+                        &packing->frame_time_offset_of_first_event);
+        glm_get_packing(glm, GLM_VAR_FLASH_FRAME_TIME_OFFSET_OF_LAST_EVENT,
+                        &packing->frame_time_offset_of_last_event);
+        glm_get_packing(glm, GLM_VAR_FLASH_AREA, &packing->area);
+        glm_get_packing(glm, GLM_VAR_FLASH_ENERGY, &packing->energy);
+    }
+
+    /* Packed variables are copied as shorts. */
+    glm_set_column(&col[ncol++], GLM_VAR_FLASH_TIME_OFFSET_OF_FIRST_EVENT,
+                   GLM_COL_SHORT, time_offset_of_first_event, sizeof(short));
+    glm_set_column(&col[ncol++], GLM_VAR_FLASH_TIME_OFFSET_OF_LAST_EVENT,
+                   GLM_COL_SHORT, time_offset_of_last_event, sizeof(short));
+    glm_set_column(&col[ncol++], GLM_VAR_FLASH_FRAME_TIME_OFFSET_OF_FIRST_EVENT,
+                   GLM_COL_SHORT, frame_time_offset_of_first_event,
+                   sizeof(short));
+    glm_set_column(&col[ncol++], GLM_VAR_FLASH_FRAME_TIME_OFFSET_OF_LAST_EVENT,
+                   GLM_COL_SHORT, frame_time_offset_of_last_event,
+                   sizeof(short));
+    glm_set_column(&col[ncol++], GLM_VAR_FLASH_LAT, GLM_COL_FLOAT, lat,
+                   sizeof(float));
+    glm_set_column(&col[ncol++], GLM_VAR_FLASH_LON, GLM_COL_FLOAT, lon,
+                   sizeof(float));
+    glm_set_column(&col[ncol++], GLM_VAR_FLASH_AREA, GLM_COL_SHORT, area,
+                   sizeof(short));
+    glm_set_column(&col[ncol++], GLM_VAR_FLASH_ENERGY, GLM_COL_SHORT, energy,
+                   sizeof(short));
+    glm_set_column(&col[ncol++], GLM_VAR_FLASH_QUALITY_FLAG, GLM_COL_SHORT,
+                   quality_flag, sizeof(short));
+
+    return glm_read_columns(glm, start, count, ncol, col);
+}
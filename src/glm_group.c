@@ -8,16 +8,23 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <assert.h>
-#include "ncglm.h"
+#include "glm_internal.h"
+
+/** Most group variables read at once. */
+#define MAX_GROUP_COLS 8
 
 /**
  * This internal function will read and unpack all the group data in
  * the file. It will be loaded into either pre-allocated array of struct
  * group, or arrays of pre-allocated storage for each group var.
  *
- * @param ncid ID of already opened GLM file.
- * @param ngroup A pointer that gets the number of groups. Ignored if
- * NULL.
+ * @param glm Pointer to the GLM file handle.
+ * @param start Index of the first group to read.
+ * @param count Number of groups to read.
+ * @param filter Pointer to the filter, or NULL to read all the
+ * groups.
+ * @param nmatch Pointer that gets the number of groups which pass the
+ * filter. Ignored if filter is NULL.
  * @param group Pointer to already-allocated arrat of GLM_GROUP_T, or
  * NULL if arrays are being read.
  * @param time_offset Pointer to already-allocated array of unsigned
@@ -39,165 +46,75 @@
  * @author Ed Hartnett
 */
 static int
-read_group_vars(int ncid, size_t *ngroup, GLM_GROUP_T *group,
-                float *time_offset, float *lat, float *lon,
+read_group_vars(GLM_FILE_T *glm, size_t start, size_t count,
+                const GLM_FILTER_T *filter, size_t *nmatch,
+                GLM_GROUP_T *group, float *time_offset, float *lat, float *lon,
                 float *energy, float *area, unsigned int *parent_flash_id,
                 short *quality_flag)
 {
-    /* Groups. */
-    int group_id_varid, group_time_offset_varid;
-    int group_frame_time_offset_varid, group_lat_varid, group_lon_varid;
-    int group_area_varid, group_energy_varid, group_parent_flash_id_varid;
-    int group_quality_flag_varid;
-    int *group_id = NULL;
-    short *group_time_offset = NULL;
-    short *group_frame_time_offset = NULL;
-    float *group_lat = NULL, *group_lon = NULL;
-    short *group_area = NULL, *group_energy = NULL, *group_parent_flash_id = NULL;
-    short *group_quality_flag = NULL;
-    size_t my_ngroup;
-
-    /* Scale factors and offsets. */
-    float group_time_offset_scale, group_time_offset_offset;
-    float group_frame_time_offset_scale, group_frame_time_offset_offset;
-    float group_area_scale, group_area_offset;
-    float group_energy_scale, group_energy_offset;
-
-    int i;
+    GLM_COLUMN_T col[MAX_GROUP_COLS];
+    int ncol = 0;
     int ret;
 
-    /* How many groups to read? */
-    if ((ret = glm_read_dims(ncid, NULL, &my_ngroup, NULL)))
-        return ret;
+    /* Check inputs. */
+    assert(glm && (glm->sections & GLM_SECTION_GROUP));
+    if (start > glm->ngroup || count > glm->ngroup - start)
+        return GLM_ERR_RANGE;
 
-    /* Return the number of groups to user if desired. */
-    if (ngroup)
-        *ngroup = my_ngroup;
-
-    /* Allocate storeage for group variables. */
-    if (!(group_id = malloc(my_ngroup * sizeof(int))))
-	return GLM_ERR_MEMORY;
-    if (!(group_time_offset = malloc(my_ngroup * sizeof(short))))
-	return GLM_ERR_MEMORY;
-    if (!(group_frame_time_offset = malloc(my_ngroup * sizeof(short))))
-	return GLM_ERR_MEMORY;
-    if (!(group_lat = malloc(my_ngroup * sizeof(float))))
-	return GLM_ERR_MEMORY;
-    if (!(group_lon = malloc(my_ngroup * sizeof(float))))
-	return GLM_ERR_MEMORY;
-    if (!(group_area = malloc(my_ngroup * sizeof(short))))
-	return GLM_ERR_MEMORY;
-    if (!(group_energy = malloc(my_ngroup * sizeof(short))))
-	return GLM_ERR_MEMORY;
-    if (!(group_parent_flash_id = malloc(my_ngroup * sizeof(short))))
-	return GLM_ERR_MEMORY;
-    if (!(group_quality_flag = malloc(my_ngroup * sizeof(short))))
-	return GLM_ERR_MEMORY;
-
-    /* Find the varids for the group variables. */
-    if ((ret = nc_inq_varid(ncid, GROUP_ID, &group_id_varid)))
-	NC_ERR(ret);
-
-    if ((ret = nc_inq_varid(ncid, GROUP_TIME_OFFSET, &group_time_offset_varid)))
-	NC_ERR(ret);
-    if ((ret = nc_get_att_float(ncid, group_time_offset_varid, SCALE_FACTOR, &group_time_offset_scale)))
-	NC_ERR(ret);
-    if ((ret = nc_get_att_float(ncid, group_time_offset_varid, ADD_OFFSET, &group_time_offset_offset)))
-	NC_ERR(ret);
-
-    if ((ret = nc_inq_varid(ncid, GROUP_FRAME_TIME_OFFSET, &group_frame_time_offset_varid)))
-	NC_ERR(ret);
-    if ((ret = nc_get_att_float(ncid, group_frame_time_offset_varid, SCALE_FACTOR, &group_frame_time_offset_scale)))
-	NC_ERR(ret);
-    if ((ret = nc_get_att_float(ncid, group_frame_time_offset_varid, ADD_OFFSET, &group_frame_time_offset_offset)))
-	NC_ERR(ret);
-
-    /* group_lat is not packed. */
-    if ((ret = nc_inq_varid(ncid, GROUP_LAT, &group_lat_varid)))
-	NC_ERR(ret);
-
-    /* group_lon is not packed. */
-    if ((ret = nc_inq_varid(ncid, GROUP_LON, &group_lon_varid)))
-	NC_ERR(ret);
-
-    if ((ret = nc_inq_varid(ncid, GROUP_AREA, &group_area_varid)))
-	NC_ERR(ret);
-    if ((ret = nc_get_att_float(ncid, group_area_varid, SCALE_FACTOR, &group_area_scale)))
-	NC_ERR(ret);
-    if ((ret = nc_get_att_float(ncid, group_area_varid, ADD_OFFSET, &group_area_offset)))
-	NC_ERR(ret);
-
-    if ((ret = nc_inq_varid(ncid, GROUP_ENERGY, &group_energy_varid)))
-	NC_ERR(ret);
-    if ((ret = nc_get_att_float(ncid, group_energy_varid, SCALE_FACTOR, &group_energy_scale)))
-	NC_ERR(ret);
-    if ((ret = nc_get_att_float(ncid, group_energy_varid, ADD_OFFSET, &group_energy_offset)))
-	NC_ERR(ret);
-
-    /* group_parent_flash_id is not packed. */
-    if ((ret = nc_inq_varid(ncid, GROUP_PARENT_FLASH_ID, &group_parent_flash_id_varid)))
-	NC_ERR(ret);
-
-    /* group_quality_flag is not packed. */
-    if ((ret = nc_inq_varid(ncid, GROUP_QUALITY_FLAG, &group_quality_flag_varid)))
-	NC_ERR(ret);
-
-    /* Read the group variables. */
-    if ((ret = nc_get_var_int(ncid, group_id_varid, group_id)))
-	NC_ERR(ret);
-    if ((ret = nc_get_var_short(ncid, group_time_offset_varid, group_time_offset)))
-	NC_ERR(ret);
-    if ((ret = nc_get_var_short(ncid, group_frame_time_offset_varid, group_frame_time_offset)))
-	NC_ERR(ret);
-    if ((ret = nc_get_var_float(ncid, group_lat_varid, group_lat)))
-	NC_ERR(ret);
-    if ((ret = nc_get_var_float(ncid, group_lon_varid, group_lon)))
-	NC_ERR(ret);
-    if ((ret = nc_get_var_short(ncid, group_area_varid, group_area)))
-    	NC_ERR(ret);
-    if ((ret = nc_get_var_short(ncid, group_energy_varid, group_energy)))
-    	NC_ERR(ret);
-    if ((ret = nc_get_var_short(ncid, group_parent_flash_id_varid, group_parent_flash_id)))
-    	NC_ERR(ret);
-    if ((ret = nc_get_var_short(ncid, group_quality_flag_varid, group_quality_flag)))
-    	NC_ERR(ret);
-
-    /* Unpack the data into our already-allocated array of struct
-     * GLM_GROUP. */
-    for (i = 0; i < my_ngroup; i++)
+    /* Describe where each variable goes. The varids, scale factors
+     * and offsets were cached when the file handle was
+     * initialized. There is no group_id array, and
+     * group_frame_time_offset is not returned. */
+    if (group) /* fill structs */
+    {
+        glm_set_column(&col[ncol++], GLM_VAR_GROUP_ID, GLM_COL_INT, &group->id,
+                       sizeof(GLM_GROUP_T));
+        glm_set_column(&col[ncol++], GLM_VAR_GROUP_TIME_OFFSET, GLM_COL_FLOAT,
+                       &group->time_offset, sizeof(GLM_GROUP_T));
+        glm_set_column_time(&col[ncol - 1], &group->time, sizeof(GLM_GROUP_T));
+        glm_set_column(&col[ncol++], GLM_VAR_GROUP_LAT, GLM_COL_FLOAT,
+                       &group->lat, sizeof(GLM_GROUP_T));
+        glm_set_column(&col[ncol++], GLM_VAR_GROUP_LON, GLM_COL_FLOAT,
+                       &group->lon, sizeof(GLM_GROUP_T));
+        glm_set_column(&col[ncol++], GLM_VAR_GROUP_AREA, GLM_COL_FLOAT,
+                       &group->area, sizeof(GLM_GROUP_T));
+        glm_set_column(&col[ncol++], GLM_VAR_GROUP_ENERGY, GLM_COL_FLOAT,
+                       &group->energy, sizeof(GLM_GROUP_T));
+        glm_set_column(&col[ncol++], GLM_VAR_GROUP_PARENT_FLASH_ID, GLM_COL_INT,
+                       &group->parent_flash_id, sizeof(GLM_GROUP_T));
+        glm_set_column(&col[ncol++], GLM_VAR_GROUP_QUALITY_FLAG, GLM_COL_SHORT,
+                       &group->quality_flag, sizeof(GLM_GROUP_T));
+    }
+    else /* fill arrays */
     {
-	group[i].id = group_id[i];
-	group[i].time_offset = (float)((unsigned short)group_time_offset[i]) *
-	    group_time_offset_scale + group_time_offset_offset;
-	group[i].lat = group_lat[i];
-	group[i].lon = group_lon[i];
-	group[i].area = (float)((unsigned short)group_area[i]) *
-	    group_area_scale + group_area_offset;
-	group[i].energy = (float)((unsigned short)group_energy[i]) *
-	    group_energy_scale + group_energy_offset;
-	group[i].parent_flash_id = group_parent_flash_id[i];
-	group[i].quality_flag = group_quality_flag[i];
+        glm_set_column(&col[ncol++], GLM_VAR_GROUP_TIME_OFFSET, GLM_COL_FLOAT,
+                       time_offset, sizeof(float));
+        glm_set_column(&col[ncol++], GLM_VAR_GROUP_LAT, GLM_COL_FLOAT, lat,
+                       sizeof(float));
+        glm_set_column(&col[ncol++], GLM_VAR_GROUP_LON, GLM_COL_FLOAT, lon,
+                       sizeof(float));
+        glm_set_column(&col[ncol++], GLM_VAR_GROUP_AREA, GLM_COL_FLOAT, area,
+                       sizeof(float));
+        glm_set_column(&col[ncol++], GLM_VAR_GROUP_ENERGY, GLM_COL_FLOAT, energy,
+                       sizeof(float));
+        glm_set_column(&col[ncol++], GLM_VAR_GROUP_PARENT_FLASH_ID, GLM_COL_INT,
+                       parent_flash_id, sizeof(unsigned int));
+        glm_set_column(&col[ncol++], GLM_VAR_GROUP_QUALITY_FLAG, GLM_COL_SHORT,
+                       quality_flag, sizeof(short));
     }
 
-    /* Free group storage. */
-    if (group_id)
-	free(group_id);
-    if (group_time_offset)
-	free(group_time_offset);
-    if (group_frame_time_offset)
-	free(group_frame_time_offset);
-    if (group_lat)
-	free(group_lat);
-    if (group_lon)
-	free(group_lon);
-    if (group_area)
-	free(group_area);
-    if (group_energy)
-	free(group_energy);
-    if (group_parent_flash_id)
-	free(group_parent_flash_id);
-    if (group_quality_flag)
-	free(group_quality_flag);
+    /* Read and unpack the group variables. */
+    if (filter)
+    {
+        GLM_PRED_T pred[GLM_MAX_PREDS];
+        int npred;
+
+        glm_filter_preds(filter, GLM_SECTION_GROUP, pred, &npred);
+        return glm_read_columns_filter(glm, start, count, npred, pred, ncol,
+                                       col, nmatch);
+    }
+    if ((ret = glm_read_columns(glm, start, count, ncol, col)))
+	return ret;
 
     return 0;
 }
@@ -217,19 +134,25 @@ read_group_vars(int ncid, size_t *ngroup, GLM_GROUP_T *group,
 int
 glm_read_group_structs(int ncid, size_t *ngroup, GLM_GROUP_T *group)
 {
+    GLM_FILE_T glm;
     int ret;
 
-    if ((ret = read_group_vars(ncid, ngroup, group, NULL, NULL,
-                               NULL, NULL, NULL, NULL, NULL)))
-	return ret;
+    if ((ret = glm_file_init(ncid, GLM_SECTION_GROUP, &glm)))
+        return ret;
 
-    return 0;
+    ret = glm_get_group_structs(&glm, ngroup, group);
+    glm_file_free(&glm);
+
+    return ret;
 }
 
 /**
  * Read and unpack all the group data in the file. It will be loaded
  * into the pre-allocated arrays for each element of the group data.
  *
+ * Any of the arrays may be NULL, in which case that variable is not
+ * read.
+ *
  * @param ncid ID of already opened GLM file.
  * @param ngroup A pointer that gets the number of groups. Ignored if
  * NULL.
@@ -256,11 +179,334 @@ glm_read_group_arrays(int ncid, size_t *ngroup, float *time_offset,
                       float *lat, float *lon, float *energy, float *area,
                       unsigned int *parent_flash_id, short *quality_flag)
 {
+    GLM_FILE_T glm;
     int ret;
 
-    if ((ret = read_group_vars(ncid, ngroup, NULL, time_offset, lat,
-                               lon, energy, area, parent_flash_id, quality_flag)))
+    if ((ret = glm_file_init(ncid, GLM_SECTION_GROUP, &glm)))
+        return ret;
+
+    ret = glm_get_group_arrays(&glm, ngroup, time_offset, lat, lon, energy,
+                               area, parent_flash_id, quality_flag);
+    glm_file_free(&glm);
+
+    return ret;
+}
+
+/**
+ * Read and unpack all the group data in the file, using the metadata
+ * cached in the GLM file handle. It will be loaded into the
+ * pre-allocated array of struct group.
+ *
+ * @param glm Pointer to the GLM file handle, from glm_open().
+ * @param ngroup A pointer that gets the number of groups. Ignored if
+ * NULL.
+ * @param group Pointer to already-allocated array of GLM_GROUP_T.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+*/
+int
+glm_get_group_structs(GLM_FILE_T *glm, size_t *ngroup, GLM_GROUP_T *group)
+{
+    int ret;
+
+    if ((ret = read_group_vars(glm, 0, glm->ngroup, NULL, NULL, group, NULL,
+                               NULL, NULL, NULL, NULL, NULL, NULL)))
 	return ret;
+    if (ngroup)
+        *ngroup = glm->ngroup;
 
     return 0;
 }
+
+/**
+ * Read and unpack all the group data in the file into arrays, using
+ * the metadata cached in the GLM file handle.
+ *
+ * Any of the arrays may be NULL, in which case that variable is not
+ * read.
+ *
+ * @param glm Pointer to the GLM file handle, from glm_open().
+ * @param ngroup A pointer that gets the number of groups. Ignored if
+ * NULL.
+ * @param time_offset Pointer to already-allocated array of float
+ * for time_offset data.
+ * @param lat Pointer to already-allocated array of float for lat
+ * data.
+ * @param lon Pointer to already-allocated array of float for lon
+ * data.
+ * @param energy Pointer to already-allocated array of float for
+ * energy data.
+ * @param area Pointer to already-allocated array of float for
+ * area data.
+ * @param parent_flash_id Pointer to already-allocated array of
+ * unsigned int for parent_flash_id data.
+ * @param quality_flag Pointer to already-allocated array of short
+ * for quality flag data.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+*/
+int
+glm_get_group_arrays(GLM_FILE_T *glm, size_t *ngroup, float *time_offset,
+                     float *lat, float *lon, float *energy, float *area,
+                     unsigned int *parent_flash_id, short *quality_flag)
+{
+    int ret;
+
+    if ((ret = read_group_vars(glm, 0, glm->ngroup, NULL, NULL, NULL,
+                               time_offset, lat, lon, energy, area,
+                               parent_flash_id, quality_flag)))
+	return ret;
+    if (ngroup)
+        *ngroup = glm->ngroup;
+
+    return 0;
+}
+
+/**
+ * Read and unpack a range of the groups in the file, using the
+ * metadata cached in the GLM file handle. It will be loaded into the
+ * pre-allocated array of struct group, which must have room for count
+ * groups.
+ *
+ * @param glm Pointer to the GLM file handle, from glm_open().
+ * @param start Index of the first group to read.
+ * @param count Number of groups to read.
+ * @param group Pointer to already-allocated array of GLM_GROUP_T.
+ *
+ * @return 0 for success, GLM_ERR_RANGE if the range is not inside the
+ * file, other error code otherwise.
+ * @author Ed Hartnett
+*/
+int
+glm_read_group_range(GLM_FILE_T *glm, size_t start, size_t count,
+                     GLM_GROUP_T *group)
+{
+    return read_group_vars(glm, start, count, NULL, NULL, group, NULL, NULL,
+                           NULL, NULL, NULL, NULL, NULL);
+}
+
+/**
+ * Read and unpack a range of the groups in the file into arrays,
+ * using the metadata cached in the GLM file handle. Each array must
+ * have room for count values.
+ *
+ * Any of the arrays may be NULL, in which case that variable is not
+ * read.
+ *
+ * @param glm Pointer to the GLM file handle, from glm_open().
+ * @param start Index of the first group to read.
+ * @param count Number of groups to read.
+ * @param time_offset Pointer to already-allocated array of float
+ * for time_offset data.
+ * @param lat Pointer to already-allocated array of float for lat
+ * data.
+ * @param lon Pointer to already-allocated array of float for lon
+ * data.
+ * @param energy Pointer to already-allocated array of float for
+ * energy data.
+ * @param area Pointer to already-allocated array of float for
+ * area data.
+ * @param parent_flash_id Pointer to already-allocated array of
+ * unsigned int for parent_flash_id data.
+ * @param quality_flag Pointer to already-allocated array of short
+ * for quality flag data.
+ *
+ * @return 0 for success, GLM_ERR_RANGE if the range is not inside the
+ * file, other error code otherwise.
+ * @author Ed Hartnett
+*/
+int
+glm_read_group_range_arrays(GLM_FILE_T *glm, size_t start, size_t count,
+                            float *time_offset, float *lat, float *lon,
+                            float *energy, float *area,
+                            unsigned int *parent_flash_id,
+                            short *quality_flag)
+{
+    return read_group_vars(glm, start, count, NULL, NULL, NULL, time_offset,
+                           lat, lon, energy, area, parent_flash_id,
+                           quality_flag);
+}
+
+/**
+ * Read and unpack the groups of a range which pass a filter into an
+ * array of struct, using the metadata cached in the GLM file
+ * handle. The filter is evaluated on the packed values, and only the
+ * groups which pass it are unpacked. They are stored one after the
+ * other at the start of the array, in file order.
+ *
+ * @param glm Pointer to the GLM file handle, from glm_open().
+ * @param start Index of the first group to read.
+ * @param count Number of groups to read.
+ * @param filter Pointer to the filter.
+ * @param nmatch Pointer that gets the number of groups which pass
+ * the filter.
+ * @param group Pointer to already-allocated array of GLM_GROUP_T,
+ * with room for count groups.
+ *
+ * @return 0 for success, GLM_ERR_RANGE if the range is not inside the
+ * file, other error code otherwise.
+ * @author Ed Hartnett
+*/
+int
+glm_read_group_filter(GLM_FILE_T *glm, size_t start, size_t count,
+                      const GLM_FILTER_T *filter, size_t *nmatch,
+                      GLM_GROUP_T *group)
+{
+    assert(filter && nmatch && group);
+    return read_group_vars(glm, start, count, filter, nmatch, group, NULL,
+                           NULL, NULL, NULL, NULL, NULL, NULL);
+}
+
+/**
+ * Read and unpack the groups of a range which pass a filter into
+ * arrays. Each array must have room for count values. See
+ * glm_read_group_filter().
+ *
+ * Any of the arrays may be NULL, in which case that variable is not
+ * read.
+ *
+ * @param glm Pointer to the GLM file handle, from glm_open().
+ * @param start Index of the first group to read.
+ * @param count Number of groups to read.
+ * @param filter Pointer to the filter.
+ * @param nmatch Pointer that gets the number of groups which pass
+ * the filter.
+ * @param time_offset Pointer to already-allocated array of float for
+ * time_offset data.
+ * @param lat Pointer to already-allocated array of float for lat
+ * data.
+ * @param lon Pointer to already-allocated array of float for lon
+ * data.
+ * @param energy Pointer to already-allocated array of float for
+ * energy data.
+ * @param area Pointer to already-allocated array of float for area
+ * data.
+ * @param parent_flash_id Pointer to already-allocated array of
+ * unsigned int for parent_flash_id data.
+ * @param quality_flag Pointer to already-allocated array of short
+ * for quality_flag data.
+ *
+ * @return 0 for success, GLM_ERR_RANGE if the range is not inside the
+ * file, other error code otherwise.
+ * @author Ed Hartnett
+*/
+int
+glm_read_group_filter_arrays(GLM_FILE_T *glm, size_t start, size_t count,
+                             const GLM_FILTER_T *filter, size_t *nmatch,
+                             float *time_offset, float *lat, float *lon,
+                             float *energy, float *area,
+                             unsigned int *parent_flash_id,
+                             short *quality_flag)
+{
+    assert(filter && nmatch);
+    return read_group_vars(glm, start, count, filter, nmatch, NULL,
+                           time_offset, lat, lon, energy, area,
+                           parent_flash_id, quality_flag);
+}
+
+/**
+ * Read the times of a range of the groups in the file, as
+ * nanoseconds since the Unix epoch, using the metadata cached in the
+ * GLM file handle. See glm_read_event_times().
+ *
+ * @param glm Pointer to the GLM file handle, from glm_open().
+ * @param start Index of the first group to read.
+ * @param count Number of groups to read.
+ * @param time Pointer to already-allocated array of count int64.
+ *
+ * @return 0 for success, GLM_ERR_RANGE if the range is not inside the
+ * file, other error code otherwise.
+ * @author Ed Hartnett
+*/
+int
+glm_read_group_times(GLM_FILE_T *glm, size_t start, size_t count,
+                     int64_t *time)
+{
+    GLM_COLUMN_T col;
+
+    /* Check inputs. */
+    assert(glm && (glm->sections & GLM_SECTION_GROUP) && time);
+    if (start > glm->ngroup || count > glm->ngroup - start)
+        return GLM_ERR_RANGE;
+
+    glm_set_column(&col, GLM_VAR_GROUP_TIME_OFFSET, GLM_COL_FLOAT, NULL,
+                   sizeof(float));
+    glm_set_column_time(&col, time, sizeof(int64_t));
+
+    return glm_read_columns(glm, start, count, 1, &col);
+}
+
+/**
+ * Read a range of the groups in the file into arrays, leaving the
+ * packed variables as the unsigned shorts they are in the file, with
+ * the scale factor and offset of each. See glm_read_event_packed().
+ *
+ * Any of the arrays may be NULL, in which case that variable is not
+ * read.
+ *
+ * @param glm Pointer to the GLM file handle, from glm_open().
+ * @param start Index of the first group to read.
+ * @param count Number of groups to read.
+ * @param time_offset Pointer to already-allocated array of unsigned
+ * short for packed time_offset data.
+ * @param lat Pointer to already-allocated array of float for lat
+ * data.
+ * @param lon Pointer to already-allocated array of float for lon
+ * data.
+ * @param energy Pointer to already-allocated array of unsigned short
+ * for packed energy data.
+ * @param area Pointer to already-allocated array of unsigned short
+ * for packed area data.
+ * @param parent_flash_id Pointer to already-allocated array of
+ * unsigned int for parent_flash_id data.
+ * @param quality_flag Pointer to already-allocated array of short
+ * for quality_flag data.
+ * @param packing Pointer to a GLM_GROUP_PACKING_T which gets the
+ * packing of each packed variable. Ignored if NULL.
+ *
+ * @return 0 for success, GLM_ERR_RANGE if the range is not inside the
+ * file, other error code otherwise.
+ * @author Ed Hartnett
+*/
+int
+glm_read_group_packed(GLM_FILE_T *glm, size_t start, size_t count,
+                      unsigned short *time_offset, float *lat, float *lon,
+                      unsigned short *energy, unsigned short *area,
+                      unsigned int *parent_flash_id, short *quality_flag,
+                      GLM_GROUP_PACKING_T *packing)
+{
+    GLM_COLUMN_T col[MAX_GROUP_COLS];
+    int ncol = 0;
+
+    /* Check inputs. */
+    assert(glm && (glm->sections & GLM_SECTION_GROUP));
+    if (start > glm->ngroup || count > glm->ngroup - start)
+        return GLM_ERR_RANGE;
+
+    if (packing)
+    {
+        glm_get_packing(glm, GLM_VAR_GROUP_TIME_OFFSET, &packing->time_offset);
+        glm_get_packing(glm, GLM_VAR_GROUP_AREA, &packing->area);
+        glm_get_packing(glm, GLM_VAR_GROUP_ENERGY, &packing->energy);
+    }
+
+    /* Packed variables are copied as shorts. */
+    glm_set_column(&col[ncol++], GLM_VAR_GROUP_TIME_OFFSET, GLM_COL_SHORT,
+                   time_offset, sizeof(short));
+    glm_set_column(&col[ncol++], GLM_VAR_GROUP_LAT, GLM_COL_FLOAT, lat,
+                   sizeof(float));
+    glm_set_column(&col[ncol++], GLM_VAR_GROUP_LON, GLM_COL_FLOAT, lon,
+                   sizeof(float));
+    glm_set_column(&col[ncol++], GLM_VAR_GROUP_AREA, GLM_COL_SHORT, area,
+                   sizeof(short));
+    glm_set_column(&col[ncol++], GLM_VAR_GROUP_ENERGY, GLM_COL_SHORT, energy,
+                   sizeof(short));
+    glm_set_column(&col[ncol++], GLM_VAR_GROUP_PARENT_FLASH_ID, GLM_COL_INT,
+                   parent_flash_id, sizeof(unsigned int));
+    glm_set_column(&col[ncol++], GLM_VAR_GROUP_QUALITY_FLAG, GLM_COL_SHORT,
+                   quality_flag, sizeof(short));
+
+    return glm_read_columns(glm, start, count, ncol, col);
+}
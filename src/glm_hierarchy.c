@@ -0,0 +1,863 @@
+/**
+ * @file
+ * Code to index how the events, groups, and flashes of a batch are
+ * related.
+ *
+ * Each event names its group with event_parent_group_id, and each
+ * group names its flash with group_parent_flash_id. The IDs of each
+ * kind are close to dense, in a GLM file and in a batch, so an ID is
+ * mapped to an index with a table over the range of IDs. Flash IDs
+ * are 16-bit counters in the file, which wrap within a granule, so
+ * when 16-bit IDs are too sparse for a table over their range, the
+ * range is taken around the wrap instead: the IDs from the one after
+ * the largest gap, modulo 65536. The children
+ * of each parent are then found with a counting sort on the index of
+ * the parent: each chunk of the children is counted by parent on its
+ * own thread, the counts are summed into the start of each parent,
+ * and each chunk then puts its children in place. Children keep their
+ * order, so the index does not depend on the number of threads.
+ *
+ * The index also gives the order in which glm_cluster_batch() puts
+ * the records of a batch, so that those of each flash are together.
+ *
+ * @author Ed Hartnett
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <assert.h>
+#include "glm_internal.h"
+
+/** Fewest records in a chunk of a parallel pass. */
+#define GLM_HIER_CHUNK 16384
+
+/** Largest range of IDs of a kind for which a table is made, as a
+ * multiple of the number of records. */
+#define GLM_HIER_MAX_SPAN 16
+
+/** Number of arrays of a GLM_HIERARCHY_T. */
+#define NUM_HIER_ARRAYS 10
+
+/** A counting sort of children by parent. */
+typedef struct GLM_SORT
+{
+    size_t n;                      /**< Number of children. */
+    const unsigned int *parent_id; /**< Parent ID of each child. */
+    unsigned int id_min;           /**< Smallest ID of a parent. */
+    size_t id_span;                /**< Length of the ID map. */
+    unsigned int id_mask;          /**< Mask of the ID map. */
+    const size_t *index;           /**< ID map of the parents. */
+    size_t nparent;                /**< Number of parents. */
+    size_t chunk_len;              /**< Children in each chunk. */
+    size_t *count;                 /**< nparent + 1 counts per chunk. */
+    size_t *parent;                /**< Gets the parent of each child. */
+    size_t *start;                 /**< Gets the start of each parent. */
+    size_t *order;                 /**< Gets the children, by parent. */
+} GLM_SORT_T;
+
+/** The gathering of the events of each flash. */
+typedef struct GLM_FLASH_EVENTS
+{
+    GLM_HIERARCHY_T *hier; /**< The hierarchy. */
+    size_t chunk_len;      /**< Flashes in each chunk. */
+} GLM_FLASH_EVENTS_T;
+
+/**
+ * Find the number of chunks for a parallel pass.
+ *
+ * @param n Number of records.
+ * @param nthreads Number of threads.
+ * @param chunk_len Pointer that gets the number of records in each
+ * chunk.
+ *
+ * @return Number of chunks, at least 1.
+ * @author Ed Hartnett
+ */
+static int
+num_chunks(size_t n, int nthreads, size_t *chunk_len)
+{
+    size_t nchunk = (n + GLM_HIER_CHUNK - 1) / GLM_HIER_CHUNK;
+
+    if (nchunk > (size_t)nthreads)
+        nchunk = nthreads;
+    if (!nchunk)
+        nchunk = 1;
+    *chunk_len = (n + nchunk - 1) / nchunk;
+
+    return (int)nchunk;
+}
+
+/**
+ * Find the range of some sets of 16-bit IDs, which may wrap: the IDs
+ * from the one after the largest gap between IDs, modulo 65536. For
+ * IDs which don't wrap, this is the range from the smallest to the
+ * largest.
+ *
+ * @param id The sets of IDs.
+ * @param n Number of IDs in each set.
+ * @param nset Number of sets.
+ * @param min Pointer that gets the first ID of the range.
+ * @param span Pointer that gets the length of the range.
+ *
+ * @return 0 for success, GLM_ERR_RANGE if there are no IDs, or an ID
+ * does not fit in 16 bits.
+ * @author Ed Hartnett
+ */
+int
+glm_wrapped_range(const unsigned int *const *id, const size_t *n, int nset,
+                  unsigned int *min, size_t *span)
+{
+    uint64_t used[(GLM_ID_MASK_16 + 1) / 64];
+    unsigned int first = 0, last = 0, gap, max_gap = 0, k;
+    int any = 0, s;
+    size_t i;
+
+    /* Check inputs. */
+    assert(id && n && min && span);
+
+    memset(used, 0, sizeof(used));
+    for (s = 0; s < nset; s++)
+    {
+        for (i = 0; i < n[s]; i++)
+        {
+            if (id[s][i] > GLM_ID_MASK_16)
+                return GLM_ERR_RANGE;
+            used[id[s][i] / 64] |= (uint64_t)1 << (id[s][i] % 64);
+        }
+    }
+
+    /* Find the largest gap between consecutive IDs. */
+    for (k = 0; k <= GLM_ID_MASK_16; k++)
+    {
+        if (!(used[k / 64] >> (k % 64) & 1))
+            continue;
+        if (!any)
+            first = k;
+        else if ((gap = k - last - 1) > max_gap)
+        {
+            max_gap = gap;
+            *min = k;
+        }
+        last = k;
+        any = 1;
+    }
+    if (!any)
+        return GLM_ERR_RANGE;
+
+    /* The gap around the wrap, from the last ID to the first. */
+    gap = GLM_ID_MASK_16 - last + first;
+    if (gap >= max_gap)
+    {
+        max_gap = gap;
+        *min = first;
+    }
+    *span = (size_t)GLM_ID_MASK_16 + 1 - max_gap;
+
+    return 0;
+}
+
+/**
+ * Find the range of a set of IDs. If the IDs are too sparse for a
+ * table over their range, and all fit in 16 bits, the range is taken
+ * around the wrap at 65536.
+ *
+ * @param id The IDs.
+ * @param n Number of IDs.
+ * @param min Pointer that gets the first ID of the range.
+ * @param span Pointer that gets the length of the range, or 0 if
+ * there are no IDs.
+ * @param mask Pointer that gets the mask applied to an ID, less min,
+ * to find its place in the range.
+ *
+ * @return 0 for success, GLM_ERR_RANGE if the IDs are too sparse for
+ * a table.
+ * @author Ed Hartnett
+ */
+static int
+id_span(const unsigned int *id, size_t n, unsigned int *min, size_t *span,
+        unsigned int *mask)
+{
+    unsigned int lo, hi;
+    size_t i;
+
+    *min = 0;
+    *span = 0;
+    *mask = UINT_MAX;
+    if (!n)
+        return 0;
+    for (lo = hi = id[0], i = 1; i < n; i++)
+    {
+        if (id[i] < lo)
+            lo = id[i];
+        if (id[i] > hi)
+            hi = id[i];
+    }
+    *min = lo;
+    *span = (size_t)(hi - lo) + 1;
+    if (*span / GLM_HIER_MAX_SPAN > n && hi <= GLM_ID_MASK_16)
+    {
+        glm_wrapped_range(&id, &n, 1, min, span);
+        *mask = GLM_ID_MASK_16;
+    }
+    if (*span / GLM_HIER_MAX_SPAN > n)
+        return GLM_ERR_RANGE;
+
+    return 0;
+}
+
+/**
+ * Find the index of the record with an ID.
+ *
+ * @param index The map from ID to index.
+ * @param min First ID of the map.
+ * @param span Length of the map.
+ * @param mask Mask of the map.
+ * @param id The ID.
+ *
+ * @return The index, or GLM_NO_INDEX if no record has the ID.
+ * @author Ed Hartnett
+ */
+static size_t
+find_index(const size_t *index, unsigned int min, size_t span,
+           unsigned int mask, unsigned int id)
+{
+    size_t k = (id - min) & mask;
+
+    return id <= mask && k < span ? index[k] : GLM_NO_INDEX;
+}
+
+/**
+ * Fill the map from ID to index.
+ *
+ * @param id The IDs.
+ * @param n Number of IDs.
+ * @param min First ID of the map.
+ * @param span Length of the map.
+ * @param mask Mask of the map.
+ * @param index The map.
+ *
+ * @return 0 for success, GLM_ERR_UNEXPECTED if an ID is used twice.
+ * @author Ed Hartnett
+ */
+static int
+fill_index(const unsigned int *id, size_t n, unsigned int min, size_t span,
+           unsigned int mask, size_t *index)
+{
+    size_t i;
+
+    for (i = 0; i < span; i++)
+        index[i] = GLM_NO_INDEX;
+    for (i = 0; i < n; i++)
+    {
+        size_t k = (id[i] - min) & mask;
+
+        if (index[k] != GLM_NO_INDEX)
+            return GLM_ERR_UNEXPECTED;
+        index[k] = i;
+    }
+
+    return 0;
+}
+
+/**
+ * Find the parent of each child of one chunk, and count the children
+ * of each parent. This is a task for glm_pool_run().
+ *
+ * @param arg Pointer to the GLM_SORT_T.
+ * @param c Index of the chunk.
+ *
+ * @return 0.
+ * @author Ed Hartnett
+ */
+static int
+count_task(void *arg, int c)
+{
+    GLM_SORT_T *s = arg;
+    size_t *count = s->count + c * (s->nparent + 1);
+    size_t lo = c * s->chunk_len, hi = lo + s->chunk_len;
+    size_t i;
+
+    if (hi > s->n)
+        hi = s->n;
+    memset(count, 0, (s->nparent + 1) * sizeof(size_t));
+    for (i = lo; i < hi; i++)
+    {
+        size_t p = find_index(s->index, s->id_min, s->id_span, s->id_mask,
+                              s->parent_id[i]);
+
+        s->parent[i] = p;
+        count[p == GLM_NO_INDEX ? s->nparent : p]++;
+    }
+
+    return 0;
+}
+
+/**
+ * Put the children of one chunk in place. This is a task for
+ * glm_pool_run().
+ *
+ * @param arg Pointer to the GLM_SORT_T.
+ * @param c Index of the chunk.
+ *
+ * @return 0.
+ * @author Ed Hartnett
+ */
+static int
+place_task(void *arg, int c)
+{
+    GLM_SORT_T *s = arg;
+    size_t *pos = s->count + c * (s->nparent + 1);
+    size_t lo = c * s->chunk_len, hi = lo + s->chunk_len;
+    size_t i;
+
+    if (hi > s->n)
+        hi = s->n;
+    for (i = lo; i < hi; i++)
+    {
+        size_t p = s->parent[i];
+
+        s->order[pos[p == GLM_NO_INDEX ? s->nparent : p]++] = i;
+    }
+
+    return 0;
+}
+
+/**
+ * Sort children by parent, with a parallel counting sort.
+ *
+ * @param s Pointer to the sort, with all but the count and chunk_len
+ * set.
+ * @param nthreads Number of threads.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+static int
+sort_children(GLM_SORT_T *s, int nthreads)
+{
+    size_t pos = 0, p;
+    int nchunk, c;
+    int ret;
+
+    nchunk = num_chunks(s->n, nthreads, &s->chunk_len);
+    if (s->nparent + 1 > SIZE_MAX / sizeof(size_t) / nchunk)
+        return GLM_ERR_RANGE;
+    if (!(s->count = glm_malloc(nchunk * (s->nparent + 1) * sizeof(size_t))))
+        return GLM_ERR_MEMORY;
+
+    /* Count the children of each parent in each chunk, then turn the
+     * counts into where each chunk puts its first child of each
+     * parent. */
+    if (!(ret = glm_pool_run(nthreads, nchunk, count_task, s)))
+    {
+        for (p = 0; p <= s->nparent; p++)
+        {
+            s->start[p] = pos;
+            for (c = 0; c < nchunk; c++)
+            {
+                size_t *count = &s->count[c * (s->nparent + 1) + p];
+                size_t n = *count;
+
+                *count = pos;
+                pos += n;
+            }
+        }
+        ret = glm_pool_run(nthreads, nchunk, place_task, s);
+    }
+    glm_free(s->count);
+
+    return ret;
+}
+
+/**
+ * Find the groups of a flash, where flash nflash stands for the
+ * groups with no flash.
+ *
+ * @param hier Pointer to the hierarchy.
+ * @param f Index of the flash.
+ * @param lo Pointer that gets the start of its groups in flash_group.
+ * @param hi Pointer that gets the end.
+ *
+ * @author Ed Hartnett
+ */
+static void
+groups_of(const GLM_HIERARCHY_T *hier, size_t f, size_t *lo, size_t *hi)
+{
+    *lo = hier->flash_group_start[f];
+    *hi = f < hier->nflash ? hier->flash_group_start[f + 1] : hier->ngroup;
+}
+
+/**
+ * Count the events of each flash of one chunk. This is a task for
+ * glm_pool_run().
+ *
+ * @param arg Pointer to the GLM_FLASH_EVENTS_T.
+ * @param c Index of the chunk.
+ *
+ * @return 0.
+ * @author Ed Hartnett
+ */
+static int
+count_flash_events(void *arg, int c)
+{
+    GLM_FLASH_EVENTS_T *fe = arg;
+    GLM_HIERARCHY_T *h = fe->hier;
+    size_t lo = c * fe->chunk_len, hi = lo + fe->chunk_len;
+    size_t f, g, glo, ghi;
+
+    if (hi > h->nflash + 1)
+        hi = h->nflash + 1;
+    for (f = lo; f < hi; f++)
+    {
+        size_t n = 0;
+
+        groups_of(h, f, &glo, &ghi);
+        for (g = glo; g < ghi; g++)
+            n += h->group_event_start[h->flash_group[g] + 1] -
+                h->group_event_start[h->flash_group[g]];
+        h->flash_event_start[f] = n;
+    }
+
+    return 0;
+}
+
+/**
+ * Copy the events of each flash of one chunk, group after group. This
+ * is a task for glm_pool_run().
+ *
+ * @param arg Pointer to the GLM_FLASH_EVENTS_T.
+ * @param c Index of the chunk.
+ *
+ * @return 0.
+ * @author Ed Hartnett
+ */
+static int
+copy_flash_events(void *arg, int c)
+{
+    GLM_FLASH_EVENTS_T *fe = arg;
+    GLM_HIERARCHY_T *h = fe->hier;
+    size_t lo = c * fe->chunk_len, hi = lo + fe->chunk_len;
+    size_t f, g, glo, ghi;
+
+    if (hi > h->nflash + 1)
+        hi = h->nflash + 1;
+    for (f = lo; f < hi; f++)
+    {
+        size_t *dst = h->flash_event + h->flash_event_start[f];
+
+        groups_of(h, f, &glo, &ghi);
+        for (g = glo; g < ghi; g++)
+        {
+            size_t elo = h->group_event_start[h->flash_group[g]];
+            size_t ehi = h->group_event_start[h->flash_group[g] + 1];
+
+            memcpy(dst, h->group_event + elo, (ehi - elo) * sizeof(size_t));
+            dst += ehi - elo;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Gather the events of each flash from the events of its groups.
+ *
+ * @param hier Pointer to the hierarchy, with the groups of each flash
+ * and the events of each group.
+ * @param nthreads Number of threads.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+static int
+gather_flash_events(GLM_HIERARCHY_T *hier, int nthreads)
+{
+    GLM_FLASH_EVENTS_T fe;
+    size_t pos = 0, f, orphan;
+    int nchunk;
+    int ret;
+
+    /* Flash nflash gets the events of the groups with no flash. */
+    fe.hier = hier;
+    nchunk = num_chunks(hier->nflash + 1, nthreads, &fe.chunk_len);
+    if ((ret = glm_pool_run(nthreads, nchunk, count_flash_events, &fe)))
+        return ret;
+    for (f = 0; f <= hier->nflash; f++)
+    {
+        size_t n = hier->flash_event_start[f];
+
+        hier->flash_event_start[f] = pos;
+        pos += n;
+    }
+    if ((ret = glm_pool_run(nthreads, nchunk, copy_flash_events, &fe)))
+        return ret;
+
+    /* The events with no group come last. */
+    orphan = hier->group_event_start[hier->ngroup];
+    memcpy(hier->flash_event + pos, hier->group_event + orphan,
+           (hier->nevent - orphan) * sizeof(size_t));
+
+    return 0;
+}
+
+/**
+ * Index how the events, groups, and flashes of a batch are related:
+ * the groups and events of each flash, the events of each group, the
+ * parent of each event and group, and the index of each group and
+ * flash ID. It takes time in proportion to the number of records, and
+ * the sorts run on several threads.
+ *
+ * The IDs of each kind must be unique, as they are in a GLM file and
+ * in a batch from glm_read_files(). Events and groups whose parent ID
+ * is not in the batch, as at the edges of glm_query_time(), have no
+ * parent.
+ *
+ * Flash IDs are 16-bit counters in a GLM file, which may wrap past
+ * 65535 within a granule; they are indexed around the wrap.
+ *
+ * @param batch Pointer to the batch.
+ * @param nthreads Number of threads. If less than 1, the number of
+ * online processors is used.
+ * @param hier Pointer to a GLM_HIERARCHY_T which gets the index. Free
+ * it with glm_free_hierarchy(). It is left empty on error.
+ *
+ * @return 0 for success, GLM_ERR_RANGE if the IDs of a kind are too
+ * sparse, GLM_ERR_UNEXPECTED if an ID is used twice, other error code
+ * otherwise.
+ * @author Ed Hartnett
+ */
+int
+glm_build_hierarchy(const GLM_BATCH_T *batch, int nthreads,
+                    GLM_HIERARCHY_T *hier)
+{
+    size_t len[NUM_HIER_ARRAYS], offset[NUM_HIER_ARRAYS];
+    size_t **array[NUM_HIER_ARRAYS];
+    GLM_SORT_T s;
+    size_t size;
+    char *block;
+    int a;
+    int ret;
+
+    /* Check inputs. */
+    assert(batch && hier);
+    memset(hier, 0, sizeof(GLM_HIERARCHY_T));
+    nthreads = glm_pool_nthreads(nthreads);
+    hier->nevent = batch->nevent;
+    hier->ngroup = batch->ngroup;
+    hier->nflash = batch->nflash;
+
+    if ((ret = id_span(batch->group_id, batch->ngroup, &hier->group_id_min,
+                       &hier->group_id_span, &hier->group_id_mask)) ||
+        (ret = id_span(batch->flash_id, batch->nflash, &hier->flash_id_min,
+                       &hier->flash_id_span, &hier->flash_id_mask)))
+    {
+        memset(hier, 0, sizeof(GLM_HIERARCHY_T));
+        return ret;
+    }
+
+    /* Lay out the arrays in one block. */
+    array[0] = &hier->flash_group_start;
+    len[0] = hier->nflash + 1;
+    array[1] = &hier->flash_group;
+    len[1] = hier->ngroup;
+    array[2] = &hier->group_event_start;
+    len[2] = hier->ngroup + 1;
+    array[3] = &hier->group_event;
+    len[3] = hier->nevent;
+    array[4] = &hier->flash_event_start;
+    len[4] = hier->nflash + 1;
+    array[5] = &hier->flash_event;
+    len[5] = hier->nevent;
+    array[6] = &hier->event_group;
+    len[6] = hier->nevent;
+    array[7] = &hier->group_flash;
+    len[7] = hier->ngroup;
+    array[8] = &hier->group_index;
+    len[8] = hier->group_id_span;
+    array[9] = &hier->flash_index;
+    len[9] = hier->flash_id_span;
+    for (a = 0; a < NUM_HIER_ARRAYS; a++)
+    {
+        if (len[a] > SIZE_MAX / sizeof(size_t))
+            ret = GLM_ERR_RANGE;
+        len[a] = (len[a] ? len[a] : 1) * sizeof(size_t);
+    }
+    if (ret || (ret = glm_block_layout(NUM_HIER_ARRAYS, len, offset, &size)) ||
+        (ret = glm_alloc_block(size, &hier->block)))
+    {
+        memset(hier, 0, sizeof(GLM_HIERARCHY_T));
+        return ret;
+    }
+    block = hier->block;
+    for (a = 0; a < NUM_HIER_ARRAYS; a++)
+        *array[a] = (size_t *)(block + offset[a]);
+
+    /* Map IDs to indexes. */
+    if (!(ret = fill_index(batch->group_id, hier->ngroup, hier->group_id_min,
+                           hier->group_id_span, hier->group_id_mask,
+                           hier->group_index)))
+        ret = fill_index(batch->flash_id, hier->nflash, hier->flash_id_min,
+                         hier->flash_id_span, hier->flash_id_mask,
+                         hier->flash_index);
+
+    /* Sort the events by group. */
+    if (!ret)
+    {
+        s.n = hier->nevent;
+        s.parent_id = batch->event_parent_group_id;
+        s.id_min = hier->group_id_min;
+        s.id_span = hier->group_id_span;
+        s.id_mask = hier->group_id_mask;
+        s.index = hier->group_index;
+        s.nparent = hier->ngroup;
+        s.parent = hier->event_group;
+        s.start = hier->group_event_start;
+        s.order = hier->group_event;
+        ret = sort_children(&s, nthreads);
+    }
+
+    /* Sort the groups by flash. */
+    if (!ret)
+    {
+        s.n = hier->ngroup;
+        s.parent_id = batch->group_parent_flash_id;
+        s.id_min = hier->flash_id_min;
+        s.id_span = hier->flash_id_span;
+        s.id_mask = hier->flash_id_mask;
+        s.index = hier->flash_index;
+        s.nparent = hier->nflash;
+        s.parent = hier->group_flash;
+        s.start = hier->flash_group_start;
+        s.order = hier->flash_group;
+        ret = sort_children(&s, nthreads);
+    }
+
+    if (!ret)
+        ret = gather_flash_events(hier, nthreads);
+    if (ret)
+        glm_free_hierarchy(hier);
+
+    return ret;
+}
+
+/**
+ * Free the arrays of a hierarchy. The struct itself is not freed, and
+ * is left empty, so it is safe to free a hierarchy twice.
+ *
+ * @param hier Pointer to the hierarchy.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+int
+glm_free_hierarchy(GLM_HIERARCHY_T *hier)
+{
+    /* Check inputs. */
+    assert(hier);
+
+    glm_free(hier->block);
+    memset(hier, 0, sizeof(GLM_HIERARCHY_T));
+
+    return 0;
+}
+
+/**
+ * Get the groups of a flash.
+ *
+ * @param hier Pointer to the hierarchy.
+ * @param flash Index of the flash in the batch.
+ * @param group Pointer that gets the indexes of its groups, in file
+ * order. They belong to the hierarchy.
+ * @param ngroup Pointer that gets the number of groups.
+ *
+ * @return 0 for success, GLM_ERR_RANGE if there is no such flash.
+ * @author Ed Hartnett
+ */
+int
+glm_flash_groups(const GLM_HIERARCHY_T *hier, size_t flash,
+                 const size_t **group, size_t *ngroup)
+{
+    /* Check inputs. */
+    assert(hier && group && ngroup);
+
+    if (flash >= hier->nflash)
+        return GLM_ERR_RANGE;
+    *group = hier->flash_group + hier->flash_group_start[flash];
+    *ngroup = hier->flash_group_start[flash + 1] -
+        hier->flash_group_start[flash];
+
+    return 0;
+}
+
+/**
+ * Get the events of a flash, which are those of its groups, group
+ * after group.
+ *
+ * @param hier Pointer to the hierarchy.
+ * @param flash Index of the flash in the batch.
+ * @param event Pointer that gets the indexes of its events. They
+ * belong to the hierarchy.
+ * @param nevent Pointer that gets the number of events.
+ *
+ * @return 0 for success, GLM_ERR_RANGE if there is no such flash.
+ * @author Ed Hartnett
+ */
+int
+glm_flash_events(const GLM_HIERARCHY_T *hier, size_t flash,
+                 const size_t **event, size_t *nevent)
+{
+    /* Check inputs. */
+    assert(hier && event && nevent);
+
+    if (flash >= hier->nflash)
+        return GLM_ERR_RANGE;
+    *event = hier->flash_event + hier->flash_event_start[flash];
+    *nevent = hier->flash_event_start[flash + 1] -
+        hier->flash_event_start[flash];
+
+    return 0;
+}
+
+/**
+ * Get the events of a group.
+ *
+ * @param hier Pointer to the hierarchy.
+ * @param group Index of the group in the batch.
+ * @param event Pointer that gets the indexes of its events, in file
+ * order. They belong to the hierarchy.
+ * @param nevent Pointer that gets the number of events.
+ *
+ * @return 0 for success, GLM_ERR_RANGE if there is no such group.
+ * @author Ed Hartnett
+ */
+int
+glm_group_events(const GLM_HIERARCHY_T *hier, size_t group,
+                 const size_t **event, size_t *nevent)
+{
+    /* Check inputs. */
+    assert(hier && event && nevent);
+
+    if (group >= hier->ngroup)
+        return GLM_ERR_RANGE;
+    *event = hier->group_event + hier->group_event_start[group];
+    *nevent = hier->group_event_start[group + 1] -
+        hier->group_event_start[group];
+
+    return 0;
+}
+
+/**
+ * Find the index of a group from its ID.
+ *
+ * @param hier Pointer to the hierarchy.
+ * @param id ID of the group.
+ * @param group Pointer that gets the index of the group in the batch.
+ *
+ * @return 0 for success, GLM_ERR_RANGE if no group has the ID.
+ * @author Ed Hartnett
+ */
+int
+glm_group_index(const GLM_HIERARCHY_T *hier, unsigned int id, size_t *group)
+{
+    size_t i;
+
+    /* Check inputs. */
+    assert(hier && group);
+
+    if ((i = find_index(hier->group_index, hier->group_id_min, hier->group_id_span,
+                        hier->group_id_mask, id)) == GLM_NO_INDEX)
+        return GLM_ERR_RANGE;
+    *group = i;
+
+    return 0;
+}
+
+/**
+ * Find the index of a flash from its ID.
+ *
+ * @param hier Pointer to the hierarchy.
+ * @param id ID of the flash.
+ * @param flash Pointer that gets the index of the flash in the batch.
+ *
+ * @return 0 for success, GLM_ERR_RANGE if no flash has the ID.
+ * @author Ed Hartnett
+ */
+int
+glm_flash_index(const GLM_HIERARCHY_T *hier, unsigned int id, size_t *flash)
+{
+    size_t i;
+
+    /* Check inputs. */
+    assert(hier && flash);
+
+    if ((i = find_index(hier->flash_index, hier->flash_id_min, hier->flash_id_span,
+                        hier->flash_id_mask, id)) == GLM_NO_INDEX)
+        return GLM_ERR_RANGE;
+    *flash = i;
+
+    return 0;
+}
+
+/**
+ * Reorder the records of a batch so that the records of each flash
+ * are next to each other: groups are put in order of their flash, and
+ * events in order of their group, with the groups and events of each
+ * flash in file order. The groups of each flash, the events of each
+ * group, and the events of each flash are then each one run of
+ * records, in flash order, so per-flash work streams through memory.
+ * Flashes and scalars are not moved. Records whose parent is not in
+ * the batch come last.
+ *
+ * IDs are not changed, so a hierarchy may be built of the reordered
+ * batch; its group_event, flash_group, and flash_event arrays are
+ * then 0, 1, 2, and so on.
+ *
+ * @param batch Pointer to the batch.
+ * @param nthreads Number of threads. If less than 1, the number of
+ * online processors is used.
+ * @param out Pointer to a GLM_BATCH_T which gets the reordered
+ * records. Free it with glm_free_batch(). It is left empty on error.
+ * @param event_perm Array of batch->nevent which gets the index in
+ * batch of each event of out. Ignored if NULL.
+ * @param group_perm Array of batch->ngroup which gets the index in
+ * batch of each group of out. Ignored if NULL.
+ *
+ * @return 0 for success, error code otherwise, as for
+ * glm_build_hierarchy().
+ * @author Ed Hartnett
+ */
+int
+glm_cluster_batch(const GLM_BATCH_T *batch, int nthreads, GLM_BATCH_T *out,
+                  size_t *event_perm, size_t *group_perm)
+{
+    GLM_HIERARCHY_T hier;
+    const size_t *idx[3];
+    int ret;
+
+    /* Check inputs. */
+    assert(batch && out && batch != out);
+    memset(out, 0, sizeof(GLM_BATCH_T));
+
+    if ((ret = glm_build_hierarchy(batch, nthreads, &hier)))
+        return ret;
+
+    /* The events of each flash, and the groups of each flash, are
+     * already in the order wanted. */
+    idx[GLM_COUNT_EVENT] = hier.flash_event;
+    idx[GLM_COUNT_GROUP] = hier.flash_group;
+    idx[GLM_COUNT_FLASH] = NULL;
+    if (!(ret = glm_batch_alloc(out, NULL, batch->nfile, batch->nevent,
+                                batch->ngroup, batch->nflash)) &&
+        (ret = glm_batch_gather(batch, out, idx, nthreads)))
+        glm_free_batch(out);
+    if (!ret && event_perm)
+        memcpy(event_perm, hier.flash_event, batch->nevent * sizeof(size_t));
+    if (!ret && group_perm)
+        memcpy(group_perm, hier.flash_group, batch->ngroup * sizeof(size_t));
+    glm_free_hierarchy(&hier);
+
+    return ret;
+}
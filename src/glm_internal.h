@@ -0,0 +1,302 @@
+/**
+ * @file
+ * Internal header file for the ncglm library. This is not installed,
+ * and is only included by library code.
+ *
+ * @author Ed Hartnett
+ */
+#ifndef _GLM_INTERNAL_H
+#define _GLM_INTERNAL_H
+
+#include "ncglm.h"
+
+/* Name given to netCDF for files opened with glm_open_mem(). */
+#define GLM_MEM_NAME "glm_mem"
+
+/* Sections of the variable table. Each section can be resolved
+ * independently, so that the ncid-based readers only look up the
+ * metadata they need. */
+#define GLM_SECTION_EVENT 1
+#define GLM_SECTION_GROUP 2
+#define GLM_SECTION_FLASH 4
+#define GLM_SECTION_SCALAR 8
+#define GLM_SECTION_ALL (GLM_SECTION_EVENT | GLM_SECTION_GROUP | \
+                         GLM_SECTION_FLASH | GLM_SECTION_SCALAR)
+
+/** Index of each variable in the variable table of GLM_FILE_T. The
+ * order must match the table of names in glm_file.c. The GLM_EV_*,
+ * GLM_GR_* and GLM_FL_* field bits are 1 << the index of the variable
+ * from the start of its section. */
+enum {
+    GLM_VAR_EVENT_ID,
+    GLM_VAR_EVENT_TIME_OFFSET,
+    GLM_VAR_EVENT_LAT,
+    GLM_VAR_EVENT_LON,
+    GLM_VAR_EVENT_ENERGY,
+    GLM_VAR_EVENT_PARENT_GROUP_ID,
+    GLM_VAR_GROUP_ID,
+    GLM_VAR_GROUP_TIME_OFFSET,
+    GLM_VAR_GROUP_FRAME_TIME_OFFSET,
+    GLM_VAR_GROUP_LAT,
+    GLM_VAR_GROUP_LON,
+    GLM_VAR_GROUP_AREA,
+    GLM_VAR_GROUP_ENERGY,
+    GLM_VAR_GROUP_PARENT_FLASH_ID,
+    GLM_VAR_GROUP_QUALITY_FLAG,
+    GLM_VAR_FLASH_ID,
+    GLM_VAR_FLASH_TIME_OFFSET_OF_FIRST_EVENT,
+    GLM_VAR_FLASH_TIME_OFFSET_OF_LAST_EVENT,
+    GLM_VAR_FLASH_FRAME_TIME_OFFSET_OF_FIRST_EVENT,
+    GLM_VAR_FLASH_FRAME_TIME_OFFSET_OF_LAST_EVENT,
+    GLM_VAR_FLASH_LAT,
+    GLM_VAR_FLASH_LON,
+    GLM_VAR_FLASH_AREA,
+    GLM_VAR_FLASH_ENERGY,
+    GLM_VAR_FLASH_QUALITY_FLAG,
+    GLM_VAR_PRODUCT_TIME,
+    GLM_VAR_PRODUCT_TIME_BOUNDS,
+    GLM_VAR_LIGHTNING_WAVELENGTH,
+    GLM_VAR_LIGHTNING_WAVELENGTH_BOUNDS,
+    GLM_VAR_GROUP_TIME_THRESHOLD,
+    GLM_VAR_FLASH_TIME_THRESHOLD,
+    GLM_VAR_LAT_FIELD_OF_VIEW,
+    GLM_VAR_LAT_FIELD_OF_VIEW_BOUNDS,
+    GLM_VAR_GOES_LAT_LON_PROJECTION,
+    GLM_VAR_EVENT_COUNT,
+    GLM_VAR_GROUP_COUNT,
+    GLM_VAR_FLASH_COUNT,
+    GLM_VAR_PERCENT_NAVIGATED_L1B_EVENTS,
+    GLM_VAR_YAW_FLIP_FLAG,
+    GLM_VAR_NOMINAL_SATELLITE_SUBPOINT_LAT,
+    GLM_VAR_NOMINAL_SATELLITE_HEIGHT,
+    GLM_VAR_NOMINAL_SATELLITE_SUBPOINT_LON,
+    GLM_VAR_LON_FIELD_OF_VIEW,
+    GLM_VAR_LON_FIELD_OF_VIEW_BOUNDS,
+    GLM_VAR_PERCENT_UNCORRECTABLE_L0_ERRORS,
+    GLM_VAR_ALGORITHM_DYNAMIC_INPUT_DATA_CONTAINER,
+    GLM_VAR_PROCESSING_PARM_VERSION_CONTAINER,
+    GLM_VAR_ALGORITHM_PRODUCT_VERSION_CONTAINER,
+    GLM_NUM_VARS
+};
+
+/** Cached metadata for one variable. For variables which are not
+ * packed, scale is 1.0 and offset is 0.0. */
+typedef struct GLM_VAR
+{
+    int varid;    /**< Varid, or -1 if not resolved. */
+    nc_type xtype; /**< Type of the variable in the file. */
+    float scale;  /**< Value of the scale_factor attribute. */
+    float offset; /**< Value of the add_offset attribute. */
+    int skip;     /**< Non-zero if readers skip it, see glm_set_fields(). */
+} GLM_VAR_T;
+
+/** Direct chunk read state of a handle, private to glm_direct.c. */
+typedef struct GLM_DIRECT GLM_DIRECT_T;
+
+/** The GLM file handle. All the metadata the readers need is
+ * resolved once, when the handle is initialized. */
+struct GLM_FILE
+{
+    int ncid;     /**< The netCDF ID. */
+    int own_ncid; /**< Non-zero if glm_close() must close ncid. */
+    int sections; /**< Sections of the var table which are resolved. */
+    size_t nevent; /**< Length of the number_of_events dimension. */
+    size_t ngroup; /**< Length of the number_of_groups dimension. */
+    size_t nflash; /**< Length of the number_of_flashes dimension. */
+    GLM_VAR_T var[GLM_NUM_VARS]; /**< Table of cached var metadata. */
+    void *scratch;       /**< Scratch buffer reused by struct reads. */
+    size_t scratch_size; /**< Size of the scratch buffer in bytes. */
+    int nthreads;        /**< Threads which read the columns of a read. */
+    char *path;          /**< Name of the file, if opened by glm_open(). */
+    GLM_DIRECT_T *direct; /**< Direct read state, or NULL if off. */
+    int64_t time_base;    /**< product_time, in ns since the Unix epoch. */
+};
+
+/* Types of output column. */
+#define GLM_COL_FLOAT 1 /* float, from a float or packed short var. */
+#define GLM_COL_INT 2   /* int or unsigned int, from an int or short var. */
+#define GLM_COL_SHORT 3 /* short, from a short var. */
+
+/** One column of output: where and how to store the values of one
+ * variable. For arrays the stride is the size of the output type,
+ * for arrays of struct it is the size of the struct. */
+typedef struct GLM_COLUMN
+{
+    int var;       /**< Index of the variable in the var table. */
+    int type;      /**< One of the GLM_COL_* output types. */
+    void *data;    /**< Address of the first output value. */
+    size_t stride; /**< Bytes between output values. */
+    void *time;    /**< Address of the first time in ns, or NULL. */
+    size_t time_stride; /**< Bytes between times. */
+} GLM_COLUMN_T;
+
+/* Resolve dimensions and the requested sections of the var table. */
+int glm_file_init(int ncid, int sections, GLM_FILE_T *glm);
+
+/* Free resources held by a handle, without closing the file. */
+void glm_file_free(GLM_FILE_T *glm);
+
+/* Get the scratch buffer of a handle, growing it if needed. */
+int glm_file_scratch(GLM_FILE_T *glm, size_t size, void **scratch);
+
+/* Fill in a column description. */
+void glm_set_column(GLM_COLUMN_T *col, int var, int type, void *data,
+                    size_t stride);
+
+/* Get the packing of a variable. */
+void glm_get_packing(GLM_FILE_T *glm, int var, GLM_PACKING_T *packing);
+
+/* Also decode a time offset column to ns since the Unix epoch. */
+void glm_set_column_time(GLM_COLUMN_T *col, int64_t *time, size_t stride);
+
+/* Read and unpack a range of values of several variables. */
+int glm_read_columns(GLM_FILE_T *glm, size_t start, size_t count,
+                     int ncol, GLM_COLUMN_T *col);
+
+/* Read values as they are in the file, and unpack them, from
+ * glm_column.c. */
+int glm_column_src_size(GLM_VAR_T *var, size_t *size);
+int glm_column_read_raw(GLM_FILE_T *glm, int v, size_t start, size_t count,
+                        void *buf);
+int glm_column_unpack(GLM_FILE_T *glm, GLM_COLUMN_T *col, void *buf,
+                      size_t count);
+
+/* Filters undone by direct chunk reads. */
+#define GLM_H5_DEFLATE 1 /* zlib deflate. */
+#define GLM_H5_SHUFFLE 2 /* Byte shuffle. */
+
+/* Direct chunk reads, from glm_direct.c. */
+int glm_direct_read(GLM_FILE_T *glm, int v, size_t start, size_t count,
+                    void *buf, int *done);
+int glm_direct_decode(const void *src, size_t src_len, int nfilter,
+                      const int *filter, unsigned int mask, size_t size,
+                      void *dst, size_t dst_len);
+void glm_direct_free(GLM_FILE_T *glm);
+
+/** Most predicates made from one GLM_FILTER_T. */
+#define GLM_MAX_PREDS 5
+
+/** A predicate on one variable. A row passes if min <= value <= max,
+ * where value is the value of the variable unpacked as type. */
+typedef struct GLM_PRED
+{
+    int var;   /**< Index of the variable in the var table. */
+    int type;  /**< GLM_COL_FLOAT or GLM_COL_SHORT. */
+    float min; /**< Smallest value which passes. */
+    float max; /**< Largest value which passes. */
+} GLM_PRED_T;
+
+/* Filtered reads, from glm_filter.c. */
+void glm_filter_preds(const GLM_FILTER_T *filter, int section,
+                      GLM_PRED_T *pred, int *npred);
+int glm_read_columns_filter(GLM_FILE_T *glm, size_t start, size_t count,
+                            int npred, const GLM_PRED_T *pred, int ncol,
+                            GLM_COLUMN_T *col, size_t *nmatch);
+
+/* Levels of the unpacking kernels, from slowest to fastest. */
+#define GLM_SIMD_SCALAR 0 /* Plain C. */
+#define GLM_SIMD_SSE2 1   /* x86 SSE2. */
+#define GLM_SIMD_AVX2 2   /* x86 AVX2. */
+#define GLM_SIMD_AVX512 3 /* x86 AVX-512F. */
+
+/* Find or choose the level of the unpacking kernels. */
+int glm_unpack_level(void);
+int glm_unpack_set_level(int level);
+
+/* Unpacking kernels, from glm_unpack.c. */
+void glm_unpack_ushort(const unsigned short *src, size_t n, float scale,
+                       float offset, void *dst, size_t stride);
+void glm_unpack_ushort_ns(const unsigned short *src, size_t n, float scale,
+                          float offset, int64_t base, void *dst,
+                          size_t stride);
+void glm_copy_4(const void *src, size_t n, void *dst, size_t stride);
+void glm_copy_2(const short *src, size_t n, void *dst, size_t stride);
+void glm_widen_ushort(const unsigned short *src, size_t n, void *dst,
+                      size_t stride);
+
+/* Matching kernels for filtered reads, from glm_unpack.c. */
+int glm_ushort_range(float scale, float offset, float min, float max,
+                     unsigned short *lo, unsigned short *span);
+void glm_match_ushort(const unsigned short *src, size_t n, unsigned short lo,
+                      unsigned short span, unsigned char *match);
+void glm_match_float(const float *src, size_t n, float min, float max,
+                     unsigned char *match);
+
+/** A task run by glm_pool_run(). It returns 0 for success, or an
+ * error code. */
+typedef int (*glm_task_fn)(void *arg, int i);
+
+/* Threading, from glm_pool.c. */
+void glm_nc_lock(void);
+void glm_nc_unlock(void);
+int glm_pool_nthreads(int nthreads);
+int glm_pool_run(int nthreads, int ntask, glm_task_fn task, void *arg);
+
+/* Read all the data of one file into a batch, from glm_batch.c. */
+int glm_read_file_batch(const char *path, GLM_BATCH_T *batch);
+
+/* Allocate the columns of a batch, from glm_batch.c. */
+int glm_batch_alloc(GLM_BATCH_T *batch, size_t *block_size, size_t nfile,
+                    size_t nevent, size_t ngroup, size_t nflash);
+
+/* Read all the data of an open file into a batch, reusing its block,
+ * from glm_batch.c. */
+int glm_batch_read(GLM_FILE_T *glm, GLM_BATCH_T *batch, size_t *block_size);
+
+/* Copy chosen records of a batch into another, from glm_batch.c. */
+int glm_batch_gather(const GLM_BATCH_T *src, GLM_BATCH_T *dst,
+                     const size_t *const *idx, int nthreads);
+
+/* Which count gives the length of a batch column. */
+#define GLM_COUNT_EVENT 0
+#define GLM_COUNT_GROUP 1
+#define GLM_COUNT_FLASH 2
+#define GLM_COUNT_FILE 3
+
+/** One column of a GLM_BATCH_T. */
+typedef struct GLM_BATCH_COL
+{
+    size_t field; /**< Offset of the column pointer in GLM_BATCH_T. */
+    int count;    /**< Which count gives its length, GLM_COUNT_*. */
+    size_t size;  /**< Size of each value in bytes. */
+} GLM_BATCH_COL_T;
+
+/** Number of columns of a GLM_BATCH_T, counting the scalars. */
+#define GLM_NUM_BATCH_COLS 28
+
+/* The columns of a batch, in the order they are laid out, from
+ * glm_batch.c. */
+extern const GLM_BATCH_COL_T glm_batch_col[GLM_NUM_BATCH_COLS];
+size_t glm_batch_col_len(const GLM_BATCH_COL_T *col, size_t nfile,
+                         size_t nevent, size_t ngroup, size_t nflash);
+
+/* List the GLM files of a directory, from glm_catalog.c. */
+int glm_catalog_scan(const char *dir, GLM_CATALOG_ENTRY_T **entry,
+                     size_t *nentry);
+
+/** Mask of IDs which are 16-bit counters in the file, and may wrap
+ * within a granule, such as flash IDs. */
+#define GLM_ID_MASK_16 0xffffu
+
+/* Find the range of 16-bit IDs which may wrap, from glm_hierarchy.c. */
+int glm_wrapped_range(const unsigned int *const *id, const size_t *n, int nset,
+                      unsigned int *min, size_t *span);
+
+/** Alignment of each array carved from a block, in bytes. */
+#define GLM_ALIGN 64
+
+/* Allocation through the allocator hooks, from glm_alloc.c. */
+void *glm_aligned_alloc(size_t size, size_t align);
+void *glm_malloc(size_t size);
+void *glm_calloc(size_t n, size_t size);
+void glm_free(void *ptr);
+char *glm_strdup(const char *s);
+int glm_block_layout(int n, const size_t *len, size_t *offset, size_t *size);
+int glm_alloc_block(size_t size, void **block);
+
+/* Byte order, and read-only file mappings, from glm_alloc.c. */
+int glm_little_endian(void);
+int glm_map_file(const char *path, size_t min_size, int size_err, void **map,
+                 size_t *length);
+
+#endif /* _GLM_INTERNAL_H */
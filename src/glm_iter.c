@@ -0,0 +1,405 @@
+/**
+ * @file
+ * Code to iterate over the events, groups, or flashes of a GLM file
+ * in fixed-size batches, so that memory use does not depend on the
+ * size of the file.
+ *
+ * @author Ed Hartnett
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "glm_internal.h"
+
+/** Number of slots in the chunk cache hash table. This is the netCDF
+ * default. */
+#define CHUNK_CACHE_NELEMS 1009
+
+/** Chunk cache preemption. This is the netCDF default. */
+#define CHUNK_CACHE_PREEMPTION 0.75
+
+/** The chunk cache settings of a variable. */
+typedef struct GLM_CHUNK_CACHE
+{
+    int set;          /**< Non-zero if the iterator changed them. */
+    size_t size;      /**< Size of the cache in bytes. */
+    size_t nelems;    /**< Number of slots in the hash table. */
+    float preemption; /**< Preemption, from 0 to 1. */
+} GLM_CHUNK_CACHE_T;
+
+/** An iterator over the events, groups, or flashes of a file. */
+struct GLM_ITER
+{
+    GLM_FILE_T *glm;  /**< The file handle. */
+    int section;      /**< GLM_SECTION_EVENT, _GROUP, or _FLASH. */
+    size_t batch_len; /**< Most elements returned by each call. */
+    size_t next;      /**< Index of the next element to return. */
+    size_t len;       /**< Number of elements in the file. */
+    GLM_CHUNK_CACHE_T cache[GLM_NUM_VARS]; /**< Caches before open. */
+};
+
+/**
+ * Put back the chunk caches which set_chunk_caches() changed.
+ *
+ * @param glm Pointer to the GLM file handle.
+ * @param cache The chunk cache settings from before.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+static int
+restore_chunk_caches(GLM_FILE_T *glm, GLM_CHUNK_CACHE_T *cache)
+{
+    int v;
+    int ret, ret1 = 0;
+
+    for (v = 0; v < GLM_NUM_VARS; v++)
+    {
+        if (!cache[v].set)
+            continue;
+        if ((ret = nc_set_var_chunk_cache(glm->ncid, glm->var[v].varid,
+                                          cache[v].size, cache[v].nelems,
+                                          cache[v].preemption)) && !ret1)
+            ret1 = ret;
+        cache[v].set = 0;
+    }
+    if (ret1)
+        NC_ERR(ret1);
+
+    return 0;
+}
+
+/**
+ * Size the chunk caches of a range of variables so that each holds
+ * the chunks touched by one batch, and no more. Each batch then
+ * decompresses each chunk once, and the cache does not grow with the
+ * file. The settings from before are kept, to be put back by
+ * restore_chunk_caches().
+ *
+ * @param glm Pointer to the GLM file handle.
+ * @param first Index of first variable in the var table.
+ * @param last One past the index of the last variable.
+ * @param batch_len Number of elements in each batch.
+ * @param cache Array of GLM_NUM_VARS which gets the settings from
+ * before of each variable changed. It must start with none set.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+static int
+set_chunk_caches(GLM_FILE_T *glm, int first, int last, size_t batch_len,
+                 GLM_CHUNK_CACHE_T *cache)
+{
+    int v;
+    int ret;
+
+    for (v = first; v < last; v++)
+    {
+        GLM_VAR_T *var = &glm->var[v];
+        size_t chunk_len, nchunk, type_size;
+        int storage;
+
+        if ((ret = nc_inq_var_chunking(glm->ncid, var->varid, &storage,
+                                       &chunk_len)))
+            NC_ERR(ret);
+        if (storage != NC_CHUNKED || !chunk_len)
+            continue;
+
+        /* A batch which does not start on a chunk boundary touches
+         * one more chunk. */
+        nchunk = batch_len / chunk_len + 2;
+        type_size = var->xtype == NC_SHORT ? sizeof(short) : sizeof(int);
+        if ((ret = nc_get_var_chunk_cache(glm->ncid, var->varid,
+                                          &cache[v].size, &cache[v].nelems,
+                                          &cache[v].preemption)))
+            NC_ERR(ret);
+        cache[v].set = 1;
+        if ((ret = nc_set_var_chunk_cache(glm->ncid, var->varid,
+                                          nchunk * chunk_len * type_size,
+                                          CHUNK_CACHE_NELEMS,
+                                          CHUNK_CACHE_PREEMPTION)))
+            NC_ERR(ret);
+    }
+
+    return 0;
+}
+
+/**
+ * Create an iterator.
+ *
+ * @param glm Pointer to the GLM file handle, from glm_open().
+ * @param section GLM_SECTION_EVENT, GLM_SECTION_GROUP, or
+ * GLM_SECTION_FLASH.
+ * @param batch_len Most elements returned by each call to next.
+ * @param iterp Pointer that gets the iterator.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+static int
+iter_open(GLM_FILE_T *glm, int section, size_t batch_len, GLM_ITER_T **iterp)
+{
+    GLM_ITER_T *iter;
+    int first, last;
+    int ret;
+
+    /* Check inputs. */
+    assert(glm && iterp && (glm->sections & section));
+    if (!batch_len)
+        return GLM_ERR_RANGE;
+
+    if (!(iter = glm_calloc(1, sizeof(GLM_ITER_T))))
+        return GLM_ERR_MEMORY;
+    iter->glm = glm;
+    iter->section = section;
+    iter->batch_len = batch_len;
+    iter->next = 0;
+
+    switch (section)
+    {
+    case GLM_SECTION_EVENT:
+        iter->len = glm->nevent;
+        first = GLM_VAR_EVENT_ID;
+        last = GLM_VAR_GROUP_ID;
+        break;
+    case GLM_SECTION_GROUP:
+        iter->len = glm->ngroup;
+        first = GLM_VAR_GROUP_ID;
+        last = GLM_VAR_FLASH_ID;
+        break;
+    default:
+        iter->len = glm->nflash;
+        first = GLM_VAR_FLASH_ID;
+        last = GLM_VAR_PRODUCT_TIME;
+    }
+
+    glm_nc_lock();
+    if ((ret = set_chunk_caches(glm, first, last, batch_len, iter->cache)))
+        restore_chunk_caches(glm, iter->cache);
+    glm_nc_unlock();
+    if (ret)
+    {
+        glm_free(iter);
+        return ret;
+    }
+
+    *iterp = iter;
+
+    return 0;
+}
+
+/**
+ * Find the range of the next batch. The iterator is only advanced
+ * past it once it has been read, with iter_advance(), so a batch
+ * which fails to read is read again by the next call.
+ *
+ * @param iter Pointer to the iterator.
+ * @param section Section the caller expects the iterator to be for.
+ * @param start Pointer that gets the index of the first element.
+ * @param count Pointer that gets the number of elements, 0 at the
+ * end.
+ *
+ * @author Ed Hartnett
+ */
+static void
+iter_range(GLM_ITER_T *iter, int section, size_t *start, size_t *count)
+{
+    assert(iter && iter->section == section && start && count);
+
+    *start = iter->next;
+    *count = iter->len - iter->next;
+    if (*count > iter->batch_len)
+        *count = iter->batch_len;
+}
+
+/**
+ * Advance the iterator past a batch, if it was read.
+ *
+ * @param iter Pointer to the iterator.
+ * @param ret Return code of the read of the batch.
+ * @param count Pointer to the number of elements of the batch. It is
+ * set to 0 if the read failed.
+ *
+ * @return ret.
+ * @author Ed Hartnett
+ */
+static int
+iter_advance(GLM_ITER_T *iter, int ret, size_t *count)
+{
+    if (ret)
+        *count = 0;
+    else
+        iter->next += *count;
+
+    return ret;
+}
+
+/**
+ * Open an iterator over the events of a file.
+ *
+ * @param glm Pointer to the GLM file handle, from glm_open(). It must
+ * stay open until the iterator is closed.
+ * @param batch_len Most events returned by each call to
+ * glm_event_iter_next().
+ * @param iter Pointer that gets the iterator. Free it with
+ * glm_iter_close().
+ *
+ * @return 0 for success, GLM_ERR_RANGE if batch_len is 0, other error
+ * code otherwise.
+ * @author Ed Hartnett
+ */
+int
+glm_event_iter_open(GLM_FILE_T *glm, size_t batch_len, GLM_ITER_T **iter)
+{
+    return iter_open(glm, GLM_SECTION_EVENT, batch_len, iter);
+}
+
+/**
+ * Read and unpack the next batch of events.
+ *
+ * @param iter Pointer to the iterator, from glm_event_iter_open().
+ * @param event Pointer to already-allocated array of GLM_EVENT_T,
+ * with room for batch_len events.
+ * @param count Pointer that gets the number of events read. It is 0
+ * when all the events have been read, or on error.
+ *
+ * @return 0 for success, error code otherwise. On error the iterator
+ * is not advanced, so the next call reads the same batch.
+ * @author Ed Hartnett
+ */
+int
+glm_event_iter_next(GLM_ITER_T *iter, GLM_EVENT_T *event, size_t *count)
+{
+    size_t start;
+    int ret;
+
+    iter_range(iter, GLM_SECTION_EVENT, &start, count);
+    if (!*count)
+        return 0;
+
+    ret = glm_read_event_range(iter->glm, start, *count, event);
+
+    return iter_advance(iter, ret, count);
+}
+
+/**
+ * Open an iterator over the groups of a file.
+ *
+ * @param glm Pointer to the GLM file handle, from glm_open(). It must
+ * stay open until the iterator is closed.
+ * @param batch_len Most groups returned by each call to
+ * glm_group_iter_next().
+ * @param iter Pointer that gets the iterator. Free it with
+ * glm_iter_close().
+ *
+ * @return 0 for success, GLM_ERR_RANGE if batch_len is 0, other error
+ * code otherwise.
+ * @author Ed Hartnett
+ */
+int
+glm_group_iter_open(GLM_FILE_T *glm, size_t batch_len, GLM_ITER_T **iter)
+{
+    return iter_open(glm, GLM_SECTION_GROUP, batch_len, iter);
+}
+
+/**
+ * Read and unpack the next batch of groups.
+ *
+ * @param iter Pointer to the iterator, from glm_group_iter_open().
+ * @param group Pointer to already-allocated array of GLM_GROUP_T,
+ * with room for batch_len groups.
+ * @param count Pointer that gets the number of groups read. It is 0
+ * when all the groups have been read, or on error.
+ *
+ * @return 0 for success, error code otherwise. On error the iterator
+ * is not advanced, so the next call reads the same batch.
+ * @author Ed Hartnett
+ */
+int
+glm_group_iter_next(GLM_ITER_T *iter, GLM_GROUP_T *group, size_t *count)
+{
+    size_t start;
+    int ret;
+
+    iter_range(iter, GLM_SECTION_GROUP, &start, count);
+    if (!*count)
+        return 0;
+
+    ret = glm_read_group_range(iter->glm, start, *count, group);
+
+    return iter_advance(iter, ret, count);
+}
+
+/**
+ * Open an iterator over the flashes of a file.
+ *
+ * @param glm Pointer to the GLM file handle, from glm_open(). It must
+ * stay open until the iterator is closed.
+ * @param batch_len Most flashes returned by each call to
+ * glm_flash_iter_next().
+ * @param iter Pointer that gets the iterator. Free it with
+ * glm_iter_close().
+ *
+ * @return 0 for success, GLM_ERR_RANGE if batch_len is 0, other error
+ * code otherwise.
+ * @author Ed Hartnett
+ */
+int
+glm_flash_iter_open(GLM_FILE_T *glm, size_t batch_len, GLM_ITER_T **iter)
+{
+    return iter_open(glm, GLM_SECTION_FLASH, batch_len, iter);
+}
+
+/**
+ * Read and unpack the next batch of flashes.
+ *
+ * @param iter Pointer to the iterator, from glm_flash_iter_open().
+ * @param flash Pointer to already-allocated array of GLM_FLASH_T,
+ * with room for batch_len flashes.
+ * @param count Pointer that gets the number of flashes read. It is 0
+ * when all the flashes have been read, or on error.
+ *
+ * @return 0 for success, error code otherwise. On error the iterator
+ * is not advanced, so the next call reads the same batch.
+ * @author Ed Hartnett
+ */
+int
+glm_flash_iter_next(GLM_ITER_T *iter, GLM_FLASH_T *flash, size_t *count)
+{
+    size_t start;
+    int ret;
+
+    iter_range(iter, GLM_SECTION_FLASH, &start, count);
+    if (!*count)
+        return 0;
+
+    ret = glm_read_flash_range(iter->glm, start, *count, flash);
+
+    return iter_advance(iter, ret, count);
+}
+
+/**
+ * Close an iterator. The chunk caches of its variables are put back
+ * as they were when it was opened. The file handle is not closed.
+ *
+ * @param iter Pointer to the iterator.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+int
+glm_iter_close(GLM_ITER_T *iter)
+{
+    int ret;
+
+    /* Check inputs. */
+    assert(iter);
+
+    glm_nc_lock();
+    ret = restore_chunk_caches(iter->glm, iter->cache);
+    glm_nc_unlock();
+    glm_free(iter);
+
+    return ret;
+}
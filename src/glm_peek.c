@@ -0,0 +1,247 @@
+/**
+ * @file
+ * Code to learn what a catalog needs to know about GLM files, their
+ * dimensions, times, counts, and field of view, without reading
+ * anything else.
+ *
+ * glm_open() resolves all the varids and packing attributes of the
+ * file, and glm_get_scalars() reads all 23 scalars, one at a time. A
+ * peek only looks up the three dimensions and the seven variables it
+ * returns. Peeks of many files may run on several threads. netCDF
+ * calls are made under the library lock, so the threads do not open
+ * files at the same time, but each asks the kernel to read the head
+ * of its file before taking the lock, so the reads of the files
+ * overlap.
+ *
+ * @author Ed Hartnett
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <assert.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "glm_internal.h"
+
+/** Bytes at the start of a file read ahead before it is opened. The
+ * superblock and most of the object headers are there. */
+#define GLM_PEEK_READAHEAD (256 * 1024)
+
+/** Number of dimensions found by a peek. */
+#define NUM_PEEK_DIMS 3
+
+/** Number of variables read by a peek. */
+#define NUM_PEEK_VARS 7
+
+/** A dimension found by a peek. */
+typedef struct GLM_PEEK_DIM
+{
+    const char *name; /**< Name of the dimension. */
+    size_t field;     /**< Offset of its length in GLM_FILE_INFO_T. */
+} GLM_PEEK_DIM_T;
+
+/** A variable read by a peek. */
+typedef struct GLM_PEEK_VAR
+{
+    const char *name; /**< Name of the variable. */
+    nc_type xtype;    /**< NC_DOUBLE, NC_FLOAT, or NC_INT, the type read. */
+    size_t field;     /**< Offset of its values in GLM_FILE_INFO_T. */
+} GLM_PEEK_VAR_T;
+
+/** The dimensions found by a peek. */
+static const GLM_PEEK_DIM_T peek_dim[NUM_PEEK_DIMS] = {
+    {NUMBER_OF_EVENTS, offsetof(GLM_FILE_INFO_T, nevent)},
+    {NUMBER_OF_GROUPS, offsetof(GLM_FILE_INFO_T, ngroup)},
+    {NUMBER_OF_FLASHES, offsetof(GLM_FILE_INFO_T, nflash)}
+};
+
+/** The variables read by a peek. */
+static const GLM_PEEK_VAR_T peek_var[NUM_PEEK_VARS] = {
+    {PRODUCT_TIME, NC_DOUBLE, offsetof(GLM_FILE_INFO_T, product_time)},
+    {PRODUCT_TIME_BOUNDS, NC_DOUBLE,
+     offsetof(GLM_FILE_INFO_T, product_time_bounds)},
+    {EVENT_COUNT, NC_INT, offsetof(GLM_FILE_INFO_T, event_count)},
+    {GROUP_COUNT, NC_INT, offsetof(GLM_FILE_INFO_T, group_count)},
+    {FLASH_COUNT, NC_INT, offsetof(GLM_FILE_INFO_T, flash_count)},
+    {LAT_FIELD_OF_VIEW_BOUNDS, NC_FLOAT,
+     offsetof(GLM_FILE_INFO_T, lat_field_of_view_bounds)},
+    {LON_FIELD_OF_VIEW_BOUNDS, NC_FLOAT,
+     offsetof(GLM_FILE_INFO_T, lon_field_of_view_bounds)}
+};
+
+/** What glm_peek_files() shares with its tasks. */
+typedef struct GLM_PEEK_FILES
+{
+    const char **paths;    /**< Names of the files. */
+    GLM_FILE_INFO_T *info; /**< Info of each file. */
+    int *status;           /**< Status of each file, or NULL. */
+} GLM_PEEK_FILES_T;
+
+/**
+ * Ask the kernel to start reading the head of a file. This is only
+ * advice, so nothing is done if it fails.
+ *
+ * @param path Name of the file.
+ *
+ * @author Ed Hartnett
+ */
+static void
+read_ahead(const char *path)
+{
+#ifdef POSIX_FADV_WILLNEED
+    int fd;
+
+    if ((fd = open(path, O_RDONLY)) < 0)
+        return;
+    posix_fadvise(fd, 0, GLM_PEEK_READAHEAD, POSIX_FADV_WILLNEED);
+    close(fd);
+#else
+    (void)path;
+#endif
+}
+
+/**
+ * Find the dimensions, and read the variables, of a peek. The netCDF
+ * lock must be held.
+ *
+ * @param ncid ID of the open GLM file.
+ * @param info Pointer to the GLM_FILE_INFO_T which gets them.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+static int
+peek(int ncid, GLM_FILE_INFO_T *info)
+{
+    int d, v;
+    int ret;
+
+    for (d = 0; d < NUM_PEEK_DIMS; d++)
+    {
+        int dimid;
+
+        if ((ret = nc_inq_dimid(ncid, peek_dim[d].name, &dimid)))
+            NC_ERR(ret);
+        if ((ret = nc_inq_dimlen(ncid, dimid,
+                                 (size_t *)((char *)info + peek_dim[d].field))))
+            NC_ERR(ret);
+    }
+
+    for (v = 0; v < NUM_PEEK_VARS; v++)
+    {
+        void *data = (char *)info + peek_var[v].field;
+        int varid;
+
+        if ((ret = nc_inq_varid(ncid, peek_var[v].name, &varid)))
+            NC_ERR(ret);
+        switch (peek_var[v].xtype)
+        {
+        case NC_DOUBLE:
+            ret = nc_get_var_double(ncid, varid, data);
+            break;
+        case NC_FLOAT:
+            ret = nc_get_var_float(ncid, varid, data);
+            break;
+        default:
+            ret = nc_get_var_int(ncid, varid, data);
+        }
+        if (ret)
+            NC_ERR(ret);
+    }
+
+    return 0;
+}
+
+/**
+ * Learn the dimensions, product time and its bounds, counts, and
+ * field of view bounds of a GLM file, reading nothing else. This is
+ * much quicker than glm_open() and glm_get_scalars().
+ *
+ * @param path Name of the GLM file.
+ * @param info Pointer to a GLM_FILE_INFO_T which gets them.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+int
+glm_peek(const char *path, GLM_FILE_INFO_T *info)
+{
+    int ncid;
+    int ret, ret2 = 0;
+
+    /* Check inputs. */
+    assert(path && info);
+
+    read_ahead(path);
+    glm_nc_lock();
+    if (!(ret = nc_open(path, NC_NOWRITE, &ncid)))
+    {
+        ret2 = peek(ncid, info);
+        nc_close(ncid);
+    }
+    glm_nc_unlock();
+    if (ret)
+        NC_ERR(ret);
+
+    return ret2;
+}
+
+/**
+ * Peek at one file, task i of glm_peek_files().
+ *
+ * @param arg Pointer to the GLM_PEEK_FILES_T.
+ * @param i Index of the file.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+static int
+peek_task(void *arg, int i)
+{
+    GLM_PEEK_FILES_T *pf = arg;
+    int ret;
+
+    ret = glm_peek(pf->paths[i], &pf->info[i]);
+    if (pf->status)
+    {
+        pf->status[i] = ret;
+        return 0;
+    }
+
+    return ret;
+}
+
+/**
+ * Peek at many GLM files, on several threads, as glm_peek() does for
+ * one. This is the way to catalog a directory of granules.
+ *
+ * @param paths Array of nfile file names.
+ * @param nfile Number of files.
+ * @param nthreads Number of threads. If less than 1, the number of
+ * online processors is used.
+ * @param info Array of nfile GLM_FILE_INFO_T which get the info of
+ * each file.
+ * @param status If not NULL, an array of nfile which gets the error
+ * code of each file, 0 if it was read. Every file is tried, whether
+ * or not the others can be read. If NULL, the peeks stop at the
+ * first file which cannot be read.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+int
+glm_peek_files(const char **paths, int nfile, int nthreads,
+               GLM_FILE_INFO_T *info, int *status)
+{
+    GLM_PEEK_FILES_T pf;
+
+    /* Check inputs. */
+    assert((paths || !nfile) && nfile >= 0 && (info || !nfile));
+
+    pf.paths = paths;
+    pf.info = info;
+    pf.status = status;
+
+    return glm_pool_run(nthreads, nfile, peek_task, &pf);
+}
@@ -0,0 +1,178 @@
+/**
+ * @file
+ * Code to process a sequence of GLM files in order, reading ahead on
+ * a background thread.
+ *
+ * A reader thread opens, reads, and unpacks the files one after the
+ * other into a ring of batches, while the calling thread hands the
+ * batches, in order, to a callback. The reader stops when the ring is
+ * full, so at most depth files are held in memory besides the one
+ * being read.
+ *
+ * @author Ed Hartnett
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <pthread.h>
+#include "glm_internal.h"
+
+/** One slot of the ring. */
+typedef struct GLM_SLOT
+{
+    GLM_BATCH_T batch; /**< Data of the file. */
+    int ret;           /**< Error code from reading the file. */
+} GLM_SLOT_T;
+
+/** Shared state of a pipeline. */
+typedef struct GLM_PIPELINE
+{
+    const char **paths;       /**< Names of the files. */
+    int nfile;                /**< Number of files. */
+    int depth;                /**< Number of slots. */
+    GLM_SLOT_T *slot;         /**< Ring of depth slots. */
+    int nfull;                /**< Number of slots read, not yet used. */
+    int stop;                 /**< Set when the reader should stop. */
+    pthread_mutex_t mutex;    /**< Guards nfull and stop. */
+    pthread_cond_t not_full;  /**< Signalled when a slot is freed. */
+    pthread_cond_t not_empty; /**< Signalled when a slot is filled. */
+} GLM_PIPELINE_T;
+
+/**
+ * Reader thread. Read each file into the next free slot, stopping
+ * early if asked to, or if a read fails.
+ *
+ * @param varg Pointer to the GLM_PIPELINE_T.
+ *
+ * @return NULL.
+ * @author Ed Hartnett
+ */
+static void *
+pipeline_reader(void *varg)
+{
+    GLM_PIPELINE_T *pl = varg;
+    int f;
+
+    for (f = 0; f < pl->nfile; f++)
+    {
+        GLM_SLOT_T *slot = &pl->slot[f % pl->depth];
+        int stop;
+
+        /* Wait for a free slot. */
+        pthread_mutex_lock(&pl->mutex);
+        while (pl->nfull == pl->depth && !pl->stop)
+            pthread_cond_wait(&pl->not_full, &pl->mutex);
+        stop = pl->stop;
+        pthread_mutex_unlock(&pl->mutex);
+        if (stop)
+            break;
+
+        /* Read the file outside the pipeline mutex. */
+        slot->ret = glm_read_file_batch(pl->paths[f], &slot->batch);
+
+        pthread_mutex_lock(&pl->mutex);
+        pl->nfull++;
+        pthread_cond_signal(&pl->not_empty);
+        pthread_mutex_unlock(&pl->mutex);
+        if (slot->ret)
+            break;
+    }
+
+    return NULL;
+}
+
+/**
+ * Read a sequence of GLM files in order, and pass the data of each,
+ * in order, to a callback. While the callback works on one file, the
+ * following files are read and unpacked on a background thread, up to
+ * depth files ahead.
+ *
+ * The batch passed to the callback belongs to the pipeline, and is
+ * freed when the callback returns. Its IDs are those in the file.
+ *
+ * @param paths Array of nfile file names.
+ * @param nfile Number of files.
+ * @param depth Number of files which may be read ahead. Must be at
+ * least 1.
+ * @param callback Function called with the data of each file, its
+ * index in paths, and arg. If it returns non-zero, the pipeline stops
+ * and returns that value.
+ * @param arg Argument passed to the callback.
+ *
+ * @return 0 for success, GLM_ERR_RANGE if depth is less than 1, the
+ * return of the callback if non-zero, other error code otherwise.
+ * @author Ed Hartnett
+ */
+int
+glm_pipeline(const char **paths, int nfile, int depth,
+             GLM_BATCH_FN callback, void *arg)
+{
+    GLM_PIPELINE_T pl;
+    pthread_t reader;
+    int f, s;
+    int ret = 0;
+
+    /* Check inputs. */
+    assert((paths || !nfile) && nfile >= 0 && callback);
+    if (depth < 1)
+        return GLM_ERR_RANGE;
+    if (!nfile)
+        return 0;
+
+    /* No more slots than files. */
+    if (depth > nfile)
+        depth = nfile;
+    if (!(pl.slot = glm_calloc(depth, sizeof(GLM_SLOT_T))))
+        return GLM_ERR_MEMORY;
+    pl.paths = paths;
+    pl.nfile = nfile;
+    pl.depth = depth;
+    pl.nfull = 0;
+    pl.stop = 0;
+    pthread_mutex_init(&pl.mutex, NULL);
+    pthread_cond_init(&pl.not_full, NULL);
+    pthread_cond_init(&pl.not_empty, NULL);
+
+    /* Hand each file to the callback as it becomes ready. */
+    if (pthread_create(&reader, NULL, pipeline_reader, &pl))
+        ret = GLM_ERR_MEMORY;
+    else
+    {
+        for (f = 0; f < nfile && !ret; f++)
+        {
+            GLM_SLOT_T *slot = &pl.slot[f % depth];
+
+            pthread_mutex_lock(&pl.mutex);
+            while (!pl.nfull)
+                pthread_cond_wait(&pl.not_empty, &pl.mutex);
+            pthread_mutex_unlock(&pl.mutex);
+
+            if (!(ret = slot->ret))
+                ret = callback(&slot->batch, f, arg);
+            glm_free_batch(&slot->batch);
+
+            pthread_mutex_lock(&pl.mutex);
+            pl.nfull--;
+            pthread_cond_signal(&pl.not_full);
+            pthread_mutex_unlock(&pl.mutex);
+        }
+
+        /* Stop the reader, if it is still going, and wait for it. */
+        pthread_mutex_lock(&pl.mutex);
+        pl.stop = 1;
+        pthread_cond_signal(&pl.not_full);
+        pthread_mutex_unlock(&pl.mutex);
+        pthread_join(reader, NULL);
+    }
+
+    /* Free any files read ahead but not used. */
+    for (s = 0; s < depth; s++)
+        glm_free_batch(&pl.slot[s].batch);
+    glm_free(pl.slot);
+    pthread_cond_destroy(&pl.not_empty);
+    pthread_cond_destroy(&pl.not_full);
+    pthread_mutex_destroy(&pl.mutex);
+
+    return ret;
+}
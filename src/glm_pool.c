@@ -0,0 +1,180 @@
+/**
+ * @file
+ * Threading support for the ncglm library.
+ *
+ * The netCDF library is not thread-safe, so every netCDF call made
+ * by library functions which may run on several threads at once is
+ * made while holding a single library-wide lock. Unpacking is done
+ * outside the lock, so threads reading different files overlap their
+ * decoding with each other's I/O.
+ *
+ * The pool runs a number of independent tasks on a number of
+ * threads, and returns when all are done.
+ *
+ * @author Ed Hartnett
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "glm_internal.h"
+
+/** Most extra threads of a run whose handles are kept on the
+ * stack. */
+#define GLM_POOL_STACK_THREADS 32
+
+/** Lock around all netCDF calls. */
+static pthread_mutex_t glm_nc_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/** Shared state of one run of the pool. */
+typedef struct GLM_POOL
+{
+    glm_task_fn task; /**< Function which runs one task. */
+    void *arg;        /**< Argument passed to every task. */
+    int ntask;        /**< Number of tasks. */
+    int next;         /**< Index of the next task to start. */
+    int ret;          /**< Error code of the first task which failed. */
+} GLM_POOL_T;
+
+/**
+ * Take the netCDF lock.
+ *
+ * @author Ed Hartnett
+ */
+void
+glm_nc_lock(void)
+{
+    pthread_mutex_lock(&glm_nc_mutex);
+}
+
+/**
+ * Release the netCDF lock.
+ *
+ * @author Ed Hartnett
+ */
+void
+glm_nc_unlock(void)
+{
+    pthread_mutex_unlock(&glm_nc_mutex);
+}
+
+/**
+ * Find the number of threads to use.
+ *
+ * @param nthreads Number of threads asked for. If less than 1, the
+ * number of online processors is used.
+ *
+ * @return Number of threads, at least 1.
+ * @author Ed Hartnett
+ */
+int
+glm_pool_nthreads(int nthreads)
+{
+    long ncpu;
+
+    if (nthreads > 0)
+        return nthreads;
+    ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+
+    return ncpu > 0 ? (int)ncpu : 1;
+}
+
+/**
+ * Run tasks until there are none left, or one has failed.
+ *
+ * @param varg Pointer to the GLM_POOL_T.
+ *
+ * @return NULL.
+ * @author Ed Hartnett
+ */
+static void *
+pool_worker(void *varg)
+{
+    GLM_POOL_T *pool = varg;
+    int i;
+
+    while ((i = __atomic_fetch_add(&pool->next, 1, __ATOMIC_RELAXED)) < pool->ntask)
+    {
+        int ret;
+
+        if (__atomic_load_n(&pool->ret, __ATOMIC_RELAXED))
+            break;
+        if ((ret = pool->task(pool->arg, i)))
+        {
+            int zero = 0;
+
+            __atomic_compare_exchange_n(&pool->ret, &zero, ret, 0,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Run ntask tasks on up to nthreads threads, including the calling
+ * thread. Tasks are started in order. Once a task fails, no more are
+ * started.
+ *
+ * @param nthreads Number of threads. If less than 1, the number of
+ * online processors is used.
+ * @param ntask Number of tasks.
+ * @param task Function which runs task i.
+ * @param arg Argument passed to every task.
+ *
+ * @return 0 for success, the error code of the first task which
+ * failed, or GLM_ERR_MEMORY if threads could not be started.
+ * @author Ed Hartnett
+ */
+int
+glm_pool_run(int nthreads, int ntask, glm_task_fn task, void *arg)
+{
+    GLM_POOL_T pool;
+    pthread_t stack_thread[GLM_POOL_STACK_THREADS];
+    pthread_t *thread = stack_thread;
+    int nthread;
+    int t;
+
+    /* Check inputs. */
+    assert(task && ntask >= 0);
+
+    pool.task = task;
+    pool.arg = arg;
+    pool.ntask = ntask;
+    pool.next = 0;
+    pool.ret = 0;
+
+    /* No more threads than tasks. The calling thread is one of
+     * them. */
+    nthread = glm_pool_nthreads(nthreads);
+    if (nthread > ntask)
+        nthread = ntask;
+    if (nthread <= 1)
+    {
+        pool_worker(&pool);
+        return pool.ret;
+    }
+
+    /* Small pools keep their threads on the stack, so that steady
+     * reads do not allocate. */
+    if (nthread - 1 > GLM_POOL_STACK_THREADS &&
+        !(thread = glm_malloc((nthread - 1) * sizeof(pthread_t))))
+        return GLM_ERR_MEMORY;
+    for (t = 0; t < nthread - 1; t++)
+        if (pthread_create(&thread[t], NULL, pool_worker, &pool))
+            break;
+
+    /* Work in this thread too, then wait for the others. If some
+     * threads could not be created, the ones which were created, and
+     * this one, do all the tasks. */
+    pool_worker(&pool);
+    nthread = t;
+    for (t = 0; t < nthread; t++)
+        pthread_join(thread[t], NULL);
+    if (thread != stack_thread)
+        glm_free(thread);
+
+    return pool.ret;
+}
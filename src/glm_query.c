@@ -0,0 +1,278 @@
+/**
+ * @file
+ * Code to read the events, groups, and flashes of a time window from
+ * a directory of GLM files.
+ *
+ * The granules which may hold data of the window are picked by the
+ * times in their names, with GLM_QUERY_SLACK seconds to spare, since
+ * product_time_bounds does not always match the name exactly. The
+ * product_time_bounds of those candidates are then found with
+ * glm_peek_files(), which reads no data, and those which do not
+ * overlap the window, or can't be read, are dropped. Only the rest
+ * are read, on several threads, into one batch with
+ * glm_read_files(). The absolute time of each record, product_time of
+ * its file plus its time offset, then decides whether it is in the
+ * window. The records which are kept are put in order of absolute
+ * time, one column per task on the thread pool, with
+ * glm_batch_gather().
+ *
+ * @author Ed Hartnett
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <assert.h>
+#include "glm_internal.h"
+
+/** Seconds by which the times in a name may differ from
+ * product_time_bounds. */
+#define GLM_QUERY_SLACK 1.0
+
+/** A record, with its absolute time, for sorting. */
+typedef struct GLM_TIME_KEY
+{
+    double t; /**< Absolute time, seconds since 2000-01-01 12:00:00. */
+    size_t i; /**< Index of the record in the batch read. */
+} GLM_TIME_KEY_T;
+
+/**
+ * Order records by absolute time, then by index, for qsort().
+ *
+ * @param a Pointer to a GLM_TIME_KEY_T.
+ * @param b Pointer to a GLM_TIME_KEY_T.
+ *
+ * @return <0, 0, or >0.
+ * @author Ed Hartnett
+ */
+static int
+cmp_key(const void *a, const void *b)
+{
+    const GLM_TIME_KEY_T *ka = a, *kb = b;
+
+    if (ka->t != kb->t)
+        return ka->t < kb->t ? -1 : 1;
+
+    return ka->i < kb->i ? -1 : ka->i > kb->i;
+}
+
+/**
+ * Order directory entries by the start time in their names, for
+ * qsort().
+ *
+ * @param a Pointer to a GLM_CATALOG_ENTRY_T.
+ * @param b Pointer to a GLM_CATALOG_ENTRY_T.
+ *
+ * @return <0, 0, or >0.
+ * @author Ed Hartnett
+ */
+static int
+cmp_name_start(const void *a, const void *b)
+{
+    const GLM_CATALOG_ENTRY_T *ea = a, *eb = b;
+
+    if (ea->name_start != eb->name_start)
+        return ea->name_start < eb->name_start ? -1 : 1;
+
+    return strcmp(ea->name, eb->name);
+}
+
+/**
+ * Might a granule hold data of a time window, going by the times in
+ * its name?
+ *
+ * @param entry Pointer to the directory entry of the granule.
+ * @param t0 Start of the window.
+ * @param t1 End of the window.
+ *
+ * @return Non-zero if it might.
+ * @author Ed Hartnett
+ */
+static int
+name_in_window(const GLM_CATALOG_ENTRY_T *entry, double t0, double t1)
+{
+    return entry->name_start <= t1 + GLM_QUERY_SLACK &&
+        entry->name_end >= t0 - GLM_QUERY_SLACK;
+}
+
+/**
+ * Find the records of one kind which are in a time window, in order
+ * of absolute time.
+ *
+ * @param batch Pointer to the batch read.
+ * @param n Number of records.
+ * @param offset Time offset of each record.
+ * @param file File of each record.
+ * @param t0 Start of the window.
+ * @param t1 End of the window.
+ * @param idxp Pointer that gets the index of each record kept. Free
+ * it with glm_free().
+ * @param nkeep Pointer that gets the number of records kept.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+static int
+select_window(const GLM_BATCH_T *batch, size_t n, const float *offset,
+              const int *file, double t0, double t1, size_t **idxp,
+              size_t *nkeep)
+{
+    GLM_TIME_KEY_T *key;
+    size_t *idx;
+    size_t i, k = 0;
+
+    if (!(key = glm_malloc(n * sizeof(GLM_TIME_KEY_T))))
+        return GLM_ERR_MEMORY;
+    for (i = 0; i < n; i++)
+    {
+        double t = batch->scalar[file[i]].product_time + offset[i];
+
+        if (t >= t0 && t <= t1)
+        {
+            key[k].t = t;
+            key[k++].i = i;
+        }
+    }
+    qsort(key, k, sizeof(GLM_TIME_KEY_T), cmp_key);
+
+    if (!(idx = glm_malloc(k * sizeof(size_t))))
+    {
+        glm_free(key);
+        return GLM_ERR_MEMORY;
+    }
+    for (i = 0; i < k; i++)
+        idx[i] = key[i].i;
+    glm_free(key);
+    *idxp = idx;
+    *nkeep = k;
+
+    return 0;
+}
+
+/**
+ * Read the events, groups, and flashes of a time window from a
+ * directory of GLM files. Only the granules whose names, and then
+ * product_time_bounds, say they may overlap the window are read, on
+ * several threads. Records are kept if t0 <= product_time + time
+ * offset <= t1, where the time of a flash is the time offset of its
+ * first event, and are returned in order of that absolute time.
+ *
+ * Granules whose product_time_bounds can't be read, such as files
+ * which are truncated or still being downloaded, are skipped, as
+ * glm_catalog_build() skips them.
+ *
+ * The batch has the columns of glm_read_files() for the granules
+ * which were read, with IDs remapped in the same way, and a scalar
+ * for each of them. Time offsets are still relative to the
+ * product_time of the file of each record. Records are kept or
+ * dropped on their own times, so a kept event may have a parent group
+ * which was not kept, at the edges of the window.
+ *
+ * @param dir Name of the directory.
+ * @param t0 Start of the window, in seconds since 2000-01-01 12:00:00
+ * UTC, like product_time.
+ * @param t1 End of the window.
+ * @param nthreads Number of threads. If less than 1, the number of
+ * online processors is used.
+ * @param batch Pointer to a GLM_BATCH_T which gets the data. Free it
+ * with glm_free_batch(). It is left empty on error.
+ *
+ * @return 0 for success, GLM_ERR_IO if the directory can't be read,
+ * other error code otherwise.
+ * @author Ed Hartnett
+ */
+int
+glm_query_time(const char *dir, double t0, double t1, int nthreads,
+               GLM_BATCH_T *batch)
+{
+    GLM_CATALOG_ENTRY_T *entry;
+    GLM_FILE_INFO_T *info = NULL;
+    GLM_BATCH_T all;
+    size_t *idx[3] = {NULL, NULL, NULL};
+    const char **paths = NULL;
+    char *names = NULL, *path;
+    int *status = NULL;
+    size_t nentry, n[3] = {0, 0, 0};
+    size_t i, nfile = 0, ncand, len = 0;
+    int k;
+    int ret;
+
+    /* Check inputs. */
+    assert(dir && batch);
+    memset(batch, 0, sizeof(GLM_BATCH_T));
+    memset(&all, 0, sizeof(GLM_BATCH_T));
+
+    /* Pick the granules by name, in time order, and find the space
+     * their paths take. */
+    if ((ret = glm_catalog_scan(dir, &entry, &nentry)))
+        return ret;
+    if (nentry)
+        qsort(entry, nentry, sizeof(GLM_CATALOG_ENTRY_T), cmp_name_start);
+    for (i = 0; i < nentry; i++)
+    {
+        if (!name_in_window(&entry[i], t0, t1))
+            continue;
+        len += strlen(dir) + strlen(entry[i].name) + 2;
+        nfile++;
+    }
+    if (nfile > INT_MAX)
+        ret = GLM_ERR_RANGE;
+    else if (!(paths = glm_malloc((nfile ? nfile : 1) * sizeof(char *))) ||
+             !(names = glm_malloc(len ? len : 1)) ||
+             !(info = glm_malloc((nfile ? nfile : 1) *
+                                 sizeof(GLM_FILE_INFO_T))) ||
+             !(status = glm_malloc((nfile ? nfile : 1) * sizeof(int))))
+        ret = GLM_ERR_MEMORY;
+    for (path = names, nfile = 0, i = 0; !ret && i < nentry; i++)
+    {
+        if (!name_in_window(&entry[i], t0, t1))
+            continue;
+        paths[nfile++] = path;
+        path += sprintf(path, "%s/%s", dir, entry[i].name) + 1;
+    }
+
+    /* Of those, keep the ones which can be read, and whose
+     * product_time_bounds overlap the window, in the same order. */
+    if (!ret && nfile &&
+        !(ret = glm_peek_files(paths, (int)nfile, nthreads, info, status)))
+    {
+        for (ncand = nfile, nfile = 0, i = 0; i < ncand; i++)
+            if (!status[i] && info[i].product_time_bounds[0] <= t1 &&
+                info[i].product_time_bounds[1] >= t0)
+                paths[nfile++] = paths[i];
+    }
+
+    /* Read them, find the records in the window, and copy those, in
+     * order, into the batch. */
+    if (!ret)
+        ret = glm_read_files(paths, (int)nfile, nthreads, &all);
+    if (!ret &&
+        !(ret = select_window(&all, all.nevent, all.event_time_offset,
+                              all.event_file, t0, t1,
+                              &idx[GLM_COUNT_EVENT], &n[GLM_COUNT_EVENT])) &&
+        !(ret = select_window(&all, all.ngroup, all.group_time_offset,
+                              all.group_file, t0, t1,
+                              &idx[GLM_COUNT_GROUP], &n[GLM_COUNT_GROUP])) &&
+        !(ret = select_window(&all, all.nflash,
+                              all.flash_time_offset_of_first_event,
+                              all.flash_file, t0, t1,
+                              &idx[GLM_COUNT_FLASH], &n[GLM_COUNT_FLASH])) &&
+        !(ret = glm_batch_alloc(batch, NULL, all.nfile, n[GLM_COUNT_EVENT],
+                                n[GLM_COUNT_GROUP], n[GLM_COUNT_FLASH])))
+        ret = glm_batch_gather(&all, batch, (const size_t *const *)idx,
+                               nthreads);
+    if (ret)
+        glm_free_batch(batch);
+
+    for (k = 0; k < 3; k++)
+        glm_free(idx[k]);
+    glm_free_batch(&all);
+    glm_free(status);
+    glm_free(info);
+    glm_free(names);
+    glm_free(paths);
+    glm_free(entry);
+
+    return ret;
+}
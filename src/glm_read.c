@@ -14,7 +14,7 @@
 #include <math.h>
 #include <assert.h>
 #include <netcdf.h>
-#include "ncglm.h"
+#include "glm_internal.h"
 
 /** Name of title attribute. */
 #define TITLE "title"
@@ -28,6 +28,12 @@
 /** Number of timing runs when -t option is used. */
 #define NUM_TRIALS 10
 
+/** Number of arrays allocated by glm_read_file(). */
+#define NUM_FILE_ARRAYS 3
+
+/** Number of arrays allocated by glm_read_file_arrays(). */
+#define NUM_FILE_ARRAYS_ARRAYS 6
+
 /**
  * Read the dimensions.
  *
@@ -113,165 +119,133 @@ glm_read_dims(int ncid, size_t *nevent, size_t *ngroup, size_t *nflash)
 int
 read_scalars(int ncid, GLM_SCALAR_T *glm_scalar)
 {
-    int product_time_varid;
-    int product_time_bounds_varid;
-    int lightning_wavelength_varid;
-    int lightning_wavelength_bounds_varid;
-    int group_time_threshold_varid;
-    int flash_time_threshold_varid;
-    int lat_field_of_view_varid;
-    int lat_field_of_view_bounds_varid;
-    int goes_lat_lon_projection_varid;
-    int event_count_varid;
-    int group_count_varid;
-    int flash_count_varid;
-    int percent_navigated_L1b_events_varid;
-    int yaw_flip_flag_varid;
-    int nominal_satellite_subpoint_lat_varid;
-    int nominal_satellite_height_varid;
-    int nominal_satellite_subpoint_lon_varid;
-    int lon_field_of_view_varid;
-    int lon_field_of_view_bounds_varid;
-    int percent_uncorrectable_L0_errors_varid;
-    int algorithm_dynamic_input_data_container_varid;
-    int processing_parm_version_container_varid;
-    int algorithm_product_version_container_varid;
+    GLM_FILE_T glm;
     int ret;
 
-    /* Get varids and values of scalars and small vars. */
-    if ((ret = nc_inq_varid(ncid, PRODUCT_TIME, &product_time_varid)))
-	NC_ERR(ret);
-    if ((ret = nc_get_var_double(ncid, product_time_varid, &glm_scalar->product_time)))
-    	NC_ERR(ret);
+    if ((ret = glm_file_init(ncid, GLM_SECTION_SCALAR, &glm)))
+        return ret;
 
-    if ((ret = nc_inq_varid(ncid, PRODUCT_TIME_BOUNDS, &product_time_bounds_varid)))
-	NC_ERR(ret);
-    if ((ret = nc_get_var_double(ncid, product_time_bounds_varid, glm_scalar->product_time_bounds)))
-    	NC_ERR(ret);
+    return glm_get_scalars(&glm, glm_scalar);
+}
 
-    if ((ret = nc_inq_varid(ncid, LIGHTNING_WAVELENGTH, &lightning_wavelength_varid)))
-	NC_ERR(ret);
-    if ((ret = nc_get_var_float(ncid, lightning_wavelength_varid, &glm_scalar->lightning_wavelength)))
-    	NC_ERR(ret);
+/**
+ * Read the scalars and small variables from the GLM file, using the
+ * varids cached in the GLM file handle. The netCDF lock must be held.
+ *
+ * @param glm Pointer to the GLM file handle.
+ * @param glm_scalar Pointer to already allocated GLM_SCALAR_T.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+static int
+get_scalars(GLM_FILE_T *glm, GLM_SCALAR_T *glm_scalar)
+{
+    GLM_VAR_T *var;
+    int ncid;
+    int ret;
 
-    if ((ret = nc_inq_varid(ncid, LIGHTNING_WAVELENGTH_BOUNDS, &lightning_wavelength_bounds_varid)))
-	NC_ERR(ret);
-    if ((ret = nc_get_var_float(ncid, lightning_wavelength_bounds_varid, glm_scalar->lightning_wavelength_bounds)))
-    	NC_ERR(ret);
+    /* Check inputs. */
+    assert(glm && (glm->sections & GLM_SECTION_SCALAR) && glm_scalar);
+    ncid = glm->ncid;
+    var = glm->var;
 
-    if ((ret = nc_inq_varid(ncid, GROUP_TIME_THRESHOLD, &group_time_threshold_varid)))
-	NC_ERR(ret);
-    if ((ret = nc_get_var_float(ncid, group_time_threshold_varid, &glm_scalar->group_time_threshold)))
+    /* Get values of scalars and small vars. */
+    if ((ret = nc_get_var_double(ncid, var[GLM_VAR_PRODUCT_TIME].varid,
+                                 &glm_scalar->product_time)))
     	NC_ERR(ret);
-
-    if ((ret = nc_inq_varid(ncid, FLASH_TIME_THRESHOLD, &flash_time_threshold_varid)))
-	NC_ERR(ret);
-    if ((ret = nc_get_var_float(ncid, flash_time_threshold_varid, &glm_scalar->flash_time_threshold)))
+    if ((ret = nc_get_var_double(ncid, var[GLM_VAR_PRODUCT_TIME_BOUNDS].varid,
+                                 glm_scalar->product_time_bounds)))
     	NC_ERR(ret);
-
-    if ((ret = nc_inq_varid(ncid, LAT_FIELD_OF_VIEW, &lat_field_of_view_varid)))
-	NC_ERR(ret);
-    if ((ret = nc_get_var_float(ncid, lat_field_of_view_varid, &glm_scalar->lat_field_of_view)))
+    if ((ret = nc_get_var_float(ncid, var[GLM_VAR_LIGHTNING_WAVELENGTH].varid,
+                                &glm_scalar->lightning_wavelength)))
     	NC_ERR(ret);
-
-    if ((ret = nc_inq_varid(ncid, LAT_FIELD_OF_VIEW_BOUNDS, &lat_field_of_view_bounds_varid)))
-	NC_ERR(ret);
-    if ((ret = nc_get_var_float(ncid, lat_field_of_view_bounds_varid, glm_scalar->lat_field_of_view_bounds)))
+    if ((ret = nc_get_var_float(ncid, var[GLM_VAR_LIGHTNING_WAVELENGTH_BOUNDS].varid,
+                                glm_scalar->lightning_wavelength_bounds)))
     	NC_ERR(ret);
-
-    if ((ret = nc_inq_varid(ncid, GOES_LAT_LON_PROJECTION, &goes_lat_lon_projection_varid)))
-	NC_ERR(ret);
-    if ((ret = nc_get_var_int(ncid, goes_lat_lon_projection_varid, &glm_scalar->goes_lat_lon_projection)))
+    if ((ret = nc_get_var_float(ncid, var[GLM_VAR_GROUP_TIME_THRESHOLD].varid,
+                                &glm_scalar->group_time_threshold)))
     	NC_ERR(ret);
-
-    if ((ret = nc_inq_varid(ncid, EVENT_COUNT, &event_count_varid)))
-	NC_ERR(ret);
-    if ((ret = nc_get_var_int(ncid, event_count_varid, &glm_scalar->event_count)))
+    if ((ret = nc_get_var_float(ncid, var[GLM_VAR_FLASH_TIME_THRESHOLD].varid,
+                                &glm_scalar->flash_time_threshold)))
     	NC_ERR(ret);
-
-    if ((ret = nc_inq_varid(ncid, GROUP_COUNT, &group_count_varid)))
-	NC_ERR(ret);
-    if ((ret = nc_get_var_int(ncid, group_count_varid, &glm_scalar->group_count)))
+    if ((ret = nc_get_var_float(ncid, var[GLM_VAR_LAT_FIELD_OF_VIEW].varid,
+                                &glm_scalar->lat_field_of_view)))
     	NC_ERR(ret);
-
-    if ((ret = nc_inq_varid(ncid, FLASH_COUNT, &flash_count_varid)))
-	NC_ERR(ret);
-    if ((ret = nc_get_var_int(ncid, flash_count_varid, &glm_scalar->flash_count)))
+    if ((ret = nc_get_var_float(ncid, var[GLM_VAR_LAT_FIELD_OF_VIEW_BOUNDS].varid,
+                                glm_scalar->lat_field_of_view_bounds)))
     	NC_ERR(ret);
-
-    if ((ret = nc_inq_varid(ncid, PERCENT_NAVIGATED_L1B_EVENTS, &percent_navigated_L1b_events_varid)))
-	NC_ERR(ret);
-    if ((ret = nc_get_var_float(ncid, percent_navigated_L1b_events_varid, &glm_scalar->percent_navigated_L1b_events)))
+    if ((ret = nc_get_var_int(ncid, var[GLM_VAR_GOES_LAT_LON_PROJECTION].varid,
+                              &glm_scalar->goes_lat_lon_projection)))
     	NC_ERR(ret);
-
-    if ((ret = nc_inq_varid(ncid, YAW_FLIP_FLAG, &yaw_flip_flag_varid)))
-	NC_ERR(ret);
-    if ((ret = nc_get_var_schar(ncid, yaw_flip_flag_varid, &glm_scalar->yaw_flip_flag)))
+    if ((ret = nc_get_var_int(ncid, var[GLM_VAR_EVENT_COUNT].varid,
+                              &glm_scalar->event_count)))
     	NC_ERR(ret);
-
-    if ((ret = nc_inq_varid(ncid, NOMINAL_SATELLITE_SUBPOINT_LAT, &nominal_satellite_subpoint_lat_varid)))
-	NC_ERR(ret);
-    if ((ret = nc_get_var_float(ncid, nominal_satellite_subpoint_lat_varid, &glm_scalar->nominal_satellite_subpoint_lat)))
+    if ((ret = nc_get_var_int(ncid, var[GLM_VAR_GROUP_COUNT].varid,
+                              &glm_scalar->group_count)))
     	NC_ERR(ret);
-
-    if ((ret = nc_inq_varid(ncid, NOMINAL_SATELLITE_HEIGHT, &nominal_satellite_height_varid)))
-	NC_ERR(ret);
-    if ((ret = nc_get_var_float(ncid, nominal_satellite_height_varid, &glm_scalar->nominal_satellite_height)))
+    if ((ret = nc_get_var_int(ncid, var[GLM_VAR_FLASH_COUNT].varid,
+                              &glm_scalar->flash_count)))
     	NC_ERR(ret);
-
-    if ((ret = nc_inq_varid(ncid, NOMINAL_SATELLITE_SUBPOINT_LON, &nominal_satellite_subpoint_lon_varid)))
-	NC_ERR(ret);
-    if ((ret = nc_get_var_float(ncid, nominal_satellite_subpoint_lon_varid, &glm_scalar->nominal_satellite_subpoint_lon)))
+    if ((ret = nc_get_var_float(ncid, var[GLM_VAR_PERCENT_NAVIGATED_L1B_EVENTS].varid,
+                                &glm_scalar->percent_navigated_L1b_events)))
     	NC_ERR(ret);
-
-    if ((ret = nc_inq_varid(ncid, LON_FIELD_OF_VIEW, &lon_field_of_view_varid)))
-	NC_ERR(ret);
-    if ((ret = nc_get_var_float(ncid, lon_field_of_view_varid, &glm_scalar->lon_field_of_view)))
+    if ((ret = nc_get_var_schar(ncid, var[GLM_VAR_YAW_FLIP_FLAG].varid,
+                                &glm_scalar->yaw_flip_flag)))
     	NC_ERR(ret);
-
-    if ((ret = nc_inq_varid(ncid, LON_FIELD_OF_VIEW_BOUNDS, &lon_field_of_view_bounds_varid)))
-	NC_ERR(ret);
-    if ((ret = nc_get_var_float(ncid, lon_field_of_view_bounds_varid, glm_scalar->lon_field_of_view_bounds)))
+    if ((ret = nc_get_var_float(ncid, var[GLM_VAR_NOMINAL_SATELLITE_SUBPOINT_LAT].varid,
+                                &glm_scalar->nominal_satellite_subpoint_lat)))
     	NC_ERR(ret);
-
-    if ((ret = nc_inq_varid(ncid, PERCENT_UNCORRECTABLE_L0_ERRORS,
-			    &percent_uncorrectable_L0_errors_varid)))
-	NC_ERR(ret);
-    if ((ret = nc_get_var_float(ncid, percent_uncorrectable_L0_errors_varid,
-				&glm_scalar->percent_uncorrectable_L0_errors)))
+    if ((ret = nc_get_var_float(ncid, var[GLM_VAR_NOMINAL_SATELLITE_HEIGHT].varid,
+                                &glm_scalar->nominal_satellite_height)))
     	NC_ERR(ret);
-
-    if ((ret = nc_inq_varid(ncid, ALGORITHM_DYNAMIC_INPUT_DATA_CONTAINER,
-			    &algorithm_dynamic_input_data_container_varid)))
-	NC_ERR(ret);
-    if ((ret = nc_get_var_int(ncid, algorithm_dynamic_input_data_container_varid,
-			      &glm_scalar->algorithm_dynamic_input_data_container)))
+    if ((ret = nc_get_var_float(ncid, var[GLM_VAR_NOMINAL_SATELLITE_SUBPOINT_LON].varid,
+                                &glm_scalar->nominal_satellite_subpoint_lon)))
     	NC_ERR(ret);
-
-    if ((ret = nc_inq_varid(ncid, PROCESSING_PARM_VERSION_CONTAINER,
-			    &processing_parm_version_container_varid)))
-	NC_ERR(ret);
-    if ((ret = nc_get_var_int(ncid, processing_parm_version_container_varid,
-			      &glm_scalar->processing_parm_version_container)))
+    if ((ret = nc_get_var_float(ncid, var[GLM_VAR_LON_FIELD_OF_VIEW].varid,
+                                &glm_scalar->lon_field_of_view)))
     	NC_ERR(ret);
-
-    if ((ret = nc_inq_varid(ncid, PROCESSING_PARM_VERSION_CONTAINER,
-			    &processing_parm_version_container_varid)))
-	NC_ERR(ret);
-    if ((ret = nc_get_var_int(ncid, processing_parm_version_container_varid,
-			      &glm_scalar->processing_parm_version_container)))
+    if ((ret = nc_get_var_float(ncid, var[GLM_VAR_LON_FIELD_OF_VIEW_BOUNDS].varid,
+                                glm_scalar->lon_field_of_view_bounds)))
     	NC_ERR(ret);
-
-    if ((ret = nc_inq_varid(ncid, ALGORITHM_PRODUCT_VERSION_CONTAINER,
-			    &algorithm_product_version_container_varid)))
-	NC_ERR(ret);
-    if ((ret = nc_get_var_int(ncid, algorithm_product_version_container_varid,
-			      &glm_scalar->algorithm_product_version_container)))
+    if ((ret = nc_get_var_float(ncid, var[GLM_VAR_PERCENT_UNCORRECTABLE_L0_ERRORS].varid,
+                                &glm_scalar->percent_uncorrectable_L0_errors)))
+    	NC_ERR(ret);
+    if ((ret = nc_get_var_int(ncid, var[GLM_VAR_ALGORITHM_DYNAMIC_INPUT_DATA_CONTAINER].varid,
+                              &glm_scalar->algorithm_dynamic_input_data_container)))
+    	NC_ERR(ret);
+    if ((ret = nc_get_var_int(ncid, var[GLM_VAR_PROCESSING_PARM_VERSION_CONTAINER].varid,
+                              &glm_scalar->processing_parm_version_container)))
+    	NC_ERR(ret);
+    if ((ret = nc_get_var_int(ncid, var[GLM_VAR_ALGORITHM_PRODUCT_VERSION_CONTAINER].varid,
+                              &glm_scalar->algorithm_product_version_container)))
     	NC_ERR(ret);
 
     return 0;
 }
 
+/**
+ * Read the scalars and small variables from the GLM file, using the
+ * varids cached in the GLM file handle.
+ *
+ * @param glm Pointer to the GLM file handle, from glm_open().
+ * @param glm_scalar Pointer to already allocated GLM_SCALAR_T.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+int
+glm_get_scalars(GLM_FILE_T *glm, GLM_SCALAR_T *glm_scalar)
+{
+    int ret;
+
+    glm_nc_lock();
+    ret = get_scalars(glm, glm_scalar);
+    glm_nc_unlock();
+
+    return ret;
+}
+
 /**
  * From GOES R SERIESPRODUCT DEFINITION AND USERS’ GUIDE(PUG) Vol 3
  * (https://www.goes-r.gov/users/docs/PUG-L1b-vol3.pdf)
@@ -326,7 +300,7 @@ read_scalars(int ncid, GLM_SCALAR_T *glm_scalar)
 int
 glm_read_file(char *file_name, int verbose)
 {
-    int ncid;
+    GLM_FILE_T *glm;
 
     size_t nevents, ngroups, nflashes;
     size_t my_nevent, my_ngroup, my_nflash;
@@ -337,11 +311,17 @@ glm_read_file(char *file_name, int verbose)
     GLM_FLASH_T *flash;
     GLM_SCALAR_T glm_scalar;
 
+    /* One block holds the structs. */
+    size_t len[NUM_FILE_ARRAYS], offset[NUM_FILE_ARRAYS], size;
+    void *block;
+
+    int close_ret;
     int ret;
 
-    /* Open the data file as read-only. */
-    if ((ret = nc_open(file_name, NC_NOWRITE, &ncid)))
-	NC_ERR(ret);
+    /* Open the data file as read-only. All the metadata is read
+     * here, once. */
+    if ((ret = glm_open(file_name, &glm)))
+	return ret;
 
     /* Optionally display some of the global attributes. The GLM data
      * files comply with the CF Conventions, and other metadata
@@ -356,48 +336,45 @@ glm_read_file(char *file_name, int verbose)
     /*         return GLM_ERR_MEMORY; */
     /* } */
 
-    /* Read the size of the dimensions. */
-    if ((ret = glm_read_dims(ncid, &nevents, &ngroups, &nflashes)))
+    /* Get the size of the dimensions. */
+    if ((ret = glm_inq_dims(glm, &nevents, &ngroups, &nflashes)))
 	return GLM_ERR_MEMORY;
 
     if (verbose)
 	printf("nflashes %zu ngroups %zu nevents %zu\n", nflashes,
 	       ngroups, nevents);
 
-    /* Allocate storage. */
-    if (!(event = malloc(nevents * sizeof(GLM_EVENT_T))))
-	return GLM_ERR_MEMORY;
-    if (!(group = malloc(ngroups * sizeof(GLM_GROUP_T))))
-	return GLM_ERR_MEMORY;
-    if (!(flash = malloc(nflashes * sizeof(GLM_FLASH_T))))
-	return GLM_ERR_MEMORY;
+    /* Allocate storage, in one block. */
+    len[0] = nevents * sizeof(GLM_EVENT_T);
+    len[1] = ngroups * sizeof(GLM_GROUP_T);
+    len[2] = nflashes * sizeof(GLM_FLASH_T);
+    if ((ret = glm_block_layout(NUM_FILE_ARRAYS, len, offset, &size)) ||
+        (ret = glm_alloc_block(size, &block)))
+    {
+        glm_close(glm);
+        return ret;
+    }
+    event = (GLM_EVENT_T *)((char *)block + offset[0]);
+    group = (GLM_GROUP_T *)((char *)block + offset[1]);
+    flash = (GLM_FLASH_T *)((char *)block + offset[2]);
 
     /* Read the vars. */
-    if ((ret = glm_read_event_structs(ncid, &my_nevent, event)))
-	return GLM_ERR_MEMORY;
-    if (my_nevent != nevents)
-        return GLM_ERR_UNEXPECTED;
-    if ((ret = glm_read_group_structs(ncid, &my_ngroup, group)))
-	return GLM_ERR_MEMORY;
-    if (my_ngroup != ngroups)
-        return GLM_ERR_UNEXPECTED;
-    if ((ret = glm_read_flash_structs(ncid, &my_nflash, flash)))
-	return GLM_ERR_MEMORY;
-    if (my_nflash != nflashes)
-        return GLM_ERR_UNEXPECTED;
-    if ((ret = read_scalars(ncid, &glm_scalar)))
-	return GLM_ERR_MEMORY;
-
-    /* Close the data file. */
-    if ((ret = nc_close(ncid)))
-	NC_ERR(ret);
+    if (!(ret = glm_get_event_structs(glm, &my_nevent, event)) &&
+        !(ret = glm_get_group_structs(glm, &my_ngroup, group)) &&
+        !(ret = glm_get_flash_structs(glm, &my_nflash, flash)) &&
+        !(ret = glm_get_scalars(glm, &glm_scalar)))
+    {
+        if (my_nevent != nevents || my_ngroup != ngroups ||
+            my_nflash != nflashes)
+            ret = GLM_ERR_UNEXPECTED;
+    }
 
-    /* Free memory. */
-    free(event);
-    free(group);
-    free(flash);
+    /* Close the data file, and free memory. */
+    if ((close_ret = glm_close(glm)) && !ret)
+        ret = close_ret;
+    glm_free(block);
 
-    return 0;
+    return ret;
 }
 
 /**
@@ -412,7 +389,7 @@ glm_read_file(char *file_name, int verbose)
 int
 glm_read_file_arrays(char *file_name, int verbose)
 {
-    int ncid;
+    GLM_FILE_T *glm;
 
     size_t nevents, ngroups, nflashes;
     size_t my_nevent;
@@ -423,70 +400,54 @@ glm_read_file_arrays(char *file_name, int verbose)
     float *lat, *lon, *energy;
     int *parent_group_id;
 
-    /* Arrays for group data. */
-    GLM_GROUP_T *group;
-
-    /* Arrays for flash data. */
-    GLM_FLASH_T *flash;
-
     /* Scalar data. */
     GLM_SCALAR_T glm_scalar;
 
+    /* One block holds the arrays. */
+    size_t len[NUM_FILE_ARRAYS_ARRAYS], offset[NUM_FILE_ARRAYS_ARRAYS], size;
+    void *block;
+
+    int close_ret;
     int ret;
 
     /* Open the data file as read-only. */
-    if ((ret = nc_open(file_name, NC_NOWRITE, &ncid)))
-	NC_ERR(ret);
+    if ((ret = glm_open(file_name, &glm)))
+	return ret;
 
-    /* Read the size of the dimensions. */
-    if ((ret = glm_read_dims(ncid, &nevents, &ngroups, &nflashes)))
+    /* Get the size of the dimensions. */
+    if ((ret = glm_inq_dims(glm, &nevents, &ngroups, &nflashes)))
 	return GLM_ERR_MEMORY;
 
     if (verbose)
 	printf("nflashes %zu ngroups %zu nevents %zu\n", nflashes,
 	       ngroups, nevents);
 
-    /* Allocate storage for event arrays. */
-    if (!(event_id = malloc(nevents * sizeof(int))))
-	return GLM_ERR_MEMORY;
-    if (!(time_offset = malloc(nevents * sizeof(float))))
-	return GLM_ERR_MEMORY;
-    if (!(lat = malloc(nevents * sizeof(float))))
-	return GLM_ERR_MEMORY;
-    if (!(lon = malloc(nevents * sizeof(float))))
-	return GLM_ERR_MEMORY;
-    if (!(energy = malloc(nevents * sizeof(float))))
-	return GLM_ERR_MEMORY;
-    if (!(parent_group_id = malloc(nevents * sizeof(int))))
-	return GLM_ERR_MEMORY;
-
-    /* Allocate storage for group arrays. */
-    if (!(group = malloc(ngroups * sizeof(GLM_GROUP_T))))
-	return GLM_ERR_MEMORY;
-
-    /* Allocate storage for flash arrays. */
-    if (!(flash = malloc(nflashes * sizeof(GLM_FLASH_T))))
-	return GLM_ERR_MEMORY;
+    /* Allocate storage, in one block. */
+    len[0] = nevents * sizeof(int);
+    len[1] = len[2] = len[3] = len[4] = nevents * sizeof(float);
+    len[5] = nevents * sizeof(int);
+    if ((ret = glm_block_layout(NUM_FILE_ARRAYS_ARRAYS, len, offset, &size)) ||
+        (ret = glm_alloc_block(size, &block)))
+    {
+        glm_close(glm);
+        return ret;
+    }
+    event_id = (int *)((char *)block + offset[0]);
+    time_offset = (float *)((char *)block + offset[1]);
+    lat = (float *)((char *)block + offset[2]);
+    lon = (float *)((char *)block + offset[3]);
+    energy = (float *)((char *)block + offset[4]);
+    parent_group_id = (int *)((char *)block + offset[5]);
 
     /* Read the vars. */
-    if ((ret = glm_read_event_arrays(ncid, &my_nevent, event_id, time_offset,
+    if (!(ret = glm_get_event_arrays(glm, &my_nevent, event_id, time_offset,
                                      lat, lon, energy, parent_group_id)))
-	return GLM_ERR_MEMORY;
-    /* if ((ret = read_group_vars(ncid, ngroups, group))) */
-    /*     return GLM_ERR_MEMORY; */
-    /* if ((ret = read_flash_vars(ncid, nflashes, flash))) */
-    /*     return GLM_ERR_MEMORY; */
-    if ((ret = read_scalars(ncid, &glm_scalar)))
-	return GLM_ERR_MEMORY;
+        ret = glm_get_scalars(glm, &glm_scalar);
 
-    /* Close the data file. */
-    if ((ret = nc_close(ncid)))
-	NC_ERR(ret);
-
-    /* Free memory. */
-    free(event_id);
-    free(group);
-    free(flash);
+    /* Close the data file, and free memory. */
+    if ((close_ret = glm_close(glm)) && !ret)
+        ret = close_ret;
+    glm_free(block);
 
-    return 0;
+    return ret;
 }
@@ -0,0 +1,410 @@
+/**
+ * @file
+ * Code for a reader context, which reads one GLM file after another
+ * into buffers it owns.
+ *
+ * Ingest of a stream of granules is mostly allocation: each file
+ * needs a handle, a scratch buffer, and room for its events, groups
+ * and flashes. A reader keeps all of these from one file to the
+ * next. Each buffer only grows when a file is bigger than any the
+ * reader has read before, so once the largest granule has been seen,
+ * reading another does no allocation in the library at all.
+ *
+ * @author Ed Hartnett
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <assert.h>
+#include "glm_internal.h"
+
+/** A reader context. */
+struct GLM_READER
+{
+    GLM_FILE_T glm;       /**< The handle, reused for every file. */
+    int open;             /**< Non-zero if a file is open. */
+    char *path;           /**< Name of the open file. */
+    size_t path_size;     /**< Size of the path buffer in bytes. */
+    GLM_EVENT_T *event;   /**< Events of the open file. */
+    size_t event_cap;     /**< Room for events. */
+    GLM_GROUP_T *group;   /**< Groups of the open file. */
+    size_t group_cap;     /**< Room for groups. */
+    GLM_FLASH_T *flash;   /**< Flashes of the open file. */
+    size_t flash_cap;     /**< Room for flashes. */
+    GLM_SCALAR_T scalar;  /**< Scalars of the open file. */
+    GLM_BATCH_T batch;    /**< All the data of the open file. */
+    size_t block_size;    /**< Size of the block of the batch. */
+};
+
+/**
+ * Make sure a buffer has room for n elements, growing it if it does
+ * not. The old contents are not kept.
+ *
+ * @param buf Pointer to the buffer, which may be NULL.
+ * @param cap Pointer to the number of elements there is room for.
+ * @param n Number of elements needed.
+ * @param size Size of each element in bytes.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+static int
+reader_grow(void **buf, size_t *cap, size_t n, size_t size)
+{
+    void *new_buf;
+
+    if (n <= *cap)
+        return 0;
+    if (n > SIZE_MAX / size)
+        return GLM_ERR_RANGE;
+    if (!(new_buf = glm_aligned_alloc(n * size, GLM_ALIGN)))
+        return GLM_ERR_MEMORY;
+    glm_free(*buf);
+    *buf = new_buf;
+    *cap = n;
+
+    return 0;
+}
+
+/**
+ * Create a reader context, with no file open.
+ *
+ * @param readerp Pointer that gets the reader. Free it with
+ * glm_reader_free().
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+int
+glm_reader_create(GLM_READER_T **readerp)
+{
+    GLM_READER_T *reader;
+    int v;
+
+    /* Check inputs. */
+    assert(readerp);
+
+    if (!(reader = glm_calloc(1, sizeof(GLM_READER_T))))
+        return GLM_ERR_MEMORY;
+    reader->glm.nthreads = 1;
+    for (v = 0; v < GLM_NUM_VARS; v++)
+        reader->glm.var[v].varid = -1;
+    *readerp = reader;
+
+    return 0;
+}
+
+/**
+ * Open a GLM file with a reader, closing the file it had open, if
+ * any. The reader keeps its buffers, and the fields and number of
+ * threads chosen with glm_set_fields() and glm_set_nthreads() on
+ * glm_reader_file(). Direct chunk reads are off for each new file.
+ *
+ * @param reader Pointer to the reader.
+ * @param file_name Name of the GLM file.
+ *
+ * @return 0 for success, error code otherwise. On error no file is
+ * open.
+ * @author Ed Hartnett
+ */
+int
+glm_reader_open(GLM_READER_T *reader, const char *file_name)
+{
+    GLM_FILE_T *glm;
+    void *scratch;
+    size_t scratch_size;
+    int skip[GLM_NUM_VARS];
+    int nthreads;
+    size_t len;
+    int ncid;
+    int v;
+    int ret;
+
+    /* Check inputs. */
+    assert(reader && file_name);
+    glm = &reader->glm;
+
+    if ((ret = glm_reader_close(reader)))
+        return ret;
+
+    /* Keep the name, for glm_set_direct(). */
+    len = strlen(file_name) + 1;
+    if ((ret = reader_grow((void **)&reader->path, &reader->path_size, len, 1)))
+        return ret;
+    memcpy(reader->path, file_name, len);
+
+    /* glm_file_init() starts a handle afresh, so save what the reader
+     * keeps from file to file. */
+    scratch = glm->scratch;
+    scratch_size = glm->scratch_size;
+    nthreads = glm->nthreads;
+    for (v = 0; v < GLM_NUM_VARS; v++)
+        skip[v] = glm->var[v].skip;
+
+    glm_nc_lock();
+    if ((ret = nc_open(file_name, NC_NOWRITE, &ncid)))
+    {
+        glm_nc_unlock();
+        NC_ERR(ret);
+    }
+    ret = glm_file_init(ncid, GLM_SECTION_ALL, glm);
+    if (ret)
+        nc_close(ncid);
+    glm_nc_unlock();
+
+    glm->scratch = scratch;
+    glm->scratch_size = scratch_size;
+    glm->nthreads = nthreads;
+    for (v = 0; v < GLM_NUM_VARS; v++)
+        glm->var[v].skip = skip[v];
+    if (ret)
+        return ret;
+    glm->own_ncid = 1;
+    glm->path = reader->path;
+    reader->open = 1;
+
+    return 0;
+}
+
+/**
+ * Get the handle of the file open in a reader. Any function which
+ * takes a GLM_FILE_T may be used on it, and reads into the scratch
+ * buffer of the reader. It is valid until the reader opens another
+ * file, or is closed or freed, and must not be passed to
+ * glm_close().
+ *
+ * @param reader Pointer to the reader.
+ * @param glm Pointer that gets the handle.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+int
+glm_reader_file(GLM_READER_T *reader, GLM_FILE_T **glm)
+{
+    /* Check inputs. */
+    assert(reader && glm);
+    if (!reader->open)
+        return GLM_ERR_UNEXPECTED;
+
+    *glm = &reader->glm;
+
+    return 0;
+}
+
+/**
+ * Read the events of the file open in a reader into a buffer of the
+ * reader.
+ *
+ * @param reader Pointer to the reader.
+ * @param nevent Pointer that gets the number of events.
+ * @param event Pointer that gets the events. They are valid until
+ * the next read of events by the reader, or it is closed or freed.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+int
+glm_reader_events(GLM_READER_T *reader, size_t *nevent,
+                  const GLM_EVENT_T **event)
+{
+    int ret;
+
+    /* Check inputs. */
+    assert(reader && nevent && event);
+    if (!reader->open)
+        return GLM_ERR_UNEXPECTED;
+
+    if ((ret = reader_grow((void **)&reader->event, &reader->event_cap,
+                           reader->glm.nevent, sizeof(GLM_EVENT_T))))
+        return ret;
+    if ((ret = glm_get_event_structs(&reader->glm, nevent, reader->event)))
+        return ret;
+    *event = reader->event;
+
+    return 0;
+}
+
+/**
+ * Read the groups of the file open in a reader into a buffer of the
+ * reader.
+ *
+ * @param reader Pointer to the reader.
+ * @param ngroup Pointer that gets the number of groups.
+ * @param group Pointer that gets the groups. They are valid until
+ * the next read of groups by the reader, or it is closed or freed.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+int
+glm_reader_groups(GLM_READER_T *reader, size_t *ngroup,
+                  const GLM_GROUP_T **group)
+{
+    int ret;
+
+    /* Check inputs. */
+    assert(reader && ngroup && group);
+    if (!reader->open)
+        return GLM_ERR_UNEXPECTED;
+
+    if ((ret = reader_grow((void **)&reader->group, &reader->group_cap,
+                           reader->glm.ngroup, sizeof(GLM_GROUP_T))))
+        return ret;
+    if ((ret = glm_get_group_structs(&reader->glm, ngroup, reader->group)))
+        return ret;
+    *group = reader->group;
+
+    return 0;
+}
+
+/**
+ * Read the flashes of the file open in a reader into a buffer of the
+ * reader.
+ *
+ * @param reader Pointer to the reader.
+ * @param nflash Pointer that gets the number of flashes.
+ * @param flash Pointer that gets the flashes. They are valid until
+ * the next read of flashes by the reader, or it is closed or freed.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+int
+glm_reader_flashes(GLM_READER_T *reader, size_t *nflash,
+                   const GLM_FLASH_T **flash)
+{
+    int ret;
+
+    /* Check inputs. */
+    assert(reader && nflash && flash);
+    if (!reader->open)
+        return GLM_ERR_UNEXPECTED;
+
+    if ((ret = reader_grow((void **)&reader->flash, &reader->flash_cap,
+                           reader->glm.nflash, sizeof(GLM_FLASH_T))))
+        return ret;
+    if ((ret = glm_get_flash_structs(&reader->glm, nflash, reader->flash)))
+        return ret;
+    *flash = reader->flash;
+
+    return 0;
+}
+
+/**
+ * Read the scalars of the file open in a reader into the reader.
+ *
+ * @param reader Pointer to the reader.
+ * @param scalar Pointer that gets the scalars. They are valid until
+ * the next read of scalars by the reader, or it is freed.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+int
+glm_reader_scalars(GLM_READER_T *reader, const GLM_SCALAR_T **scalar)
+{
+    int ret;
+
+    /* Check inputs. */
+    assert(reader && scalar);
+    if (!reader->open)
+        return GLM_ERR_UNEXPECTED;
+
+    if ((ret = glm_get_scalars(&reader->glm, &reader->scalar)))
+        return ret;
+    *scalar = &reader->scalar;
+
+    return 0;
+}
+
+/**
+ * Read all the data of the file open in a reader into a batch of the
+ * reader, as glm_read_files() would for one file.
+ *
+ * @param reader Pointer to the reader.
+ * @param batch Pointer that gets the batch. It is valid until the
+ * next read of a batch by the reader, or it is freed, and must not
+ * be passed to glm_free_batch().
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+int
+glm_reader_batch(GLM_READER_T *reader, const GLM_BATCH_T **batch)
+{
+    int ret;
+
+    /* Check inputs. */
+    assert(reader && batch);
+    if (!reader->open)
+        return GLM_ERR_UNEXPECTED;
+
+    if ((ret = glm_batch_read(&reader->glm, &reader->batch,
+                              &reader->block_size)))
+        return ret;
+    *batch = &reader->batch;
+
+    return 0;
+}
+
+/**
+ * Close the file open in a reader, if any, keeping the buffers of the
+ * reader for the next file.
+ *
+ * @param reader Pointer to the reader.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+int
+glm_reader_close(GLM_READER_T *reader)
+{
+    int ret;
+
+    /* Check inputs. */
+    assert(reader);
+
+    if (!reader->open)
+        return 0;
+    reader->open = 0;
+    glm_direct_free(&reader->glm);
+    glm_nc_lock();
+    ret = nc_close(reader->glm.ncid);
+    glm_nc_unlock();
+    if (ret)
+        NC_ERR(ret);
+
+    return 0;
+}
+
+/**
+ * Close the file open in a reader, if any, and free the reader and
+ * all its buffers.
+ *
+ * @param reader Pointer to the reader.
+ *
+ * @return 0 for success, error code otherwise.
+ * @author Ed Hartnett
+ */
+int
+glm_reader_free(GLM_READER_T *reader)
+{
+    int ret;
+
+    /* Check inputs. */
+    assert(reader);
+
+    ret = glm_reader_close(reader);
+    glm_free(reader->glm.scratch);
+    glm_free(reader->path);
+    glm_free(reader->event);
+    glm_free(reader->group);
+    glm_free(reader->flash);
+    glm_free(reader->batch.block);
+    glm_free(reader);
+
+    return ret;
+}
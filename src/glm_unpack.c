@@ -0,0 +1,1083 @@
+/**
+ * @file
+ * Kernels which unpack and copy GLM data into output columns.
+ *
+ * Each kernel writes n values to dst, which are stride bytes
+ * apart. When stride is the size of the output type, the output is
+ * an array, otherwise it is a field in an array of struct.
+ *
+ * When unpacking into an array, the packed data may be stored at the
+ * end of the output array itself. Since the output values are never
+ * smaller than the input values, writing output value i can only
+ * overwrite input values which have already been read. The SIMD
+ * kernels load each block of input before storing any of its
+ * output, so this still holds.
+ *
+ * On x86, SSE2, AVX2 and AVX-512 versions of the unpacking kernels
+ * are built with function target attributes, and the best one the
+ * CPU supports is chosen at run time. Every version does the
+ * multiply and the add as two separate single precision operations,
+ * exactly like the scalar code, so all of them return bit-identical
+ * results.
+ *
+ * Time offsets may also be decoded to int64 nanoseconds since the
+ * Unix epoch. The unpacking is done in double precision, on the
+ * scale factor and offset in nanoseconds, and is rounded to a whole
+ * nanosecond by adding GLM_ROUND_MAGIC, which leaves the rounded
+ * value in the low bits of the double. Neither SSE2, AVX2, nor
+ * AVX-512F can convert doubles to int64 directly. The scalar code
+ * rounds the same way, so again all versions agree to the bit.
+ *
+ * @author Ed Hartnett
+*/
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include "glm_internal.h"
+
+/* Do not let the compiler fuse the multiply and add into an FMA, or
+ * results would depend on the compiler flags. */
+#if defined(__clang__)
+#pragma STDC FP_CONTRACT OFF
+#elif defined(__GNUC__)
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define GLM_X86 1
+#include <immintrin.h>
+#endif
+
+/** Number of values unpacked at a time into a temporary array, when
+ * unpacking into an array of struct. */
+#define BLOCK_LEN 256
+
+/** 1.5 * 2^52. Adding it to a double of magnitude less than 2^51
+ * rounds it to a whole number, and leaves that number, plus the bits
+ * of GLM_ROUND_MAGIC, in the bits of the sum. */
+#define GLM_ROUND_MAGIC 6755399441055744.0
+
+/** Kernel level in use, or -1 if not chosen yet. */
+static int simd_level = -1;
+
+/* The level may be chosen by several threads at once. */
+#ifdef __GNUC__
+#define LOAD_LEVEL() __atomic_load_n(&simd_level, __ATOMIC_RELAXED)
+#define STORE_LEVEL(l) __atomic_store_n(&simd_level, (l), __ATOMIC_RELAXED)
+#else
+#define LOAD_LEVEL() (simd_level)
+#define STORE_LEVEL(l) (simd_level = (l))
+#endif
+
+/**
+ * Find the best kernel level supported by this CPU.
+ *
+ * @return One of the GLM_SIMD_* levels.
+ * @author Ed Hartnett
+ */
+static int
+cpu_simd_level(void)
+{
+#ifdef GLM_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        return GLM_SIMD_AVX512;
+    if (__builtin_cpu_supports("avx2"))
+        return GLM_SIMD_AVX2;
+    if (__builtin_cpu_supports("sse2"))
+        return GLM_SIMD_SSE2;
+#endif
+    return GLM_SIMD_SCALAR;
+}
+
+/**
+ * Find the kernel level in use. It is chosen the first time this is
+ * called. Threads which race here all compute the same value.
+ *
+ * @return One of the GLM_SIMD_* levels.
+ * @author Ed Hartnett
+ */
+int
+glm_unpack_level(void)
+{
+    int level = LOAD_LEVEL();
+
+    if (level < 0)
+    {
+        level = cpu_simd_level();
+        STORE_LEVEL(level);
+    }
+
+    return level;
+}
+
+/**
+ * Choose the kernel level. This is used by tests, to check each
+ * level against the scalar code.
+ *
+ * @param level One of the GLM_SIMD_* levels, or -1 to use the best
+ * level supported by the CPU.
+ *
+ * @return 0 for success, GLM_ERR_UNEXPECTED if the CPU does not
+ * support the level.
+ * @author Ed Hartnett
+ */
+int
+glm_unpack_set_level(int level)
+{
+    int max_level = cpu_simd_level();
+
+    if (level > max_level)
+        return GLM_ERR_UNEXPECTED;
+    if (level < 0)
+        level = max_level;
+    STORE_LEVEL(level);
+
+    return 0;
+}
+
+/**
+ * Unpack contiguous unsigned short data to float, one value at a
+ * time.
+ *
+ * @param src Packed values.
+ * @param n Number of values.
+ * @param scale The scale_factor.
+ * @param offset The add_offset.
+ * @param dst Float output.
+ *
+ * @author Ed Hartnett
+ */
+static void
+unpack_scalar(const unsigned short *src, size_t n, float scale,
+              float offset, float *dst)
+{
+    size_t i;
+
+    for (i = 0; i < n; i++)
+        dst[i] = (float)src[i] * scale + offset;
+}
+
+/**
+ * Widen contiguous unsigned short data to unsigned int, one value at
+ * a time.
+ *
+ * @param src Input values.
+ * @param n Number of values.
+ * @param dst Output values.
+ *
+ * @author Ed Hartnett
+ */
+static void
+widen_scalar(const unsigned short *src, size_t n, unsigned int *dst)
+{
+    size_t i;
+
+    for (i = 0; i < n; i++)
+        dst[i] = src[i];
+}
+
+/**
+ * Get the bits of a double as an int64.
+ *
+ * @param d The double.
+ *
+ * @return Its bits.
+ * @author Ed Hartnett
+ */
+static int64_t
+double_bits(double d)
+{
+    int64_t i;
+
+    memcpy(&i, &d, sizeof(i));
+    return i;
+}
+
+/**
+ * Decode contiguous packed time offsets to nanoseconds since the
+ * Unix epoch, one value at a time.
+ *
+ * @param src Packed values.
+ * @param n Number of values.
+ * @param scale The scale_factor, in ns.
+ * @param offset The add_offset, in ns.
+ * @param base product_time, in ns since the Unix epoch.
+ * @param dst Output times.
+ *
+ * @author Ed Hartnett
+ */
+static void
+ns_scalar(const unsigned short *src, size_t n, double scale, double offset,
+          int64_t base, int64_t *dst)
+{
+    const int64_t magic = double_bits(GLM_ROUND_MAGIC);
+    size_t i;
+
+    for (i = 0; i < n; i++)
+    {
+        double d = (double)src[i] * scale + offset;
+
+        dst[i] = double_bits(d + GLM_ROUND_MAGIC) - magic + base;
+    }
+}
+
+/**
+ * Match contiguous unsigned short data against a range, one value at
+ * a time. See glm_match_ushort().
+ *
+ * @param src Input values.
+ * @param n Number of values.
+ * @param lo Smallest value in the range.
+ * @param span Largest value in the range, minus lo.
+ * @param match Match flags, cleared for values not in the range.
+ *
+ * @author Ed Hartnett
+ */
+static void
+match_scalar(const unsigned short *src, size_t n, unsigned short lo,
+             unsigned short span, unsigned char *match)
+{
+    size_t i;
+
+    for (i = 0; i < n; i++)
+        match[i] &= (unsigned short)(src[i] - lo) <= span;
+}
+
+#ifdef GLM_X86
+/**
+ * Unpack contiguous unsigned short data to float, 8 values at a time,
+ * with SSE2.
+ *
+ * @param src Packed values.
+ * @param n Number of values.
+ * @param scale The scale_factor.
+ * @param offset The add_offset.
+ * @param dst Float output.
+ *
+ * @author Ed Hartnett
+ */
+__attribute__((target("sse2"))) static void
+unpack_sse2(const unsigned short *src, size_t n, float scale, float offset,
+            float *dst)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128 vscale = _mm_set1_ps(scale);
+    const __m128 voffset = _mm_set1_ps(offset);
+    size_t i;
+
+    for (i = 0; i + 8 <= n; i += 8)
+    {
+        __m128i in = _mm_loadu_si128((const __m128i *)(src + i));
+        __m128 lo = _mm_cvtepi32_ps(_mm_unpacklo_epi16(in, zero));
+        __m128 hi = _mm_cvtepi32_ps(_mm_unpackhi_epi16(in, zero));
+
+        _mm_storeu_ps(dst + i, _mm_add_ps(_mm_mul_ps(lo, vscale), voffset));
+        _mm_storeu_ps(dst + i + 4, _mm_add_ps(_mm_mul_ps(hi, vscale), voffset));
+    }
+    unpack_scalar(src + i, n - i, scale, offset, dst + i);
+}
+
+/**
+ * Widen contiguous unsigned short data to unsigned int, 8 values at a
+ * time, with SSE2.
+ *
+ * @param src Input values.
+ * @param n Number of values.
+ * @param dst Output values.
+ *
+ * @author Ed Hartnett
+ */
+__attribute__((target("sse2"))) static void
+widen_sse2(const unsigned short *src, size_t n, unsigned int *dst)
+{
+    const __m128i zero = _mm_setzero_si128();
+    size_t i;
+
+    for (i = 0; i + 8 <= n; i += 8)
+    {
+        __m128i in = _mm_loadu_si128((const __m128i *)(src + i));
+        __m128i lo = _mm_unpacklo_epi16(in, zero);
+        __m128i hi = _mm_unpackhi_epi16(in, zero);
+
+        _mm_storeu_si128((__m128i *)(dst + i), lo);
+        _mm_storeu_si128((__m128i *)(dst + i + 4), hi);
+    }
+    widen_scalar(src + i, n - i, dst + i);
+}
+
+/**
+ * Unpack contiguous unsigned short data to float, 8 values at a time,
+ * with AVX2.
+ *
+ * @param src Packed values.
+ * @param n Number of values.
+ * @param scale The scale_factor.
+ * @param offset The add_offset.
+ * @param dst Float output.
+ *
+ * @author Ed Hartnett
+ */
+__attribute__((target("avx2"))) static void
+unpack_avx2(const unsigned short *src, size_t n, float scale, float offset,
+            float *dst)
+{
+    const __m256 vscale = _mm256_set1_ps(scale);
+    const __m256 voffset = _mm256_set1_ps(offset);
+    size_t i;
+
+    for (i = 0; i + 8 <= n; i += 8)
+    {
+        __m128i in = _mm_loadu_si128((const __m128i *)(src + i));
+        __m256 f = _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(in));
+
+        _mm256_storeu_ps(dst + i, _mm256_add_ps(_mm256_mul_ps(f, vscale),
+                                                voffset));
+    }
+    unpack_scalar(src + i, n - i, scale, offset, dst + i);
+}
+
+/**
+ * Widen contiguous unsigned short data to unsigned int, 8 values at a
+ * time, with AVX2.
+ *
+ * @param src Input values.
+ * @param n Number of values.
+ * @param dst Output values.
+ *
+ * @author Ed Hartnett
+ */
+__attribute__((target("avx2"))) static void
+widen_avx2(const unsigned short *src, size_t n, unsigned int *dst)
+{
+    size_t i;
+
+    for (i = 0; i + 8 <= n; i += 8)
+    {
+        __m128i in = _mm_loadu_si128((const __m128i *)(src + i));
+
+        _mm256_storeu_si256((__m256i *)(dst + i), _mm256_cvtepu16_epi32(in));
+    }
+    widen_scalar(src + i, n - i, dst + i);
+}
+
+/**
+ * Unpack contiguous unsigned short data to float, 16 values at a
+ * time, with AVX-512.
+ *
+ * @param src Packed values.
+ * @param n Number of values.
+ * @param scale The scale_factor.
+ * @param offset The add_offset.
+ * @param dst Float output.
+ *
+ * @author Ed Hartnett
+ */
+__attribute__((target("avx512f"))) static void
+unpack_avx512(const unsigned short *src, size_t n, float scale,
+              float offset, float *dst)
+{
+    const __m512 vscale = _mm512_set1_ps(scale);
+    const __m512 voffset = _mm512_set1_ps(offset);
+    size_t i;
+
+    for (i = 0; i + 16 <= n; i += 16)
+    {
+        __m256i in = _mm256_loadu_si256((const __m256i *)(src + i));
+        __m512 f = _mm512_cvtepi32_ps(_mm512_cvtepu16_epi32(in));
+
+        _mm512_storeu_ps(dst + i, _mm512_add_ps(_mm512_mul_ps(f, vscale),
+                                                voffset));
+    }
+    unpack_scalar(src + i, n - i, scale, offset, dst + i);
+}
+
+/**
+ * Widen contiguous unsigned short data to unsigned int, 16 values at
+ * a time, with AVX-512.
+ *
+ * @param src Input values.
+ * @param n Number of values.
+ * @param dst Output values.
+ *
+ * @author Ed Hartnett
+ */
+__attribute__((target("avx512f"))) static void
+widen_avx512(const unsigned short *src, size_t n, unsigned int *dst)
+{
+    size_t i;
+
+    for (i = 0; i + 16 <= n; i += 16)
+    {
+        __m256i in = _mm256_loadu_si256((const __m256i *)(src + i));
+
+        _mm512_storeu_si512((void *)(dst + i), _mm512_cvtepu16_epi32(in));
+    }
+    widen_scalar(src + i, n - i, dst + i);
+}
+/**
+ * Decode contiguous packed time offsets to nanoseconds since the
+ * Unix epoch, 8 values at a time, with SSE2.
+ *
+ * @param src Packed values.
+ * @param n Number of values.
+ * @param scale The scale_factor, in ns.
+ * @param offset The add_offset, in ns.
+ * @param base product_time, in ns since the Unix epoch.
+ * @param dst Output times.
+ *
+ * @author Ed Hartnett
+ */
+__attribute__((target("sse2"))) static void
+ns_sse2(const unsigned short *src, size_t n, double scale, double offset,
+        int64_t base, int64_t *dst)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128d vscale = _mm_set1_pd(scale);
+    const __m128d voffset = _mm_set1_pd(offset);
+    const __m128d vmagic = _mm_set1_pd(GLM_ROUND_MAGIC);
+    const __m128i vbase = _mm_set1_epi64x(base - double_bits(GLM_ROUND_MAGIC));
+    size_t i;
+    int k;
+
+    for (i = 0; i + 8 <= n; i += 8)
+    {
+        __m128i in = _mm_loadu_si128((const __m128i *)(src + i));
+        __m128i w[2];
+
+        w[0] = _mm_unpacklo_epi16(in, zero);
+        w[1] = _mm_unpackhi_epi16(in, zero);
+        for (k = 0; k < 4; k++)
+        {
+            __m128i x = k % 2 ? _mm_shuffle_epi32(w[k / 2], 0xee) : w[k / 2];
+            __m128d d = _mm_mul_pd(_mm_cvtepi32_pd(x), vscale);
+
+            d = _mm_add_pd(_mm_add_pd(d, voffset), vmagic);
+            _mm_storeu_si128((__m128i *)(dst + i + 2 * k),
+                             _mm_add_epi64(_mm_castpd_si128(d), vbase));
+        }
+    }
+    ns_scalar(src + i, n - i, scale, offset, base, dst + i);
+}
+
+/**
+ * Decode contiguous packed time offsets to nanoseconds since the
+ * Unix epoch, 8 values at a time, with AVX2.
+ *
+ * @param src Packed values.
+ * @param n Number of values.
+ * @param scale The scale_factor, in ns.
+ * @param offset The add_offset, in ns.
+ * @param base product_time, in ns since the Unix epoch.
+ * @param dst Output times.
+ *
+ * @author Ed Hartnett
+ */
+__attribute__((target("avx2"))) static void
+ns_avx2(const unsigned short *src, size_t n, double scale, double offset,
+        int64_t base, int64_t *dst)
+{
+    const __m256d vscale = _mm256_set1_pd(scale);
+    const __m256d voffset = _mm256_set1_pd(offset);
+    const __m256d vmagic = _mm256_set1_pd(GLM_ROUND_MAGIC);
+    const __m256i vbase = _mm256_set1_epi64x(base - double_bits(GLM_ROUND_MAGIC));
+    size_t i;
+
+    for (i = 0; i + 8 <= n; i += 8)
+    {
+        __m128i in = _mm_loadu_si128((const __m128i *)(src + i));
+        __m256i w = _mm256_cvtepu16_epi32(in);
+        __m256d lo = _mm256_cvtepi32_pd(_mm256_castsi256_si128(w));
+        __m256d hi = _mm256_cvtepi32_pd(_mm256_extracti128_si256(w, 1));
+
+        lo = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(lo, vscale), voffset), vmagic);
+        hi = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(hi, vscale), voffset), vmagic);
+        _mm256_storeu_si256((__m256i *)(dst + i),
+                            _mm256_add_epi64(_mm256_castpd_si256(lo), vbase));
+        _mm256_storeu_si256((__m256i *)(dst + i + 4),
+                            _mm256_add_epi64(_mm256_castpd_si256(hi), vbase));
+    }
+    ns_scalar(src + i, n - i, scale, offset, base, dst + i);
+}
+
+/**
+ * Decode contiguous packed time offsets to nanoseconds since the
+ * Unix epoch, 16 values at a time, with AVX-512.
+ *
+ * @param src Packed values.
+ * @param n Number of values.
+ * @param scale The scale_factor, in ns.
+ * @param offset The add_offset, in ns.
+ * @param base product_time, in ns since the Unix epoch.
+ * @param dst Output times.
+ *
+ * @author Ed Hartnett
+ */
+__attribute__((target("avx512f"))) static void
+ns_avx512(const unsigned short *src, size_t n, double scale, double offset,
+          int64_t base, int64_t *dst)
+{
+    const __m512d vscale = _mm512_set1_pd(scale);
+    const __m512d voffset = _mm512_set1_pd(offset);
+    const __m512d vmagic = _mm512_set1_pd(GLM_ROUND_MAGIC);
+    const __m512i vbase = _mm512_set1_epi64(base - double_bits(GLM_ROUND_MAGIC));
+    size_t i;
+
+    for (i = 0; i + 16 <= n; i += 16)
+    {
+        __m256i in = _mm256_loadu_si256((const __m256i *)(src + i));
+        __m512i w = _mm512_cvtepu16_epi32(in);
+        __m512d lo = _mm512_cvtepi32_pd(_mm512_castsi512_si256(w));
+        __m512d hi = _mm512_cvtepi32_pd(_mm512_extracti64x4_epi64(w, 1));
+
+        lo = _mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(lo, vscale), voffset), vmagic);
+        hi = _mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(hi, vscale), voffset), vmagic);
+        _mm512_storeu_si512((void *)(dst + i),
+                            _mm512_add_epi64(_mm512_castpd_si512(lo), vbase));
+        _mm512_storeu_si512((void *)(dst + i + 8),
+                            _mm512_add_epi64(_mm512_castpd_si512(hi), vbase));
+    }
+    ns_scalar(src + i, n - i, scale, offset, base, dst + i);
+}
+
+/**
+ * Match contiguous unsigned short data against a range, 16 values at
+ * a time, with SSE2. See glm_match_ushort().
+ *
+ * @param src Input values.
+ * @param n Number of values.
+ * @param lo Smallest value in the range.
+ * @param span Largest value in the range, minus lo.
+ * @param match Match flags, cleared for values not in the range.
+ *
+ * @author Ed Hartnett
+ */
+__attribute__((target("sse2"))) static void
+match_sse2(const unsigned short *src, size_t n, unsigned short lo,
+           unsigned short span, unsigned char *match)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi8(1);
+    const __m128i vlo = _mm_set1_epi16((short)lo);
+    const __m128i vspan = _mm_set1_epi16((short)span);
+    size_t i;
+
+    for (i = 0; i + 16 <= n; i += 16)
+    {
+        __m128i a = _mm_sub_epi16(_mm_loadu_si128((const __m128i *)(src + i)), vlo);
+        __m128i b = _mm_sub_epi16(_mm_loadu_si128((const __m128i *)(src + i + 8)), vlo);
+        __m128i in, old;
+
+        /* x <= span exactly when x - span saturates to 0. */
+        a = _mm_cmpeq_epi16(_mm_subs_epu16(a, vspan), zero);
+        b = _mm_cmpeq_epi16(_mm_subs_epu16(b, vspan), zero);
+        in = _mm_and_si128(_mm_packs_epi16(a, b), one);
+        old = _mm_loadu_si128((const __m128i *)(match + i));
+        _mm_storeu_si128((__m128i *)(match + i), _mm_and_si128(old, in));
+    }
+    match_scalar(src + i, n - i, lo, span, match + i);
+}
+
+/**
+ * Match contiguous unsigned short data against a range, 32 values at
+ * a time, with AVX2. See glm_match_ushort().
+ *
+ * @param src Input values.
+ * @param n Number of values.
+ * @param lo Smallest value in the range.
+ * @param span Largest value in the range, minus lo.
+ * @param match Match flags, cleared for values not in the range.
+ *
+ * @author Ed Hartnett
+ */
+__attribute__((target("avx2"))) static void
+match_avx2(const unsigned short *src, size_t n, unsigned short lo,
+           unsigned short span, unsigned char *match)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one = _mm256_set1_epi8(1);
+    const __m256i vlo = _mm256_set1_epi16((short)lo);
+    const __m256i vspan = _mm256_set1_epi16((short)span);
+    size_t i;
+
+    for (i = 0; i + 32 <= n; i += 32)
+    {
+        __m256i a = _mm256_sub_epi16(_mm256_loadu_si256((const __m256i *)(src + i)), vlo);
+        __m256i b = _mm256_sub_epi16(_mm256_loadu_si256((const __m256i *)(src + i + 16)), vlo);
+        __m256i in, old;
+
+        a = _mm256_cmpeq_epi16(_mm256_subs_epu16(a, vspan), zero);
+        b = _mm256_cmpeq_epi16(_mm256_subs_epu16(b, vspan), zero);
+
+        /* Packing works within each 128-bit lane, so put the 64-bit
+         * quarters back in order. */
+        in = _mm256_permute4x64_epi64(_mm256_packs_epi16(a, b), 0xd8);
+        in = _mm256_and_si256(in, one);
+        old = _mm256_loadu_si256((const __m256i *)(match + i));
+        _mm256_storeu_si256((__m256i *)(match + i), _mm256_and_si256(old, in));
+    }
+    match_scalar(src + i, n - i, lo, span, match + i);
+}
+#endif /* GLM_X86 */
+
+/**
+ * Unpack contiguous unsigned short data to float, with the best
+ * kernel for this CPU.
+ *
+ * @param src Packed values.
+ * @param n Number of values.
+ * @param scale The scale_factor.
+ * @param offset The add_offset.
+ * @param dst Float output.
+ *
+ * @author Ed Hartnett
+ */
+static void
+unpack_array(const unsigned short *src, size_t n, float scale, float offset,
+             float *dst)
+{
+    switch (glm_unpack_level())
+    {
+#ifdef GLM_X86
+    case GLM_SIMD_AVX512:
+        unpack_avx512(src, n, scale, offset, dst);
+        break;
+    case GLM_SIMD_AVX2:
+        unpack_avx2(src, n, scale, offset, dst);
+        break;
+    case GLM_SIMD_SSE2:
+        unpack_sse2(src, n, scale, offset, dst);
+        break;
+#endif
+    default:
+        unpack_scalar(src, n, scale, offset, dst);
+    }
+}
+
+/**
+ * Widen contiguous unsigned short data to unsigned int, with the
+ * best kernel for this CPU.
+ *
+ * @param src Input values.
+ * @param n Number of values.
+ * @param dst Output values.
+ *
+ * @author Ed Hartnett
+ */
+static void
+widen_array(const unsigned short *src, size_t n, unsigned int *dst)
+{
+    switch (glm_unpack_level())
+    {
+#ifdef GLM_X86
+    case GLM_SIMD_AVX512:
+        widen_avx512(src, n, dst);
+        break;
+    case GLM_SIMD_AVX2:
+        widen_avx2(src, n, dst);
+        break;
+    case GLM_SIMD_SSE2:
+        widen_sse2(src, n, dst);
+        break;
+#endif
+    default:
+        widen_scalar(src, n, dst);
+    }
+}
+
+/**
+ * Decode contiguous packed time offsets to nanoseconds since the
+ * Unix epoch, with the best kernel for this CPU.
+ *
+ * @param src Packed values.
+ * @param n Number of values.
+ * @param scale The scale_factor, in ns.
+ * @param offset The add_offset, in ns.
+ * @param base product_time, in ns since the Unix epoch.
+ * @param dst Output times.
+ *
+ * @author Ed Hartnett
+ */
+static void
+ns_array(const unsigned short *src, size_t n, double scale, double offset,
+         int64_t base, int64_t *dst)
+{
+    switch (glm_unpack_level())
+    {
+#ifdef GLM_X86
+    case GLM_SIMD_AVX512:
+        ns_avx512(src, n, scale, offset, base, dst);
+        break;
+    case GLM_SIMD_AVX2:
+        ns_avx2(src, n, scale, offset, base, dst);
+        break;
+    case GLM_SIMD_SSE2:
+        ns_sse2(src, n, scale, offset, base, dst);
+        break;
+#endif
+    default:
+        ns_scalar(src, n, scale, offset, base, dst);
+    }
+}
+
+/**
+ * Unpack unsigned short data with a scale factor and offset, as
+ * described in the PUG.
+ *
+ * @param src Packed values.
+ * @param n Number of values.
+ * @param scale The scale_factor.
+ * @param offset The add_offset.
+ * @param dst Address of first float output.
+ * @param stride Bytes between float outputs.
+ *
+ * @author Ed Hartnett
+ */
+void
+glm_unpack_ushort(const unsigned short *src, size_t n, float scale,
+                  float offset, void *dst, size_t stride)
+{
+    float tmp[BLOCK_LEN];
+    char *out = dst;
+    size_t i, j;
+
+    /* Arrays are unpacked directly. */
+    if (stride == sizeof(float))
+    {
+        unpack_array(src, n, scale, offset, dst);
+        return;
+    }
+
+    /* For arrays of struct, unpack a block at a time, and then store
+     * each value in its struct. */
+    for (i = 0; i < n; i += BLOCK_LEN)
+    {
+        size_t len = n - i < BLOCK_LEN ? n - i : BLOCK_LEN;
+
+        unpack_array(src + i, len, scale, offset, tmp);
+        for (j = 0; j < len; j++)
+            *(float *)(out + (i + j) * stride) = tmp[j];
+    }
+}
+
+/**
+ * Decode packed time offsets to nanoseconds since the Unix epoch:
+ * base plus the offset, unpacked in double precision and rounded to
+ * the nearest nanosecond. The offsets must be less than about 26
+ * days.
+ *
+ * @param src Packed values.
+ * @param n Number of values.
+ * @param scale The scale_factor, in seconds.
+ * @param offset The add_offset, in seconds.
+ * @param base product_time, in ns since the Unix epoch.
+ * @param dst Address of first int64 output.
+ * @param stride Bytes between int64 outputs.
+ *
+ * @author Ed Hartnett
+ */
+void
+glm_unpack_ushort_ns(const unsigned short *src, size_t n, float scale,
+                     float offset, int64_t base, void *dst, size_t stride)
+{
+    double scale_ns = (double)scale * 1e9, offset_ns = (double)offset * 1e9;
+    int64_t tmp[BLOCK_LEN];
+    char *out = dst;
+    size_t i, j;
+
+    /* Arrays are decoded directly. */
+    if (stride == sizeof(int64_t))
+    {
+        ns_array(src, n, scale_ns, offset_ns, base, dst);
+        return;
+    }
+
+    /* For arrays of struct, decode a block at a time, and then store
+     * each value in its struct. */
+    for (i = 0; i < n; i += BLOCK_LEN)
+    {
+        size_t len = n - i < BLOCK_LEN ? n - i : BLOCK_LEN;
+
+        ns_array(src + i, len, scale_ns, offset_ns, base, tmp);
+        for (j = 0; j < len; j++)
+            memcpy(out + (i + j) * stride, &tmp[j], sizeof(int64_t));
+    }
+}
+
+/**
+ * Unpack values read by glm_read_event_packed(),
+ * glm_read_group_packed(), or glm_read_flash_packed(). The results
+ * are bit-identical to the values the other readers return.
+ *
+ * @param packing Pointer to the packing of the variable.
+ * @param packed Packed values.
+ * @param n Number of values.
+ * @param value Pointer to already-allocated array of n float, which
+ * gets the values. It may be the same memory as packed.
+ *
+ * @return 0 for success.
+ * @author Ed Hartnett
+ */
+int
+glm_unpack(const GLM_PACKING_T *packing, const unsigned short *packed,
+           size_t n, float *value)
+{
+    /* Check inputs. */
+    assert(packing && (packed || !n) && (value || !n));
+
+    /* Unpacking in place is done from the end of the array, as
+     * glm_read_columns() does. */
+    if (n && packed == (const unsigned short *)value)
+    {
+        unsigned short *tail = (unsigned short *)(value + n) - n;
+
+        memmove(tail, packed, n * sizeof(unsigned short));
+        packed = tail;
+    }
+    glm_unpack_ushort(packed, n, packing->scale_factor, packing->add_offset,
+                      value, sizeof(float));
+
+    return 0;
+}
+
+/**
+ * Copy 4-byte values (int or float).
+ *
+ * @param src Input values.
+ * @param n Number of values.
+ * @param dst Address of first output.
+ * @param stride Bytes between outputs.
+ *
+ * @author Ed Hartnett
+ */
+void
+glm_copy_4(const void *src, size_t n, void *dst, size_t stride)
+{
+    const int *in = src;
+    char *out = dst;
+    size_t i;
+
+    if (stride == sizeof(int))
+    {
+        memmove(dst, src, n * sizeof(int));
+        return;
+    }
+
+    for (i = 0; i < n; i++)
+        *(int *)(out + i * stride) = in[i];
+}
+
+/**
+ * Copy short values, such as the quality flags.
+ *
+ * @param src Input values.
+ * @param n Number of values.
+ * @param dst Address of first output.
+ * @param stride Bytes between outputs.
+ *
+ * @author Ed Hartnett
+ */
+void
+glm_copy_2(const short *src, size_t n, void *dst, size_t stride)
+{
+    char *out = dst;
+    size_t i;
+
+    if (stride == sizeof(short))
+    {
+        memmove(dst, src, n * sizeof(short));
+        return;
+    }
+
+    for (i = 0; i < n; i++)
+        *(short *)(out + i * stride) = src[i];
+}
+
+/**
+ * Widen unsigned short values to unsigned int. This is used for the
+ * IDs which are stored as _Unsigned shorts.
+ *
+ * @param src Input values.
+ * @param n Number of values.
+ * @param dst Address of first output.
+ * @param stride Bytes between outputs.
+ *
+ * @author Ed Hartnett
+ */
+void
+glm_widen_ushort(const unsigned short *src, size_t n, void *dst,
+                 size_t stride)
+{
+    char *out = dst;
+    size_t i;
+
+    if (stride == sizeof(unsigned int))
+    {
+        widen_array(src, n, dst);
+        return;
+    }
+
+    for (i = 0; i < n; i++)
+        *(unsigned int *)(out + i * stride) = src[i];
+}
+
+/* Comparisons for first_packed(). */
+#define CMP_GE 0 /* value >= bound */
+#define CMP_GT 1 /* value > bound */
+#define CMP_LE 2 /* value <= bound */
+#define CMP_LT 3 /* value < bound */
+
+/**
+ * Find the first packed value whose unpacked value compares true
+ * against a bound. The unpacked values are monotonic, so the result
+ * of the comparison is false up to some packed value, and true from
+ * there on, provided the comparison goes the same way as the scale
+ * factor.
+ *
+ * @param scale The scale_factor.
+ * @param offset The add_offset.
+ * @param bound Bound to compare against.
+ * @param cmp One of the CMP_* comparisons.
+ *
+ * @return The first packed value, or 65536 if there is none.
+ * @author Ed Hartnett
+ */
+static unsigned int
+first_packed(float scale, float offset, float bound, int cmp)
+{
+    unsigned int lo = 0, hi = 65536;
+
+    while (lo < hi)
+    {
+        unsigned int mid = (lo + hi) / 2;
+        float v = (float)(unsigned short)mid * scale + offset;
+        int t;
+
+        switch (cmp)
+        {
+        case CMP_GE:
+            t = v >= bound;
+            break;
+        case CMP_GT:
+            t = v > bound;
+            break;
+        case CMP_LE:
+            t = v <= bound;
+            break;
+        default:
+            t = v < bound;
+        }
+        if (t)
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+
+    return lo;
+}
+
+/**
+ * Find the packed values which unpack to a value between min and
+ * max. The unpacking is monotonic, so they are a range of packed
+ * values. Because each packed value is unpacked with the same single
+ * precision arithmetic as the kernels, the range is exact: a packed
+ * value is in it if and only if its unpacked value is between min
+ * and max.
+ *
+ * @param scale The scale_factor.
+ * @param offset The add_offset.
+ * @param min Smallest unpacked value, may be -INFINITY.
+ * @param max Largest unpacked value, may be INFINITY.
+ * @param lo Pointer that gets the smallest packed value in the range.
+ * @param span Pointer that gets the largest packed value in the
+ * range, minus lo.
+ *
+ * @return Non-zero if there are packed values in the range, 0 if
+ * there are none.
+ * @author Ed Hartnett
+ */
+int
+glm_ushort_range(float scale, float offset, float min, float max,
+                 unsigned short *lo, unsigned short *span)
+{
+    unsigned int first, end;
+
+    if (!(min <= max))
+        return 0;
+    if (scale >= 0)
+    {
+        first = first_packed(scale, offset, min, CMP_GE);
+        end = first_packed(scale, offset, max, CMP_GT);
+    }
+    else
+    {
+        first = first_packed(scale, offset, max, CMP_LE);
+        end = first_packed(scale, offset, min, CMP_LT);
+    }
+    if (first >= end)
+        return 0;
+    *lo = first;
+    *span = end - 1 - first;
+
+    return 1;
+}
+
+/**
+ * Match unsigned short data against a range of values. The range is
+ * from lo to lo + span, modulo 65536, so the same kernel also
+ * matches signed short data, with lo and span computed in signed
+ * arithmetic. Each match flag is cleared if its value is not in the
+ * range, and otherwise left as it is, so several ranges may be
+ * matched one after the other.
+ *
+ * @param src Input values.
+ * @param n Number of values.
+ * @param lo Smallest value in the range.
+ * @param span Largest value in the range, minus lo.
+ * @param match Array of n match flags, each 0 or 1.
+ *
+ * @author Ed Hartnett
+ */
+void
+glm_match_ushort(const unsigned short *src, size_t n, unsigned short lo,
+                 unsigned short span, unsigned char *match)
+{
+    switch (glm_unpack_level())
+    {
+#ifdef GLM_X86
+    case GLM_SIMD_AVX512: /* 16-bit compares need AVX-512BW. */
+    case GLM_SIMD_AVX2:
+        match_avx2(src, n, lo, span, match);
+        break;
+    case GLM_SIMD_SSE2:
+        match_sse2(src, n, lo, span, match);
+        break;
+#endif
+    default:
+        match_scalar(src, n, lo, span, match);
+    }
+}
+
+/**
+ * Match float data against a range of values. Each match flag is
+ * cleared if its value is not between min and max.
+ *
+ * @param src Input values.
+ * @param n Number of values.
+ * @param min Smallest value in the range.
+ * @param max Largest value in the range.
+ * @param match Array of n match flags, each 0 or 1.
+ *
+ * @author Ed Hartnett
+ */
+void
+glm_match_float(const float *src, size_t n, float min, float max,
+                unsigned char *match)
+{
+    size_t i;
+
+    for (i = 0; i < n; i++)
+        match[i] &= src[i] >= min && src[i] <= max;
+}
@@ -0,0 +1,164 @@
+/*
+  Program to test the allocator hooks of the ncglm library, with GOES-17
+  Global Lightning Mapper data.
+
+  Ed Hartnett
+
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "un_test.h"
+#include "ncglm.h"
+
+/* Err is used to keep track of errors within each set of tests,
+ * total_err is the number of errors in the entire test program, which
+ * generally cosists of several sets of tests. */
+int total_err = 0, err = 0;
+
+/* Alignment of the columns of a batch. */
+#define ALIGN 64
+
+/* Size of a huge page. */
+#define HUGEPAGE 2097152
+
+/* Number of files read to make a batch of more than a huge page. */
+#define NUM_BIG 20
+
+/* Is a pointer aligned? */
+#define ALIGNED(p, a) (!((uintptr_t)(p) % (a)))
+
+int
+main()
+{
+    UN_COUNTS_T counts = UN_COUNTS_INIT;
+
+    printf("Testing GLM allocator hooks.\n");
+    printf("testing batches from the allocator...");
+    {
+        const char *paths[3] = {GLM_DATA_FILE, GLM_DATA_FILE, GLM_DATA_FILE};
+        GLM_BATCH_T batch;
+        char *start, *end;
+
+        if (glm_set_allocator(un_count_alloc, un_count_free, &counts)) ERR;
+        if (glm_read_files(paths, 3, 2, &batch)) ERR;
+        if (!counts.nalloc || counts.nalloc == counts.nfree) ERR;
+        if (batch.nevent != 3 * 4578 || batch.event_file[batch.nevent - 1] != 2) ERR;
+
+        /* Every column is aligned, and in the one block. */
+        start = batch.block;
+        end = (char *)batch.flash_file + batch.nflash * sizeof(int);
+        if (!start || !ALIGNED(start, ALIGN)) ERR;
+        if (!ALIGNED(batch.event_id, ALIGN) || !ALIGNED(batch.event_lat, ALIGN) ||
+            !ALIGNED(batch.group_quality_flag, ALIGN) ||
+            !ALIGNED(batch.flash_energy, ALIGN) || !ALIGNED(batch.scalar, ALIGN)) ERR;
+        if ((char *)batch.event_id < start || (char *)batch.group_id < start ||
+            (char *)batch.scalar < end) ERR;
+        if (counts.max_align < ALIGN) ERR;
+
+        if (glm_free_batch(&batch)) ERR;
+        if (counts.nalloc != counts.nfree) ERR;
+    }
+    SUMMARIZE_ERR;
+    printf("testing everything is freed...");
+    {
+        GLM_FILE_T *glm;
+        GLM_ITER_T *iter;
+        GLM_EVENT_T event[100];
+        GLM_FLASH_T *flash;
+        GLM_FILTER_T filter;
+        struct ArrowSchema schema;
+        struct ArrowArray array;
+        const char *path = GLM_DATA_FILE;
+        GLM_BATCH_T batch;
+        size_t nflash, nmatch, count;
+
+        /* Handles, scratch buffers, iterators, and filters. */
+        if (glm_open(GLM_DATA_FILE, &glm)) ERR;
+        if (glm_set_nthreads(glm, 3)) ERR;
+        if (glm_inq_dims(glm, NULL, NULL, &nflash)) ERR;
+        if (!(flash = malloc(nflash * sizeof(GLM_FLASH_T)))) ERR;
+        if (glm_get_flash_structs(glm, NULL, flash)) ERR;
+        if (glm_event_iter_open(glm, 100, &iter)) ERR;
+        if (glm_event_iter_next(iter, event, &count)) ERR;
+        if (count != 100) ERR;
+        if (glm_iter_close(iter)) ERR;
+        memset(&filter, 0, sizeof(GLM_FILTER_T));
+        filter.flags = GLM_FILTER_ENERGY;
+        filter.energy_min = 1e-13;
+        if (glm_read_flash_filter(glm, 0, nflash, &filter, &nmatch, flash)) ERR;
+        if (glm_close(glm)) ERR;
+        free(flash);
+        if (counts.nalloc != counts.nfree) ERR;
+
+        /* Whole files. */
+        if (glm_read_file(GLM_DATA_FILE, 0)) ERR;
+        if (glm_read_file_arrays(GLM_DATA_FILE, 0)) ERR;
+        if (counts.nalloc != counts.nfree) ERR;
+
+        /* Arrow exports. */
+        if (glm_read_files(&path, 1, 1, &batch)) ERR;
+        if (glm_export_groups_arrow(&batch, &schema, &array)) ERR;
+        schema.release(&schema);
+        array.release(&array);
+        if (glm_free_batch(&batch)) ERR;
+        if (counts.nalloc != counts.nfree) ERR;
+    }
+    SUMMARIZE_ERR;
+    printf("testing running out of memory...");
+    {
+        const char *paths[2] = {GLM_DATA_FILE, GLM_DATA_FILE};
+        GLM_BATCH_T batch;
+        int f, ret;
+
+        /* Fail each allocation in turn, until none fail. */
+        for (f = 0; ; f++)
+        {
+            counts.fail = f;
+            ret = glm_read_files(paths, 2, 1, &batch);
+            if (ret && ret != GLM_ERR_MEMORY) ERR;
+            if (ret && batch.block) ERR;
+            if (glm_free_batch(&batch)) ERR;
+            if (counts.nalloc != counts.nfree) ERR;
+            if (!ret)
+                break;
+        }
+        if (!f) ERR;
+        counts.fail = -1;
+    }
+    SUMMARIZE_ERR;
+    printf("testing huge pages...");
+    {
+        const char *paths[NUM_BIG];
+        GLM_BATCH_T batch;
+        int f;
+
+        for (f = 0; f < NUM_BIG; f++)
+            paths[f] = GLM_DATA_FILE;
+        if (glm_set_hugepages(1)) ERR;
+        if (glm_read_files(paths, NUM_BIG, 0, &batch)) ERR;
+        if (counts.max_align != HUGEPAGE) ERR;
+        if (!ALIGNED(batch.block, HUGEPAGE)) ERR;
+        if (batch.flash_id[batch.nflash - 1] <= batch.flash_id[0]) ERR;
+        if (glm_free_batch(&batch)) ERR;
+        if (glm_set_hugepages(0)) ERR;
+        if (counts.nalloc != counts.nfree) ERR;
+    }
+    SUMMARIZE_ERR;
+    printf("testing the default allocator...");
+    {
+        const char *path = GLM_DATA_FILE;
+        GLM_BATCH_T batch;
+        size_t nalloc = counts.nalloc;
+
+        if (glm_set_allocator(NULL, NULL, NULL)) ERR;
+        if (glm_read_files(&path, 1, 1, &batch)) ERR;
+        if (!ALIGNED(batch.block, ALIGN) || !ALIGNED(batch.flash_lat, ALIGN)) ERR;
+        if (glm_free_batch(&batch)) ERR;
+        if (counts.nalloc != nalloc) ERR;
+    }
+    SUMMARIZE_ERR;
+    FINAL_RESULTS;
+}
@@ -0,0 +1,203 @@
+/*
+  Program to test exporting GOES-17 Global Lightning Mapper data
+  through the Apache Arrow C Data Interface. This plays the part of
+  the consumer.
+
+  Ed Hartnett
+
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "un_test.h"
+#include "ncglm.h"
+
+/* Err is used to keep track of errors within each set of tests,
+ * total_err is the number of errors in the entire test program, which
+ * generally cosists of several sets of tests. */
+int total_err = 0, err = 0;
+
+/* Name of the cache file written. */
+#define CACHE_FILE "tst_arrow.glmc"
+
+/* Expected fields of each export. */
+#define NUM_EVENT_FIELDS 7
+#define NUM_GROUP_FIELDS 9
+#define NUM_FLASH_FIELDS 11
+const char *event_name[NUM_EVENT_FIELDS] = {"id", "time_offset", "lat", "lon",
+                                            "energy", "parent_group_id", "file"};
+const char *event_format[NUM_EVENT_FIELDS] = {"I", "f", "f", "f", "f", "I", "i"};
+const char *group_name[NUM_GROUP_FIELDS] = {"id", "time_offset", "lat", "lon",
+                                            "area", "energy", "parent_flash_id",
+                                            "quality_flag", "file"};
+const char *group_format[NUM_GROUP_FIELDS] = {"I", "f", "f", "f", "f", "f", "I",
+                                              "s", "i"};
+const char *flash_name[NUM_FLASH_FIELDS] = {"id", "time_offset_of_first_event",
+                                            "time_offset_of_last_event",
+                                            "frame_time_offset_of_first_event",
+                                            "frame_time_offset_of_last_event",
+                                            "lat", "lon", "area", "energy",
+                                            "quality_flag", "file"};
+const char *flash_format[NUM_FLASH_FIELDS] = {"I", "f", "f", "f", "f", "f", "f",
+                                              "f", "f", "s", "i"};
+
+/* Check an exported schema and array. Return the number of errors. */
+static int
+check_export(const struct ArrowSchema *schema, const struct ArrowArray *array,
+             int nfield, const char **name, const char **format,
+             size_t length, const void **data)
+{
+    int nerr = 0;
+    int c;
+
+    if (strcmp(schema->format, "+s") || schema->n_children != nfield ||
+        !schema->release)
+        nerr++;
+    if (array->length != length || array->null_count || array->offset ||
+        array->n_buffers != 1 || array->buffers[0] ||
+        array->n_children != nfield || !array->release)
+        nerr++;
+    for (c = 0; c < nfield && !nerr; c++)
+    {
+        const struct ArrowSchema *cs = schema->children[c];
+        const struct ArrowArray *ca = array->children[c];
+
+        if (strcmp(cs->name, name[c]) || strcmp(cs->format, format[c]) ||
+            cs->n_children || !cs->release)
+            nerr++;
+        if (ca->length != length || ca->null_count || ca->n_buffers != 2 ||
+            ca->buffers[0] || ca->buffers[1] != data[c] || ca->n_children ||
+            !ca->release)
+            nerr++;
+    }
+
+    return nerr;
+}
+
+int
+main()
+{
+    printf("Testing GLM Arrow export.\n");
+    printf("testing exporting events, groups, and flashes...");
+    {
+        const char *paths[2] = {GLM_DATA_FILE, GLM_DATA_FILE};
+        GLM_BATCH_T batch;
+        struct ArrowSchema schema;
+        struct ArrowArray array;
+
+        if (glm_read_files(paths, 2, 1, &batch)) ERR;
+
+        /* Events. */
+        {
+            const void *data[NUM_EVENT_FIELDS] = {batch.event_id, batch.event_time_offset,
+                                                  batch.event_lat, batch.event_lon,
+                                                  batch.event_energy,
+                                                  batch.event_parent_group_id,
+                                                  batch.event_file};
+            const float *lat;
+
+            if (glm_export_events_arrow(&batch, &schema, &array)) ERR;
+            if (check_export(&schema, &array, NUM_EVENT_FIELDS, event_name,
+                             event_format, batch.nevent, data)) ERR;
+            lat = array.children[2]->buffers[1];
+            if (lat[batch.nevent - 1] != batch.event_lat[batch.nevent - 1]) ERR;
+            schema.release(&schema);
+            array.release(&array);
+            if (schema.release || array.release) ERR;
+        }
+
+        /* Groups. */
+        {
+            const void *data[NUM_GROUP_FIELDS] = {batch.group_id, batch.group_time_offset,
+                                                  batch.group_lat, batch.group_lon,
+                                                  batch.group_area, batch.group_energy,
+                                                  batch.group_parent_flash_id,
+                                                  batch.group_quality_flag,
+                                                  batch.group_file};
+
+            if (glm_export_groups_arrow(&batch, &schema, &array)) ERR;
+            if (check_export(&schema, &array, NUM_GROUP_FIELDS, group_name,
+                             group_format, batch.ngroup, data)) ERR;
+            schema.release(&schema);
+            array.release(&array);
+        }
+
+        /* Flashes. */
+        {
+            const void *data[NUM_FLASH_FIELDS] = {batch.flash_id,
+                                                  batch.flash_time_offset_of_first_event,
+                                                  batch.flash_time_offset_of_last_event,
+                                                  batch.flash_frame_time_offset_of_first_event,
+                                                  batch.flash_frame_time_offset_of_last_event,
+                                                  batch.flash_lat, batch.flash_lon,
+                                                  batch.flash_area, batch.flash_energy,
+                                                  batch.flash_quality_flag,
+                                                  batch.flash_file};
+
+            if (glm_export_flashes_arrow(&batch, &schema, &array)) ERR;
+            if (check_export(&schema, &array, NUM_FLASH_FIELDS, flash_name,
+                             flash_format, batch.nflash, data)) ERR;
+            schema.release(&schema);
+            array.release(&array);
+        }
+
+        /* Only the array. */
+        if (glm_export_flashes_arrow(&batch, NULL, &array)) ERR;
+        if (array.length != batch.nflash) ERR;
+        array.release(&array);
+
+        if (glm_free_batch(&batch)) ERR;
+    }
+    SUMMARIZE_ERR;
+    printf("testing moving children out of an export...");
+    {
+        const char *path = GLM_DATA_FILE;
+        GLM_BATCH_T batch;
+        struct ArrowSchema schema, child_schema;
+        struct ArrowArray array, child_array;
+        const float *energy;
+
+        if (glm_read_files(&path, 1, 1, &batch)) ERR;
+        if (glm_export_groups_arrow(&batch, &schema, &array)) ERR;
+
+        /* Move the energy column out, as a consumer may, and release
+         * the parents first. */
+        child_schema = *schema.children[5];
+        schema.children[5]->release = NULL;
+        child_array = *array.children[5];
+        array.children[5]->release = NULL;
+        schema.release(&schema);
+        array.release(&array);
+
+        if (strcmp(child_schema.name, "energy")) ERR;
+        energy = child_array.buffers[1];
+        if (child_array.length != batch.ngroup) ERR;
+        if (energy[100] != batch.group_energy[100]) ERR;
+        child_schema.release(&child_schema);
+        child_array.release(&child_array);
+        if (child_schema.release || child_array.release) ERR;
+
+        if (glm_free_batch(&batch)) ERR;
+    }
+    SUMMARIZE_ERR;
+    printf("testing exporting a cache...");
+    {
+        GLM_CACHE_T *cache;
+        const GLM_BATCH_T *batch;
+        struct ArrowSchema schema;
+        struct ArrowArray array;
+
+        if (glm_convert_to_cache(GLM_DATA_FILE, CACHE_FILE)) ERR;
+        if (glm_open_cache(CACHE_FILE, &cache)) ERR;
+        if (glm_cache_batch(cache, &batch)) ERR;
+        if (glm_export_events_arrow(batch, &schema, &array)) ERR;
+        if (array.length != 4578) ERR;
+        if (array.children[0]->buffers[1] != batch->event_id) ERR;
+        schema.release(&schema);
+        array.release(&array);
+        if (glm_close_cache(cache)) ERR;
+    }
+    SUMMARIZE_ERR;
+    FINAL_RESULTS;
+}
@@ -0,0 +1,207 @@
+/*
+  Program to test reading several GOES-17 Global Lightning Mapper
+  files at once into one batch.
+
+  Ed Hartnett
+
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "un_test.h"
+#include "ncglm.h"
+
+/* Err is used to keep track of errors within each set of tests,
+ * total_err is the number of errors in the entire test program, which
+ * generally cosists of several sets of tests. */
+int total_err = 0, err = 0;
+
+/* Number of times the test file is read. */
+#define NUM_FILES 3
+
+/* Numbers of threads to test. */
+#define NUM_NTHREADS 3
+int nthreads[NUM_NTHREADS] = {1, 4, 0};
+
+int
+main()
+{
+    printf("Testing reading many GLM files at once.\n");
+    printf("testing reading one file...");
+    {
+        const char *paths[1] = {GLM_DATA_FILE};
+        GLM_BATCH_T batch;
+        GLM_FILE_T *glm;
+        GLM_EVENT_T *event;
+        GLM_GROUP_T *group;
+        GLM_FLASH_T *flash;
+        size_t nevent, ngroup, nflash;
+        size_t i;
+
+        if (glm_open(GLM_DATA_FILE, &glm)) ERR;
+        if (glm_inq_dims(glm, &nevent, &ngroup, &nflash)) ERR;
+        if (!(event = malloc(nevent * sizeof(GLM_EVENT_T)))) ERR;
+        if (!(group = malloc(ngroup * sizeof(GLM_GROUP_T)))) ERR;
+        if (!(flash = malloc(nflash * sizeof(GLM_FLASH_T)))) ERR;
+        if (glm_get_event_structs(glm, NULL, event)) ERR;
+        if (glm_get_group_structs(glm, NULL, group)) ERR;
+        if (glm_get_flash_structs(glm, NULL, flash)) ERR;
+        if (glm_close(glm)) ERR;
+
+        if (glm_read_files(paths, 1, 1, &batch)) ERR;
+        if (batch.nfile != 1 || batch.nevent != nevent ||
+            batch.ngroup != ngroup || batch.nflash != nflash) ERR;
+
+        /* With one file, the IDs are not changed. */
+        for (i = 0; i < nevent; i++)
+        {
+            if (batch.event_id[i] != event[i].id) ERR;
+            if (batch.event_time_offset[i] != event[i].time_offset) ERR;
+            if (batch.event_lat[i] != event[i].lat) ERR;
+            if (batch.event_lon[i] != event[i].lon) ERR;
+            if (batch.event_energy[i] != event[i].energy) ERR;
+            if (batch.event_parent_group_id[i] != event[i].parent_group_id) ERR;
+            if (batch.event_file[i]) ERR;
+        }
+        for (i = 0; i < ngroup; i++)
+        {
+            if (batch.group_id[i] != group[i].id) ERR;
+            if (batch.group_time_offset[i] != group[i].time_offset) ERR;
+            if (batch.group_lat[i] != group[i].lat) ERR;
+            if (batch.group_lon[i] != group[i].lon) ERR;
+            if (batch.group_area[i] != group[i].area) ERR;
+            if (batch.group_energy[i] != group[i].energy) ERR;
+            if (batch.group_parent_flash_id[i] != group[i].parent_flash_id) ERR;
+            if (batch.group_quality_flag[i] != group[i].quality_flag) ERR;
+            if (batch.group_file[i]) ERR;
+        }
+        for (i = 0; i < nflash; i++)
+        {
+            if (batch.flash_id[i] != flash[i].id) ERR;
+            if (batch.flash_time_offset_of_first_event[i] !=
+                flash[i].time_offset_of_first_event) ERR;
+            if (batch.flash_time_offset_of_last_event[i] !=
+                flash[i].time_offset_of_last_event) ERR;
+            if (batch.flash_lat[i] != flash[i].lat) ERR;
+            if (batch.flash_lon[i] != flash[i].lon) ERR;
+            if (batch.flash_area[i] != flash[i].area) ERR;
+            if (batch.flash_energy[i] != flash[i].energy) ERR;
+            if (batch.flash_quality_flag[i] != flash[i].quality_flag) ERR;
+            if (batch.flash_file[i]) ERR;
+        }
+        if (glm_free_batch(&batch)) ERR;
+
+        /* Freeing twice is harmless. */
+        if (glm_free_batch(&batch)) ERR;
+
+        free(event);
+        free(group);
+        free(flash);
+    }
+    SUMMARIZE_ERR;
+    printf("testing reading many files...");
+    {
+        const char *paths[NUM_FILES];
+        GLM_BATCH_T batch;
+        GLM_FILE_T *glm;
+        size_t nevent, ngroup, nflash;
+        int t, f;
+
+        if (glm_open(GLM_DATA_FILE, &glm)) ERR;
+        if (glm_inq_dims(glm, &nevent, &ngroup, &nflash)) ERR;
+        if (glm_close(glm)) ERR;
+        for (f = 0; f < NUM_FILES; f++)
+            paths[f] = GLM_DATA_FILE;
+
+        for (t = 0; t < NUM_NTHREADS; t++)
+        {
+            GLM_BATCH_T one;
+            const char *path = GLM_DATA_FILE;
+            unsigned int max_event = 0, max_group = 0, max_flash = 0;
+            size_t i;
+
+            if (glm_read_files(&path, 1, 1, &one)) ERR;
+            if (glm_read_files(paths, NUM_FILES, nthreads[t], &batch)) ERR;
+            if (batch.nfile != NUM_FILES || batch.nevent != NUM_FILES * nevent ||
+                batch.ngroup != NUM_FILES * ngroup ||
+                batch.nflash != NUM_FILES * nflash) ERR;
+
+            for (f = 0; f < NUM_FILES; f++)
+            {
+                size_t e = f * nevent, g = f * ngroup, l = f * nflash;
+                unsigned int min_event = batch.event_id[e];
+                unsigned int min_group = batch.group_id[g];
+                unsigned int min_flash = batch.flash_id[l];
+
+                if (batch.scalar[f].product_time != one.scalar[0].product_time) ERR;
+
+                /* Each file has the same values, with its IDs shifted
+                 * past those of the file before. */
+                for (i = 0; i < nevent; i++)
+                {
+                    if (batch.event_file[e + i] != f) ERR;
+                    if (batch.event_lat[e + i] != one.event_lat[i]) ERR;
+                    if (batch.event_energy[e + i] != one.event_energy[i]) ERR;
+                    if (batch.event_id[e + i] - one.event_id[i] !=
+                        min_event - one.event_id[0]) ERR;
+                    if (batch.event_parent_group_id[e + i] - one.event_parent_group_id[i] !=
+                        min_group - one.group_id[0]) ERR;
+                    if (f && batch.event_id[e + i] <= max_event) ERR;
+                }
+                for (i = 0; i < ngroup; i++)
+                {
+                    if (batch.group_file[g + i] != f) ERR;
+                    if (batch.group_lon[g + i] != one.group_lon[i]) ERR;
+                    if (batch.group_quality_flag[g + i] != one.group_quality_flag[i]) ERR;
+                    if (batch.group_id[g + i] - one.group_id[i] !=
+                        min_group - one.group_id[0]) ERR;
+                    if (batch.group_parent_flash_id[g + i] - one.group_parent_flash_id[i] !=
+                        min_flash - one.flash_id[0]) ERR;
+                    if (f && batch.group_id[g + i] <= max_group) ERR;
+                }
+                for (i = 0; i < nflash; i++)
+                {
+                    if (batch.flash_file[l + i] != f) ERR;
+                    if (batch.flash_area[l + i] != one.flash_area[i]) ERR;
+                    if (batch.flash_time_offset_of_last_event[l + i] !=
+                        one.flash_time_offset_of_last_event[i]) ERR;
+                    if (batch.flash_id[l + i] - one.flash_id[i] !=
+                        min_flash - one.flash_id[0]) ERR;
+                    if (f && batch.flash_id[l + i] <= max_flash) ERR;
+                }
+
+                /* Find the largest IDs so far. */
+                for (i = 0; i < nevent; i++)
+                    if (batch.event_id[e + i] > max_event)
+                        max_event = batch.event_id[e + i];
+                for (i = 0; i < ngroup; i++)
+                    if (batch.group_id[g + i] > max_group)
+                        max_group = batch.group_id[g + i];
+                for (i = 0; i < nflash; i++)
+                    if (batch.flash_id[l + i] > max_flash)
+                        max_flash = batch.flash_id[l + i];
+            }
+
+            /* The first file keeps its IDs. */
+            if (memcmp(batch.event_id, one.event_id, nevent * sizeof(unsigned int))) ERR;
+            if (memcmp(batch.flash_id, one.flash_id, nflash * sizeof(unsigned int))) ERR;
+
+            if (glm_free_batch(&batch)) ERR;
+            if (glm_free_batch(&one)) ERR;
+        }
+    }
+    SUMMARIZE_ERR;
+    printf("testing reading no files and a missing file...");
+    {
+        const char *paths[2] = {GLM_DATA_FILE, "no_such_file.nc"};
+        GLM_BATCH_T batch;
+
+        if (glm_read_files(paths, 0, 2, &batch)) ERR;
+        if (batch.nfile || batch.nevent || batch.ngroup || batch.nflash) ERR;
+        if (glm_free_batch(&batch)) ERR;
+        if (!glm_read_files(paths, 2, 2, &batch)) ERR;
+    }
+    SUMMARIZE_ERR;
+    FINAL_RESULTS;
+}
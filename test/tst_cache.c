@@ -0,0 +1,192 @@
+/*
+  Program to test the cache files of decoded GOES-17 Global Lightning
+  Mapper data.
+
+  Ed Hartnett
+
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "un_test.h"
+#include "ncglm.h"
+
+/* Err is used to keep track of errors within each set of tests,
+ * total_err is the number of errors in the entire test program, which
+ * generally cosists of several sets of tests. */
+int total_err = 0, err = 0;
+
+/* Names of the cache files written. */
+#define CACHE_FILE "tst_cache.glmc"
+#define CACHE_FILE_3 "tst_cache_3.glmc"
+#define CACHE_FILE_BAD "tst_cache_bad.glmc"
+
+/* Alignment of the columns. */
+#define ALIGN 64
+
+/* Is a column aligned? */
+#define ALIGNED(p) (!((uintptr_t)(p) % ALIGN))
+
+/* Are the columns of two batches the same? */
+static int
+same_batch(const GLM_BATCH_T *a, const GLM_BATCH_T *b)
+{
+    size_t f;
+
+    if (a->nfile != b->nfile || a->nevent != b->nevent ||
+        a->ngroup != b->ngroup || a->nflash != b->nflash)
+        return 0;
+    if (memcmp(a->event_id, b->event_id, a->nevent * sizeof(unsigned int)) ||
+        memcmp(a->event_time_offset, b->event_time_offset, a->nevent * sizeof(float)) ||
+        memcmp(a->event_lat, b->event_lat, a->nevent * sizeof(float)) ||
+        memcmp(a->event_lon, b->event_lon, a->nevent * sizeof(float)) ||
+        memcmp(a->event_energy, b->event_energy, a->nevent * sizeof(float)) ||
+        memcmp(a->event_parent_group_id, b->event_parent_group_id,
+               a->nevent * sizeof(unsigned int)) ||
+        memcmp(a->event_file, b->event_file, a->nevent * sizeof(int)))
+        return 0;
+    if (memcmp(a->group_id, b->group_id, a->ngroup * sizeof(unsigned int)) ||
+        memcmp(a->group_time_offset, b->group_time_offset, a->ngroup * sizeof(float)) ||
+        memcmp(a->group_lat, b->group_lat, a->ngroup * sizeof(float)) ||
+        memcmp(a->group_lon, b->group_lon, a->ngroup * sizeof(float)) ||
+        memcmp(a->group_area, b->group_area, a->ngroup * sizeof(float)) ||
+        memcmp(a->group_energy, b->group_energy, a->ngroup * sizeof(float)) ||
+        memcmp(a->group_parent_flash_id, b->group_parent_flash_id,
+               a->ngroup * sizeof(unsigned int)) ||
+        memcmp(a->group_quality_flag, b->group_quality_flag, a->ngroup * sizeof(short)) ||
+        memcmp(a->group_file, b->group_file, a->ngroup * sizeof(int)))
+        return 0;
+    if (memcmp(a->flash_id, b->flash_id, a->nflash * sizeof(unsigned int)) ||
+        memcmp(a->flash_time_offset_of_first_event, b->flash_time_offset_of_first_event,
+               a->nflash * sizeof(float)) ||
+        memcmp(a->flash_time_offset_of_last_event, b->flash_time_offset_of_last_event,
+               a->nflash * sizeof(float)) ||
+        memcmp(a->flash_frame_time_offset_of_first_event,
+               b->flash_frame_time_offset_of_first_event, a->nflash * sizeof(float)) ||
+        memcmp(a->flash_frame_time_offset_of_last_event,
+               b->flash_frame_time_offset_of_last_event, a->nflash * sizeof(float)) ||
+        memcmp(a->flash_lat, b->flash_lat, a->nflash * sizeof(float)) ||
+        memcmp(a->flash_lon, b->flash_lon, a->nflash * sizeof(float)) ||
+        memcmp(a->flash_area, b->flash_area, a->nflash * sizeof(float)) ||
+        memcmp(a->flash_energy, b->flash_energy, a->nflash * sizeof(float)) ||
+        memcmp(a->flash_quality_flag, b->flash_quality_flag, a->nflash * sizeof(short)) ||
+        memcmp(a->flash_file, b->flash_file, a->nflash * sizeof(int)))
+        return 0;
+    for (f = 0; f < a->nfile; f++)
+        if (a->scalar[f].product_time != b->scalar[f].product_time ||
+            a->scalar[f].event_count != b->scalar[f].event_count ||
+            a->scalar[f].yaw_flip_flag != b->scalar[f].yaw_flip_flag ||
+            a->scalar[f].algorithm_product_version_container !=
+            b->scalar[f].algorithm_product_version_container)
+            return 0;
+
+    return 1;
+}
+
+/* Copy a file, changing one byte and keeping only len bytes. */
+static int
+copy_file(const char *from, const char *to, long change, long len)
+{
+    FILE *in, *out;
+    long i;
+    int c;
+
+    if (!(in = fopen(from, "rb")) || !(out = fopen(to, "wb")))
+        return 1;
+    for (i = 0; (c = getc(in)) != EOF && i < len; i++)
+        putc(i == change ? c ^ 0xff : c, out);
+    fclose(in);
+    fclose(out);
+
+    return 0;
+}
+
+int
+main()
+{
+    printf("Testing GLM cache files.\n");
+    printf("testing converting a file to a cache...");
+    {
+        const char *path = GLM_DATA_FILE;
+        GLM_BATCH_T expected;
+        const GLM_BATCH_T *batch;
+        GLM_CACHE_T *cache;
+
+        if (glm_read_files(&path, 1, 1, &expected)) ERR;
+        if (glm_convert_to_cache(GLM_DATA_FILE, CACHE_FILE)) ERR;
+        if (glm_open_cache(CACHE_FILE, &cache)) ERR;
+        if (glm_cache_batch(cache, &batch)) ERR;
+        if (!same_batch(batch, &expected)) ERR;
+        if (batch->nevent != 4578 || batch->ngroup != 1609 || batch->nflash != 123) ERR;
+
+        /* Columns are aligned. */
+        if (!ALIGNED(batch->event_id) || !ALIGNED(batch->event_lat) ||
+            !ALIGNED(batch->group_quality_flag) || !ALIGNED(batch->group_file) ||
+            !ALIGNED(batch->flash_energy) || !ALIGNED(batch->scalar)) ERR;
+        if (glm_close_cache(cache)) ERR;
+
+        /* Open it again. */
+        if (glm_open_cache(CACHE_FILE, &cache)) ERR;
+        if (glm_cache_batch(cache, &batch)) ERR;
+        if (!same_batch(batch, &expected)) ERR;
+        if (glm_close_cache(cache)) ERR;
+        if (glm_free_batch(&expected)) ERR;
+    }
+    SUMMARIZE_ERR;
+    printf("testing caching a batch of several files...");
+    {
+        const char *paths[3] = {GLM_DATA_FILE, GLM_DATA_FILE, GLM_DATA_FILE};
+        GLM_BATCH_T expected, empty;
+        const GLM_BATCH_T *batch;
+        GLM_CACHE_T *cache;
+
+        if (glm_read_files(paths, 3, 2, &expected)) ERR;
+        if (glm_write_cache(&expected, CACHE_FILE_3)) ERR;
+        if (glm_open_cache(CACHE_FILE_3, &cache)) ERR;
+        if (glm_cache_batch(cache, &batch)) ERR;
+        if (!same_batch(batch, &expected)) ERR;
+        if (batch->nfile != 3 || batch->event_file[batch->nevent - 1] != 2) ERR;
+        if (glm_close_cache(cache)) ERR;
+
+        /* A cache of no files. */
+        if (glm_read_files(paths, 0, 1, &empty)) ERR;
+        if (glm_write_cache(&empty, CACHE_FILE_3)) ERR;
+        if (glm_open_cache(CACHE_FILE_3, &cache)) ERR;
+        if (glm_cache_batch(cache, &batch)) ERR;
+        if (batch->nfile || batch->nevent || batch->ngroup || batch->nflash) ERR;
+        if (glm_close_cache(cache)) ERR;
+
+        if (glm_free_batch(&expected)) ERR;
+        if (glm_free_batch(&empty)) ERR;
+    }
+    SUMMARIZE_ERR;
+    printf("testing files which are not valid caches...");
+    {
+        GLM_CACHE_T *cache;
+
+        if (glm_open_cache("no_such_file.glmc", &cache) != GLM_ERR_IO) ERR;
+        if (glm_open_cache(GLM_DATA_FILE, &cache) != GLM_ERR_CACHE) ERR;
+
+        /* A bad magic number, version, and column offset. */
+        if (copy_file(CACHE_FILE, CACHE_FILE_BAD, 0, 1000000)) ERR;
+        if (glm_open_cache(CACHE_FILE_BAD, &cache) != GLM_ERR_CACHE) ERR;
+        if (copy_file(CACHE_FILE, CACHE_FILE_BAD, 4, 1000000)) ERR;
+        if (glm_open_cache(CACHE_FILE_BAD, &cache) != GLM_ERR_CACHE) ERR;
+        if (copy_file(CACHE_FILE, CACHE_FILE_BAD, 64 + 8, 1000000)) ERR;
+        if (glm_open_cache(CACHE_FILE_BAD, &cache) != GLM_ERR_CACHE) ERR;
+
+        /* Truncated files. */
+        if (copy_file(CACHE_FILE, CACHE_FILE_BAD, -1, 10)) ERR;
+        if (glm_open_cache(CACHE_FILE_BAD, &cache) != GLM_ERR_CACHE) ERR;
+        if (copy_file(CACHE_FILE, CACHE_FILE_BAD, -1, 5000)) ERR;
+        if (glm_open_cache(CACHE_FILE_BAD, &cache) != GLM_ERR_CACHE) ERR;
+
+        /* Files which can't be written or converted. */
+        if (glm_convert_to_cache(GLM_DATA_FILE, "no_such_dir/x.glmc") != GLM_ERR_IO) ERR;
+        if (!glm_convert_to_cache("no_such_file.nc", CACHE_FILE_BAD)) ERR;
+    }
+    SUMMARIZE_ERR;
+    FINAL_RESULTS;
+}
@@ -0,0 +1,290 @@
+/*
+  Program to test catalogs of directories of GOES-17 Global Lightning
+  Mapper data files.
+
+  Ed Hartnett
+
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <utime.h>
+#include <sys/stat.h>
+#include "un_test.h"
+#include "ncglm.h"
+
+/* Err is used to keep track of errors within each set of tests,
+ * total_err is the number of errors in the entire test program, which
+ * generally cosists of several sets of tests. */
+int total_err = 0, err = 0;
+
+/* Directory of granules, and the catalog of it. */
+#define DIR_NAME "tst_catalog_dir"
+#define CATALOG_FILE "tst_catalog.glmx"
+
+/* Copies of the test file, under the names of other granules. N1 is
+ * 20 s before the test file, N2 and N3 follow it. N5 is not a GLM
+ * file, though it has the name of one. */
+#define N0 GLM_DATA_FILE
+#define N1 "OR_GLM-L2-LCFA_G17_s20192692359200_e20192692359400_c20192692359428.nc"
+#define N2 "OR_GLM-L2-LCFA_G17_s20192700000000_e20192700000200_c20192700000228.nc"
+#define N3 "OR_GLM-L2-LCFA_G17_s20192700000200_e20192700000400_c20192700000428.nc"
+#define N4 "OR_GLM-L2-LCFA_G17_s20192700000400_e20192700001000_c20192700001028.nc"
+#define N5 "OR_GLM-L2-LCFA_G17_s20192700001000_e20192700001200_c20192700001228.nc"
+#define NOT_GLM "notes.nc"
+
+/* Number of times in a name. */
+#define NUM_TIMES 3
+
+/* Write a file which is not a GLM file into the directory. */
+static int
+write_junk(const char *name)
+{
+    FILE *out;
+
+    if (!(out = fopen(un_dir_path(DIR_NAME, name), "wb"))) ERR;
+    if (fprintf(out, "not a GLM file\n") < 0) ERR;
+    if (fclose(out)) ERR;
+
+    return 0;
+}
+
+/* Find a granule of a catalog by name. */
+static int
+find_entry(GLM_CATALOG_T *catalog, const char *name, size_t *idx)
+{
+    const GLM_CATALOG_ENTRY_T *entry;
+    size_t n, i;
+
+    if (glm_catalog_len(catalog, &n)) ERR;
+    for (i = 0; i < n; i++)
+    {
+        if (glm_catalog_entry(catalog, i, &entry)) ERR;
+        if (!strcmp(entry->name, name))
+        {
+            *idx = i;
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/* Count the granules of a catalog which overlap a time window. */
+static int
+count_time(GLM_CATALOG_T *catalog, double t0, double t1, size_t *nmatch)
+{
+    GLM_CATALOG_QUERY_T query;
+
+    memset(&query, 0, sizeof(query));
+    query.flags = GLM_FILTER_TIME;
+    query.time_min = t0;
+    query.time_max = t1;
+    if (glm_catalog_query(catalog, &query, nmatch, NULL)) ERR;
+
+    return 0;
+}
+
+int
+main()
+{
+    GLM_SCALAR_T scalar;
+
+    printf("Testing GLM catalogs.\n");
+    printf("testing times in file names...");
+    {
+        GLM_FILE_T *glm;
+        double t[NUM_TIMES], t2[NUM_TIMES];
+
+        if (glm_open(GLM_DATA_FILE, &glm)) ERR;
+        if (glm_get_scalars(glm, &scalar)) ERR;
+        if (glm_close(glm)) ERR;
+
+        /* The times in the name agree with product_time_bounds. */
+        if (glm_name_times(GLM_DATA_FILE, &t[0], &t[1], &t[2])) ERR;
+        if (fabs(t[0] - scalar.product_time_bounds[0]) > 0.5) ERR;
+        if (fabs(t[1] - scalar.product_time_bounds[1]) > 0.5) ERR;
+        if (fabs(t[1] - t[0] - 20.0) > 1e-6 || fabs(t[2] - t[1] - 2.8) > 1e-6) ERR;
+
+        /* Directories are ignored, and any time may be skipped. */
+        if (glm_name_times("/a/b_s1/" GLM_DATA_FILE, &t2[0], NULL, &t2[2])) ERR;
+        if (t2[0] != t[0] || t2[2] != t[2]) ERR;
+        if (glm_name_times(N1, &t2[0], &t2[1], NULL)) ERR;
+        if (fabs(t[0] - t2[1]) > 1e-6 || fabs(t[0] - t2[0] - 20.0) > 1e-6) ERR;
+
+        /* Not GLM names. */
+        if (glm_name_times(NOT_GLM, NULL, NULL, NULL) != GLM_ERR_NAME) ERR;
+        if (glm_name_times("OR_GLM_s2019269235940_e20192700000000_c20192700000028.nc",
+                           NULL, NULL, NULL) != GLM_ERR_NAME) ERR;
+        if (glm_name_times("OR_GLM_s20193692359400_e20192700000000_c20192700000028.nc",
+                           NULL, NULL, NULL) != GLM_ERR_NAME) ERR;
+        if (glm_name_times("OR_GLM_s20192692359400_c20192700000028.nc",
+                           NULL, NULL, NULL) != GLM_ERR_NAME) ERR;
+    }
+    SUMMARIZE_ERR;
+    printf("testing building and querying a catalog...");
+    {
+        GLM_CATALOG_T *catalog;
+        const GLM_CATALOG_ENTRY_T *entry, *prev = NULL;
+        GLM_CATALOG_QUERY_T query;
+        double p0 = scalar.product_time_bounds[0];
+        double p1 = scalar.product_time_bounds[1];
+        double e2, e3;
+        size_t match[4];
+        size_t nentry, nmatch, i, idx;
+
+        mkdir(DIR_NAME, 0755);
+        if (un_copy_data_file(DIR_NAME, N0) || un_copy_data_file(DIR_NAME, N1) || un_copy_data_file(DIR_NAME, N2) ||
+            un_copy_data_file(DIR_NAME, N3)) ERR;
+        if (write_junk(N5) || write_junk(NOT_GLM)) ERR;
+
+        if (glm_catalog_build(DIR_NAME, CATALOG_FILE, 2, &nentry)) ERR;
+        if (nentry != 4) ERR;
+        if (glm_catalog_open(CATALOG_FILE, &catalog)) ERR;
+        if (glm_catalog_len(catalog, &nentry)) ERR;
+        if (nentry != 4) ERR;
+
+        /* Entries are in time order, and have the counts and extent
+         * of the file. */
+        for (i = 0; i < nentry; i++)
+        {
+            if (glm_catalog_entry(catalog, i, &entry)) ERR;
+            if (entry->nevent != 4578 || entry->ngroup != 1609 ||
+                entry->nflash != 123) ERR;
+            if (entry->lat_min > entry->lat_max || entry->lat_min < -90 ||
+                entry->lat_max > 90 || entry->lon_min < -180 ||
+                entry->lon_max > 180) ERR;
+            if (entry->time_start > entry->time_end) ERR;
+            if (prev && prev->time_start > entry->time_start) ERR;
+            prev = entry;
+        }
+        if (glm_catalog_entry(catalog, nentry, &entry) != GLM_ERR_RANGE) ERR;
+
+        /* The span of a granule covers its product_time_bounds and the
+         * times in its name. */
+        if (find_entry(catalog, N1, &idx)) ERR;
+        if (glm_catalog_entry(catalog, idx, &entry)) ERR;
+        if (idx != 0 || entry->time_start >= p0 || entry->time_end != p1) ERR;
+        if (find_entry(catalog, N3, &idx)) ERR;
+        if (glm_catalog_entry(catalog, idx, &entry)) ERR;
+        if (entry->time_start != p0 || entry->time_end <= p1) ERR;
+        e3 = entry->name_end;
+        if (find_entry(catalog, N2, &idx)) ERR;
+        if (glm_catalog_entry(catalog, idx, &entry)) ERR;
+        e2 = entry->name_end;
+
+        /* Time queries. */
+        if (count_time(catalog, p1 - 1, p1, &nmatch)) ERR;
+        if (nmatch != 4) ERR;
+        if (count_time(catalog, p0 - 15, p0 - 10, &nmatch)) ERR;
+        if (nmatch != 1) ERR;
+        if (count_time(catalog, e2 + 1, e2 + 1, &nmatch)) ERR;
+        if (nmatch != 1) ERR;
+        if (count_time(catalog, e3 + 10, e3 + 20, &nmatch)) ERR;
+        if (nmatch != 0) ERR;
+        if (count_time(catalog, p0 - 100, p0 - 50, &nmatch)) ERR;
+        if (nmatch != 0) ERR;
+
+        /* Box queries. */
+        if (glm_catalog_entry(catalog, 0, &entry)) ERR;
+        memset(&query, 0, sizeof(query));
+        query.flags = GLM_FILTER_BOX;
+        query.lat_min = entry->lat_min;
+        query.lat_max = entry->lat_min + 1;
+        query.lon_min = entry->lon_max - 1;
+        query.lon_max = entry->lon_max;
+        if (glm_catalog_query(catalog, &query, &nmatch, match)) ERR;
+        if (nmatch != 4) ERR;
+        for (i = 0; i < nmatch; i++)
+            if (match[i] != i) ERR;
+        query.lon_min = 0.0;
+        query.lon_max = 10.0;
+        if (glm_catalog_query(catalog, &query, &nmatch, match)) ERR;
+        if (nmatch != 0) ERR;
+
+        /* Both at once. */
+        query.flags = GLM_FILTER_BOX | GLM_FILTER_TIME;
+        query.lon_min = entry->lon_min;
+        query.lon_max = entry->lon_max;
+        query.time_min = e2 + 1;
+        query.time_max = e2 + 2;
+        if (glm_catalog_query(catalog, &query, &nmatch, match)) ERR;
+        if (nmatch != 1 || find_entry(catalog, N3, &idx) || match[0] != idx) ERR;
+
+        /* No query. */
+        query.flags = 0;
+        if (glm_catalog_query(catalog, &query, &nmatch, NULL)) ERR;
+        if (nmatch != 4) ERR;
+        if (glm_catalog_close(catalog)) ERR;
+    }
+    SUMMARIZE_ERR;
+    printf("testing updating a catalog...");
+    {
+        GLM_CATALOG_T *catalog;
+        struct stat st;
+        struct utimbuf times;
+        FILE *f;
+        size_t nentry, idx;
+        char zero[256];
+
+        /* Spoil N2 without changing its size or time, so that only
+         * an update which does not read it again still has it. */
+        if (stat(un_dir_path(DIR_NAME, N2), &st)) ERR;
+        memset(zero, 0, sizeof(zero));
+        if (!(f = fopen(un_dir_path(DIR_NAME, N2), "r+b"))) ERR;
+        if (fwrite(zero, sizeof(zero), 1, f) != 1) ERR;
+        if (fclose(f)) ERR;
+        times.actime = st.st_atime;
+        times.modtime = st.st_mtime;
+        if (utime(un_dir_path(DIR_NAME, N2), &times)) ERR;
+
+        /* Add N4, and take away N1. */
+        if (un_copy_data_file(DIR_NAME, N4)) ERR;
+        if (remove(un_dir_path(DIR_NAME, N1))) ERR;
+
+        if (glm_catalog_update(DIR_NAME, CATALOG_FILE, 0, &nentry)) ERR;
+        if (nentry != 4) ERR;
+        if (glm_catalog_open(CATALOG_FILE, &catalog)) ERR;
+        if (find_entry(catalog, N0, &idx) || find_entry(catalog, N2, &idx) ||
+            find_entry(catalog, N3, &idx) || find_entry(catalog, N4, &idx)) ERR;
+        if (!find_entry(catalog, N1, &idx)) ERR;
+        if (glm_catalog_close(catalog)) ERR;
+
+        /* A build reads every file, so N2 is left out. */
+        if (glm_catalog_build(DIR_NAME, CATALOG_FILE, 1, &nentry)) ERR;
+        if (nentry != 3) ERR;
+        if (glm_catalog_update(DIR_NAME, CATALOG_FILE, 1, &nentry)) ERR;
+        if (nentry != 3) ERR;
+
+        /* With no catalog, an update is a build. */
+        if (remove(CATALOG_FILE)) ERR;
+        if (glm_catalog_update(DIR_NAME, CATALOG_FILE, 1, &nentry)) ERR;
+        if (nentry != 3) ERR;
+    }
+    SUMMARIZE_ERR;
+    printf("testing errors...");
+    {
+        GLM_CATALOG_T *catalog;
+        size_t nentry;
+
+        if (glm_catalog_open("no_such_file.glmx", &catalog) != GLM_ERR_IO) ERR;
+        if (glm_catalog_open(GLM_DATA_FILE, &catalog) != GLM_ERR_CATALOG) ERR;
+        if (glm_catalog_build("no_such_dir", CATALOG_FILE, 1, &nentry) != GLM_ERR_IO) ERR;
+        if (glm_catalog_build(DIR_NAME, "no_such_dir/x.glmx", 1, &nentry) != GLM_ERR_IO) ERR;
+
+        /* Tidy up. */
+        remove(un_dir_path(DIR_NAME, N0));
+        remove(un_dir_path(DIR_NAME, N2));
+        remove(un_dir_path(DIR_NAME, N3));
+        remove(un_dir_path(DIR_NAME, N4));
+        remove(un_dir_path(DIR_NAME, N5));
+        remove(un_dir_path(DIR_NAME, NOT_GLM));
+        rmdir(DIR_NAME);
+        remove(CATALOG_FILE);
+    }
+    SUMMARIZE_ERR;
+    FINAL_RESULTS;
+}
@@ -0,0 +1,239 @@
+/*
+  Program to test direct chunk reads of a GOES-17 Global Lightning
+  Mapper file. The values must be the same as those read through
+  netCDF.
+
+  Ed Hartnett
+
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "un_test.h"
+#include "glm_internal.h"
+#ifdef HAVE_HDF5_DIRECT
+#include <zlib.h>
+#endif
+
+/* Err is used to keep track of errors within each set of tests,
+ * total_err is the number of errors in the entire test program, which
+ * generally cosists of several sets of tests. */
+int total_err = 0, err = 0;
+
+/* Number of values in the chunks of the decode tests. */
+#define NVAL 1000
+
+/* Ranges of events to read. The test file has chunks of 256 values. */
+#define NUM_RANGES 5
+size_t range_start[NUM_RANGES] = {0, 250, 256, 4000, 4577};
+size_t range_count[NUM_RANGES] = {4578, 300, 256, 578, 1};
+
+/* Thread counts to test. */
+#define NUM_THREADS 3
+int threads[NUM_THREADS] = {1, 4, 0};
+
+/* Shuffle the bytes of n values, as the HDF5 shuffle filter does. */
+static void
+shuffle(const unsigned char *src, size_t n, size_t size, unsigned char *dst)
+{
+    size_t i, b;
+
+    for (b = 0; b < size; b++)
+        for (i = 0; i < n; i++)
+            dst[b * n + i] = src[i * size + b];
+}
+
+/* Are two groups the same? The structs have padding, so they can't be
+ * compared with memcmp(). */
+static int
+same_group(const GLM_GROUP_T *a, const GLM_GROUP_T *b)
+{
+    return a->id == b->id && a->time_offset == b->time_offset &&
+        a->lat == b->lat && a->lon == b->lon && a->area == b->area &&
+        a->energy == b->energy && a->parent_flash_id == b->parent_flash_id &&
+        a->quality_flag == b->quality_flag && a->time == b->time;
+}
+
+int
+main()
+{
+    printf("Testing GLM direct chunk reads.\n");
+    printf("testing decoding chunks...");
+    {
+        int value[NVAL], out[NVAL];
+        unsigned char shuffled[NVAL * sizeof(int)];
+        int filter[2] = {GLM_H5_SHUFFLE, GLM_H5_DEFLATE};
+        int i;
+
+        for (i = 0; i < NVAL; i++)
+            value[i] = i * 1000003;
+
+        /* No filters. */
+        if (glm_direct_decode(value, sizeof(value), 0, NULL, 0, sizeof(int),
+                              out, sizeof(out))) ERR;
+        if (memcmp(out, value, sizeof(value))) ERR;
+
+        /* Shuffle only. */
+        shuffle((unsigned char *)value, NVAL, sizeof(int), shuffled);
+        memset(out, 0, sizeof(out));
+        if (glm_direct_decode(shuffled, sizeof(shuffled), 1, filter, 0,
+                              sizeof(int), out, sizeof(out))) ERR;
+        if (memcmp(out, value, sizeof(value))) ERR;
+
+        /* The mask says the shuffle was not applied. */
+        if (glm_direct_decode(value, sizeof(value), 1, filter, 1, sizeof(int),
+                              out, sizeof(out))) ERR;
+        if (memcmp(out, value, sizeof(value))) ERR;
+
+        /* A chunk of the wrong length. */
+        if (glm_direct_decode(shuffled, sizeof(shuffled) - 4, 1, filter, 0,
+                              sizeof(int), out, sizeof(out)) != GLM_ERR_UNEXPECTED) ERR;
+
+#ifdef HAVE_HDF5_DIRECT
+        {
+            unsigned char packed[NVAL * sizeof(int) + 100];
+            uLongf packed_len = sizeof(packed);
+
+            /* Shuffle, then deflate, as netCDF writes them. */
+            if (compress(packed, &packed_len, shuffled, sizeof(shuffled)) != Z_OK) ERR;
+            memset(out, 0, sizeof(out));
+            if (glm_direct_decode(packed, packed_len, 2, filter, 0, sizeof(int),
+                                  out, sizeof(out))) ERR;
+            if (memcmp(out, value, sizeof(value))) ERR;
+
+            /* Deflate only. */
+            packed_len = sizeof(packed);
+            if (compress(packed, &packed_len, (unsigned char *)value,
+                         sizeof(value)) != Z_OK) ERR;
+            memset(out, 0, sizeof(out));
+            if (glm_direct_decode(packed, packed_len, 2, filter, 1, sizeof(int),
+                                  out, sizeof(out))) ERR;
+            if (memcmp(out, value, sizeof(value))) ERR;
+
+            /* A corrupt chunk. */
+            packed[packed_len / 2] ^= 0xff;
+            packed[2] ^= 0xff;
+            if (glm_direct_decode(packed, packed_len, 2, filter, 1, sizeof(int),
+                                  out, sizeof(out)) != GLM_ERR_UNEXPECTED) ERR;
+        }
+#endif
+    }
+    SUMMARIZE_ERR;
+    printf("testing direct reads...");
+    {
+        GLM_FILE_T *glm, *dglm;
+        GLM_EVENT_T *event, *devent;
+        GLM_GROUP_T *group, *dgroup;
+        GLM_FLASH_T *flash, *dflash;
+        float *lat, *dlat;
+        size_t nevent, ngroup, nflash, i;
+        int direct;
+        int t, r;
+
+        if (glm_open(GLM_DATA_FILE, &glm)) ERR;
+        if (glm_inq_dims(glm, &nevent, &ngroup, &nflash)) ERR;
+        if (!(event = malloc(nevent * sizeof(GLM_EVENT_T)))) ERR;
+        if (!(devent = malloc(nevent * sizeof(GLM_EVENT_T)))) ERR;
+        if (!(group = malloc(ngroup * sizeof(GLM_GROUP_T)))) ERR;
+        if (!(dgroup = malloc(ngroup * sizeof(GLM_GROUP_T)))) ERR;
+        if (!(flash = malloc(nflash * sizeof(GLM_FLASH_T)))) ERR;
+        if (!(dflash = malloc(nflash * sizeof(GLM_FLASH_T)))) ERR;
+        if (!(lat = malloc(nevent * sizeof(float)))) ERR;
+        if (!(dlat = malloc(nevent * sizeof(float)))) ERR;
+
+        /* Read everything through netCDF. */
+        if (glm_inq_direct(glm, &direct)) ERR;
+        if (direct) ERR;
+        if (glm_get_event_structs(glm, NULL, event)) ERR;
+        if (glm_get_group_structs(glm, NULL, group)) ERR;
+        if (glm_get_flash_structs(glm, NULL, flash)) ERR;
+        if (!group[0].time || !flash[0].time_of_first_event) ERR;
+        if (glm_read_event_range_arrays(glm, 0, nevent, NULL, NULL, lat, NULL,
+                                        NULL, NULL)) ERR;
+
+        for (t = 0; t < NUM_THREADS; t++)
+        {
+            if (glm_open(GLM_DATA_FILE, &dglm)) ERR;
+            if (glm_set_direct(dglm, threads[t])) ERR;
+            if (glm_inq_direct(dglm, &direct)) ERR;
+#ifdef HAVE_HDF5_DIRECT
+            if (!direct) ERR;
+#else
+            if (direct) ERR;
+#endif
+
+            /* Whole reads. */
+            if (glm_get_event_structs(dglm, NULL, devent)) ERR;
+            if (memcmp(devent, event, nevent * sizeof(GLM_EVENT_T))) ERR;
+            if (glm_get_group_structs(dglm, NULL, dgroup)) ERR;
+            for (i = 0; i < ngroup; i++)
+                if (!same_group(&dgroup[i], &group[i])) ERR;
+            if (glm_get_flash_structs(dglm, NULL, dflash)) ERR;
+            for (i = 0; i < nflash; i++)
+                if (dflash[i].id != flash[i].id || dflash[i].lat != flash[i].lat ||
+                    dflash[i].area != flash[i].area ||
+                    dflash[i].time_of_first_event != flash[i].time_of_first_event ||
+                    dflash[i].time_of_last_event != flash[i].time_of_last_event) ERR;
+
+            /* Ranges which start and end inside chunks. */
+            for (r = 0; r < NUM_RANGES; r++)
+            {
+                memset(dlat, 0, nevent * sizeof(float));
+                if (glm_read_event_range(dglm, range_start[r], range_count[r],
+                                         devent)) ERR;
+                if (memcmp(devent, &event[range_start[r]],
+                           range_count[r] * sizeof(GLM_EVENT_T))) ERR;
+                if (glm_read_event_range_arrays(dglm, range_start[r],
+                                                range_count[r], NULL, NULL,
+                                                dlat, NULL, NULL, NULL)) ERR;
+                if (memcmp(dlat, &lat[range_start[r]],
+                           range_count[r] * sizeof(float))) ERR;
+            }
+
+            /* Turn direct reads off again. */
+            if (glm_set_direct(dglm, -1)) ERR;
+            if (glm_inq_direct(dglm, &direct)) ERR;
+            if (direct) ERR;
+            if (glm_read_event_range(dglm, 250, 300, devent)) ERR;
+            if (memcmp(devent, &event[250], 300 * sizeof(GLM_EVENT_T))) ERR;
+            if (glm_close(dglm)) ERR;
+        }
+
+        free(event);
+        free(devent);
+        free(group);
+        free(dgroup);
+        free(flash);
+        free(dflash);
+        free(lat);
+        free(dlat);
+        if (glm_close(glm)) ERR;
+    }
+    SUMMARIZE_ERR;
+    printf("testing direct reads of a file in memory...");
+    {
+        GLM_FILE_T *glm;
+        FILE *f;
+        void *buf;
+        long len;
+        int direct;
+
+        /* Files in memory are always read through netCDF. */
+        if (!(f = fopen(GLM_DATA_FILE, "rb"))) ERR;
+        if (fseek(f, 0, SEEK_END)) ERR;
+        if ((len = ftell(f)) <= 0) ERR;
+        rewind(f);
+        if (!(buf = malloc(len))) ERR;
+        if (fread(buf, 1, len, f) != len) ERR;
+        fclose(f);
+        if (glm_open_mem(buf, len, &glm)) ERR;
+        if (glm_set_direct(glm, 2)) ERR;
+        if (glm_inq_direct(glm, &direct)) ERR;
+        if (direct) ERR;
+        if (glm_close(glm)) ERR;
+        free(buf);
+    }
+    SUMMARIZE_ERR;
+    FINAL_RESULTS;
+}
@@ -0,0 +1,553 @@
+/*
+  Program to test the GLM file handle, which caches the metadata of
+  a GOES-17 Global Lightning Mapper file.
+
+  Ed Hartnett
+
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+#include "un_test.h"
+#include "ncglm.h"
+
+/* Err is used to keep track of errors within each set of tests,
+ * total_err is the number of errors in the entire test program, which
+ * generally cosists of several sets of tests. */
+int total_err = 0, err = 0;
+
+int
+main()
+{
+    printf("Testing GLM file handle.\n");
+    printf("testing glm_open()/glm_close()...");
+    {
+        GLM_FILE_T *glm;
+        size_t nevent, ngroup, nflash;
+        int ncid;
+
+        if (glm_open(GLM_DATA_FILE, &glm)) ERR;
+        if (glm_inq_dims(glm, &nevent, &ngroup, &nflash)) ERR;
+        if (nevent != 4578 || ngroup != 1609 || nflash != 123) ERR;
+        if (glm_inq_dims(glm, NULL, NULL, NULL)) ERR;
+        if (glm_inq_ncid(glm, &ncid)) ERR;
+        if (ncid <= 0) ERR;
+        if (glm_close(glm)) ERR;
+    }
+    SUMMARIZE_ERR;
+    printf("testing handle reads match ncid reads...");
+    {
+        GLM_FILE_T *glm;
+        size_t nevent, ngroup, nflash;
+        size_t my_nevent, my_ngroup, my_nflash;
+        GLM_EVENT_T *event, *event2;
+        GLM_GROUP_T *group, *group2;
+        GLM_FLASH_T *flash, *flash2;
+        GLM_SCALAR_T scalar, scalar2;
+        int ncid;
+        int i;
+
+        if (glm_open(GLM_DATA_FILE, &glm)) ERR;
+        if (glm_inq_dims(glm, &nevent, &ngroup, &nflash)) ERR;
+        if (glm_inq_ncid(glm, &ncid)) ERR;
+
+        /* Allocate storage. */
+        if (!(event = malloc(nevent * sizeof(GLM_EVENT_T)))) ERR;
+        if (!(event2 = malloc(nevent * sizeof(GLM_EVENT_T)))) ERR;
+        if (!(group = malloc(ngroup * sizeof(GLM_GROUP_T)))) ERR;
+        if (!(group2 = malloc(ngroup * sizeof(GLM_GROUP_T)))) ERR;
+        if (!(flash = malloc(nflash * sizeof(GLM_FLASH_T)))) ERR;
+        if (!(flash2 = malloc(nflash * sizeof(GLM_FLASH_T)))) ERR;
+
+        /* Read with the handle. Read twice, to make sure the cached
+         * metadata can be reused. */
+        if (glm_get_event_structs(glm, &my_nevent, event)) ERR;
+        if (my_nevent != nevent) ERR;
+        if (glm_get_event_structs(glm, &my_nevent, event)) ERR;
+        if (my_nevent != nevent) ERR;
+        if (glm_get_group_structs(glm, &my_ngroup, group)) ERR;
+        if (my_ngroup != ngroup) ERR;
+        if (glm_get_flash_structs(glm, &my_nflash, flash)) ERR;
+        if (my_nflash != nflash) ERR;
+        if (glm_get_scalars(glm, &scalar)) ERR;
+
+        /* Read with the ncid. */
+        if (glm_read_event_structs(ncid, NULL, event2)) ERR;
+        if (glm_read_group_structs(ncid, NULL, group2)) ERR;
+        if (glm_read_flash_structs(ncid, NULL, flash2)) ERR;
+        if (read_scalars(ncid, &scalar2)) ERR;
+
+        /* Results must be the same. */
+        for (i = 0; i < nevent; i++)
+        {
+            if (event[i].id != event2[i].id) ERR;
+            if (event[i].time_offset != event2[i].time_offset) ERR;
+            if (event[i].lat != event2[i].lat) ERR;
+            if (event[i].lon != event2[i].lon) ERR;
+            if (event[i].energy != event2[i].energy) ERR;
+            if (event[i].parent_group_id != event2[i].parent_group_id) ERR;
+        }
+        for (i = 0; i < ngroup; i++)
+        {
+            if (group[i].id != group2[i].id) ERR;
+            if (group[i].lat != group2[i].lat) ERR;
+            if (group[i].energy != group2[i].energy) ERR;
+            if (group[i].parent_flash_id != group2[i].parent_flash_id) ERR;
+        }
+        for (i = 0; i < nflash; i++)
+        {
+            if (flash[i].id != flash2[i].id) ERR;
+            if (flash[i].lat != flash2[i].lat) ERR;
+            if (flash[i].area != flash2[i].area) ERR;
+        }
+        if (scalar.product_time != scalar2.product_time) ERR;
+        if (scalar.event_count != nevent) ERR;
+        if (scalar.group_count != ngroup) ERR;
+        if (scalar.flash_count != nflash) ERR;
+        if (scalar.processing_parm_version_container !=
+            scalar2.processing_parm_version_container) ERR;
+
+        /* Free resources. */
+        free(event);
+        free(event2);
+        free(group);
+        free(group2);
+        free(flash);
+        free(flash2);
+        if (glm_close(glm)) ERR;
+    }
+    SUMMARIZE_ERR;
+    printf("testing range reads match full reads...");
+    {
+        GLM_FILE_T *glm;
+        size_t nevent, ngroup, nflash;
+        GLM_EVENT_T *event, *event2;
+        GLM_GROUP_T *group, *group2;
+        GLM_FLASH_T *flash, *flash2;
+        float *lat, *energy;
+        size_t start, count;
+        int i;
+
+        if (glm_open(GLM_DATA_FILE, &glm)) ERR;
+        if (glm_inq_dims(glm, &nevent, &ngroup, &nflash)) ERR;
+
+        /* Allocate storage. */
+        if (!(event = malloc(nevent * sizeof(GLM_EVENT_T)))) ERR;
+        if (!(event2 = malloc(nevent * sizeof(GLM_EVENT_T)))) ERR;
+        if (!(group = malloc(ngroup * sizeof(GLM_GROUP_T)))) ERR;
+        if (!(group2 = malloc(ngroup * sizeof(GLM_GROUP_T)))) ERR;
+        if (!(flash = malloc(nflash * sizeof(GLM_FLASH_T)))) ERR;
+        if (!(flash2 = malloc(nflash * sizeof(GLM_FLASH_T)))) ERR;
+        if (!(lat = malloc(10 * sizeof(float)))) ERR;
+        if (!(energy = malloc(10 * sizeof(float)))) ERR;
+
+        /* Read everything. */
+        if (glm_get_event_structs(glm, NULL, event)) ERR;
+        if (glm_get_group_structs(glm, NULL, group)) ERR;
+        if (glm_get_flash_structs(glm, NULL, flash)) ERR;
+
+        /* Read again in slices of an odd size. */
+        for (start = 0; start < nevent; start += count)
+        {
+            count = nevent - start < 1000 ? nevent - start : 1000;
+            if (glm_read_event_range(glm, start, count, event2 + start)) ERR;
+        }
+        for (start = 0; start < ngroup; start += count)
+        {
+            count = ngroup - start < 333 ? ngroup - start : 333;
+            if (glm_read_group_range(glm, start, count, group2 + start)) ERR;
+        }
+        for (start = 0; start < nflash; start += count)
+        {
+            count = nflash - start < 50 ? nflash - start : 50;
+            if (glm_read_flash_range(glm, start, count, flash2 + start)) ERR;
+        }
+
+        /* Results must be the same. */
+        if (memcmp(event, event2, nevent * sizeof(GLM_EVENT_T))) ERR;
+        for (i = 0; i < ngroup; i++)
+        {
+            if (group[i].id != group2[i].id) ERR;
+            if (group[i].time_offset != group2[i].time_offset) ERR;
+            if (group[i].area != group2[i].area) ERR;
+            if (group[i].parent_flash_id != group2[i].parent_flash_id) ERR;
+        }
+        for (i = 0; i < nflash; i++)
+        {
+            if (flash[i].id != flash2[i].id) ERR;
+            if (flash[i].energy != flash2[i].energy) ERR;
+            if (flash[i].quality_flag != flash2[i].quality_flag) ERR;
+        }
+
+        /* Read the middle of the groups into arrays. */
+        {
+            float time_offset[10], lon[10], area[10];
+            unsigned int parent_flash_id[10];
+            short quality_flag[10];
+
+            if (glm_read_group_range_arrays(glm, 100, 10, time_offset, lat, lon,
+                                            energy, area, parent_flash_id,
+                                            quality_flag)) ERR;
+            for (i = 0; i < 10; i++)
+            {
+                if (lat[i] != group[100 + i].lat) ERR;
+                if (energy[i] != group[100 + i].energy) ERR;
+                if (parent_flash_id[i] != group[100 + i].parent_flash_id) ERR;
+            }
+        }
+
+        /* Empty ranges are fine, ranges past the end are not. */
+        if (glm_read_event_range(glm, nevent, 0, event2)) ERR;
+        if (glm_read_event_range(glm, nevent - 1, 2, event2) != GLM_ERR_RANGE) ERR;
+        if (glm_read_group_range(glm, ngroup + 1, 0, group2) != GLM_ERR_RANGE) ERR;
+        if (glm_read_flash_range(glm, 1, nflash, flash2) != GLM_ERR_RANGE) ERR;
+
+        /* Free resources. */
+        free(event);
+        free(event2);
+        free(group);
+        free(group2);
+        free(flash);
+        free(flash2);
+        free(lat);
+        free(energy);
+        if (glm_close(glm)) ERR;
+    }
+    SUMMARIZE_ERR;
+    printf("testing glm_open_mem()...");
+    {
+        GLM_FILE_T *glm, *glm2;
+        FILE *fp;
+        char *buf;
+        long len;
+        size_t nevent, ngroup, nflash;
+        GLM_EVENT_T *event, *event2;
+        GLM_FLASH_T *flash;
+        GLM_SCALAR_T scalar, scalar2;
+        int ncid;
+
+        /* Read the whole file into memory. */
+        if (!(fp = fopen(GLM_DATA_FILE, "rb"))) ERR;
+        if (fseek(fp, 0, SEEK_END)) ERR;
+        if ((len = ftell(fp)) <= 0) ERR;
+        rewind(fp);
+        if (!(buf = malloc(len))) ERR;
+        if (fread(buf, 1, len, fp) != len) ERR;
+        fclose(fp);
+
+        /* Open it from memory, and from disk. */
+        if (glm_open_mem(buf, len, &glm)) ERR;
+        if (glm_open(GLM_DATA_FILE, &glm2)) ERR;
+        if (glm_inq_dims(glm, &nevent, &ngroup, &nflash)) ERR;
+        if (nevent != 4578 || ngroup != 1609 || nflash != 123) ERR;
+
+        /* Handle readers. */
+        if (!(event = malloc(nevent * sizeof(GLM_EVENT_T)))) ERR;
+        if (!(event2 = malloc(nevent * sizeof(GLM_EVENT_T)))) ERR;
+        if (glm_get_event_structs(glm, NULL, event)) ERR;
+        if (glm_get_event_structs(glm2, NULL, event2)) ERR;
+        if (memcmp(event, event2, nevent * sizeof(GLM_EVENT_T))) ERR;
+        if (glm_get_scalars(glm, &scalar)) ERR;
+        if (glm_get_scalars(glm2, &scalar2)) ERR;
+        if (scalar.product_time != scalar2.product_time) ERR;
+        if (scalar.flash_count != nflash) ERR;
+
+        /* The ncid readers work on the in-memory file too. */
+        if (glm_inq_ncid(glm, &ncid)) ERR;
+        if (glm_read_event_structs(ncid, NULL, event2)) ERR;
+        if (memcmp(event, event2, nevent * sizeof(GLM_EVENT_T))) ERR;
+        if (!(flash = malloc(nflash * sizeof(GLM_FLASH_T)))) ERR;
+        if (glm_read_flash_structs(ncid, NULL, flash)) ERR;
+        if (read_scalars(ncid, &scalar2)) ERR;
+        if (scalar.event_count != scalar2.event_count) ERR;
+
+        free(event);
+        free(event2);
+        free(flash);
+        if (glm_close(glm)) ERR;
+        if (glm_close(glm2)) ERR;
+        free(buf);
+    }
+    SUMMARIZE_ERR;
+    printf("testing field selection...");
+    {
+        GLM_FILE_T *glm;
+        GLM_EVENT_T *event, *event2;
+        GLM_GROUP_T *group, *group2;
+        GLM_FLASH_T *flash, *flash2;
+        float *lat, *lon, *time_offset, *lat2, *lon2, *time_offset2;
+        float *area;
+        size_t nevent, ngroup, nflash;
+        size_t i;
+
+        if (glm_open(GLM_DATA_FILE, &glm)) ERR;
+        if (glm_inq_dims(glm, &nevent, &ngroup, &nflash)) ERR;
+        if (!(event = malloc(nevent * sizeof(GLM_EVENT_T)))) ERR;
+        if (!(event2 = malloc(nevent * sizeof(GLM_EVENT_T)))) ERR;
+        if (!(group = malloc(ngroup * sizeof(GLM_GROUP_T)))) ERR;
+        if (!(group2 = malloc(ngroup * sizeof(GLM_GROUP_T)))) ERR;
+        if (!(flash = calloc(nflash, sizeof(GLM_FLASH_T)))) ERR;
+        if (!(flash2 = malloc(nflash * sizeof(GLM_FLASH_T)))) ERR;
+        if (!(lat = malloc(nevent * sizeof(float)))) ERR;
+        if (!(lon = malloc(nevent * sizeof(float)))) ERR;
+        if (!(time_offset = malloc(nevent * sizeof(float)))) ERR;
+        if (!(lat2 = malloc(nevent * sizeof(float)))) ERR;
+        if (!(lon2 = malloc(nevent * sizeof(float)))) ERR;
+        if (!(time_offset2 = malloc(nevent * sizeof(float)))) ERR;
+        if (!(area = malloc(nflash * sizeof(float)))) ERR;
+
+        /* Read everything. */
+        if (glm_get_event_structs(glm, NULL, event)) ERR;
+        if (glm_get_group_structs(glm, NULL, group)) ERR;
+        if (glm_get_flash_structs(glm, NULL, flash)) ERR;
+        if (glm_get_event_arrays(glm, NULL, NULL, time_offset, lat, lon, NULL,
+                                 NULL)) ERR;
+
+        /* NULL arrays are skipped, whatever the mask. */
+        for (i = 0; i < nevent; i++)
+            if (lat[i] != event[i].lat || lon[i] != event[i].lon ||
+                time_offset[i] != event[i].time_offset) ERR;
+        if (glm_get_group_arrays(glm, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
+                                 NULL)) ERR;
+        if (glm_read_flash_range_arrays(glm, 0, nflash, NULL, NULL, NULL, NULL,
+                                        NULL, NULL, area, NULL, NULL)) ERR;
+        for (i = 0; i < nflash; i++)
+            if (area[i] != flash[i].area) ERR;
+
+        /* Only read some fields. The others are left alone. */
+        if (glm_set_fields(glm, GLM_EV_LAT | GLM_EV_LON | GLM_EV_TIME,
+                           GLM_GR_ID | GLM_GR_PARENT, GLM_FL_ENERGY)) ERR;
+        memset(event2, 0, nevent * sizeof(GLM_EVENT_T));
+        memset(group2, 0, ngroup * sizeof(GLM_GROUP_T));
+        memset(flash2, 0, nflash * sizeof(GLM_FLASH_T));
+        if (glm_get_event_structs(glm, NULL, event2)) ERR;
+        if (glm_get_group_structs(glm, NULL, group2)) ERR;
+        if (glm_get_flash_structs(glm, NULL, flash2)) ERR;
+        for (i = 0; i < nevent; i++)
+        {
+            if (event2[i].lat != event[i].lat || event2[i].lon != event[i].lon ||
+                event2[i].time_offset != event[i].time_offset) ERR;
+            if (event2[i].id || event2[i].energy || event2[i].parent_group_id) ERR;
+        }
+        for (i = 0; i < ngroup; i++)
+        {
+            if (group2[i].id != group[i].id ||
+                group2[i].parent_flash_id != group[i].parent_flash_id) ERR;
+            if (group2[i].lat || group2[i].area || group2[i].quality_flag) ERR;
+        }
+        for (i = 0; i < nflash; i++)
+        {
+            if (flash2[i].energy != flash[i].energy) ERR;
+            if (flash2[i].id || flash2[i].lat || flash2[i].time_offset_of_last_event) ERR;
+        }
+
+        /* The mask also applies to array reads. */
+        for (i = 0; i < nevent; i++)
+            lat2[i] = lon2[i] = time_offset2[i] = -1;
+        if (glm_set_fields(glm, GLM_EV_LAT, GLM_GR_ALL, GLM_FL_ALL)) ERR;
+        if (glm_get_event_arrays(glm, NULL, NULL, time_offset2, lat2, lon2,
+                                 NULL, NULL)) ERR;
+        for (i = 0; i < nevent; i++)
+            if (lat2[i] != lat[i] || lon2[i] != -1 || time_offset2[i] != -1) ERR;
+
+        /* Reading everything again. */
+        if (glm_set_fields(glm, GLM_EV_ALL, GLM_GR_ALL, GLM_FL_ALL)) ERR;
+        if (glm_get_event_structs(glm, NULL, event2)) ERR;
+        if (memcmp(event, event2, nevent * sizeof(GLM_EVENT_T))) ERR;
+        if (glm_get_flash_structs(glm, NULL, flash2)) ERR;
+        if (memcmp(flash, flash2, nflash * sizeof(GLM_FLASH_T))) ERR;
+
+        free(event);
+        free(event2);
+        free(group);
+        free(group2);
+        free(flash);
+        free(flash2);
+        free(lat);
+        free(lon);
+        free(time_offset);
+        free(lat2);
+        free(lon2);
+        free(time_offset2);
+        free(area);
+        if (glm_close(glm)) ERR;
+    }
+    SUMMARIZE_ERR;
+    printf("testing reads with several threads...");
+    {
+        GLM_FILE_T *glm, *tglm;
+        size_t nevent, ngroup, nflash, nmatch, tnmatch;
+        GLM_EVENT_T *event, *tevent, *fevent;
+        GLM_GROUP_T *group, *tgroup;
+        GLM_FLASH_T *flash, *tflash;
+        GLM_FILTER_T filter;
+        float *lat, *tlat;
+        int nthreads[3] = {2, 4, 0};
+        int t, i;
+
+        if (glm_open(GLM_DATA_FILE, &glm)) ERR;
+        if (glm_inq_dims(glm, &nevent, &ngroup, &nflash)) ERR;
+        if (!(event = malloc(nevent * sizeof(GLM_EVENT_T)))) ERR;
+        if (!(tevent = malloc(nevent * sizeof(GLM_EVENT_T)))) ERR;
+        if (!(fevent = malloc(nevent * sizeof(GLM_EVENT_T)))) ERR;
+        if (!(group = malloc(ngroup * sizeof(GLM_GROUP_T)))) ERR;
+        if (!(tgroup = malloc(ngroup * sizeof(GLM_GROUP_T)))) ERR;
+        if (!(flash = malloc(nflash * sizeof(GLM_FLASH_T)))) ERR;
+        if (!(tflash = malloc(nflash * sizeof(GLM_FLASH_T)))) ERR;
+        if (!(lat = malloc(nevent * sizeof(float)))) ERR;
+        if (!(tlat = malloc(nevent * sizeof(float)))) ERR;
+
+        /* Read everything with one thread. */
+        if (glm_get_event_structs(glm, NULL, event)) ERR;
+        if (glm_get_group_structs(glm, NULL, group)) ERR;
+        if (glm_get_flash_structs(glm, NULL, flash)) ERR;
+        if (glm_read_event_range_arrays(glm, 0, nevent, NULL, NULL, lat, NULL,
+                                        NULL, NULL)) ERR;
+        memset(&filter, 0, sizeof(GLM_FILTER_T));
+        filter.flags = GLM_FILTER_BOX;
+        filter.lat_min = event[nevent / 2].lat - 1;
+        filter.lat_max = event[nevent / 2].lat + 1;
+        filter.lon_min = event[nevent / 2].lon - 2;
+        filter.lon_max = event[nevent / 2].lon + 2;
+        if (glm_read_event_filter(glm, 0, nevent, &filter, &nmatch,
+                                  fevent)) ERR;
+
+        for (t = 0; t < 3; t++)
+        {
+            if (glm_open(GLM_DATA_FILE, &tglm)) ERR;
+            if (glm_set_nthreads(tglm, nthreads[t])) ERR;
+
+            /* Results must be the same. */
+            if (glm_get_event_structs(tglm, NULL, tevent)) ERR;
+            if (memcmp(event, tevent, nevent * sizeof(GLM_EVENT_T))) ERR;
+            if (glm_get_group_structs(tglm, NULL, tgroup)) ERR;
+            for (i = 0; i < ngroup; i++)
+            {
+                if (group[i].id != tgroup[i].id) ERR;
+                if (group[i].lat != tgroup[i].lat) ERR;
+                if (group[i].area != tgroup[i].area) ERR;
+                if (group[i].quality_flag != tgroup[i].quality_flag) ERR;
+            }
+            if (glm_get_flash_structs(tglm, NULL, tflash)) ERR;
+            for (i = 0; i < nflash; i++)
+            {
+                if (flash[i].id != tflash[i].id) ERR;
+                if (flash[i].time_offset_of_last_event !=
+                    tflash[i].time_offset_of_last_event) ERR;
+                if (flash[i].energy != tflash[i].energy) ERR;
+            }
+            if (glm_read_event_range_arrays(tglm, 0, nevent, NULL, NULL, tlat,
+                                            NULL, NULL, NULL)) ERR;
+            if (memcmp(lat, tlat, nevent * sizeof(float))) ERR;
+            if (glm_read_event_range(tglm, 1000, 7, tevent)) ERR;
+            if (memcmp(event + 1000, tevent, 7 * sizeof(GLM_EVENT_T))) ERR;
+
+            /* Filtered reads. */
+            if (glm_read_event_filter(tglm, 0, nevent, &filter, &tnmatch,
+                                      tevent)) ERR;
+            if (tnmatch != nmatch || !tnmatch) ERR;
+            if (memcmp(fevent, tevent, nmatch * sizeof(GLM_EVENT_T))) ERR;
+
+            /* Fields which are not chosen are not read. */
+            if (glm_set_fields(tglm, GLM_EV_ENERGY, GLM_GR_ALL, GLM_FL_ALL)) ERR;
+            memset(tevent, 0, nevent * sizeof(GLM_EVENT_T));
+            if (glm_get_event_structs(tglm, NULL, tevent)) ERR;
+            for (i = 0; i < nevent; i++)
+                if (tevent[i].energy != event[i].energy || tevent[i].lat) ERR;
+
+            if (glm_close(tglm)) ERR;
+        }
+
+        free(event);
+        free(tevent);
+        free(fevent);
+        free(group);
+        free(tgroup);
+        free(flash);
+        free(tflash);
+        free(lat);
+        free(tlat);
+        if (glm_close(glm)) ERR;
+    }
+    SUMMARIZE_ERR;
+    printf("testing times in ns since the Unix epoch...");
+    {
+        GLM_FILE_T *glm;
+        GLM_SCALAR_T scalar;
+        size_t nevent, ngroup, nflash;
+        GLM_EVENT_T *event;
+        GLM_GROUP_T *group;
+        GLM_FLASH_T *flash;
+        int64_t *time, *time2;
+        double base;
+        int nthreads[2] = {1, 3};
+        int t, i;
+
+        if (glm_open(GLM_DATA_FILE, &glm)) ERR;
+        if (glm_inq_dims(glm, &nevent, &ngroup, &nflash)) ERR;
+        if (glm_get_scalars(glm, &scalar)) ERR;
+        base = scalar.product_time + GLM_J2000_UNIX;
+        if (!(event = malloc(nevent * sizeof(GLM_EVENT_T)))) ERR;
+        if (!(group = malloc(ngroup * sizeof(GLM_GROUP_T)))) ERR;
+        if (!(flash = malloc(nflash * sizeof(GLM_FLASH_T)))) ERR;
+        if (!(time = malloc(nevent * sizeof(int64_t)))) ERR;
+        if (!(time2 = malloc(nevent * sizeof(int64_t)))) ERR;
+
+        for (t = 0; t < 2; t++)
+        {
+            if (glm_set_nthreads(glm, nthreads[t])) ERR;
+
+            /* The struct times agree with the arrays, and with the
+             * float time offsets, to the precision of a float. The
+             * test file is from 2019-09-26. */
+            if (glm_get_event_structs(glm, NULL, event)) ERR;
+            if (glm_read_event_times(glm, 0, nevent, time)) ERR;
+            for (i = 0; i < nevent; i++)
+            {
+                if (event[i].time != time[i]) ERR;
+                if (fabs(time[i] / 1e9 - base - event[i].time_offset) > 1e-5) ERR;
+                if (time[i] < 1569456000000000000LL ||
+                    time[i] > 1569628800000000000LL) ERR;
+            }
+            if (glm_get_group_structs(glm, NULL, group)) ERR;
+            if (glm_read_group_times(glm, 0, ngroup, time)) ERR;
+            for (i = 0; i < ngroup; i++)
+            {
+                if (group[i].time != time[i]) ERR;
+                if (fabs(time[i] / 1e9 - base - group[i].time_offset) > 1e-5) ERR;
+            }
+            if (glm_get_flash_structs(glm, NULL, flash)) ERR;
+            if (glm_read_flash_times(glm, 0, nflash, time, time2)) ERR;
+            for (i = 0; i < nflash; i++)
+            {
+                if (flash[i].time_of_first_event != time[i] ||
+                    flash[i].time_of_last_event != time2[i]) ERR;
+                if (time[i] > time2[i]) ERR;
+                if (fabs(time[i] / 1e9 - base -
+                         flash[i].time_offset_of_first_event) > 1e-5) ERR;
+            }
+
+            /* Ranges, and one array of a flash. */
+            if (glm_read_event_times(glm, 1000, 7, time)) ERR;
+            for (i = 0; i < 7; i++)
+                if (time[i] != event[1000 + i].time) ERR;
+            if (glm_read_flash_times(glm, 5, 3, NULL, time)) ERR;
+            for (i = 0; i < 3; i++)
+                if (time[i] != flash[5 + i].time_of_last_event) ERR;
+            if (glm_read_event_times(glm, nevent, 1, time) != GLM_ERR_RANGE) ERR;
+            if (glm_read_event_times(glm, nevent, 0, time)) ERR;
+        }
+
+        free(event);
+        free(group);
+        free(flash);
+        free(time);
+        free(time2);
+        if (glm_close(glm)) ERR;
+    }
+    SUMMARIZE_ERR;
+    FINAL_RESULTS;
+}
@@ -0,0 +1,287 @@
+/*
+  Program to test reading only the events, groups and flashes of a
+  GOES-17 Global Lightning Mapper file which pass a filter.
+
+  Ed Hartnett
+
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "un_test.h"
+#include "ncglm.h"
+
+/* Err is used to keep track of errors within each set of tests,
+ * total_err is the number of errors in the entire test program, which
+ * generally cosists of several sets of tests. */
+int total_err = 0, err = 0;
+
+/* Number of filters tested. */
+#define NUM_FILTERS 7
+
+/* Does a value pass a filter? */
+static int
+passes(const GLM_FILTER_T *f, float lat, float lon, float time,
+       float energy, int has_quality, short quality_flag)
+{
+    if ((f->flags & GLM_FILTER_BOX) &&
+        !(lat >= f->lat_min && lat <= f->lat_max &&
+          lon >= f->lon_min && lon <= f->lon_max))
+        return 0;
+    if ((f->flags & GLM_FILTER_TIME) &&
+        !(time >= f->time_min && time <= f->time_max))
+        return 0;
+    if ((f->flags & GLM_FILTER_ENERGY) && !(energy >= f->energy_min))
+        return 0;
+    if ((f->flags & GLM_FILTER_QUALITY) && has_quality &&
+        quality_flag != f->quality_flag)
+        return 0;
+    return 1;
+}
+
+/* Are two groups the same? The structs have padding, so they can't be
+ * compared with memcmp(). */
+static int
+same_group(const GLM_GROUP_T *a, const GLM_GROUP_T *b)
+{
+    return a->id == b->id && a->time_offset == b->time_offset &&
+        a->lat == b->lat && a->lon == b->lon && a->area == b->area &&
+        a->energy == b->energy && a->parent_flash_id == b->parent_flash_id &&
+        a->quality_flag == b->quality_flag && a->time == b->time;
+}
+
+/* Are two flashes the same? */
+static int
+same_flash(const GLM_FLASH_T *a, const GLM_FLASH_T *b)
+{
+    return a->id == b->id &&
+        a->time_offset_of_first_event == b->time_offset_of_first_event &&
+        a->time_offset_of_last_event == b->time_offset_of_last_event &&
+        a->frame_time_offset_of_first_event == b->frame_time_offset_of_first_event &&
+        a->frame_time_offset_of_last_event == b->frame_time_offset_of_last_event &&
+        a->lat == b->lat && a->lon == b->lon && a->area == b->area &&
+        a->energy == b->energy && a->quality_flag == b->quality_flag &&
+        a->time_of_first_event == b->time_of_first_event &&
+        a->time_of_last_event == b->time_of_last_event;
+}
+
+/* Make the filters to test, around the values of one event. */
+static void
+make_filters(const GLM_EVENT_T *e, GLM_FILTER_T *filter)
+{
+    memset(filter, 0, NUM_FILTERS * sizeof(GLM_FILTER_T));
+
+    /* A box. */
+    filter[0].flags = GLM_FILTER_BOX;
+    filter[0].lat_min = e->lat - 1;
+    filter[0].lat_max = e->lat + 1;
+    filter[0].lon_min = e->lon - 2;
+    filter[0].lon_max = e->lon + 2;
+
+    /* A time window, with bounds on packed values. */
+    filter[1].flags = GLM_FILTER_TIME;
+    filter[1].time_min = e->time_offset;
+    filter[1].time_max = e->time_offset + 5;
+
+    /* Minimum energy, and good quality. */
+    filter[2].flags = GLM_FILTER_ENERGY | GLM_FILTER_QUALITY;
+    filter[2].energy_min = e->energy;
+    filter[2].quality_flag = 0;
+
+    /* Everything at once. */
+    filter[3] = filter[0];
+    filter[3].flags = GLM_FILTER_BOX | GLM_FILTER_TIME | GLM_FILTER_ENERGY;
+    filter[3].time_min = -1;
+    filter[3].time_max = 100;
+    filter[3].energy_min = 0;
+
+    /* A box far from any lightning. */
+    filter[4].flags = GLM_FILTER_BOX;
+    filter[4].lat_min = -89;
+    filter[4].lat_max = -88;
+    filter[4].lon_min = 0;
+    filter[4].lon_max = 1;
+
+    /* A box with min > max. */
+    filter[5].flags = GLM_FILTER_BOX;
+    filter[5].lat_min = 10;
+    filter[5].lat_max = -10;
+    filter[5].lon_min = -180;
+    filter[5].lon_max = 180;
+
+    /* No parts at all. */
+    filter[6].flags = 0;
+}
+
+int
+main()
+{
+    printf("Testing GLM filtered reads.\n");
+    printf("testing filtered event reads...");
+    {
+        GLM_FILE_T *glm;
+        GLM_FILTER_T filter[NUM_FILTERS];
+        GLM_EVENT_T *event, *fevent;
+        float *lat, *energy;
+        size_t nevent, nmatch, n, i;
+        int f;
+
+        if (glm_open(GLM_DATA_FILE, &glm)) ERR;
+        if (glm_inq_dims(glm, &nevent, NULL, NULL)) ERR;
+        if (!(event = malloc(nevent * sizeof(GLM_EVENT_T)))) ERR;
+        if (!(fevent = malloc(nevent * sizeof(GLM_EVENT_T)))) ERR;
+        if (!(lat = malloc(nevent * sizeof(float)))) ERR;
+        if (!(energy = malloc(nevent * sizeof(float)))) ERR;
+        if (glm_get_event_structs(glm, NULL, event)) ERR;
+        make_filters(&event[nevent / 2], filter);
+
+        for (f = 0; f < NUM_FILTERS; f++)
+        {
+            if (glm_read_event_filter(glm, 0, nevent, &filter[f], &nmatch,
+                                      fevent)) ERR;
+            if (glm_read_event_filter_arrays(glm, 0, nevent, &filter[f], &n,
+                                             NULL, NULL, lat, NULL, energy,
+                                             NULL)) ERR;
+            if (n != nmatch) ERR;
+
+            /* The filtered events are the events which pass, in
+             * order. */
+            for (i = 0, n = 0; i < nevent; i++)
+            {
+                if (!passes(&filter[f], event[i].lat, event[i].lon,
+                            event[i].time_offset, event[i].energy, 0, 0))
+                    continue;
+                if (n >= nmatch) ERR;
+                if (memcmp(&fevent[n], &event[i], sizeof(GLM_EVENT_T))) ERR;
+                if (lat[n] != event[i].lat || energy[n] != event[i].energy) ERR;
+                n++;
+            }
+            if (n != nmatch) ERR;
+
+            /* Some filters are chosen to pass some of the events. */
+            if (f < 4 && (!nmatch || nmatch == nevent)) ERR;
+            if ((f == 4 || f == 5) && nmatch) ERR;
+            if (f == 6 && nmatch != nevent) ERR;
+        }
+
+        /* A range of the events. */
+        if (glm_read_event_filter(glm, 1000, 2000, &filter[0], &nmatch,
+                                  fevent)) ERR;
+        for (i = 1000, n = 0; i < 3000; i++)
+            if (passes(&filter[0], event[i].lat, event[i].lon, 0, 0, 0, 0))
+                if (memcmp(&fevent[n++], &event[i], sizeof(GLM_EVENT_T))) ERR;
+        if (n != nmatch) ERR;
+        if (glm_read_event_filter(glm, 0, 0, &filter[0], &nmatch, fevent)) ERR;
+        if (nmatch) ERR;
+        if (glm_read_event_filter(glm, nevent, 1, &filter[0], &nmatch,
+                                  fevent) != GLM_ERR_RANGE) ERR;
+
+        /* On several threads. */
+        if (glm_set_nthreads(glm, 3)) ERR;
+        for (f = 0; f < NUM_FILTERS; f++)
+        {
+            if (glm_read_event_filter(glm, 0, nevent, &filter[f], &nmatch,
+                                      fevent)) ERR;
+            for (i = 0, n = 0; i < nevent; i++)
+                if (passes(&filter[f], event[i].lat, event[i].lon,
+                           event[i].time_offset, event[i].energy, 0, 0))
+                    if (n >= nmatch ||
+                        memcmp(&fevent[n++], &event[i], sizeof(GLM_EVENT_T))) ERR;
+            if (n != nmatch) ERR;
+        }
+
+        free(event);
+        free(fevent);
+        free(lat);
+        free(energy);
+        if (glm_close(glm)) ERR;
+    }
+    SUMMARIZE_ERR;
+    printf("testing filtered group and flash reads...");
+    {
+        GLM_FILE_T *glm;
+        GLM_FILTER_T filter[NUM_FILTERS];
+        GLM_EVENT_T event;
+        GLM_GROUP_T *group, *fgroup;
+        GLM_FLASH_T *flash, *fflash;
+        float *area;
+        size_t ngroup, nflash, nmatch, n, i;
+        int f;
+
+        if (glm_open(GLM_DATA_FILE, &glm)) ERR;
+        if (glm_inq_dims(glm, NULL, &ngroup, &nflash)) ERR;
+        if (!(group = malloc(ngroup * sizeof(GLM_GROUP_T)))) ERR;
+        if (!(fgroup = malloc(ngroup * sizeof(GLM_GROUP_T)))) ERR;
+        if (!(flash = malloc(nflash * sizeof(GLM_FLASH_T)))) ERR;
+        if (!(fflash = malloc(nflash * sizeof(GLM_FLASH_T)))) ERR;
+        if (!(area = malloc(nflash * sizeof(float)))) ERR;
+        if (glm_get_group_structs(glm, NULL, group)) ERR;
+        if (glm_get_flash_structs(glm, NULL, flash)) ERR;
+        if (!group[0].time || !flash[0].time_of_first_event) ERR;
+        if (glm_read_event_range(glm, 2000, 1, &event)) ERR;
+        make_filters(&event, filter);
+
+        for (f = 0; f < NUM_FILTERS; f++)
+        {
+            if (glm_read_group_filter(glm, 0, ngroup, &filter[f], &nmatch,
+                                      fgroup)) ERR;
+            for (i = 0, n = 0; i < ngroup; i++)
+            {
+                if (!passes(&filter[f], group[i].lat, group[i].lon,
+                            group[i].time_offset, group[i].energy, 1,
+                            group[i].quality_flag))
+                    continue;
+                if (n >= nmatch) ERR;
+                if (!same_group(&fgroup[n], &group[i])) ERR;
+                n++;
+            }
+            if (n != nmatch) ERR;
+
+            /* Flash time offsets are whole numbers in GLM_FLASH_T, so
+             * check the flashes with the unpacked time from an array
+             * read. */
+            if (glm_read_flash_filter(glm, 0, nflash, &filter[f], &nmatch,
+                                      fflash)) ERR;
+            if (glm_read_flash_filter_arrays(glm, 0, nflash, &filter[f], &n,
+                                             NULL, NULL, NULL, NULL, NULL,
+                                             NULL, area, NULL, NULL)) ERR;
+            if (n != nmatch) ERR;
+            for (i = 0; i < nmatch; i++)
+                if (area[i] != fflash[i].area) ERR;
+            if (f == 6 && nmatch != nflash) ERR;
+            if ((f == 4 || f == 5) && nmatch) ERR;
+        }
+
+        /* The box filter on flashes. */
+        if (glm_read_flash_filter(glm, 0, nflash, &filter[0], &nmatch,
+                                  fflash)) ERR;
+        for (i = 0, n = 0; i < nflash; i++)
+            if (passes(&filter[0], flash[i].lat, flash[i].lon, 0, 0, 0, 0))
+                if (!same_flash(&fflash[n++], &flash[i])) ERR;
+        if (n != nmatch || !n) ERR;
+
+        /* Only read some fields. */
+        if (glm_set_fields(glm, GLM_EV_ALL, GLM_GR_LAT, GLM_FL_ALL)) ERR;
+        memset(fgroup, 0, ngroup * sizeof(GLM_GROUP_T));
+        if (glm_read_group_filter(glm, 0, ngroup, &filter[0], &nmatch,
+                                  fgroup)) ERR;
+        for (i = 0, n = 0; i < ngroup; i++)
+            if (passes(&filter[0], group[i].lat, group[i].lon, 0, 0, 0, 0))
+            {
+                if (fgroup[n].lat != group[i].lat) ERR;
+                if (fgroup[n].lon || fgroup[n].id) ERR;
+                n++;
+            }
+        if (n != nmatch || !n) ERR;
+
+        free(group);
+        free(fgroup);
+        free(flash);
+        free(fflash);
+        free(area);
+        if (glm_close(glm)) ERR;
+    }
+    SUMMARIZE_ERR;
+    FINAL_RESULTS;
+}
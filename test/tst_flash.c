@@ -51,5 +51,72 @@ main()
             NC_ERR(ret);
     }
    SUMMARIZE_ERR;
+   printf("testing GLM flash array reads match struct reads...");
+    {
+        int ncid;
+        size_t nflash, my_nflash;
+        GLM_FLASH_T *flash;
+        float *first, *last, *frame_first, *frame_last;
+        float *lat, *lon, *area, *energy;
+        short *quality_flag;
+        int i;
+        int ret;
+
+        /* Open the data file as read-only. */
+        if ((ret = nc_open(GLM_DATA_FILE, NC_NOWRITE, &ncid)))
+            NC_ERR(ret);
+        if ((ret = glm_read_dims(ncid, NULL, NULL, &nflash))) ERR;
+
+        /* Allocate storage. */
+        if (!(flash = malloc(nflash * sizeof(GLM_FLASH_T)))) ERR;
+        if (!(first = malloc(nflash * sizeof(float)))) ERR;
+        if (!(last = malloc(nflash * sizeof(float)))) ERR;
+        if (!(frame_first = malloc(nflash * sizeof(float)))) ERR;
+        if (!(frame_last = malloc(nflash * sizeof(float)))) ERR;
+        if (!(lat = malloc(nflash * sizeof(float)))) ERR;
+        if (!(lon = malloc(nflash * sizeof(float)))) ERR;
+        if (!(area = malloc(nflash * sizeof(float)))) ERR;
+        if (!(energy = malloc(nflash * sizeof(float)))) ERR;
+        if (!(quality_flag = malloc(nflash * sizeof(short)))) ERR;
+
+        /* Read data both ways. */
+        if (glm_read_flash_structs(ncid, NULL, flash)) ERR;
+        if (glm_read_flash_arrays(ncid, &my_nflash, first, last, frame_first,
+                                  frame_last, lat, lon, area, energy,
+                                  quality_flag)) ERR;
+        if (my_nflash != nflash) ERR;
+
+        /* Results must be the same. */
+        for (i = 0; i < nflash; i++)
+        {
+            if (flash[i].time_offset_of_first_event != first[i]) ERR;
+            if (flash[i].time_offset_of_last_event != last[i]) ERR;
+            if (flash[i].frame_time_offset_of_first_event != frame_first[i]) ERR;
+            if (flash[i].frame_time_offset_of_last_event != frame_last[i]) ERR;
+            if (flash[i].lat != lat[i]) ERR;
+            if (flash[i].lon != lon[i]) ERR;
+            if (flash[i].area != area[i]) ERR;
+            if (flash[i].energy != energy[i]) ERR;
+            if (flash[i].quality_flag != quality_flag[i]) ERR;
+            if (flash[i].id < 0) ERR;
+        }
+
+        /* Free resources. */
+        free(flash);
+        free(first);
+        free(last);
+        free(frame_first);
+        free(frame_last);
+        free(lat);
+        free(lon);
+        free(area);
+        free(energy);
+        free(quality_flag);
+
+        /* Close the data file. */
+        if ((ret = nc_close(ncid)))
+            NC_ERR(ret);
+    }
+   SUMMARIZE_ERR;
    FINAL_RESULTS;
 }
@@ -56,5 +56,65 @@ main()
             NC_ERR(ret);
     }
    SUMMARIZE_ERR;
+   printf("testing GLM group array reads match struct reads...");
+    {
+        int ncid;
+        size_t ngroup, my_ngroup;
+        GLM_GROUP_T *group;
+        float *time_offset, *lat, *lon, *energy, *area;
+        unsigned int *parent_flash_id;
+        short *quality_flag;
+        int i;
+        int ret;
+
+        /* Open the data file as read-only. */
+        if ((ret = nc_open(GLM_DATA_FILE, NC_NOWRITE, &ncid)))
+            NC_ERR(ret);
+        if ((ret = glm_read_dims(ncid, NULL, &ngroup, NULL))) ERR;
+
+        /* Allocate storage. */
+        if (!(group = malloc(ngroup * sizeof(GLM_GROUP_T)))) ERR;
+        if (!(time_offset = malloc(ngroup * sizeof(float)))) ERR;
+        if (!(lat = malloc(ngroup * sizeof(float)))) ERR;
+        if (!(lon = malloc(ngroup * sizeof(float)))) ERR;
+        if (!(energy = malloc(ngroup * sizeof(float)))) ERR;
+        if (!(area = malloc(ngroup * sizeof(float)))) ERR;
+        if (!(parent_flash_id = malloc(ngroup * sizeof(unsigned int)))) ERR;
+        if (!(quality_flag = malloc(ngroup * sizeof(short)))) ERR;
+
+        /* Read data both ways. */
+        if (glm_read_group_structs(ncid, NULL, group)) ERR;
+        if (glm_read_group_arrays(ncid, &my_ngroup, time_offset, lat, lon,
+                                  energy, area, parent_flash_id,
+                                  quality_flag)) ERR;
+        if (my_ngroup != ngroup) ERR;
+
+        /* Results must be the same. */
+        for (i = 0; i < ngroup; i++)
+        {
+            if (group[i].time_offset != time_offset[i]) ERR;
+            if (group[i].lat != lat[i]) ERR;
+            if (group[i].lon != lon[i]) ERR;
+            if (group[i].energy != energy[i]) ERR;
+            if (group[i].area != area[i]) ERR;
+            if (group[i].parent_flash_id != parent_flash_id[i]) ERR;
+            if (group[i].quality_flag != quality_flag[i]) ERR;
+        }
+
+        /* Free resources. */
+        free(group);
+        free(time_offset);
+        free(lat);
+        free(lon);
+        free(energy);
+        free(area);
+        free(parent_flash_id);
+        free(quality_flag);
+
+        /* Close the data file. */
+        if ((ret = nc_close(ncid)))
+            NC_ERR(ret);
+    }
+   SUMMARIZE_ERR;
    FINAL_RESULTS;
 }
@@ -0,0 +1,420 @@
+/*
+  Program to test the index of how the events, groups, and flashes of
+  GOES-17 Global Lightning Mapper data are related.
+
+  Ed Hartnett
+
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "un_test.h"
+#include "ncglm.h"
+
+/* Err is used to keep track of errors within each set of tests,
+ * total_err is the number of errors in the entire test program, which
+ * generally cosists of several sets of tests. */
+int total_err = 0, err = 0;
+
+/* Number of copies of the test file read into one batch, enough for
+ * the sorts to run in several chunks. */
+#define NCOPY 8
+
+/* First ID of the flashes of the test file when they are relabelled
+ * to wrap past 65535, as the 16-bit flash IDs of a GLM file do. */
+#define WRAP_FLASH_ID 65500
+
+/* Relabel the flashes of a batch with IDs from first on, modulo 65536,
+ * and the groups which refer to them. */
+static int
+wrap_flash_ids(GLM_BATCH_T *b, unsigned int first)
+{
+    size_t f, g;
+
+    for (g = 0; g < b->ngroup; g++)
+    {
+        for (f = 0; f < b->nflash; f++)
+            if (b->group_parent_flash_id[g] == b->flash_id[f])
+                break;
+        if (f == b->nflash) ERR;
+        b->group_parent_flash_id[g] = (first + f) & 0xffff;
+    }
+    for (f = 0; f < b->nflash; f++)
+        b->flash_id[f] = (first + f) & 0xffff;
+
+    return 0;
+}
+
+/* Check that a set of children, sorted by parent, is each child once,
+ * in file order within each parent. */
+static int
+check_children(size_t nparent, const size_t *start, const size_t *order,
+               size_t n, const unsigned int *parent_id,
+               const unsigned int *id, const size_t *parent)
+{
+    unsigned char *seen;
+    size_t p, i;
+
+    if (!(seen = calloc(n ? n : 1, 1))) ERR;
+    if (start[0] != 0) ERR;
+    for (p = 0; p < nparent; p++)
+    {
+        if (start[p + 1] < start[p]) ERR;
+        for (i = start[p]; i < start[p + 1]; i++)
+        {
+            if (parent_id[order[i]] != id[p]) ERR;
+            if (parent[order[i]] != p) ERR;
+            if (i > start[p] && order[i] <= order[i - 1]) ERR;
+            if (seen[order[i]]++) ERR;
+        }
+    }
+
+    /* Those with no parent come last. */
+    for (i = start[nparent]; i < n; i++)
+    {
+        if (parent[order[i]] != GLM_NO_INDEX) ERR;
+        if (seen[order[i]]++) ERR;
+    }
+    for (i = 0; i < n; i++)
+        if (!seen[i]) ERR;
+    free(seen);
+
+    return 0;
+}
+
+/* Check a hierarchy against its batch. */
+static int
+check_hierarchy(const GLM_BATCH_T *b, const GLM_HIERARCHY_T *h)
+{
+    size_t f, g, i, n;
+    const size_t *idx;
+
+    if (h->nevent != b->nevent || h->ngroup != b->ngroup ||
+        h->nflash != b->nflash) ERR;
+    if (check_children(b->ngroup, h->group_event_start, h->group_event,
+                       b->nevent, b->event_parent_group_id, b->group_id,
+                       h->event_group)) ERR;
+    if (check_children(b->nflash, h->flash_group_start, h->flash_group,
+                       b->ngroup, b->group_parent_flash_id, b->flash_id,
+                       h->group_flash)) ERR;
+
+    /* The events of a flash are those of its groups. */
+    for (f = 0; f < b->nflash; f++)
+    {
+        const size_t *group, *event;
+        size_t ngroup, nevent, k = 0;
+
+        if (glm_flash_groups(h, f, &group, &ngroup)) ERR;
+        if (glm_flash_events(h, f, &event, &nevent)) ERR;
+        for (g = 0; g < ngroup; g++)
+        {
+            if (glm_group_events(h, group[g], &idx, &n)) ERR;
+            if (k + n > nevent) ERR;
+            if (memcmp(event + k, idx, n * sizeof(size_t))) ERR;
+            k += n;
+        }
+        if (k != nevent) ERR;
+    }
+
+    /* The maps. */
+    for (g = 0; g < b->ngroup; g++)
+    {
+        if (glm_group_index(h, b->group_id[g], &i)) ERR;
+        if (i != g) ERR;
+    }
+    for (f = 0; f < b->nflash; f++)
+    {
+        if (glm_flash_index(h, b->flash_id[f], &i)) ERR;
+        if (i != f) ERR;
+    }
+
+    /* Out of range. */
+    if (glm_flash_groups(h, b->nflash, &idx, &n) != GLM_ERR_RANGE) ERR;
+    if (glm_flash_events(h, b->nflash, &idx, &n) != GLM_ERR_RANGE) ERR;
+    if (glm_group_events(h, b->ngroup, &idx, &n) != GLM_ERR_RANGE) ERR;
+    if (glm_group_index(h, h->group_id_min - 1, &i) != GLM_ERR_RANGE) ERR;
+    if (glm_flash_index(h, h->flash_id_min + h->flash_id_span, &i) !=
+        GLM_ERR_RANGE) ERR;
+
+    return 0;
+}
+
+int
+main()
+{
+    printf("Testing GLM hierarchy.\n");
+    printf("testing hierarchy of a file...");
+    {
+        GLM_BATCH_T batch;
+        GLM_HIERARCHY_T hier;
+        const char *path = GLM_DATA_FILE;
+        const size_t *event;
+        size_t nevent, f;
+        size_t total = 0;
+
+        if (glm_read_files(&path, 1, 1, &batch)) ERR;
+        if (glm_build_hierarchy(&batch, 1, &hier)) ERR;
+        if (check_hierarchy(&batch, &hier)) ERR;
+
+        /* Every event of the test file is in a flash. */
+        for (f = 0; f < batch.nflash; f++)
+        {
+            if (glm_flash_events(&hier, f, &event, &nevent)) ERR;
+            total += nevent;
+        }
+        if (total != batch.nevent) ERR;
+        if (hier.flash_event_start[batch.nflash] != batch.nevent) ERR;
+        if (glm_free_hierarchy(&hier)) ERR;
+        if (glm_free_hierarchy(&hier)) ERR;
+        if (glm_free_batch(&batch)) ERR;
+    }
+    SUMMARIZE_ERR;
+    printf("testing hierarchy on several threads...");
+    {
+        GLM_BATCH_T batch;
+        GLM_HIERARCHY_T one, hier;
+        const char *paths[NCOPY];
+        int nthreads[3] = {2, 3, 0};
+        int p, t;
+
+        for (p = 0; p < NCOPY; p++)
+            paths[p] = GLM_DATA_FILE;
+        if (glm_read_files(paths, NCOPY, 2, &batch)) ERR;
+        if (glm_build_hierarchy(&batch, 1, &one)) ERR;
+        if (check_hierarchy(&batch, &one)) ERR;
+
+        /* The index does not depend on the number of threads. */
+        for (t = 0; t < 3; t++)
+        {
+            if (glm_build_hierarchy(&batch, nthreads[t], &hier)) ERR;
+            if (memcmp(one.group_event, hier.group_event,
+                       batch.nevent * sizeof(size_t))) ERR;
+            if (memcmp(one.group_event_start, hier.group_event_start,
+                       (batch.ngroup + 1) * sizeof(size_t))) ERR;
+            if (memcmp(one.flash_group, hier.flash_group,
+                       batch.ngroup * sizeof(size_t))) ERR;
+            if (memcmp(one.flash_event, hier.flash_event,
+                       batch.nevent * sizeof(size_t))) ERR;
+            if (memcmp(one.flash_event_start, hier.flash_event_start,
+                       (batch.nflash + 1) * sizeof(size_t))) ERR;
+            if (glm_free_hierarchy(&hier)) ERR;
+        }
+        if (glm_free_hierarchy(&one)) ERR;
+        if (glm_free_batch(&batch)) ERR;
+    }
+    SUMMARIZE_ERR;
+    printf("testing wrapped flash IDs...");
+    {
+        GLM_BATCH_T batch;
+        GLM_HIERARCHY_T one, hier;
+        const char *path = GLM_DATA_FILE;
+        size_t i;
+
+        if (glm_read_files(&path, 1, 1, &batch)) ERR;
+        if (glm_build_hierarchy(&batch, 1, &one)) ERR;
+
+        /* 65500 to 65535, then 0 on. */
+        if (wrap_flash_ids(&batch, WRAP_FLASH_ID)) ERR;
+        if (batch.flash_id[batch.nflash - 1] >= WRAP_FLASH_ID) ERR;
+        if (glm_build_hierarchy(&batch, 2, &hier)) ERR;
+        if (check_hierarchy(&batch, &hier)) ERR;
+        if (hier.flash_id_min != WRAP_FLASH_ID ||
+            hier.flash_id_span != batch.nflash ||
+            hier.flash_id_mask != 0xffff) ERR;
+
+        /* The index is the same as before relabelling. */
+        if (memcmp(one.flash_group, hier.flash_group,
+                   batch.ngroup * sizeof(size_t))) ERR;
+        if (memcmp(one.flash_group_start, hier.flash_group_start,
+                   (batch.nflash + 1) * sizeof(size_t))) ERR;
+        if (memcmp(one.flash_event, hier.flash_event,
+                   batch.nevent * sizeof(size_t))) ERR;
+        if (memcmp(one.group_flash, hier.group_flash,
+                   batch.ngroup * sizeof(size_t))) ERR;
+
+        /* IDs which only match in their low 16 bits are not there. */
+        if (glm_flash_index(&hier, 0, &i) || i != 0xffff - WRAP_FLASH_ID + 1) ERR;
+        if (glm_flash_index(&hier, 0x10000, &i) != GLM_ERR_RANGE) ERR;
+        if (glm_flash_index(&hier, WRAP_FLASH_ID - 1, &i) != GLM_ERR_RANGE) ERR;
+        if (glm_free_hierarchy(&hier)) ERR;
+        if (glm_free_hierarchy(&one)) ERR;
+
+        /* Wrapped IDs too sparse for a table. */
+        batch.flash_id[1] = 30000;
+        if (glm_build_hierarchy(&batch, 1, &hier) != GLM_ERR_RANGE) ERR;
+        if (glm_free_batch(&batch)) ERR;
+    }
+    SUMMARIZE_ERR;
+    printf("testing records with no parent...");
+    {
+        GLM_BATCH_T batch;
+        GLM_HIERARCHY_T hier;
+        unsigned int event_parent[5] = {11, 10, 99, 12, 11};
+        unsigned int group_id[3] = {10, 11, 12};
+        unsigned int group_parent[3] = {6, 5, 77};
+        unsigned int flash_id[2] = {5, 6};
+        size_t group_event[5] = {1, 0, 4, 3, 2};
+        size_t flash_group[3] = {1, 0, 2};
+        size_t flash_event[5] = {0, 4, 1, 3, 2};
+        size_t i;
+
+        memset(&batch, 0, sizeof(batch));
+        batch.nevent = 5;
+        batch.ngroup = 3;
+        batch.nflash = 2;
+        batch.event_parent_group_id = event_parent;
+        batch.group_id = group_id;
+        batch.group_parent_flash_id = group_parent;
+        batch.flash_id = flash_id;
+
+        if (glm_build_hierarchy(&batch, 2, &hier)) ERR;
+        if (check_hierarchy(&batch, &hier)) ERR;
+        if (memcmp(hier.group_event, group_event, sizeof(group_event))) ERR;
+        if (memcmp(hier.flash_group, flash_group, sizeof(flash_group))) ERR;
+        if (memcmp(hier.flash_event, flash_event, sizeof(flash_event))) ERR;
+        if (hier.group_event_start[3] != 4 || hier.flash_group_start[2] != 2 ||
+            hier.flash_event_start[2] != 3) ERR;
+        if (hier.event_group[2] != GLM_NO_INDEX ||
+            hier.group_flash[2] != GLM_NO_INDEX) ERR;
+        if (glm_flash_index(&hier, 77, &i) != GLM_ERR_RANGE) ERR;
+        if (glm_free_hierarchy(&hier)) ERR;
+
+        /* IDs used twice. */
+        group_id[2] = 10;
+        if (glm_build_hierarchy(&batch, 1, &hier) != GLM_ERR_UNEXPECTED) ERR;
+        if (hier.block || hier.nevent) ERR;
+
+        /* IDs too sparse for a table. */
+        group_id[2] = 1000000;
+        if (glm_build_hierarchy(&batch, 1, &hier) != GLM_ERR_RANGE) ERR;
+        if (hier.block || hier.nevent) ERR;
+
+        /* No records. */
+        memset(&batch, 0, sizeof(batch));
+        if (glm_build_hierarchy(&batch, 1, &hier)) ERR;
+        if (check_hierarchy(&batch, &hier)) ERR;
+        if (glm_free_hierarchy(&hier)) ERR;
+    }
+    SUMMARIZE_ERR;
+    printf("testing clustered batches...");
+    {
+        GLM_BATCH_T batch, out;
+        GLM_HIERARCHY_T hier;
+        const char *paths[NCOPY];
+        size_t *event_perm, *group_perm;
+        unsigned char *seen;
+        size_t i;
+        int nthreads[2] = {1, 3};
+        int p, t;
+
+        for (p = 0; p < NCOPY; p++)
+            paths[p] = GLM_DATA_FILE;
+        if (glm_read_files(paths, NCOPY, 2, &batch)) ERR;
+        if (!(event_perm = malloc(batch.nevent * sizeof(size_t)))) ERR;
+        if (!(group_perm = malloc(batch.ngroup * sizeof(size_t)))) ERR;
+
+        for (t = 0; t < 2; t++)
+        {
+            if (glm_cluster_batch(&batch, nthreads[t], &out, event_perm,
+                                  group_perm)) ERR;
+            if (out.nfile != batch.nfile || out.nevent != batch.nevent ||
+                out.ngroup != batch.ngroup || out.nflash != batch.nflash) ERR;
+
+            /* The permutations take each record back to the batch. */
+            if (!(seen = calloc(batch.nevent, 1))) ERR;
+            for (i = 0; i < batch.nevent; i++)
+            {
+                size_t e = event_perm[i];
+
+                if (e >= batch.nevent || seen[e]++) ERR;
+                if (out.event_id[i] != batch.event_id[e] ||
+                    out.event_time_offset[i] != batch.event_time_offset[e] ||
+                    out.event_lat[i] != batch.event_lat[e] ||
+                    out.event_lon[i] != batch.event_lon[e] ||
+                    out.event_energy[i] != batch.event_energy[e] ||
+                    out.event_parent_group_id[i] != batch.event_parent_group_id[e] ||
+                    out.event_file[i] != batch.event_file[e]) ERR;
+            }
+            free(seen);
+            if (!(seen = calloc(batch.ngroup, 1))) ERR;
+            for (i = 0; i < batch.ngroup; i++)
+            {
+                size_t g = group_perm[i];
+
+                if (g >= batch.ngroup || seen[g]++) ERR;
+                if (out.group_id[i] != batch.group_id[g] ||
+                    out.group_time_offset[i] != batch.group_time_offset[g] ||
+                    out.group_lat[i] != batch.group_lat[g] ||
+                    out.group_lon[i] != batch.group_lon[g] ||
+                    out.group_area[i] != batch.group_area[g] ||
+                    out.group_energy[i] != batch.group_energy[g] ||
+                    out.group_parent_flash_id[i] != batch.group_parent_flash_id[g] ||
+                    out.group_quality_flag[i] != batch.group_quality_flag[g] ||
+                    out.group_file[i] != batch.group_file[g]) ERR;
+            }
+            free(seen);
+
+            /* Flashes and scalars are not moved. */
+            if (memcmp(out.flash_id, batch.flash_id,
+                       batch.nflash * sizeof(unsigned int))) ERR;
+            if (memcmp(out.flash_energy, batch.flash_energy,
+                       batch.nflash * sizeof(float))) ERR;
+            if (memcmp(out.flash_file, batch.flash_file,
+                       batch.nflash * sizeof(int))) ERR;
+            if (memcmp(out.scalar, batch.scalar,
+                       batch.nfile * sizeof(GLM_SCALAR_T))) ERR;
+
+            /* In the reordered batch, the records of each flash, and
+             * the events of each group, are runs in order. */
+            if (glm_build_hierarchy(&out, 2, &hier)) ERR;
+            if (check_hierarchy(&out, &hier)) ERR;
+            for (i = 0; i < batch.nevent; i++)
+                if (hier.group_event[i] != i || hier.flash_event[i] != i) ERR;
+            for (i = 0; i < batch.ngroup; i++)
+                if (hier.flash_group[i] != i) ERR;
+            if (glm_free_hierarchy(&hier)) ERR;
+            if (glm_free_batch(&out)) ERR;
+        }
+
+        /* The permutations are optional. */
+        if (glm_cluster_batch(&batch, 0, &out, NULL, NULL)) ERR;
+        if (glm_free_batch(&out)) ERR;
+
+        free(event_perm);
+        free(group_perm);
+        if (glm_free_batch(&batch)) ERR;
+    }
+    SUMMARIZE_ERR;
+    printf("testing clustering with wrapped flash IDs...");
+    {
+        GLM_BATCH_T batch, out;
+        GLM_HIERARCHY_T hier;
+        const char *path = GLM_DATA_FILE;
+        size_t *group_perm;
+        size_t i;
+
+        if (glm_read_files(&path, 1, 1, &batch)) ERR;
+        if (wrap_flash_ids(&batch, WRAP_FLASH_ID)) ERR;
+        if (!(group_perm = malloc(batch.ngroup * sizeof(size_t)))) ERR;
+        if (glm_cluster_batch(&batch, 2, &out, NULL, group_perm)) ERR;
+        for (i = 0; i < batch.ngroup; i++)
+            if (out.group_parent_flash_id[i] !=
+                batch.group_parent_flash_id[group_perm[i]]) ERR;
+
+        /* Each flash is one run of records. */
+        if (glm_build_hierarchy(&out, 1, &hier)) ERR;
+        if (check_hierarchy(&out, &hier)) ERR;
+        if (hier.flash_id_mask != 0xffff) ERR;
+        for (i = 0; i < out.nevent; i++)
+            if (hier.group_event[i] != i || hier.flash_event[i] != i) ERR;
+        for (i = 0; i < out.ngroup; i++)
+            if (hier.flash_group[i] != i) ERR;
+        if (glm_free_hierarchy(&hier)) ERR;
+        if (glm_free_batch(&out)) ERR;
+        free(group_perm);
+        if (glm_free_batch(&batch)) ERR;
+    }
+    SUMMARIZE_ERR;
+    FINAL_RESULTS;
+}
@@ -0,0 +1,183 @@
+/*
+  Program to test the iterators over the events, groups and flashes
+  of a GOES-17 Global Lightning Mapper file.
+
+  Ed Hartnett
+
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "un_test.h"
+#include "ncglm.h"
+
+/* Err is used to keep track of errors within each set of tests,
+ * total_err is the number of errors in the entire test program, which
+ * generally cosists of several sets of tests. */
+int total_err = 0, err = 0;
+
+/* Batch lengths to test. */
+#define NUM_BATCH_LEN 4
+size_t batch_len[NUM_BATCH_LEN] = {1, 100, 1609, 10000};
+
+int
+main()
+{
+    printf("Testing GLM iterators.\n");
+    printf("testing event iterator...");
+    {
+        GLM_FILE_T *glm;
+        GLM_ITER_T *iter;
+        GLM_EVENT_T *event, *batch;
+        size_t nevent, total, count;
+        int b;
+
+        if (glm_open(GLM_DATA_FILE, &glm)) ERR;
+        if (glm_inq_dims(glm, &nevent, NULL, NULL)) ERR;
+        if (!(event = malloc(nevent * sizeof(GLM_EVENT_T)))) ERR;
+        if (glm_get_event_structs(glm, NULL, event)) ERR;
+
+        for (b = 0; b < NUM_BATCH_LEN; b++)
+        {
+            if (!(batch = malloc(batch_len[b] * sizeof(GLM_EVENT_T)))) ERR;
+            if (glm_event_iter_open(glm, batch_len[b], &iter)) ERR;
+            total = 0;
+            do {
+                if (glm_event_iter_next(iter, batch, &count)) ERR;
+                if (count > batch_len[b]) ERR;
+                if (memcmp(batch, event + total, count * sizeof(GLM_EVENT_T))) ERR;
+                total += count;
+            } while (count);
+            if (total != nevent) ERR;
+
+            /* Once at the end, it stays at the end. */
+            if (glm_event_iter_next(iter, batch, &count)) ERR;
+            if (count) ERR;
+            if (glm_iter_close(iter)) ERR;
+            free(batch);
+        }
+
+        /* A batch length of 0 is not allowed. */
+        if (glm_event_iter_open(glm, 0, &iter) != GLM_ERR_RANGE) ERR;
+
+        free(event);
+        if (glm_close(glm)) ERR;
+    }
+    SUMMARIZE_ERR;
+    printf("testing group and flash iterators...");
+    {
+        GLM_FILE_T *glm;
+        GLM_ITER_T *iter;
+        GLM_GROUP_T *group, *gbatch;
+        GLM_FLASH_T *flash, *fbatch;
+        size_t ngroup, nflash, total, count;
+        size_t i;
+
+        if (glm_open(GLM_DATA_FILE, &glm)) ERR;
+        if (glm_inq_dims(glm, NULL, &ngroup, &nflash)) ERR;
+        if (!(group = malloc(ngroup * sizeof(GLM_GROUP_T)))) ERR;
+        if (!(flash = malloc(nflash * sizeof(GLM_FLASH_T)))) ERR;
+        if (!(gbatch = malloc(64 * sizeof(GLM_GROUP_T)))) ERR;
+        if (!(fbatch = malloc(64 * sizeof(GLM_FLASH_T)))) ERR;
+        if (glm_get_group_structs(glm, NULL, group)) ERR;
+        if (glm_get_flash_structs(glm, NULL, flash)) ERR;
+
+        /* Groups. */
+        if (glm_group_iter_open(glm, 64, &iter)) ERR;
+        total = 0;
+        do {
+            if (glm_group_iter_next(iter, gbatch, &count)) ERR;
+            for (i = 0; i < count; i++)
+            {
+                if (gbatch[i].id != group[total + i].id) ERR;
+                if (gbatch[i].lat != group[total + i].lat) ERR;
+                if (gbatch[i].energy != group[total + i].energy) ERR;
+                if (gbatch[i].parent_flash_id != group[total + i].parent_flash_id) ERR;
+            }
+            total += count;
+        } while (count);
+        if (total != ngroup) ERR;
+        if (glm_iter_close(iter)) ERR;
+
+        /* Flashes. */
+        if (glm_flash_iter_open(glm, 64, &iter)) ERR;
+        total = 0;
+        do {
+            if (glm_flash_iter_next(iter, fbatch, &count)) ERR;
+            for (i = 0; i < count; i++)
+            {
+                if (fbatch[i].id != flash[total + i].id) ERR;
+                if (fbatch[i].lon != flash[total + i].lon) ERR;
+                if (fbatch[i].area != flash[total + i].area) ERR;
+            }
+            total += count;
+        } while (count);
+        if (total != nflash) ERR;
+        if (glm_iter_close(iter)) ERR;
+
+        free(group);
+        free(flash);
+        free(gbatch);
+        free(fbatch);
+        if (glm_close(glm)) ERR;
+    }
+    SUMMARIZE_ERR;
+    printf("testing iterator read errors...");
+    {
+        GLM_FILE_T *glm;
+        GLM_ITER_T *iter;
+        GLM_EVENT_T event[2], batch[2];
+        UN_COUNTS_T counts = UN_COUNTS_INIT;
+        size_t count;
+
+        if (glm_set_allocator(un_count_alloc, un_count_free, &counts)) ERR;
+        if (glm_open(GLM_DATA_FILE, &glm)) ERR;
+        if (glm_read_event_range(glm, 0, 2, event)) ERR;
+        if (glm_close(glm)) ERR;
+
+        /* A batch which fails to read is read again by the next
+         * call. Opening the file again gives it no scratch space, so
+         * the first read allocates. */
+        if (glm_open(GLM_DATA_FILE, &glm)) ERR;
+        if (glm_event_iter_open(glm, 2, &iter)) ERR;
+        counts.fail = 0;
+        count = 99;
+        if (glm_event_iter_next(iter, batch, &count) != GLM_ERR_MEMORY) ERR;
+        if (count) ERR;
+        if (glm_event_iter_next(iter, batch, &count)) ERR;
+        if (count != 2) ERR;
+        if (memcmp(batch, event, sizeof(event))) ERR;
+        if (glm_iter_close(iter)) ERR;
+        if (glm_close(glm)) ERR;
+        if (glm_set_allocator(NULL, NULL, NULL)) ERR;
+        if (counts.nalloc != counts.nfree) ERR;
+    }
+    SUMMARIZE_ERR;
+    printf("testing iterator chunk caches...");
+    {
+        GLM_FILE_T *glm;
+        GLM_ITER_T *iter;
+        size_t size, nelems;
+        float preemption;
+        int ncid, varid;
+
+        if (glm_open(GLM_DATA_FILE, &glm)) ERR;
+        if (glm_inq_ncid(glm, &ncid)) ERR;
+        if (nc_inq_varid(ncid, EVENT_ENERGY, &varid)) ERR;
+        if (nc_set_var_chunk_cache(ncid, varid, 1234567, 4133, 0.5)) ERR;
+
+        /* The iterator sizes the cache for one batch... */
+        if (glm_event_iter_open(glm, 10, &iter)) ERR;
+        if (nc_get_var_chunk_cache(ncid, varid, &size, &nelems, &preemption)) ERR;
+        if (size == 1234567) ERR;
+
+        /* ...and puts it back when it is closed. */
+        if (glm_iter_close(iter)) ERR;
+        if (nc_get_var_chunk_cache(ncid, varid, &size, &nelems, &preemption)) ERR;
+        if (size != 1234567 || nelems != 4133 || preemption != 0.5) ERR;
+        if (glm_close(glm)) ERR;
+    }
+    SUMMARIZE_ERR;
+    FINAL_RESULTS;
+}
@@ -0,0 +1,286 @@
+/*
+  Program to test reading packed GOES-17 Global Lightning Mapper data,
+  as the unsigned shorts in the file.
+
+  Ed Hartnett
+
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "un_test.h"
+#include "ncglm.h"
+
+/* Err is used to keep track of errors within each set of tests,
+ * total_err is the number of errors in the entire test program, which
+ * generally cosists of several sets of tests. */
+int total_err = 0, err = 0;
+
+/* Check a packing against the attributes of a variable. */
+static int
+check_packing(int ncid, const char *name, const GLM_PACKING_T *packing)
+{
+    float scale, offset;
+    int varid;
+
+    if (nc_inq_varid(ncid, name, &varid)) ERR;
+    if (nc_get_att_float(ncid, varid, SCALE_FACTOR, &scale)) ERR;
+    if (nc_get_att_float(ncid, varid, ADD_OFFSET, &offset)) ERR;
+    if (packing->scale_factor != scale || packing->add_offset != offset) ERR;
+
+    return 0;
+}
+
+/* Check that packed values unpack to exactly the values read. */
+static int
+check_unpack(const GLM_PACKING_T *packing, const unsigned short *packed,
+             const float *expected, size_t n)
+{
+    unsigned short *copy;
+    float *value;
+
+    /* Nothing to unpack, and nowhere to put it. */
+    if (glm_unpack(packing, NULL, 0, NULL)) ERR;
+
+    if (!(value = malloc((n ? n : 1) * sizeof(float)))) ERR;
+    if (glm_unpack(packing, packed, n, value)) ERR;
+    if (memcmp(value, expected, n * sizeof(float))) ERR;
+
+    /* In place. */
+    copy = (unsigned short *)value;
+    memcpy(copy, packed, n * sizeof(unsigned short));
+    if (glm_unpack(packing, copy, n, value)) ERR;
+    if (memcmp(value, expected, n * sizeof(float))) ERR;
+    free(value);
+
+    return 0;
+}
+
+int
+main()
+{
+    printf("Testing GLM packed reads.\n");
+    printf("testing packed event reads...");
+    {
+        GLM_FILE_T *glm;
+        GLM_EVENT_PACKING_T packing;
+        size_t nevent;
+        int *id, *id2, *parent, *parent2;
+        float *time_offset, *lat, *lon, *energy;
+        unsigned short *ptime_offset, *plat, *plon, *penergy;
+        int nthreads[2] = {1, 3};
+        int ncid, t;
+
+        if (glm_open(GLM_DATA_FILE, &glm)) ERR;
+        if (glm_inq_dims(glm, &nevent, NULL, NULL)) ERR;
+        if (glm_inq_ncid(glm, &ncid)) ERR;
+        if (!(id = malloc(nevent * sizeof(int)))) ERR;
+        if (!(id2 = malloc(nevent * sizeof(int)))) ERR;
+        if (!(parent = malloc(nevent * sizeof(int)))) ERR;
+        if (!(parent2 = malloc(nevent * sizeof(int)))) ERR;
+        if (!(time_offset = malloc(nevent * sizeof(float)))) ERR;
+        if (!(lat = malloc(nevent * sizeof(float)))) ERR;
+        if (!(lon = malloc(nevent * sizeof(float)))) ERR;
+        if (!(energy = malloc(nevent * sizeof(float)))) ERR;
+        if (!(ptime_offset = malloc(nevent * sizeof(unsigned short)))) ERR;
+        if (!(plat = malloc(nevent * sizeof(unsigned short)))) ERR;
+        if (!(plon = malloc(nevent * sizeof(unsigned short)))) ERR;
+        if (!(penergy = malloc(nevent * sizeof(unsigned short)))) ERR;
+        if (glm_read_event_range_arrays(glm, 0, nevent, id, time_offset, lat,
+                                        lon, energy, parent)) ERR;
+
+        for (t = 0; t < 2; t++)
+        {
+            if (glm_set_nthreads(glm, nthreads[t])) ERR;
+            memset(&packing, 0, sizeof(packing));
+            if (glm_read_event_packed(glm, 0, nevent, id2, ptime_offset, plat,
+                                      plon, penergy, parent2, &packing)) ERR;
+
+            /* The packing is that of the attributes, and unpacks to
+             * the values of the other readers. */
+            if (check_packing(ncid, EVENT_TIME_OFFSET, &packing.time_offset)) ERR;
+            if (check_packing(ncid, EVENT_LAT, &packing.lat)) ERR;
+            if (check_packing(ncid, EVENT_LON, &packing.lon)) ERR;
+            if (check_packing(ncid, EVENT_ENERGY, &packing.energy)) ERR;
+            if (memcmp(id, id2, nevent * sizeof(int))) ERR;
+            if (memcmp(parent, parent2, nevent * sizeof(int))) ERR;
+            if (check_unpack(&packing.time_offset, ptime_offset, time_offset,
+                             nevent)) ERR;
+            if (check_unpack(&packing.lat, plat, lat, nevent)) ERR;
+            if (check_unpack(&packing.lon, plon, lon, nevent)) ERR;
+            if (check_unpack(&packing.energy, penergy, energy, nevent)) ERR;
+        }
+
+        /* A range, some columns, and no packing. */
+        if (glm_read_event_packed(glm, 1000, 7, NULL, NULL, plat, NULL, NULL,
+                                  NULL, NULL)) ERR;
+        if (check_unpack(&packing.lat, plat, lat + 1000, 7)) ERR;
+        if (glm_read_event_packed(glm, nevent, 1, NULL, NULL, plat, NULL, NULL,
+                                  NULL, NULL) != GLM_ERR_RANGE) ERR;
+
+        free(id);
+        free(id2);
+        free(parent);
+        free(parent2);
+        free(time_offset);
+        free(lat);
+        free(lon);
+        free(energy);
+        free(ptime_offset);
+        free(plat);
+        free(plon);
+        free(penergy);
+        if (glm_close(glm)) ERR;
+    }
+    SUMMARIZE_ERR;
+    printf("testing packed group reads...");
+    {
+        GLM_FILE_T *glm;
+        GLM_GROUP_PACKING_T packing;
+        size_t ngroup;
+        float *time_offset, *lat, *lon, *energy, *area, *lat2, *lon2;
+        unsigned short *ptime_offset, *penergy, *parea;
+        unsigned int *parent, *parent2;
+        short *quality, *quality2;
+        int ncid;
+
+        if (glm_open(GLM_DATA_FILE, &glm)) ERR;
+        if (glm_inq_dims(glm, NULL, &ngroup, NULL)) ERR;
+        if (glm_inq_ncid(glm, &ncid)) ERR;
+        if (!(time_offset = malloc(ngroup * sizeof(float)))) ERR;
+        if (!(lat = malloc(ngroup * sizeof(float)))) ERR;
+        if (!(lon = malloc(ngroup * sizeof(float)))) ERR;
+        if (!(energy = malloc(ngroup * sizeof(float)))) ERR;
+        if (!(area = malloc(ngroup * sizeof(float)))) ERR;
+        if (!(lat2 = malloc(ngroup * sizeof(float)))) ERR;
+        if (!(lon2 = malloc(ngroup * sizeof(float)))) ERR;
+        if (!(ptime_offset = malloc(ngroup * sizeof(unsigned short)))) ERR;
+        if (!(penergy = malloc(ngroup * sizeof(unsigned short)))) ERR;
+        if (!(parea = malloc(ngroup * sizeof(unsigned short)))) ERR;
+        if (!(parent = malloc(ngroup * sizeof(unsigned int)))) ERR;
+        if (!(parent2 = malloc(ngroup * sizeof(unsigned int)))) ERR;
+        if (!(quality = malloc(ngroup * sizeof(short)))) ERR;
+        if (!(quality2 = malloc(ngroup * sizeof(short)))) ERR;
+
+        if (glm_read_group_range_arrays(glm, 0, ngroup, time_offset, lat, lon,
+                                        energy, area, parent, quality)) ERR;
+        if (glm_read_group_packed(glm, 0, ngroup, ptime_offset, lat2, lon2,
+                                  penergy, parea, parent2, quality2,
+                                  &packing)) ERR;
+        if (check_packing(ncid, GROUP_TIME_OFFSET, &packing.time_offset)) ERR;
+        if (check_packing(ncid, GROUP_AREA, &packing.area)) ERR;
+        if (check_packing(ncid, GROUP_ENERGY, &packing.energy)) ERR;
+        if (memcmp(lat, lat2, ngroup * sizeof(float))) ERR;
+        if (memcmp(lon, lon2, ngroup * sizeof(float))) ERR;
+        if (memcmp(parent, parent2, ngroup * sizeof(unsigned int))) ERR;
+        if (memcmp(quality, quality2, ngroup * sizeof(short))) ERR;
+        if (check_unpack(&packing.time_offset, ptime_offset, time_offset,
+                         ngroup)) ERR;
+        if (check_unpack(&packing.energy, penergy, energy, ngroup)) ERR;
+        if (check_unpack(&packing.area, parea, area, ngroup)) ERR;
+
+        free(time_offset);
+        free(lat);
+        free(lon);
+        free(energy);
+        free(area);
+        free(lat2);
+        free(lon2);
+        free(ptime_offset);
+        free(penergy);
+        free(parea);
+        free(parent);
+        free(parent2);
+        free(quality);
+        free(quality2);
+        if (glm_close(glm)) ERR;
+    }
+    SUMMARIZE_ERR;
+    printf("testing packed flash reads...");
+    {
+        GLM_FILE_T *glm;
+        GLM_FLASH_PACKING_T packing;
+        size_t nflash;
+        float *first, *last, *frame_first, *frame_last, *area, *energy;
+        float *lat, *lon, *lat2, *lon2;
+        unsigned short *pfirst, *plast, *pframe_first, *pframe_last;
+        unsigned short *parea, *penergy;
+        short *quality, *quality2;
+        int ncid;
+
+        if (glm_open(GLM_DATA_FILE, &glm)) ERR;
+        if (glm_inq_dims(glm, NULL, NULL, &nflash)) ERR;
+        if (glm_inq_ncid(glm, &ncid)) ERR;
+        if (!(first = malloc(nflash * sizeof(float)))) ERR;
+        if (!(last = malloc(nflash * sizeof(float)))) ERR;
+        if (!(frame_first = malloc(nflash * sizeof(float)))) ERR;
+        if (!(frame_last = malloc(nflash * sizeof(float)))) ERR;
+        if (!(area = malloc(nflash * sizeof(float)))) ERR;
+        if (!(energy = malloc(nflash * sizeof(float)))) ERR;
+        if (!(lat = malloc(nflash * sizeof(float)))) ERR;
+        if (!(lon = malloc(nflash * sizeof(float)))) ERR;
+        if (!(lat2 = malloc(nflash * sizeof(float)))) ERR;
+        if (!(lon2 = malloc(nflash * sizeof(float)))) ERR;
+        if (!(pfirst = malloc(nflash * sizeof(unsigned short)))) ERR;
+        if (!(plast = malloc(nflash * sizeof(unsigned short)))) ERR;
+        if (!(pframe_first = malloc(nflash * sizeof(unsigned short)))) ERR;
+        if (!(pframe_last = malloc(nflash * sizeof(unsigned short)))) ERR;
+        if (!(parea = malloc(nflash * sizeof(unsigned short)))) ERR;
+        if (!(penergy = malloc(nflash * sizeof(unsigned short)))) ERR;
+        if (!(quality = malloc(nflash * sizeof(short)))) ERR;
+        if (!(quality2 = malloc(nflash * sizeof(short)))) ERR;
+
+        if (glm_read_flash_range_arrays(glm, 0, nflash, first, last,
+                                        frame_first, frame_last, lat, lon,
+                                        area, energy, quality)) ERR;
+        if (glm_read_flash_packed(glm, 0, nflash, pfirst, plast, pframe_first,
+                                  pframe_last, lat2, lon2, parea, penergy,
+                                  quality2, &packing)) ERR;
+        if (check_packing(ncid, FLASH_TIME_OFFSET_OF_FIRST_EVENT,
+                          &packing.time_offset_of_first_event)) ERR;
+        if (check_packing(ncid, FLASH_TIME_OFFSET_OF_LAST_EVENT,
+                          &packing.time_offset_of_last_event)) ERR;
+        if (check_packing(ncid, FLASH_FRAME_TIME_OFFSET_OF_FIRST_EVENT,
+                          &packing.frame_time_offset_of_first_event)) ERR;
+        if (check_packing(ncid, FLASH_FRAME_TIME_OFFSET_OF_LAST_EVENT,
+                          &packing.frame_time_offset_of_last_event)) ERR;
+        if (check_packing(ncid, FLASH_AREA, &packing.area)) ERR;
+        if (check_packing(ncid, FLASH_ENERGY, &packing.energy)) ERR;
+        if (memcmp(lat, lat2, nflash * sizeof(float))) ERR;
+        if (memcmp(lon, lon2, nflash * sizeof(float))) ERR;
+        if (memcmp(quality, quality2, nflash * sizeof(short))) ERR;
+        if (check_unpack(&packing.time_offset_of_first_event, pfirst, first,
+                         nflash)) ERR;
+        if (check_unpack(&packing.time_offset_of_last_event, plast, last,
+                         nflash)) ERR;
+        if (check_unpack(&packing.frame_time_offset_of_first_event,
+                         pframe_first, frame_first, nflash)) ERR;
+        if (check_unpack(&packing.frame_time_offset_of_last_event,
+                         pframe_last, frame_last, nflash)) ERR;
+        if (check_unpack(&packing.area, parea, area, nflash)) ERR;
+        if (check_unpack(&packing.energy, penergy, energy, nflash)) ERR;
+
+        free(first);
+        free(last);
+        free(frame_first);
+        free(frame_last);
+        free(area);
+        free(energy);
+        free(lat);
+        free(lon);
+        free(lat2);
+        free(lon2);
+        free(pfirst);
+        free(plast);
+        free(pframe_first);
+        free(pframe_last);
+        free(parea);
+        free(penergy);
+        free(quality);
+        free(quality2);
+        if (glm_close(glm)) ERR;
+    }
+    SUMMARIZE_ERR;
+    FINAL_RESULTS;
+}
@@ -0,0 +1,119 @@
+/*
+  Program to test peeking at the metadata of GOES-17 Global Lightning
+  Mapper data files.
+
+  Ed Hartnett
+
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "un_test.h"
+#include "ncglm.h"
+
+/* Err is used to keep track of errors within each set of tests,
+ * total_err is the number of errors in the entire test program, which
+ * generally cosists of several sets of tests. */
+int total_err = 0, err = 0;
+
+/* Number of files peeked at in parallel. */
+#define NUM_FILES 8
+
+/* Check info against the scalars and dimensions of a file. */
+static int
+check_info(const GLM_FILE_INFO_T *info, const GLM_SCALAR_T *scalar,
+           size_t nevent, size_t ngroup, size_t nflash)
+{
+    int i;
+
+    if (info->nevent != nevent || info->ngroup != ngroup ||
+        info->nflash != nflash) ERR;
+    if (info->product_time != scalar->product_time) ERR;
+    if (info->event_count != scalar->event_count ||
+        info->group_count != scalar->group_count ||
+        info->flash_count != scalar->flash_count) ERR;
+    for (i = 0; i < EXTRA_DIM_LEN; i++)
+    {
+        if (info->product_time_bounds[i] != scalar->product_time_bounds[i]) ERR;
+        if (info->lat_field_of_view_bounds[i] !=
+            scalar->lat_field_of_view_bounds[i]) ERR;
+        if (info->lon_field_of_view_bounds[i] !=
+            scalar->lon_field_of_view_bounds[i]) ERR;
+    }
+
+    return 0;
+}
+
+int
+main()
+{
+    GLM_SCALAR_T scalar;
+    size_t nevent, ngroup, nflash;
+
+    printf("Testing GLM peek.\n");
+    printf("testing peek at one file...");
+    {
+        GLM_FILE_T *glm;
+        GLM_FILE_INFO_T info;
+
+        /* Read the file the usual way. */
+        if (glm_open(GLM_DATA_FILE, &glm)) ERR;
+        if (glm_inq_dims(glm, &nevent, &ngroup, &nflash)) ERR;
+        if (glm_get_scalars(glm, &scalar)) ERR;
+        if (glm_close(glm)) ERR;
+
+        /* Peek. */
+        memset(&info, 0, sizeof(GLM_FILE_INFO_T));
+        if (glm_peek(GLM_DATA_FILE, &info)) ERR;
+        if (check_info(&info, &scalar, nevent, ngroup, nflash)) ERR;
+        if (info.nevent != 4578 || info.event_count != 4578) ERR;
+        if (info.product_time_bounds[0] > info.product_time_bounds[1]) ERR;
+
+        /* A file which is not there. */
+        if (!glm_peek("no_such_file.nc", &info)) ERR;
+    }
+    SUMMARIZE_ERR;
+    printf("testing peek at many files...");
+    {
+        const char *paths[NUM_FILES];
+        GLM_FILE_INFO_T info[NUM_FILES];
+        int status[NUM_FILES];
+        int nthreads[] = {1, 3, 0};
+        int t, f;
+
+        for (t = 0; t < 3; t++)
+        {
+            for (f = 0; f < NUM_FILES; f++)
+                paths[f] = GLM_DATA_FILE;
+            memset(info, 0, sizeof(info));
+            if (glm_peek_files(paths, NUM_FILES, nthreads[t], info, NULL)) ERR;
+            for (f = 0; f < NUM_FILES; f++)
+                if (check_info(&info[f], &scalar, nevent, ngroup, nflash)) ERR;
+
+            /* With a status array, one bad file does not stop the
+             * others. */
+            paths[2] = "no_such_file.nc";
+            memset(info, 0, sizeof(info));
+            if (glm_peek_files(paths, NUM_FILES, nthreads[t], info, status)) ERR;
+            for (f = 0; f < NUM_FILES; f++)
+            {
+                if (f == 2)
+                {
+                    if (!status[f]) ERR;
+                    continue;
+                }
+                if (status[f]) ERR;
+                if (check_info(&info[f], &scalar, nevent, ngroup, nflash)) ERR;
+            }
+
+            /* Without one, the bad file is an error. */
+            if (!glm_peek_files(paths, NUM_FILES, nthreads[t], info, NULL)) ERR;
+        }
+
+        /* No files. */
+        if (glm_peek_files(NULL, 0, 2, NULL, NULL)) ERR;
+    }
+    SUMMARIZE_ERR;
+    FINAL_RESULTS;
+}
@@ -0,0 +1,140 @@
+/*
+  Program to test the read-ahead pipeline over a sequence of GOES-17
+  Global Lightning Mapper files.
+
+  Ed Hartnett
+
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "un_test.h"
+#include "ncglm.h"
+
+/* Err is used to keep track of errors within each set of tests,
+ * total_err is the number of errors in the entire test program, which
+ * generally cosists of several sets of tests. */
+int total_err = 0, err = 0;
+
+/* Number of times the test file is read. */
+#define NUM_FILES 5
+
+/* Depths to test. */
+#define NUM_DEPTH 4
+int depth[NUM_DEPTH] = {1, 2, 4, 10};
+
+/* Return of the callback when it wants to stop. */
+#define STOP 42
+
+/* What the callback checks against, and counts. */
+typedef struct CHECK
+{
+    GLM_BATCH_T *expected; /* Data of the test file. */
+    int nseen;             /* Number of calls. */
+    int stop_at;           /* Call which returns STOP, or -1. */
+    int nerr;              /* Number of mismatches. */
+} CHECK_T;
+
+/* Callback which checks each batch against the test file. */
+static int
+check_batch(const GLM_BATCH_T *batch, int file, void *arg)
+{
+    CHECK_T *check = arg;
+    GLM_BATCH_T *e = check->expected;
+
+    if (file != check->nseen)
+        check->nerr++;
+    if (batch->nfile != 1 || batch->nevent != e->nevent ||
+        batch->ngroup != e->ngroup || batch->nflash != e->nflash)
+        check->nerr++;
+    else
+    {
+        if (memcmp(batch->event_id, e->event_id, e->nevent * sizeof(unsigned int)) ||
+            memcmp(batch->event_energy, e->event_energy, e->nevent * sizeof(float)) ||
+            memcmp(batch->group_lat, e->group_lat, e->ngroup * sizeof(float)) ||
+            memcmp(batch->group_parent_flash_id, e->group_parent_flash_id,
+                   e->ngroup * sizeof(unsigned int)) ||
+            memcmp(batch->flash_area, e->flash_area, e->nflash * sizeof(float)))
+            check->nerr++;
+    }
+    if (check->nseen++ == check->stop_at)
+        return STOP;
+
+    return 0;
+}
+
+int
+main()
+{
+    printf("Testing GLM read-ahead pipeline.\n");
+    printf("testing pipeline...");
+    {
+        const char *paths[NUM_FILES];
+        GLM_BATCH_T expected;
+        CHECK_T check;
+        int d, f;
+
+        for (f = 0; f < NUM_FILES; f++)
+            paths[f] = GLM_DATA_FILE;
+        if (glm_read_files(paths, 1, 1, &expected)) ERR;
+        check.expected = &expected;
+
+        for (d = 0; d < NUM_DEPTH; d++)
+        {
+            check.nseen = 0;
+            check.stop_at = -1;
+            check.nerr = 0;
+            if (glm_pipeline(paths, NUM_FILES, depth[d], check_batch, &check)) ERR;
+            if (check.nseen != NUM_FILES || check.nerr) ERR;
+        }
+
+        /* No files. */
+        check.nseen = 0;
+        if (glm_pipeline(paths, 0, 2, check_batch, &check)) ERR;
+        if (check.nseen) ERR;
+
+        /* The depth must be at least 1. */
+        if (glm_pipeline(paths, NUM_FILES, 0, check_batch, &check) != GLM_ERR_RANGE) ERR;
+
+        if (glm_free_batch(&expected)) ERR;
+    }
+    SUMMARIZE_ERR;
+    printf("testing stopping pipeline early...");
+    {
+        const char *paths[NUM_FILES];
+        GLM_BATCH_T expected;
+        CHECK_T check;
+        int d, f;
+
+        for (f = 0; f < NUM_FILES; f++)
+            paths[f] = GLM_DATA_FILE;
+        if (glm_read_files(paths, 1, 1, &expected)) ERR;
+        check.expected = &expected;
+
+        /* The callback stops the pipeline. */
+        for (d = 0; d < NUM_DEPTH; d++)
+        {
+            check.nseen = 0;
+            check.stop_at = 1;
+            check.nerr = 0;
+            if (glm_pipeline(paths, NUM_FILES, depth[d], check_batch, &check) != STOP) ERR;
+            if (check.nseen != 2 || check.nerr) ERR;
+        }
+
+        /* A file which can't be read stops the pipeline. */
+        paths[2] = "no_such_file.nc";
+        for (d = 0; d < NUM_DEPTH; d++)
+        {
+            check.nseen = 0;
+            check.stop_at = -1;
+            check.nerr = 0;
+            if (!glm_pipeline(paths, NUM_FILES, depth[d], check_batch, &check)) ERR;
+            if (check.nseen != 2 || check.nerr) ERR;
+        }
+
+        if (glm_free_batch(&expected)) ERR;
+    }
+    SUMMARIZE_ERR;
+    FINAL_RESULTS;
+}
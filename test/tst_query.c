@@ -0,0 +1,203 @@
+/*
+  Program to test time-range queries of directories of GOES-17 Global
+  Lightning Mapper data files.
+
+  Ed Hartnett
+
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "un_test.h"
+#include "ncglm.h"
+
+/* Err is used to keep track of errors within each set of tests,
+ * total_err is the number of errors in the entire test program, which
+ * generally cosists of several sets of tests. */
+int total_err = 0, err = 0;
+
+/* Directory of granules. */
+#define DIR_NAME "tst_query_dir"
+
+/* A copy of the test file, under the name of a granule a day
+ * later. Its product_time_bounds and records are those of the test
+ * file, so no query finds them. */
+#define FAR "OR_GLM-L2-LCFA_G17_s20192702359400_e20192710000000_c20192710000028.nc"
+
+/* The start of the test file, under the name of the granule after
+ * it, as if it were still being downloaded. Its name overlaps windows
+ * around the test file, but it can't be read. */
+#define TRUNCATED "OR_GLM-L2-LCFA_G17_s20192700000000_e20192700000200_c20192700000228.nc"
+
+/* Bytes of the test file in TRUNCATED. */
+#define TRUNCATED_LEN 1000
+
+/* Seconds in a day. */
+#define DAY 86400.0
+
+/* Write the start of the test file into the directory under a name. */
+static int
+write_truncated(const char *name)
+{
+    FILE *in, *out;
+    char buf[TRUNCATED_LEN];
+
+    if (!(in = fopen(GLM_DATA_FILE, "rb"))) ERR;
+    if (fread(buf, 1, sizeof(buf), in) != sizeof(buf)) ERR;
+    fclose(in);
+    if (!(out = fopen(un_dir_path(DIR_NAME, name), "wb"))) ERR;
+    if (fwrite(buf, 1, sizeof(buf), out) != sizeof(buf)) ERR;
+    if (fclose(out)) ERR;
+
+    return 0;
+}
+
+/* Check that the records of a query batch are in the window, in time
+ * order. */
+static int
+check_order(const GLM_BATCH_T *b, double t0, double t1)
+{
+    double t, prev;
+    size_t i;
+
+    for (prev = t0, i = 0; i < b->nevent; prev = t, i++)
+    {
+        t = b->scalar[b->event_file[i]].product_time + b->event_time_offset[i];
+        if (t < prev || t > t1) ERR;
+    }
+    for (prev = t0, i = 0; i < b->ngroup; prev = t, i++)
+    {
+        t = b->scalar[b->group_file[i]].product_time + b->group_time_offset[i];
+        if (t < prev || t > t1) ERR;
+    }
+    for (prev = t0, i = 0; i < b->nflash; prev = t, i++)
+    {
+        t = b->scalar[b->flash_file[i]].product_time +
+            b->flash_time_offset_of_first_event[i];
+        if (t < prev || t > t1) ERR;
+    }
+
+    return 0;
+}
+
+int
+main()
+{
+    GLM_BATCH_T all;
+    const char *path = GLM_DATA_FILE;
+    double p0, p1;
+
+    printf("Testing GLM time queries.\n");
+    printf("testing query of a directory...");
+    {
+        GLM_BATCH_T batch;
+        int nthreads[] = {1, 3, 0};
+        int t;
+
+        if (glm_read_files(&path, 1, 1, &all)) ERR;
+        p0 = all.scalar[0].product_time_bounds[0];
+        p1 = all.scalar[0].product_time_bounds[1];
+
+        mkdir(DIR_NAME, 0755);
+        if (un_copy_data_file(DIR_NAME, GLM_DATA_FILE) ||
+            un_copy_data_file(DIR_NAME, FAR)) ERR;
+
+        /* A granule which can't be read is skipped. */
+        if (write_truncated(TRUNCATED)) ERR;
+
+        for (t = 0; t < 3; t++)
+        {
+            size_t i, j;
+
+            /* A window around the test file reads only it, and keeps
+             * all its records. */
+            if (glm_query_time(DIR_NAME, p0 - 5, p1 + 5, nthreads[t], &batch)) ERR;
+            if (batch.nfile != 1 || batch.nevent != all.nevent ||
+                batch.ngroup != all.ngroup || batch.nflash != all.nflash) ERR;
+            if (batch.scalar[0].product_time != all.scalar[0].product_time) ERR;
+            if (check_order(&batch, p0 - 5, p1 + 5)) ERR;
+
+            /* Each event is an event of the file. */
+            for (i = 0; i < batch.nevent; i++)
+            {
+                for (j = 0; j < all.nevent; j++)
+                    if (all.event_id[j] == batch.event_id[i])
+                        break;
+                if (j == all.nevent) ERR;
+                if (all.event_lat[j] != batch.event_lat[i] ||
+                    all.event_energy[j] != batch.event_energy[i] ||
+                    all.event_parent_group_id[j] != batch.event_parent_group_id[i]) ERR;
+            }
+            if (glm_free_batch(&batch)) ERR;
+        }
+    }
+    SUMMARIZE_ERR;
+    printf("testing query of part of a granule...");
+    {
+        GLM_BATCH_T batch;
+        double t0 = p0 + 5, t1 = p0 + 12;
+        size_t nevent = 0, ngroup = 0, nflash = 0, i;
+        double t;
+
+        for (i = 0; i < all.nevent; i++)
+        {
+            t = all.scalar[0].product_time + all.event_time_offset[i];
+            if (t >= t0 && t <= t1)
+                nevent++;
+        }
+        for (i = 0; i < all.ngroup; i++)
+        {
+            t = all.scalar[0].product_time + all.group_time_offset[i];
+            if (t >= t0 && t <= t1)
+                ngroup++;
+        }
+        for (i = 0; i < all.nflash; i++)
+        {
+            t = all.scalar[0].product_time + all.flash_time_offset_of_first_event[i];
+            if (t >= t0 && t <= t1)
+                nflash++;
+        }
+        if (!nevent || nevent == all.nevent) ERR;
+
+        if (glm_query_time(DIR_NAME, t0, t1, 2, &batch)) ERR;
+        if (batch.nevent != nevent || batch.ngroup != ngroup ||
+            batch.nflash != nflash) ERR;
+        if (check_order(&batch, t0, t1)) ERR;
+        if (glm_free_batch(&batch)) ERR;
+
+        /* The granule named a day later is picked by its name, but
+         * its product_time_bounds are not in the window, so it is not
+         * read. */
+        if (glm_query_time(DIR_NAME, p0 + DAY, p1 + DAY, 2, &batch)) ERR;
+        if (batch.nfile || batch.nevent || batch.ngroup ||
+            batch.nflash) ERR;
+        if (glm_free_batch(&batch)) ERR;
+
+        /* No granules in the window. */
+        if (glm_query_time(DIR_NAME, p0 - DAY, p1 - DAY, 2, &batch)) ERR;
+        if (batch.nfile || batch.nevent || batch.ngroup || batch.nflash) ERR;
+        if (glm_free_batch(&batch)) ERR;
+    }
+    SUMMARIZE_ERR;
+    printf("testing query of bad directories...");
+    {
+        GLM_BATCH_T batch;
+
+        if (glm_query_time("no_such_dir", p0, p1, 2, &batch) != GLM_ERR_IO) ERR;
+        if (batch.nfile || batch.nevent) ERR;
+
+        unlink(un_dir_path(DIR_NAME, GLM_DATA_FILE));
+        unlink(un_dir_path(DIR_NAME, FAR));
+        unlink(un_dir_path(DIR_NAME, TRUNCATED));
+        if (glm_query_time(DIR_NAME, p0, p1, 2, &batch)) ERR;
+        if (batch.nfile || batch.nevent) ERR;
+        if (glm_free_batch(&batch)) ERR;
+        rmdir(DIR_NAME);
+        if (glm_free_batch(&all)) ERR;
+    }
+    SUMMARIZE_ERR;
+    FINAL_RESULTS;
+}
@@ -0,0 +1,227 @@
+/*
+  Program to test the reader context of the ncglm library, with
+  GOES-17 Global Lightning Mapper data.
+
+  Ed Hartnett
+
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "un_test.h"
+#include "ncglm.h"
+
+/* Err is used to keep track of errors within each set of tests,
+ * total_err is the number of errors in the entire test program, which
+ * generally cosists of several sets of tests. */
+int total_err = 0, err = 0;
+
+/* Expected sizes of the test file. */
+#define NUM_EVENT 4578
+#define NUM_GROUP 1609
+#define NUM_FLASH 123
+
+/* Number of times the file is read to show the steady state. */
+#define NUM_REREAD 5
+
+/* Read everything of the file open in a reader, and check it. */
+static int
+read_all(GLM_READER_T *reader)
+{
+    const GLM_EVENT_T *event;
+    const GLM_GROUP_T *group;
+    const GLM_FLASH_T *flash;
+    const GLM_SCALAR_T *scalar;
+    const GLM_BATCH_T *batch;
+    size_t nevent, ngroup, nflash;
+
+    if (glm_reader_events(reader, &nevent, &event)) ERR;
+    if (nevent != NUM_EVENT || event[1].id != event[0].id + 1) ERR;
+    if (glm_reader_groups(reader, &ngroup, &group)) ERR;
+    if (ngroup != NUM_GROUP) ERR;
+    if (glm_reader_flashes(reader, &nflash, &flash)) ERR;
+    if (nflash != NUM_FLASH) ERR;
+    if (glm_reader_scalars(reader, &scalar)) ERR;
+    if (scalar->event_count != NUM_EVENT) ERR;
+    if (glm_reader_batch(reader, &batch)) ERR;
+    if (batch->nevent != NUM_EVENT || batch->ngroup != NUM_GROUP ||
+        batch->nflash != NUM_FLASH || batch->nfile != 1) ERR;
+    if (batch->event_id[NUM_EVENT - 1] != event[NUM_EVENT - 1].id) ERR;
+    if (batch->group_lat[7] != group[7].lat) ERR;
+    if (batch->flash_energy[NUM_FLASH - 1] != flash[NUM_FLASH - 1].energy) ERR;
+    if (batch->scalar->flash_count != NUM_FLASH) ERR;
+
+    return 0;
+}
+
+int
+main()
+{
+    UN_COUNTS_T counts = UN_COUNTS_INIT;
+
+    printf("Testing GLM reader context.\n");
+    printf("testing a reader reads what glm_open() does...");
+    {
+        GLM_READER_T *reader;
+        GLM_FILE_T *glm, *rglm;
+        GLM_EVENT_T *event;
+        GLM_GROUP_T *group;
+        GLM_FLASH_T *flash;
+        GLM_SCALAR_T scalar;
+        const GLM_EVENT_T *revent;
+        const GLM_GROUP_T *rgroup;
+        const GLM_FLASH_T *rflash;
+        const GLM_SCALAR_T *rscalar;
+        const GLM_BATCH_T *batch;
+        size_t nevent, ngroup, nflash, n;
+        size_t i;
+
+        /* Read the file the usual way. */
+        if (glm_open(GLM_DATA_FILE, &glm)) ERR;
+        if (glm_inq_dims(glm, &nevent, &ngroup, &nflash)) ERR;
+        if (!(event = malloc(nevent * sizeof(GLM_EVENT_T)))) ERR;
+        if (!(group = malloc(ngroup * sizeof(GLM_GROUP_T)))) ERR;
+        if (!(flash = malloc(nflash * sizeof(GLM_FLASH_T)))) ERR;
+        if (glm_get_event_structs(glm, NULL, event)) ERR;
+        if (glm_get_group_structs(glm, NULL, group)) ERR;
+        if (glm_get_flash_structs(glm, NULL, flash)) ERR;
+        if (glm_get_scalars(glm, &scalar)) ERR;
+        if (glm_close(glm)) ERR;
+
+        /* Read it with a reader. */
+        if (glm_reader_create(&reader)) ERR;
+        if (glm_reader_open(reader, GLM_DATA_FILE)) ERR;
+        if (glm_reader_file(reader, &rglm)) ERR;
+        if (glm_inq_dims(rglm, &n, NULL, NULL)) ERR;
+        if (n != nevent) ERR;
+        if (glm_reader_events(reader, &n, &revent)) ERR;
+        if (n != nevent || memcmp(revent, event, nevent * sizeof(GLM_EVENT_T))) ERR;
+        if (glm_reader_groups(reader, &n, &rgroup)) ERR;
+        if (n != ngroup) ERR;
+        for (i = 0; i < ngroup; i++)
+            if (rgroup[i].id != group[i].id || rgroup[i].lat != group[i].lat ||
+                rgroup[i].energy != group[i].energy ||
+                rgroup[i].quality_flag != group[i].quality_flag) ERR;
+        if (glm_reader_flashes(reader, &n, &rflash)) ERR;
+        if (n != nflash) ERR;
+        for (i = 0; i < nflash; i++)
+            if (rflash[i].id != flash[i].id || rflash[i].lon != flash[i].lon ||
+                rflash[i].area != flash[i].area) ERR;
+        if (glm_reader_scalars(reader, &rscalar)) ERR;
+        if (memcmp(rscalar, &scalar, sizeof(GLM_SCALAR_T))) ERR;
+        if (glm_reader_batch(reader, &batch)) ERR;
+        if (batch->nevent != nevent || batch->event_file[nevent - 1]) ERR;
+        for (i = 0; i < nevent; i++)
+            if (batch->event_lat[i] != event[i].lat ||
+                batch->event_parent_group_id[i] != event[i].parent_group_id) ERR;
+        if (glm_reader_free(reader)) ERR;
+
+        free(event);
+        free(group);
+        free(flash);
+    }
+    SUMMARIZE_ERR;
+    printf("testing steady state reads do not allocate...");
+    {
+        GLM_READER_T *reader;
+        GLM_FILE_T *glm;
+        size_t nalloc;
+        int r;
+
+        if (glm_set_allocator(un_count_alloc, un_count_free, &counts)) ERR;
+        if (glm_reader_create(&reader)) ERR;
+
+        /* The first file grows the buffers. */
+        if (glm_reader_open(reader, GLM_DATA_FILE)) ERR;
+        if (read_all(reader)) ERR;
+        nalloc = counts.nalloc;
+        if (!nalloc) ERR;
+
+        /* After that, nothing is allocated. */
+        for (r = 0; r < NUM_REREAD; r++)
+        {
+            if (glm_reader_open(reader, GLM_DATA_FILE)) ERR;
+            if (read_all(reader)) ERR;
+            if (glm_reader_close(reader)) ERR;
+        }
+        if (counts.nalloc != nalloc) ERR;
+
+        /* Not with several threads either, once the scratch buffer
+         * has grown to hold all the columns of a read. The number of
+         * threads is kept from file to file. */
+        if (glm_reader_open(reader, GLM_DATA_FILE)) ERR;
+        if (glm_reader_file(reader, &glm)) ERR;
+        if (glm_set_nthreads(glm, 3)) ERR;
+        if (read_all(reader)) ERR;
+        nalloc = counts.nalloc;
+        for (r = 0; r < NUM_REREAD; r++)
+        {
+            if (glm_reader_open(reader, GLM_DATA_FILE)) ERR;
+            if (read_all(reader)) ERR;
+        }
+        if (counts.nalloc != nalloc) ERR;
+
+        if (glm_reader_free(reader)) ERR;
+        if (counts.nalloc != counts.nfree) ERR;
+    }
+    SUMMARIZE_ERR;
+    printf("testing fields are kept from file to file...");
+    {
+        GLM_READER_T *reader;
+        GLM_FILE_T *glm;
+        const GLM_FLASH_T *flash;
+        size_t nflash;
+        float area;
+
+        if (glm_reader_create(&reader)) ERR;
+        if (glm_reader_open(reader, GLM_DATA_FILE)) ERR;
+        if (glm_reader_flashes(reader, &nflash, &flash)) ERR;
+        area = flash[0].area;
+        if (glm_reader_file(reader, &glm)) ERR;
+        if (glm_set_fields(glm, GLM_EV_ALL, GLM_GR_ALL, GLM_FL_ID)) ERR;
+
+        /* Fields which are not read are left as they were. */
+        if (glm_reader_open(reader, GLM_DATA_FILE)) ERR;
+        if (glm_reader_file(reader, &glm)) ERR;
+        ((GLM_FLASH_T *)flash)[0].area = -1.0;
+        if (glm_reader_flashes(reader, &nflash, &flash)) ERR;
+        if (nflash != NUM_FLASH || flash[0].area != -1.0) ERR;
+        if (glm_set_fields(glm, GLM_EV_ALL, GLM_GR_ALL, GLM_FL_ALL)) ERR;
+        if (glm_reader_flashes(reader, &nflash, &flash)) ERR;
+        if (flash[0].area != area) ERR;
+        if (glm_reader_free(reader)) ERR;
+        if (counts.nalloc != counts.nfree) ERR;
+    }
+    SUMMARIZE_ERR;
+    printf("testing errors...");
+    {
+        GLM_READER_T *reader;
+        GLM_FILE_T *glm;
+        const GLM_EVENT_T *event;
+        const GLM_BATCH_T *batch;
+        size_t nevent;
+
+        if (glm_reader_create(&reader)) ERR;
+
+        /* Nothing can be read until a file is open. */
+        if (glm_reader_file(reader, &glm) != GLM_ERR_UNEXPECTED) ERR;
+        if (glm_reader_events(reader, &nevent, &event) != GLM_ERR_UNEXPECTED) ERR;
+        if (glm_reader_batch(reader, &batch) != GLM_ERR_UNEXPECTED) ERR;
+        if (glm_reader_close(reader)) ERR;
+
+        /* A file which is not there leaves the reader closed. */
+        if (glm_reader_open(reader, GLM_DATA_FILE)) ERR;
+        if (!glm_reader_open(reader, "no_such_file.nc")) ERR;
+        if (glm_reader_events(reader, &nevent, &event) != GLM_ERR_UNEXPECTED) ERR;
+
+        /* And it can open another. */
+        if (glm_reader_open(reader, GLM_DATA_FILE)) ERR;
+        if (read_all(reader)) ERR;
+        if (glm_reader_free(reader)) ERR;
+        if (counts.nalloc != counts.nfree) ERR;
+        if (glm_set_allocator(NULL, NULL, NULL)) ERR;
+    }
+    SUMMARIZE_ERR;
+    FINAL_RESULTS;
+}
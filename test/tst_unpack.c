@@ -0,0 +1,369 @@
+/*
+  Program to test the unpacking kernels of the ncglm library. Each
+  SIMD level the CPU supports must give results bit-identical to the
+  scalar code, for every possible packed value.
+
+  Ed Hartnett
+
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "un_test.h"
+#include "glm_internal.h"
+
+/* Err is used to keep track of errors within each set of tests,
+ * total_err is the number of errors in the entire test program, which
+ * generally cosists of several sets of tests. */
+int total_err = 0, err = 0;
+
+/* Number of possible unsigned short values. */
+#define NVAL 65536
+
+/* Scale factors and offsets to test. The first few are from the
+ * event_lat, event_lon, event_energy, and event_time_offset vars of
+ * the test file. */
+#define NPACK 5
+float test_scale[NPACK] = {0.00203128f, 0.00203128f, 1.9024e-17f,
+                           3.8147e-07f, 1.0f};
+float test_offset[NPACK] = {-66.56f, -141.56f, 2.8515e-16f, -0.5f, 0.0f};
+
+/* A struct like GLM_EVENT_T, to test output with a stride. */
+typedef struct
+{
+    int id;
+    float value;
+    unsigned int uvalue;
+    short flag;
+} TST_T;
+
+/* A struct like GLM_EVENT_T, to test time output with a stride. */
+typedef struct
+{
+    float value;
+    short flag;
+    int64_t time;
+} TST_NS_T;
+
+/* A product_time, in ns since the Unix epoch, for time decoding. */
+#define TEST_BASE 1569542380000000000LL
+
+int
+main()
+{
+    unsigned short *src;
+    int max_level;
+    int i;
+
+    printf("Testing GLM unpacking kernels.\n");
+
+    /* Every possible packed value. */
+    if (!(src = malloc(NVAL * sizeof(unsigned short)))) ERR;
+    for (i = 0; i < NVAL; i++)
+        src[i] = i;
+
+    /* What is the best level on this CPU? */
+    if (glm_unpack_set_level(-1)) ERR;
+    max_level = glm_unpack_level();
+    printf("best kernel level is %d\n", max_level);
+
+    printf("testing array unpacking at each level...");
+    {
+        float *expected, *data;
+        unsigned int *uexpected, *udata;
+        int level, p;
+
+        if (!(expected = malloc(NVAL * sizeof(float)))) ERR;
+        if (!(data = malloc(NVAL * sizeof(float)))) ERR;
+        if (!(uexpected = malloc(NVAL * sizeof(unsigned int)))) ERR;
+        if (!(udata = malloc(NVAL * sizeof(unsigned int)))) ERR;
+
+        for (p = 0; p < NPACK; p++)
+        {
+            /* Get the expected values from the scalar code. */
+            if (glm_unpack_set_level(GLM_SIMD_SCALAR)) ERR;
+            glm_unpack_ushort(src, NVAL, test_scale[p], test_offset[p],
+                              expected, sizeof(float));
+            glm_widen_ushort(src, NVAL, uexpected, sizeof(unsigned int));
+            for (i = 0; i < NVAL; i++)
+                if (uexpected[i] != i) ERR;
+
+            for (level = GLM_SIMD_SSE2; level <= max_level; level++)
+            {
+                int n;
+
+                if (glm_unpack_set_level(level)) ERR;
+
+                /* All values. */
+                glm_unpack_ushort(src, NVAL, test_scale[p], test_offset[p],
+                                  data, sizeof(float));
+                if (memcmp(data, expected, NVAL * sizeof(float))) ERR;
+                glm_widen_ushort(src, NVAL, udata, sizeof(unsigned int));
+                if (memcmp(udata, uexpected, NVAL * sizeof(unsigned int))) ERR;
+
+                /* Lengths which leave a remainder, at an unaligned
+                 * start. */
+                for (n = 0; n < 40; n++)
+                {
+                    memset(data, 0, (n + 1) * sizeof(float));
+                    glm_unpack_ushort(src + 1, n, test_scale[p], test_offset[p],
+                                      data, sizeof(float));
+                    if (memcmp(data, expected + 1, n * sizeof(float))) ERR;
+                    if (data[n] != 0) ERR;
+                }
+            }
+        }
+        free(expected);
+        free(data);
+        free(uexpected);
+        free(udata);
+    }
+    SUMMARIZE_ERR;
+    printf("testing in-place unpacking at each level...");
+    {
+        float *expected, *data;
+        unsigned int *udata;
+        int level, n;
+
+        if (!(expected = malloc(NVAL * sizeof(float)))) ERR;
+        if (!(data = malloc(NVAL * sizeof(float)))) ERR;
+        if (!(udata = malloc(NVAL * sizeof(unsigned int)))) ERR;
+
+        if (glm_unpack_set_level(GLM_SIMD_SCALAR)) ERR;
+        glm_unpack_ushort(src, NVAL, test_scale[0], test_offset[0],
+                          expected, sizeof(float));
+
+        for (level = GLM_SIMD_SCALAR; level <= max_level; level++)
+        {
+            if (glm_unpack_set_level(level)) ERR;
+
+            /* Put the packed values at the end of the output array,
+             * as glm_read_columns() does. */
+            for (n = 1; n <= NVAL; n = n * 3 + 1)
+            {
+                unsigned short *tail = (unsigned short *)(data + n) - n;
+
+                memcpy(tail, src, n * sizeof(unsigned short));
+                glm_unpack_ushort(tail, n, test_scale[0], test_offset[0],
+                                  data, sizeof(float));
+                if (memcmp(data, expected, n * sizeof(float))) ERR;
+
+                tail = (unsigned short *)(udata + n) - n;
+                memcpy(tail, src, n * sizeof(unsigned short));
+                glm_widen_ushort(tail, n, udata, sizeof(unsigned int));
+                for (i = 0; i < n; i++)
+                    if (udata[i] != i) ERR;
+            }
+        }
+        free(expected);
+        free(data);
+        free(udata);
+    }
+    SUMMARIZE_ERR;
+    printf("testing struct unpacking at each level...");
+    {
+        float *expected;
+        TST_T *tst;
+        short *flag;
+        int *id;
+        int level;
+
+        if (!(expected = malloc(NVAL * sizeof(float)))) ERR;
+        if (!(tst = malloc(NVAL * sizeof(TST_T)))) ERR;
+        if (!(flag = malloc(NVAL * sizeof(short)))) ERR;
+        if (!(id = malloc(NVAL * sizeof(int)))) ERR;
+        for (i = 0; i < NVAL; i++)
+        {
+            flag[i] = i - 32768;
+            id[i] = i * 7;
+        }
+
+        if (glm_unpack_set_level(GLM_SIMD_SCALAR)) ERR;
+        glm_unpack_ushort(src, NVAL, test_scale[1], test_offset[1],
+                          expected, sizeof(float));
+
+        for (level = GLM_SIMD_SCALAR; level <= max_level; level++)
+        {
+            if (glm_unpack_set_level(level)) ERR;
+            memset(tst, 0, NVAL * sizeof(TST_T));
+            glm_copy_4(id, NVAL, &tst->id, sizeof(TST_T));
+            glm_unpack_ushort(src, NVAL, test_scale[1], test_offset[1],
+                              &tst->value, sizeof(TST_T));
+            glm_widen_ushort(src, NVAL, &tst->uvalue, sizeof(TST_T));
+            glm_copy_2(flag, NVAL, &tst->flag, sizeof(TST_T));
+            for (i = 0; i < NVAL; i++)
+            {
+                if (tst[i].id != id[i]) ERR;
+                if (memcmp(&tst[i].value, &expected[i], sizeof(float))) ERR;
+                if (tst[i].uvalue != i) ERR;
+                if (tst[i].flag != flag[i]) ERR;
+            }
+        }
+        free(expected);
+        free(tst);
+        free(flag);
+        free(id);
+    }
+    SUMMARIZE_ERR;
+    printf("testing time decoding at each level...");
+    {
+        int64_t *expected, *data;
+        TST_NS_T *tst;
+        int level, p, n;
+
+        if (!(expected = malloc(NVAL * sizeof(int64_t)))) ERR;
+        if (!(data = malloc(NVAL * sizeof(int64_t)))) ERR;
+        if (!(tst = malloc(NVAL * sizeof(TST_NS_T)))) ERR;
+
+        for (p = 0; p < NPACK; p++)
+        {
+            /* The scalar code is within a rounding of the exact
+             * time. */
+            if (glm_unpack_set_level(GLM_SIMD_SCALAR)) ERR;
+            glm_unpack_ushort_ns(src, NVAL, test_scale[p], test_offset[p],
+                                 TEST_BASE, expected, sizeof(int64_t));
+            for (i = 0; i < NVAL; i++)
+            {
+                long double exact = ((long double)i * test_scale[p] +
+                                     test_offset[p]) * 1e9L;
+                long double diff = (long double)(expected[i] - TEST_BASE) - exact;
+
+                if (diff > 0.5000001L || diff < -0.5000001L) ERR;
+            }
+
+            for (level = GLM_SIMD_SCALAR; level <= max_level; level++)
+            {
+                if (glm_unpack_set_level(level)) ERR;
+
+                /* All values, and lengths which leave a remainder. */
+                glm_unpack_ushort_ns(src, NVAL, test_scale[p], test_offset[p],
+                                     TEST_BASE, data, sizeof(int64_t));
+                if (memcmp(data, expected, NVAL * sizeof(int64_t))) ERR;
+                for (n = 0; n < 40; n++)
+                {
+                    memset(data, 0, (n + 1) * sizeof(int64_t));
+                    glm_unpack_ushort_ns(src + 1, n, test_scale[p],
+                                         test_offset[p], TEST_BASE, data,
+                                         sizeof(int64_t));
+                    if (memcmp(data, expected + 1, n * sizeof(int64_t))) ERR;
+                    if (data[n] != 0) ERR;
+                }
+
+                /* In place, from the end of the output array. */
+                for (n = 1; n <= NVAL; n = n * 3 + 1)
+                {
+                    unsigned short *tail = (unsigned short *)(data + n) - n;
+
+                    memcpy(tail, src, n * sizeof(unsigned short));
+                    glm_unpack_ushort_ns(tail, n, test_scale[p], test_offset[p],
+                                         TEST_BASE, data, sizeof(int64_t));
+                    if (memcmp(data, expected, n * sizeof(int64_t))) ERR;
+                }
+
+                /* Into an array of struct. */
+                memset(tst, 0, NVAL * sizeof(TST_NS_T));
+                glm_unpack_ushort_ns(src, NVAL, test_scale[p], test_offset[p],
+                                     TEST_BASE, &tst->time, sizeof(TST_NS_T));
+                for (i = 0; i < NVAL; i++)
+                    if (tst[i].time != expected[i] || tst[i].flag) ERR;
+            }
+        }
+        free(expected);
+        free(data);
+        free(tst);
+    }
+    SUMMARIZE_ERR;
+    printf("testing packed ranges are exact...");
+    {
+        float *value;
+        float min[4], max[4];
+        unsigned short lo, span;
+        int p, r;
+
+        if (!(value = malloc(NVAL * sizeof(float)))) ERR;
+        if (glm_unpack_set_level(GLM_SIMD_SCALAR)) ERR;
+        for (p = 0; p < NPACK; p++)
+        {
+            glm_unpack_ushort(src, NVAL, test_scale[p], test_offset[p],
+                              value, sizeof(float));
+
+            /* Ranges ending on, between, and outside packed values. */
+            min[0] = value[1000];
+            max[0] = value[2000];
+            min[1] = (value[1000] + value[1001]) / 2;
+            max[1] = (value[50000] + value[50001]) / 2;
+            min[2] = value[NVAL - 1] * 2 + 1;
+            max[2] = min[2] + 1;
+            min[3] = -1e30f;
+            max[3] = 1e30f;
+            for (r = 0; r < 4; r++)
+            {
+                int nonempty = glm_ushort_range(test_scale[p], test_offset[p],
+                                                min[r], max[r], &lo, &span);
+                int n = 0;
+
+                for (i = 0; i < NVAL; i++)
+                {
+                    int in = value[i] >= min[r] && value[i] <= max[r];
+
+                    if (in != (nonempty && (unsigned short)(i - lo) <= span)) ERR;
+                    n += in;
+                }
+                if (nonempty != (n > 0)) ERR;
+            }
+        }
+        free(value);
+    }
+    SUMMARIZE_ERR;
+    printf("testing matching at each level...");
+    {
+        unsigned char *expected, *match;
+        unsigned short lo[4] = {0, 1000, 65000, 65535};
+        unsigned short span[4] = {65535, 20000, 1000, 0};
+        int level, r, n;
+
+        if (!(expected = malloc(NVAL))) ERR;
+        if (!(match = malloc(NVAL))) ERR;
+
+        for (r = 0; r < 4; r++)
+        {
+            /* Start with every other flag set. */
+            for (i = 0; i < NVAL; i++)
+                expected[i] = (i & 1) && (unsigned short)(i - lo[r]) <= span[r];
+
+            for (level = GLM_SIMD_SCALAR; level <= max_level; level++)
+            {
+                if (glm_unpack_set_level(level)) ERR;
+                for (i = 0; i < NVAL; i++)
+                    match[i] = i & 1;
+                glm_match_ushort(src, NVAL, lo[r], span[r], match);
+                if (memcmp(match, expected, NVAL)) ERR;
+
+                /* Lengths which leave a remainder, at an unaligned
+                 * start. */
+                for (n = 0; n < 70; n++)
+                {
+                    memset(match, 1, n + 1);
+                    glm_match_ushort(src + 1, n, lo[r], span[r], match);
+                    for (i = 0; i < n; i++)
+                        if (match[i] != ((unsigned short)(i + 1 - lo[r]) <= span[r])) ERR;
+                    if (match[n] != 1) ERR;
+                }
+            }
+        }
+        free(expected);
+        free(match);
+    }
+    SUMMARIZE_ERR;
+    printf("testing unsupported kernel level...");
+    {
+        if (max_level < GLM_SIMD_AVX512)
+            if (glm_unpack_set_level(max_level + 1) != GLM_ERR_UNEXPECTED) ERR;
+        if (glm_unpack_set_level(-1)) ERR;
+        if (glm_unpack_level() != max_level) ERR;
+    }
+    SUMMARIZE_ERR;
+    free(src);
+    FINAL_RESULTS;
+}
@@ -5,10 +5,15 @@
  * Amsterdam
  */
 
+#include <stdio.h>
+#include <stdlib.h>
 #include <time.h>
 #include <sys/time.h>
 #include "un_test.h"
 
+/* Size of the buffer for the name of a file in a directory. */
+#define MAX_PATH 256
+
 /** Subtract the `struct timeval' values X and Y, storing the result in
     RESULT.  Return 1 if the difference is negative, otherwise 0.  This
     function from the GNU documentation. */
@@ -36,3 +41,70 @@ un_timeval_subtract (result, x, y)
     /* Return 1 if result is negative. */
     return x->tv_sec < y->tv_sec;
 }
+
+/** Make the name of a file in a directory. The name is in a static
+    buffer, which the next call overwrites. */
+const char *
+un_dir_path(const char *dir, const char *name)
+{
+    static char path[MAX_PATH];
+
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    return path;
+}
+
+/** Copy the test file into a directory under a name. Return 0 on
+    success, 2 on error. */
+int
+un_copy_data_file(const char *dir, const char *name)
+{
+    FILE *in, *out;
+    char buf[4096];
+    size_t n;
+
+    if (!(in = fopen(GLM_DATA_FILE, "rb"))) ERR2;
+    if (!(out = fopen(un_dir_path(dir, name), "wb")))
+    {
+        fclose(in);
+        ERR2;
+    }
+    while ((n = fread(buf, 1, sizeof(buf), in)))
+        if (fwrite(buf, 1, n, out) != n) ERR2;
+    fclose(in);
+    if (fclose(out)) ERR2;
+
+    return 0;
+}
+
+/** An allocator for glm_set_allocator() which counts what it does,
+    and can be made to fail. The ctx is a UN_COUNTS_T. Sizes of 0,
+    and alignments which are less than 16 or not a power of 2, which
+    the library never asks for, fail. */
+void *
+un_count_alloc(size_t size, size_t align, void *ctx)
+{
+    UN_COUNTS_T *counts = ctx;
+    void *ptr;
+
+    if (!size || align < 16 || (align & (align - 1)))
+        return NULL;
+    if (counts->fail >= 0 && !counts->fail--)
+        return NULL;
+    if (posix_memalign(&ptr, align, size))
+        return NULL;
+    counts->nalloc++;
+    if (align > counts->max_align)
+        counts->max_align = align;
+
+    return ptr;
+}
+
+/** The free of the counting allocator. */
+void
+un_count_free(void *ptr, void *ctx)
+{
+    UN_COUNTS_T *counts = ctx;
+
+    counts->nfree++;
+    free(ptr);
+}
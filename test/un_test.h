@@ -8,6 +8,7 @@
 #define _UN_TEST_H
 
 #include <assert.h>
+#include <stddef.h>
 
 #define MILLION 1000000
 
@@ -61,8 +62,25 @@
    return 0; \
 } while (0)
 
-/* Prototype from tst_utils.c. */
+/* Bookkeeping of the counting allocator of tst_utils.c, which is
+ * passed as the ctx of glm_set_allocator(). */
+typedef struct UN_COUNTS
+{
+    size_t nalloc;    /* Number of allocations. */
+    size_t nfree;     /* Number of frees. */
+    size_t max_align; /* Largest alignment asked for. */
+    int fail;         /* If >= 0, fail after this many more allocations. */
+} UN_COUNTS_T;
+
+/* Counts which count, and do not fail. */
+#define UN_COUNTS_INIT {0, 0, 0, -1}
+
+/* Prototypes from tst_utils.c. */
 int un_timeval_subtract(struct timeval *result, struct timeval *x,
 			struct timeval *y);
+const char *un_dir_path(const char *dir, const char *name);
+int un_copy_data_file(const char *dir, const char *name);
+void *un_count_alloc(size_t size, size_t align, void *ctx);
+void un_count_free(void *ptr, void *ctx);
 
 #endif /* _UN_TEST_H */